@@ -20,7 +20,27 @@
 #ifndef WINDOWS_SENSOR_PLUGIN_H
 #define WINDOWS_SENSOR_PLUGIN_H
 
+// Local NMEA server, includes Winsock so must precede windows.h
+#include "sensor_plugin_server.h"
+#include "sensor_plugin_gpsd.h"
+#include "sensor_plugin_n2k.h"
+#include "sensor_plugin_signalk.h"
+#include "sensor_plugin_json.h"
+#include "sensor_plugin_publisher.h"
+#include "sensor_plugin_ntp.h"
+#include "sensor_plugin_nmea.h"
+#include "sensor_plugin_arbiter.h"
+#include "sensor_plugin_sources.h"
+#include "sensor_plugin_cadence.h"
+#include "sensor_plugin_epoch.h"
+#include "sensor_plugin_latency.h"
+#include "sensor_plugin_counters.h"
+#include "sensor_plugin_logger.h"
+
 #include "sensor_plugin_settings.h"
+#include "sensor_plugin_track.h"
+#include "sensor_plugin_overlay.h"
+#include "sensor_plugin_skyplot.h"
 
 // Windows COM and Sensor API
 #define _WINSOCKAPI_
@@ -29,6 +49,11 @@
 #include <sensors.h>
 #pragma comment(lib,"sensorsapi.lib")
 
+// Compass and gyrometer
+#include "sensor_plugin_orientation.h"
+#include "sensor_plugin_motion.h"
+#include "sensor_plugin_barometer.h"
+
 // wxWidgets
 // Pre compiled headers 
 #include "wx/wxprec.h"
@@ -39,6 +64,11 @@
 #include <wx/timer.h>
 #include <wx/string.h>
 #include <wx/fileconf.h>
+#include <wx/filename.h>
+#include <wx/aui/framemanager.h>
+
+#include <atomic>
+#include <thread>
 
 // Defines version numbers, names etc. for this plugin
 #include "version.h"
@@ -59,14 +89,55 @@ bool isRMC;
 // The PC's GPS Sensor Name
 wxString sensorName;
 
+// Track Log Options
+bool isTrackLog;
+bool isTrackOverlay;
+double trackTolerance;
+double exportTolerance;
+double speedTolerance;
+wxString trackLogFileName;
+
+// Accuracy Ring Options
+bool isAccuracyRing;
+double uere;
+
+// Sky Plot Options
+bool isSkyPlot;
+
+// NMEA Server Options
+bool isServerTCP;
+int serverTCPPort;
+bool isServerUDP;
+wxString serverUDPAddress;
+int serverUDPPort;
+bool isGPSD;
+int gpsdPort;
+bool isSharedMemory;
+bool isNTP;
+int ntpUnit;
+bool isN2K;
+wxString n2kAddress;
+int n2kPort;
+int n2kSource;
+int n2kFormat;
+bool isSignalK;
+wxString signalKAddress;
+int signalKPort;
+
+// Location Source Options
+bool isFusion;
+bool isAdaptiveInterval;
+int batterySaver;
+int epochOffset;
+
+// Diagnostics, shown in the settings dialog
+wxString diagnosticsText;
+
+// Orientation Sensor Options
+bool isOrientation;
+bool isMotion;
+bool isBarometer;
 
-// Structure for aggregating satellites used for position fix
-typedef struct _satellite_info {
-	unsigned int id;
-	double elevation;
-	double azimuth;
-	double snr;
-} SatelliteInformation;
 
 // The Windows Sensor plugin
 class Windows_Sensor_Plugin : public opencpn_plugin_116, wxTimer {
@@ -90,6 +161,10 @@ public:
 	wxString GetLongDescription();
 	wxBitmap *GetPlugInBitmap();
 	void ShowPreferencesDialog(wxWindow* parent);
+	bool RenderOverlayMultiCanvas(wxDC &dc, PlugIn_ViewPort *vp, int canvasIndex);
+	bool RenderGLOverlayMultiCanvas(wxGLContext *pcontext, PlugIn_ViewPort *vp, int canvasIndex);
+	void SetColorScheme(PI_ColorScheme cs);
+	void SetNMEASentence(wxString &sentence);
 		
 private: 
 	
@@ -108,14 +183,113 @@ private:
 	// NMEA 0183 Checksum
 	wxString ComputeChecksum(wxString sentence);
 
-	// Uses Windows Sensor API to find, initialize and fetch data from a location sensor
-	bool InitializeSensor(void);
-	bool GetData(void);
-	void GetSatelliteInfo(const PROPERTYKEY key, std::vector<SatelliteInformation> &sats);
+	// Append the checksum and send the sentence to OpenCPN and any local clients
+	void SendSentence(wxString sentence);
+	std::vector<std::string> epochSentences;
+
+	// Serves our sentences to other applications on this computer
+	NMEA_Server nmeaServer;
+
+	// The decoded fix for the current epoch
+	PositionFix currentFix;
+	void UpdateFix(void);
+
+	// Serves the decoded fix to gpsd clients
+	GPSD_Server gpsdServer;
+
+	// Publishes the decoded fix to shared memory for local applications
+	Fix_Publisher fixPublisher;
+
+	// Disciplines the system clock via ntpd
+	NTP_Reference_Clock ntpClock;
+
+	// Sends the decoded fix as NMEA 2000 PGNs
+	N2K_Output n2kOutput;
+
+	// Sends the decoded fix as Signal K deltas
+	Signal_K_Output signalKOutput;
+
+	// Heading and rate of turn, generated at the native rate of the sensors
+	Orientation_Sensor orientationSensor;
+
+	// Roll, pitch and yaw from the inertial sensors
+	Motion_Sensor motionSensor;
+	void SendMotionMessage(void);
+
+	// Barometric pressure and tendency
+	Barometer_Sensor barometerSensor;
 
-	// Windows Sensor COM interfaces
-	ISensorManager *sensorManager;
-	ISensor *sensor;
+	// Sentences received from OpenCPN, narrowed into a fixed buffer and decoded in place
+	char nmeaBuffer[NMEA_MAXIMUM_LENGTH + 1];
+
+	// Fix assembled from the sentences of an external receiver
+	int externalSource;
+	PositionFix externalFix;
+	std::vector<SatelliteInformation> externalSatellites;
+	GSV_Assembler externalConstellations;
+	void UpdateExternalFix(const NmeaSentence &sentence);
+
+	// Chooses which of the internal sensors or external receiver to forward
+	Source_Arbiter sourceArbiter;
+	int selectedSource;
+	PositionFix fusedFix;
+	std::vector<SatelliteInformation> fusedSatellites;
+	void ApplyFix(const PositionFix &fix, const std::vector<SatelliteInformation> &sourceSatellites);
+
+	// Reused for the JSON plugin messages
+	std::string messageBuffer;
+	Json_Writer messageWriter;
+
+	// Uses Windows Sensor API to fetch data from a location sensor
+	bool GetData(ISensor *sensor);
+	void GetSatelliteInfo(ISensorDataReport *sensorData, const PROPERTYKEY key, std::vector<SatelliteInformation> &sats);
+	void CaptureReceiveTime(ISensorDataReport *sensorData);
+
+	// Location sensors, which may be added, removed, enabled or disabled at any time
+	Location_Sensors locationSensors;
+	long long lastRescan;
+
+	// Discovery runs in the background so that OpenCPN is not held up, the sensors are attached once it completes
+	std::thread discoveryThread;
+	std::atomic<bool> isDiscovered;
+	std::atomic<unsigned int> discoveredCount;
+	bool isAttached;
+	void AttachSensors(void);
+
+	// Start up latency, monotonic milliseconds
+	long long initTime;
+	long long attachTime;
+	long long firstFixTime;
+	std::vector<SensorTransition> sensorTransitions;
+	void SendStateMessage(const SensorTransition &transition);
+
+	// Epoch interval, adapted to the vessel's speed and turn rate
+	Adaptive_Cadence cadence;
+	unsigned int epochInterval;
+	void UpdateInterval(bool isValid, long long now);
+	void RequestReportInterval(void);
+
+	// Fires each epoch on a UTC boundary, rather than every so many milliseconds from whenever we started
+	Epoch_Scheduler epochScheduler;
+	void ScheduleEpoch(void);
+
+	// Latency of each stage from the sensor timestamping a report to its sentences reaching OpenCPN
+	Latency_Monitor latencyMonitor;
+	// Performance counter when the current report was fetched, before it is wound back to the report's timestamp
+	long long acquireTime;
+	// Time spent in PushNMEABuffer this epoch
+	long long pushTicks;
+	long long latencyTime;
+	void SendLatencyMessage(void);
+
+	// Performance counters, with the start up and epoch timings
+	long long performanceFrequency;
+	long long counterTime;
+	void SendCountersMessage(void);
+
+	// Verbose logging is written to its own file by a background thread, rather than to the OpenCPN log
+	Async_Logger verboseLog;
+	wxString verboseLogFileName;
 
 	// The GPS variables
 	double latitude;
@@ -125,6 +299,7 @@ private:
 	double trueHeading;
 	double magneticHeading;
 	double magneticVariation;
+	bool isVariationValid;
 	double altitude;
 	double hDOP;
 	double pDOP;
@@ -141,8 +316,30 @@ private:
 	unsigned int operationMode;
 	unsigned int fixStatus;
 
+	// When the current report was received and the sentence, if any, the sensor attached to it
+	ReceiveTime receiveTime;
+	std::string sensorSentence;
+
 	// If sensor has been initialized
 	bool isRunning;
+
+	// Simplified log of our track
+	Track_Log trackLog;
+
+	// Breadcrumb trail drawn on the chart
+	Track_Overlay trackOverlay;
+
+	// Estimated position error drawn around own ship
+	Accuracy_Overlay accuracyOverlay;
+
+	// Dockable satellite display
+	Sky_Plot_Panel *skyPlotPanel;
+	void ShowSkyPlot(bool show);
+
+	// Learned sky obstructions, persisted between sessions
+	Obstruction_Mask obstructionMask;
+	wxString obstructionMaskFileName;
+	long long maskSaveTime;
 	
 	// Preferences Dialog
 	Windows_Sensor_Plugin_Settings *settingsDialog;
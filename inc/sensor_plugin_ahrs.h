@@ -0,0 +1,72 @@
+// Copyright(C) 2024 by Steven Adler
+//
+// This file is part of Windows Sensor Plugin for OpenCPN.
+//
+// Windows Sensor Plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Windows Sensor Plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Windows Sensor Plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#ifndef WINDOWS_SENSOR_PLUGIN_AHRS_H
+#define WINDOWS_SENSOR_PLUGIN_AHRS_H
+
+// Filter gain, larger values converge faster but are noisier
+#define AHRS_DEFAULT_BETA 0.1
+
+// Unit quaternion, rotates vectors from the body frame into the earth frame
+typedef struct _quaternion {
+	double w;
+	double x;
+	double y;
+	double z;
+} Quaternion;
+
+// Three component vector, in the body frame unless stated otherwise
+typedef struct _vector3 {
+	double x;
+	double y;
+	double z;
+} Vector3;
+
+// Madgwick attitude and heading reference system.
+// Body frame is x forward, y to port, z up. The earth frame is x towards magnetic north, z up.
+// Refer to S. Madgwick, "An efficient orientation filter for inertial and inertial/magnetic sensor arrays", 2010
+class Madgwick_Filter {
+
+public:
+	Madgwick_Filter(double beta = AHRS_DEFAULT_BETA);
+	~Madgwick_Filter(void);
+
+	void Reset(void);
+
+	// Gyroscope in radians per second, accelerometer and magnetometer in any consistent units.
+	// The magnetometer may be omitted, in which case yaw is unreferenced and will drift.
+	void Update(const Vector3 &gyroscope, const Vector3 &accelerometer, const Vector3 &magnetometer, double elapsed);
+	void Update(const Vector3 &gyroscope, const Vector3 &accelerometer, double elapsed);
+
+	Quaternion GetQuaternion(void);
+
+	// Degrees. Roll is positive with the starboard side down, pitch is positive bow up,
+	// yaw is the magnetic heading, clockwise from north
+	void GetEulerAngles(double &roll, double &pitch, double &yaw);
+
+	// Rotate a body frame vector into the earth frame
+	static Vector3 Rotate(const Quaternion &q, const Vector3 &v);
+
+private:
+	Quaternion q;
+	double beta;
+
+	void Integrate(double qDot1, double qDot2, double qDot3, double qDot4, double elapsed);
+};
+
+#endif
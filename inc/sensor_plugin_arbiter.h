@@ -0,0 +1,125 @@
+// Copyright(C) 2024 by Steven Adler
+//
+// This file is part of Windows Sensor Plugin for OpenCPN.
+//
+// Windows Sensor Plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Windows Sensor Plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Windows Sensor Plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#ifndef WINDOWS_SENSOR_PLUGIN_ARBITER_H
+#define WINDOWS_SENSOR_PLUGIN_ARBITER_H
+
+// wxWidgets Precompiled Headers
+#include "wx/wxprec.h"
+
+#ifndef  WX_PRECOMP
+#include "wx/wx.h"
+#endif
+#include <wx/string.h>
+
+#include <vector>
+
+// Position fix and satellites
+#include "sensor_plugin_fix.h"
+
+// A source that has not reported for this long, in milliseconds, is unusable
+#define ARBITER_SOURCE_TIMEOUT 3000
+// or for this many epochs, when the epochs are longer
+#define ARBITER_TIMEOUT_EPOCHS 2
+// A challenger must score this much better than the selected source
+#define ARBITER_SWITCH_MARGIN 0.2
+// for this many consecutive epochs before it is selected
+#define ARBITER_SWITCH_EPOCHS 3
+// Exponential smoothing of each source's score
+#define ARBITER_SCORE_SMOOTHING 0.3
+// Distance, in metres, between a fix and its dead reckoned prediction at which consistency is halved
+#define ARBITER_CONSISTENCY_DISTANCE 50.0
+// Assumed if a source does not report HDOP
+#define ARBITER_DEFAULT_HDOP 2.0
+// User equivalent range error, in metres, used to convert HDOP into a horizontal error when fusing
+#define ARBITER_UERE 5.0
+// Share of the score that depends on how many of a source's satellites are in clear sky
+#define ARBITER_CLEAR_SKY_SHARE 0.5
+
+// The latest fix from one location source
+typedef struct _gnss_source {
+	wxString name;
+	bool isExternal;
+	PositionFix fix;
+	std::vector<SatelliteInformation> satellites;
+	// Monotonic milliseconds when the fix was measured, zero if never
+	long long receiveTime;
+	// Smoothed distance between each fix and the position predicted from the previous one
+	double residual;
+	// Smoothed distance between this source and the fused position
+	double fusionResidual;
+	// Fraction of the source's satellites in clear sky, as per the obstruction mask
+	double clearSkyWeight;
+	// Position aligned to the time of the latest fusion
+	double alignedLatitude;
+	double alignedLongitude;
+	double score;
+	unsigned int updateCount;
+} GnssSource;
+
+// Selects the best of several location sources, or optionally combines them.
+// Each source is scored on its fix quality, HDOP, age, the consistency of successive fixes and how many of
+// its satellites are in clear sky, as those behind an obstruction are prone to multipath. The selected
+// source is only replaced by a clearly better one that stays better for several epochs, but if it becomes
+// unusable the best remaining source is selected immediately.
+class Source_Arbiter {
+
+public:
+	Source_Arbiter(void);
+	~Source_Arbiter(void);
+
+	// Returns the index of the new source
+	int AddSource(const wxString &name, bool isExternal);
+	void Clear(void);
+
+	void Update(int source, const PositionFix &fix, const std::vector<SatelliteInformation> &satellites, long long now, double clearSkyWeight);
+
+	// Sensors are asked to report once per epoch, so the timeout stretches with the epoch interval
+	void SetEpochInterval(unsigned int interval, long long now);
+
+	// Rescore every source and return the one to forward, -1 if none is usable
+	int Select(long long now);
+
+	// Combine every usable source into one fix, each aligned to now and weighted by the inverse of its
+	// estimated variance. Returns the number of sources combined, the fix is only written if at least two.
+	unsigned int Fuse(long long now, PositionFix &fused, std::vector<SatelliteInformation> &satellites);
+
+	int GetSelected(void);
+	unsigned int GetSourceCount(void);
+	const GnssSource &GetSource(int source);
+
+private:
+	std::vector<GnssSource> sources;
+	int selected;
+
+	// Source that is outscoring the selected one and for how many epochs
+	int challenger;
+	unsigned int challengerEpochs;
+
+	// Current timeout, and a shorter one adopted once the sources have had time to report more often
+	long long timeout;
+	long long pendingTimeout;
+	long long pendingSince;
+
+	double Score(const GnssSource &source, long long now);
+	static double QualityWeight(unsigned int fixType);
+	static double Distance(double latitude1, double longitude1, double latitude2, double longitude2);
+	static void Propagate(const PositionFix &fix, double interval, double &latitude, double &longitude);
+};
+
+#endif
@@ -0,0 +1,97 @@
+// Copyright(C) 2024 by Steven Adler
+//
+// This file is part of Windows Sensor Plugin for OpenCPN.
+//
+// Windows Sensor Plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Windows Sensor Plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Windows Sensor Plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#ifndef WINDOWS_SENSOR_PLUGIN_BAROMETER_H
+#define WINDOWS_SENSOR_PLUGIN_BAROMETER_H
+
+// Sensor API helpers
+#include "sensor_plugin_orientation.h"
+
+// Streaming JSON writer
+#include "sensor_plugin_json.h"
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+// Pressure is sampled every second and averaged over a minute
+#define BAROMETER_SAMPLE_INTERVAL 1000
+#define BAROMETER_AVERAGE_SAMPLES 60
+// Sentences and the plugin message are sent every 10 seconds
+#define BAROMETER_OUTPUT_SAMPLES 10
+// 24 hours of one minute averages
+#define BAROMETER_HISTORY_SIZE 1440
+#define BAROMETER_SHORT_WINDOW 180
+#define BAROMETER_LONG_WINDOW 1440
+// Conversion to inches of mercury
+#define BAROMETER_BAR_TO_INHG 29.5300
+
+// Fixed size circular buffer of one minute pressure averages.
+// Running sums are maintained for the 3 and 24 hour windows, so the mean and tendency are constant time.
+class Pressure_History {
+
+public:
+	Pressure_History(void);
+	~Pressure_History(void);
+
+	void Clear(void);
+	void Add(double pressure);
+
+	// Change in pressure over the last number of minutes, false if the history is too short
+	bool GetTendency(unsigned int minutes, double &tendency);
+	// Mean pressure over the 3 or 24 hour window, false if the window is empty
+	bool GetShortMean(double &mean);
+	bool GetLongMean(double &mean);
+
+private:
+	double history[BAROMETER_HISTORY_SIZE];
+	unsigned int historyIndex;
+	unsigned int historyCount;
+	double shortSum;
+	double longSum;
+
+	double GetAgo(unsigned int minutes);
+};
+
+// Barometric pressure and temperature sensors.
+// Samples on its own thread, sends XDR and MDA sentences to OpenCPN and publishes the pressure and
+// its 3 and 24 hour tendency to other plugins in the WINDOWS_SENSOR_BAROMETER message.
+class Barometer_Sensor {
+
+public:
+	Barometer_Sensor(void);
+	~Barometer_Sensor(void);
+
+	bool Start(void);
+	void Stop(void);
+	bool IsRunning(void);
+
+private:
+	std::thread sensorThread;
+	std::atomic<bool> isRunning;
+
+	Pressure_History pressureHistory;
+
+	std::string messageBuffer;
+	Json_Writer messageWriter;
+
+	void SensorLoop(void);
+	void SendOutput(double pressure, bool isTemperature, double temperature);
+};
+
+#endif
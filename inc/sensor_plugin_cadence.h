@@ -0,0 +1,103 @@
+// Copyright(C) 2024 by Steven Adler
+//
+// This file is part of Windows Sensor Plugin for OpenCPN.
+//
+// Windows Sensor Plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Windows Sensor Plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Windows Sensor Plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#ifndef WINDOWS_SENSOR_PLUGIN_CADENCE_H
+#define WINDOWS_SENSOR_PLUGIN_CADENCE_H
+
+#include <windows.h>
+
+// Epoch interval, in milliseconds, for each tier
+#define CADENCE_MANOEUVRE_INTERVAL 200
+#define CADENCE_FAST_INTERVAL 500
+#define CADENCE_NORMAL_INTERVAL 1000
+#define CADENCE_STATIONARY_INTERVAL 5000
+// Battery saver never polls faster than this, and slower still when cruising or stationary
+#define CADENCE_SAVER_MINIMUM_INTERVAL 1000
+#define CADENCE_SAVER_NORMAL_INTERVAL 2000
+#define CADENCE_SAVER_STATIONARY_INTERVAL 10000
+
+// Speed, in knots, and turn rate, in degrees per second, at which each tier is entered
+#define CADENCE_MANOEUVRE_SPEED 20.0
+#define CADENCE_MANOEUVRE_TURN_RATE 10.0
+#define CADENCE_FAST_SPEED 8.0
+#define CADENCE_FAST_TURN_RATE 3.0
+#define CADENCE_STATIONARY_SPEED 0.3
+// A tier is left once below this fraction of the threshold at which it was entered
+#define CADENCE_EXIT_RATIO 0.8
+// Course over ground is meaningless below this speed, so no turn rate is derived
+#define CADENCE_TURN_SPEED 1.0
+#define CADENCE_TURN_SMOOTHING 0.5
+
+// Faster tiers are adopted at once, slower ones only after being indicated for this long, in milliseconds
+#define CADENCE_SLOWDOWN_DELAY 10000
+#define CADENCE_STATIONARY_DELAY 60000
+
+enum CADENCE_TIER {
+	CADENCE_STATIONARY,
+	CADENCE_NORMAL,
+	CADENCE_FAST,
+	CADENCE_MANOEUVRE
+};
+
+// Battery saver profile
+enum BATTERY_SAVER {
+	BATTERY_SAVER_NEVER,
+	// Whilst running on battery or Windows battery saver is on
+	BATTERY_SAVER_ON_BATTERY,
+	BATTERY_SAVER_ALWAYS
+};
+
+// Chooses the epoch interval from the vessel's dynamics.
+// Fast or turning vessels are polled more often, stationary ones less often. Turn rate is derived from
+// successive courses over ground. Hysteresis in both the thresholds and the time taken to slow down stops
+// the interval from hunting.
+class Adaptive_Cadence {
+
+public:
+	Adaptive_Cadence(void);
+	~Adaptive_Cadence(void);
+
+	void Reset(void);
+
+	// Called each epoch with the current fix, returns the interval in milliseconds
+	unsigned int Update(double speedOverGround, double courseOverGround, bool isValid, long long now, bool isSaving);
+
+	unsigned int GetInterval(void);
+	CADENCE_TIER GetTier(void);
+	// Degrees per second, positive to starboard
+	double GetTurnRate(void);
+
+	// Whether the computer is running on battery or Windows battery saver is on
+	static bool IsOnBattery(void);
+
+private:
+	CADENCE_TIER tier;
+	CADENCE_TIER pendingTier;
+	long long pendingSince;
+	unsigned int interval;
+
+	double turnRate;
+	double lastCourse;
+	long long lastTime;
+	bool hasCourse;
+
+	CADENCE_TIER Indicated(double speedOverGround, bool isValid);
+	static unsigned int Interval(CADENCE_TIER tier, bool isSaving);
+};
+
+#endif
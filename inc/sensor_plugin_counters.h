@@ -0,0 +1,86 @@
+// Copyright(C) 2024 by Steven Adler
+//
+// This file is part of Windows Sensor Plugin for OpenCPN.
+//
+// Windows Sensor Plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Windows Sensor Plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Windows Sensor Plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#ifndef WINDOWS_SENSOR_PLUGIN_COUNTERS_H
+#define WINDOWS_SENSOR_PLUGIN_COUNTERS_H
+
+// wxWidgets Precompiled Headers
+#include "wx/wxprec.h"
+
+#ifndef  WX_PRECOMP
+#include "wx/wx.h"
+#endif
+#include <wx/string.h>
+
+#include <atomic>
+
+// Counters are serialised as a JSON plugin message
+#include "sensor_plugin_json.h"
+
+// Threads with a block of their own, any more share the last block
+#define COUNTER_MAXIMUM_THREADS 16
+// Interval, in milliseconds, between counter plugin messages
+#define COUNTER_REPORT_INTERVAL 60000
+
+typedef enum _performance_counter {
+	// Timer notifications
+	COUNTER_TICKS,
+	// Reports read from the internal sensors
+	COUNTER_REPORTS,
+	// Sentences pushed to OpenCPN, by type
+	COUNTER_GGA,
+	COUNTER_GLL,
+	COUNTER_GSV,
+	COUNTER_RMC,
+	COUNTER_BYTES_PUSHED,
+	// Reports and external sentences without a valid fix
+	COUNTER_REJECTED_FIXES,
+	// Failed Sensor API calls
+	COUNTER_COM_FAILURES,
+	// Performance counter ticks spent in GetData
+	COUNTER_GETDATA_TIME,
+	// Sentences from an external receiver, and those that were malformed
+	COUNTER_NMEA_RECEIVED,
+	COUNTER_NMEA_ERRORS,
+	// Verbose log records dropped because the ring was full
+	COUNTER_LOG_DROPPED,
+	COUNTER_COUNT
+} PERFORMANCE_COUNTER;
+
+// Process wide performance counters, cheap enough to leave enabled.
+// Each thread increments its own cache line aligned block with a plain load and store, there is no
+// locked instruction and no sharing between threads. The blocks are only summed when the counters are
+// read, so a reader may be a few increments behind. Blocks are never released, so a thread's counts
+// survive it, and the counters run from when OpenCPN loaded the plugin.
+class Performance_Counters {
+
+public:
+	static void Increment(PERFORMANCE_COUNTER counter);
+	static void Add(PERFORMANCE_COUNTER counter, unsigned long long value);
+
+	// Sum of every thread's block
+	static unsigned long long Get(PERFORMANCE_COUNTER counter);
+	static const char *CounterName(PERFORMANCE_COUNTER counter);
+
+	// {"ticks":n,"reports":n,...}, the time in GetData is converted to milliseconds
+	static void Write(Json_Writer &writer, long long frequency);
+	// One line per counter for the settings dialog
+	static wxString Summary(long long frequency);
+};
+
+#endif
@@ -0,0 +1,89 @@
+// Copyright(C) 2024 by Steven Adler
+//
+// This file is part of Windows Sensor Plugin for OpenCPN.
+//
+// Windows Sensor Plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Windows Sensor Plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Windows Sensor Plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#ifndef WINDOWS_SENSOR_PLUGIN_EPOCH_H
+#define WINDOWS_SENSOR_PLUGIN_EPOCH_H
+
+// Epochs closer than this, in milliseconds, are skipped rather than fired late
+#define EPOCH_MINIMUM_DELAY 2
+// Default offset, in milliseconds, after each boundary at which the epoch fires
+#define EPOCH_DEFAULT_OFFSET 50
+// Smoothing of the UTC to monotonic offset, so that one late report does not move the epochs
+#define EPOCH_REFERENCE_SMOOTHING 0.1
+// A change in the offset larger than this, in 100 nanosecond intervals, is a clock step and is adopted at once
+#define EPOCH_REFERENCE_STEP 10000000LL
+
+// Schedules epochs on UTC boundaries using a monotonic clock.
+// Each fix pairs its GNSS time with the monotonic time at which it was received. From the smoothed offset
+// between the two, the next multiple of the interval since midnight, plus a fixed offset, is converted to a
+// monotonic deadline, so each boundary maps to when its fix arrives. A fix without a GNSS time is instead
+// taken to belong to the boundary before its report, which locks the epochs to the phase of the reports. Each deadline is computed afresh rather than accumulated, so nothing drifts, and the
+// scheduler has no clock of its own: all times are passed in, so it may equally drive a dedicated thread.
+// UTC times are 100 nanosecond intervals since 1601, as per FILETIME, monotonic times are in ticks.
+class Epoch_Scheduler {
+
+public:
+	Epoch_Scheduler(void);
+	~Epoch_Scheduler(void);
+
+	// Ticks per second of the monotonic clock, clears the reference and statistics
+	void Reset(long long frequency);
+
+	// GNSS time of a fix and when it was received
+	void SetReference(long long utc, long long monotonic);
+	// Time of a report without a GNSS time, from the system clock, and when it was received
+	void SetReportReference(long long realtime, long long monotonic, unsigned int interval);
+	bool HasReference(void);
+
+	// Monotonic time of the first epoch boundary after now
+	long long NextEpoch(long long now, unsigned int interval, unsigned int offset);
+	// Milliseconds from now until the deadline, rounded up
+	unsigned int Delay(long long deadline, long long now);
+
+	// Record when the epoch returned by NextEpoch actually started
+	void Record(long long actual);
+
+	// Lateness of each epoch in milliseconds
+	void GetJitter(double &mean, double &deviation, double &maximum, unsigned long long &count);
+	// Boundaries passed without an epoch, eg. whilst OpenCPN was busy
+	unsigned long long GetMissedCount(void);
+
+private:
+	long long frequency;
+	// UTC less monotonic, in 100 nanosecond intervals
+	double referenceOffset;
+	bool hasReference;
+	// Whether the offset follows the phase of the reports rather than GNSS time
+	bool isReportLocked;
+
+	long long scheduled;
+	long long scheduledPeriod;
+
+	// Welford running mean and variance
+	unsigned long long count;
+	double mean;
+	double sumSquares;
+	double maximum;
+	unsigned long long missed;
+
+	void UpdateOffset(double offset);
+	long long ToHundredNanoseconds(long long ticks);
+	long long ToTicks(long long hundredNanoseconds);
+};
+
+#endif
@@ -0,0 +1,64 @@
+// Copyright(C) 2024 by Steven Adler
+//
+// This file is part of Windows Sensor Plugin for OpenCPN.
+//
+// Windows Sensor Plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Windows Sensor Plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Windows Sensor Plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#ifndef WINDOWS_SENSOR_PLUGIN_FIX_H
+#define WINDOWS_SENSOR_PLUGIN_FIX_H
+
+#include <vector>
+
+// Structure for aggregating satellites used for position fix
+typedef struct _satellite_info {
+	unsigned int id;
+	double elevation;
+	double azimuth;
+	double snr;
+} SatelliteInformation;
+
+// A decoded position fix, shared by the outputs that do not use NMEA 0183
+typedef struct _position_fix {
+	double latitude;
+	double longitude;
+	double altitude;
+	double speedOverGround; // knots
+	double courseOverGround;
+	double magneticVariation;
+	double hDOP;
+	double vDOP;
+	double pDOP;
+	double geoidalSeparation;
+	double dgpsAge;
+	unsigned int dgpsReferenceId;
+	unsigned int satellitesInUse;
+	unsigned int satellitesInView;
+	unsigned int fixType;
+	unsigned int fixStatus;
+	unsigned int selectionMode;
+	long long timeStamp; // UTC milliseconds since the epoch
+	bool isValid;
+	// Few sensors report the magnetic variation
+	bool isVariationValid;
+} PositionFix;
+
+// When a sensor report was received, the monotonic and realtime clocks are sampled together so that
+// intervals are immune to the system clock being stepped
+typedef struct _receive_time {
+	long long monotonic; // QueryPerformanceCounter ticks
+	long long realtime; // UTC 100 nanosecond intervals since 1601, as per FILETIME
+} ReceiveTime;
+
+#endif
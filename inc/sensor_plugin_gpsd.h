@@ -0,0 +1,119 @@
+// Copyright(C) 2024 by Steven Adler
+//
+// This file is part of Windows Sensor Plugin for OpenCPN.
+//
+// Windows Sensor Plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Windows Sensor Plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Windows Sensor Plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#ifndef WINDOWS_SENSOR_PLUGIN_GPSD_H
+#define WINDOWS_SENSOR_PLUGIN_GPSD_H
+
+// Winsock must be included before windows.h
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "ws2_32.lib")
+
+// wxWidgets Precompiled Headers
+#include "wx/wxprec.h"
+
+#ifndef  WX_PRECOMP
+#include "wx/wx.h"
+#endif
+#include <wx/string.h>
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Decoded position fix and satellites
+#include "sensor_plugin_fix.h"
+
+// Default gpsd port
+#define GPSD_DEFAULT_PORT 2947
+// Connections beyond this are refused
+#define GPSD_MAXIMUM_CLIENTS 256
+// Longest command accepted from a client
+#define GPSD_MAXIMUM_COMMAND 1024
+
+// State of each connected client
+typedef struct _gpsd_client {
+	SOCKET socket;
+	std::string command;
+	bool isWatching;
+	bool isJSON;
+	bool isNMEA;
+} GpsdClient;
+
+// gpsd protocol compatible server.
+// Implements the subset of the gpsd JSON protocol used by most clients, VERSION, WATCH, DEVICES and POLL.
+// TPV and SKY reports are serialised once per epoch directly from the decoded fix, and the same buffers
+// are written to every watching client.
+class GPSD_Server {
+
+public:
+	GPSD_Server(void);
+	~GPSD_Server(void);
+
+	bool Start(unsigned short port);
+	void Stop(void);
+	bool IsRunning(void);
+
+	// Serialise this epoch and queue it for transmission, never blocks on the network
+	void Publish(const PositionFix &fix, const std::vector<SatelliteInformation> &satellites, const std::vector<std::string> &sentences);
+
+	unsigned int GetClientCount(void);
+
+private:
+	SOCKET listenSocket;
+
+	// Loopback datagram socket used to wake the event loop when an epoch is published
+	SOCKET wakeSocket;
+	sockaddr_in wakeAddress;
+
+	std::vector<GpsdClient> clients;
+	std::atomic<unsigned int> clientCount;
+
+	std::thread loopThread;
+	std::atomic<bool> isRunning;
+
+	// Pre-serialised reports for the latest epoch
+	std::mutex epochMutex;
+	std::string pendingTPV;
+	std::string pendingSKY;
+	std::vector<std::string> pendingSentences;
+	bool hasPendingEpoch;
+
+	// Reports most recently sent, owned by the event loop and used to answer POLL
+	std::string currentTPV;
+	std::string currentSKY;
+	std::vector<std::string> currentSentences;
+
+	void EventLoop(void);
+	void AcceptClients(void);
+	bool ReadCommands(GpsdClient &client);
+	bool ExecuteCommand(GpsdClient &client, const std::string &command);
+	void SendEpoch(void);
+	bool SendString(SOCKET s, const std::string &text);
+	void CloseSockets(void);
+
+	static std::string VersionReport(void);
+	static std::string DevicesReport(void);
+	static std::string WatchReport(const GpsdClient &client);
+	static std::string MemberValue(const std::string &command, const char *key);
+	static std::string FormatTime(long long timeStamp);
+};
+
+#endif
@@ -0,0 +1,64 @@
+// Copyright(C) 2024 by Steven Adler
+//
+// This file is part of Windows Sensor Plugin for OpenCPN.
+//
+// Windows Sensor Plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Windows Sensor Plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Windows Sensor Plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// Project: Windows Sensor Plugin
+// Description: Heading and rate of turn from compass and gyrometer readings
+// Owner: twocanplugin@hotmail.com
+// Date: 01/04/2024
+// Version History:
+// 1.0 Initial Release
+
+#ifndef WINDOWS_SENSOR_PLUGIN_HEADING_H
+#define WINDOWS_SENSOR_PLUGIN_HEADING_H
+
+#include <string>
+
+// Time constant of the filter used to derive rate of turn from heading when there is no gyrometer
+#define ORIENTATION_RATE_TIME_CONSTANT 1.0
+
+// Derives true heading and rate of turn and formats the HDG, HDT and ROT sentences.
+// Independent of the Sensor API, the orientation sensor feeds it the values it reads.
+class Heading_Estimator {
+
+public:
+	Heading_Estimator(void);
+	~Heading_Estimator(void);
+
+	void Reset(void);
+
+	// Rate of turn from successive headings, low pass filtered as the compass is noisy.
+	// Timestamps are in 100 nanosecond units. False for the first heading or if time has not advanced.
+	bool Update(double heading, long long timeStamp, double &rateOfTurn);
+
+	// Magnetic heading corrected by the variation, east is positive. False if the variation is not known.
+	static bool TrueHeading(double magneticHeading, double variation, bool isVariationValid, double &trueHeading);
+
+	// Degrees per minute, turning to starboard is positive, from the angular velocity about the device's Z axis
+	static double GyrometerRate(double angularVelocity);
+
+	// Sentences without their checksum
+	static std::string FormatHDG(double magneticHeading, double variation, bool isVariationValid);
+	static std::string FormatHDT(double trueHeading);
+	static std::string FormatROT(double rateOfTurn);
+
+private:
+	double previousHeading;
+	long long previousTimeStamp;
+	double filteredRate;
+};
+
+#endif
@@ -0,0 +1,80 @@
+// Copyright(C) 2024 by Steven Adler
+//
+// This file is part of Windows Sensor Plugin for OpenCPN.
+//
+// Windows Sensor Plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Windows Sensor Plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Windows Sensor Plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#ifndef WINDOWS_SENSOR_PLUGIN_HEAVE_H
+#define WINDOWS_SENSOR_PLUGIN_HEAVE_H
+
+// Standard gravity, metres per second per second
+#define HEAVE_GRAVITY 9.80665
+// Waves with periods longer than this are treated as drift, seconds
+#define HEAVE_HIGH_PASS_PERIOD 60.0
+// Accelerations with periods shorter than this are treated as noise, seconds
+#define HEAVE_LOW_PASS_PERIOD 0.5
+// Time for the filters to settle before heave is reported, seconds
+#define HEAVE_SETTLING_TIME 90.0
+// Heave history used for the significant heave, 20 seconds at 200 Hz
+#define HEAVE_BUFFER_SIZE 4096
+
+// Streaming heave estimator.
+// Vertical acceleration in the earth frame is band pass filtered and integrated twice. Each integration
+// is followed by a high pass filter which removes the drift caused by sensor bias.
+// Each sample is processed in constant time without allocating memory.
+class Heave_Estimator {
+
+public:
+	Heave_Estimator(void);
+	~Heave_Estimator(void);
+
+	void Reset(void);
+
+	// Vertical acceleration in metres per second per second excluding gravity, up is positive
+	void Process(double verticalAcceleration, double elapsed);
+
+	// Metres, up is positive
+	double GetHeave(void);
+	// Four times the standard deviation of the heave history
+	double GetSignificantHeave(void);
+	bool IsSettled(void);
+
+private:
+	// First order high pass filter state
+	typedef struct _high_pass {
+		double input;
+		double output;
+	} HighPass;
+
+	HighPass accelerationFilter;
+	HighPass velocityFilter;
+	HighPass displacementFilter;
+	double lowPassAcceleration;
+	double velocity;
+	double displacement;
+	double heave;
+	double runningTime;
+
+	// Ring buffer of heave, with running sums so that the statistics are constant time
+	double history[HEAVE_BUFFER_SIZE];
+	unsigned int historyIndex;
+	unsigned int historyCount;
+	double historySum;
+	double historySumOfSquares;
+
+	static double ApplyHighPass(HighPass &filter, double input, double elapsed);
+};
+
+#endif
@@ -0,0 +1,64 @@
+// Copyright(C) 2024 by Steven Adler
+//
+// This file is part of Windows Sensor Plugin for OpenCPN.
+//
+// Windows Sensor Plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Windows Sensor Plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Windows Sensor Plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#ifndef WINDOWS_SENSOR_PLUGIN_JSON_H
+#define WINDOWS_SENSOR_PLUGIN_JSON_H
+
+#include <string>
+
+// Deepest nesting of objects and arrays
+#define JSON_MAXIMUM_DEPTH 16
+
+// Streaming JSON writer.
+// Appends directly to a caller owned buffer, inserting separators as required. Reset clears the buffer
+// but retains its capacity, so a buffer that is reused for each message stops allocating once it has
+// grown to the size of the largest message.
+class Json_Writer {
+
+public:
+	Json_Writer(std::string &buffer);
+	~Json_Writer(void);
+
+	void Reset(void);
+
+	void BeginObject(void);
+	void EndObject(void);
+	void BeginArray(void);
+	void EndArray(void);
+
+	// Keys are not escaped, they are always literals
+	void Key(const char *key);
+
+	void String(const char *value);
+	void String(const std::string &value);
+	// Non finite values are written as null
+	void Number(double value, int precision);
+	void Integer(long long value);
+	void Boolean(bool value);
+	void Null(void);
+
+private:
+	std::string &buffer;
+	bool isFirst[JSON_MAXIMUM_DEPTH];
+	unsigned int depth;
+	bool isAfterKey;
+
+	void Separator(void);
+};
+
+#endif
@@ -0,0 +1,116 @@
+// Copyright(C) 2024 by Steven Adler
+//
+// This file is part of Windows Sensor Plugin for OpenCPN.
+//
+// Windows Sensor Plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Windows Sensor Plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Windows Sensor Plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#ifndef WINDOWS_SENSOR_PLUGIN_LATENCY_H
+#define WINDOWS_SENSOR_PLUGIN_LATENCY_H
+
+// wxWidgets Precompiled Headers
+#include "wx/wxprec.h"
+
+#ifndef  WX_PRECOMP
+#include "wx/wx.h"
+#endif
+#include <wx/string.h>
+
+#include <atomic>
+
+// Percentiles are serialised as a JSON plugin message
+#include "sensor_plugin_json.h"
+
+// Each power of two is divided into this many buckets, so a value is recorded to within 1/16, about 6%
+#define LATENCY_SUB_BUCKET_BITS 4
+#define LATENCY_SUB_BUCKETS (1 << LATENCY_SUB_BUCKET_BITS)
+// Powers of two above the linear range, values are in microseconds so this covers about four minutes
+#define LATENCY_OCTAVES 24
+#define LATENCY_BUCKETS ((LATENCY_OCTAVES + 1) * LATENCY_SUB_BUCKETS)
+// Interval, in milliseconds, between latency plugin messages
+#define LATENCY_REPORT_INTERVAL 60000
+
+// Stages between the sensor timestamping a report and its sentences reaching OpenCPN
+typedef enum _latency_stage {
+	// Age of the report when we fetched it
+	LATENCY_REPORT,
+	// Reading the values from the report
+	LATENCY_DECODE,
+	// Formatting the sentences, excluding the time spent pushing them
+	LATENCY_FORMAT,
+	// PushNMEABuffer, summed over the epoch
+	LATENCY_PUSH,
+	// Handing the epoch to the servers and publishers
+	LATENCY_PUBLISH,
+	// Report timestamp to the last sentence pushed
+	LATENCY_TOTAL,
+	LATENCY_STAGES
+} LATENCY_STAGE;
+
+// Log linear histogram of latencies in microseconds, in the manner of an HDR histogram.
+// Values below LATENCY_SUB_BUCKETS have a bucket each, above that each power of two has LATENCY_SUB_BUCKETS
+// buckets, so the relative precision is the same at every magnitude and the memory is fixed.
+// Recording is a single relaxed atomic increment, so any thread may record without locking, and a
+// reader sees a histogram that is at worst a few samples behind.
+class Latency_Histogram {
+
+public:
+	Latency_Histogram(void);
+	~Latency_Histogram(void);
+
+	void Record(unsigned long long microseconds);
+	void Clear(void);
+
+	unsigned long long GetCount(void);
+	unsigned long long GetMaximum(void);
+	// Value in microseconds at or below which the given percentage of samples lie, zero if empty
+	double Percentile(double percentage);
+
+private:
+	std::atomic<unsigned int> buckets[LATENCY_BUCKETS];
+	std::atomic<unsigned long long> count;
+	std::atomic<unsigned long long> maximum;
+
+	static unsigned int BucketIndex(unsigned long long value);
+	// Midpoint of the range of values recorded in the bucket
+	static double BucketValue(unsigned int index);
+};
+
+// A histogram for each stage, recorded in ticks of the performance counter
+class Latency_Monitor {
+
+public:
+	Latency_Monitor(void);
+	~Latency_Monitor(void);
+
+	// Ticks per second of the performance counter, clears the histograms
+	void Reset(long long frequency);
+
+	// Negative intervals, eg. a report timestamped after we fetched it, are ignored
+	void Record(LATENCY_STAGE stage, long long ticks);
+
+	Latency_Histogram &GetHistogram(LATENCY_STAGE stage);
+	static const char *StageName(LATENCY_STAGE stage);
+
+	// {"report":{"count":n,"p50":x.xxx,"p90":x.xxx,"p99":x.xxx,"max":x.xxx},...} in milliseconds
+	void Write(Json_Writer &writer);
+	// One line per stage for the settings dialog
+	wxString Summary(void);
+
+private:
+	long long frequency;
+	Latency_Histogram histograms[LATENCY_STAGES];
+};
+
+#endif
@@ -0,0 +1,139 @@
+// Copyright(C) 2024 by Steven Adler
+//
+// This file is part of Windows Sensor Plugin for OpenCPN.
+//
+// Windows Sensor Plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Windows Sensor Plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Windows Sensor Plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#ifndef WINDOWS_SENSOR_PLUGIN_LOGGER_H
+#define WINDOWS_SENSOR_PLUGIN_LOGGER_H
+
+// wxWidgets Precompiled Headers
+#include "wx/wxprec.h"
+
+#ifndef  WX_PRECOMP
+#include "wx/wx.h"
+#endif
+#include <wx/string.h>
+#include <wx/file.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+// Records in the ring, must be a power of two
+#define LOGGER_CAPACITY 1024
+#define LOGGER_MAXIMUM_ARGUMENTS 6
+// Longest text argument, including the terminator, long enough for any NMEA 0183 sentence
+#define LOGGER_TEXT_LENGTH 96
+// Interval, in milliseconds, at which the writer drains the ring
+#define LOGGER_WRITE_INTERVAL 50
+// The log is rotated once it reaches this size, keeping this many previous files
+#define LOGGER_MAXIMUM_FILE_SIZE (4 * 1024 * 1024)
+#define LOGGER_FILES 3
+
+// Each message is identified by its index into the table of formats.
+// Formats may only use %lld and %llu for integers, %f, %e and %g for numbers and %s for the text.
+typedef enum _log_message {
+	LOG_SENSOR_SENTENCE,
+	LOG_SATELLITE_ID,
+	LOG_SATELLITE_AZIMUTH,
+	LOG_SATELLITE_ELEVATION,
+	LOG_SATELLITE_SNR,
+	LOG_EPOCH_INTERVAL,
+	LOG_EPOCH_JITTER,
+	LOG_GENERATED_SENTENCE,
+	// Written by the logger itself
+	LOG_DROPPED,
+	LOG_MESSAGES
+} LOG_MESSAGE;
+
+// The format determines which member is used
+typedef union _log_argument {
+	long long integer;
+	double number;
+} LogArgument;
+
+static inline LogArgument LogInteger(long long value) {
+	LogArgument argument;
+	argument.integer = value;
+	return argument;
+}
+
+static inline LogArgument LogNumber(double value) {
+	LogArgument argument;
+	argument.number = value;
+	return argument;
+}
+
+typedef struct _log_record {
+	// UTC, 100 nanosecond intervals since 1601
+	long long timeStamp;
+	unsigned int message;
+	unsigned int argumentCount;
+	LogArgument arguments[LOGGER_MAXIMUM_ARGUMENTS];
+	char text[LOGGER_TEXT_LENGTH];
+} LogRecord;
+
+// Each slot's sequence number tells a writer whether it is free and the reader whether it is filled
+typedef struct _log_slot {
+	std::atomic<unsigned long long> sequence;
+	LogRecord record;
+} LogSlot;
+
+// Asynchronous verbose log.
+// The caller only copies a fixed size record, the message id, its arguments and a timestamp, into a
+// bounded lock free ring (a Vyukov queue, so any thread may log). A background thread formats the records
+// and appends them to a file, rotated once it becomes large. If the ring is full the record is dropped and
+// counted rather than the caller being made to wait, the number dropped is written to the log.
+class Async_Logger {
+
+public:
+	Async_Logger(void);
+	~Async_Logger(void);
+
+	bool Open(const wxString &fileName);
+	void Close(void);
+	bool IsOpen(void);
+
+	// Returns false if the log is closed or the ring is full, the text may be NULL
+	bool Write(LOG_MESSAGE message, const char *text, unsigned int argumentCount = 0, const LogArgument *arguments = NULL);
+
+	unsigned long long GetDroppedCount(void);
+
+private:
+	LogSlot slots[LOGGER_CAPACITY];
+	std::atomic<unsigned long long> head;
+	// Only used by the writer thread
+	unsigned long long tail;
+
+	std::atomic<bool> isOpen;
+	std::atomic<bool> isRunning;
+	std::atomic<unsigned long long> droppedCount;
+	unsigned long long reportedDropped;
+
+	wxString fileName;
+	wxFile logFile;
+	wxFileOffset fileSize;
+	std::thread writerThread;
+
+	void WriterLoop(void);
+	bool Read(LogRecord &record);
+	void Drain(std::string &buffer);
+	void Rotate(void);
+
+	static void Format(const LogRecord &record, std::string &line);
+};
+
+#endif
@@ -0,0 +1,95 @@
+// Copyright(C) 2024 by Steven Adler
+//
+// This file is part of Windows Sensor Plugin for OpenCPN.
+//
+// Windows Sensor Plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Windows Sensor Plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Windows Sensor Plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#ifndef WINDOWS_SENSOR_PLUGIN_MOTION_H
+#define WINDOWS_SENSOR_PLUGIN_MOTION_H
+
+// Sensor API helpers
+#include "sensor_plugin_orientation.h"
+
+// Attitude filter
+#include "sensor_plugin_ahrs.h"
+
+// Heave filter
+#include "sensor_plugin_heave.h"
+
+#include <mmsystem.h>
+#pragma comment(lib,"winmm.lib")
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+// Inertial sensors are sampled between 200 Hz and 50 Hz
+#define MOTION_MINIMUM_INTERVAL 5
+#define MOTION_MAXIMUM_INTERVAL 20
+// The magnetometer changes slowly, 50 Hz to 10 Hz is sufficient
+#define MOTION_MAGNETOMETER_MINIMUM_INTERVAL 20
+#define MOTION_MAGNETOMETER_MAXIMUM_INTERVAL 100
+// Attitude is sent to OpenCPN at 5 Hz
+#define MOTION_OUTPUT_INTERVAL 200
+// Gaps longer than this, in seconds, are not integrated
+#define MOTION_MAXIMUM_ELAPSED 0.1
+
+// Motion sensor.
+// Fuses the accelerometer, gyrometer and, if present, magnetometer on its own thread at up to 200 Hz
+// using a Madgwick filter, and sends roll, pitch and yaw to OpenCPN as an XDR sentence at a decimated rate.
+// Heave is estimated from the vertical component of the acceleration, rotated into the earth frame.
+// As with the compass, the device is assumed to be lying flat with its top edge facing the bow.
+class Motion_Sensor {
+
+public:
+	Motion_Sensor(void);
+	~Motion_Sensor(void);
+
+	bool Start(void);
+	void Stop(void);
+	bool IsRunning(void);
+
+	// Most recent attitude in degrees, false if no samples have been received
+	bool GetAttitude(double &roll, double &pitch, double &yaw);
+
+	// Most recent heave in metres, false until the heave filter has settled
+	bool GetHeave(double &heave, double &significantHeave);
+
+	unsigned int GetSampleInterval(void);
+	unsigned long long GetSampleCount(void);
+
+private:
+	std::thread sensorThread;
+	std::atomic<bool> isRunning;
+	std::atomic<unsigned int> sampleInterval;
+	std::atomic<unsigned long long> sampleCount;
+
+	Madgwick_Filter filter;
+	Heave_Estimator heaveEstimator;
+
+	std::mutex attitudeMutex;
+	double latestRoll;
+	double latestPitch;
+	double latestYaw;
+	bool hasAttitude;
+	double latestHeave;
+	double latestSignificantHeave;
+	bool hasHeave;
+
+	void SensorLoop(void);
+	static bool GetVector(ISensorDataReport *report, REFPROPERTYKEY keyX, REFPROPERTYKEY keyY, REFPROPERTYKEY keyZ, Vector3 &value);
+};
+
+#endif
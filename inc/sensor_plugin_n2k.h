@@ -0,0 +1,104 @@
+// Copyright(C) 2024 by Steven Adler
+//
+// This file is part of Windows Sensor Plugin for OpenCPN.
+//
+// Windows Sensor Plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Windows Sensor Plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Windows Sensor Plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#ifndef WINDOWS_SENSOR_PLUGIN_N2K_H
+#define WINDOWS_SENSOR_PLUGIN_N2K_H
+
+// Winsock must be included before windows.h
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "ws2_32.lib")
+
+// wxWidgets Precompiled Headers
+#include "wx/wxprec.h"
+
+#ifndef  WX_PRECOMP
+#include "wx/wx.h"
+#endif
+#include <wx/string.h>
+
+#include <vector>
+
+// Decoded position fix and satellites
+#include "sensor_plugin_fix.h"
+
+// PGN encoding and fast packet segmentation
+#include "sensor_plugin_n2k_encoder.h"
+
+// Default port used by Yacht Devices gateways for the RAW protocol
+#define N2K_DEFAULT_PORT 1456
+// Default source address, as we do not claim an address
+#define N2K_DEFAULT_SOURCE 15
+
+// Rapid update PGNs are limited to 10 Hz
+#define N2K_RAPID_INTERVAL 100
+// Largest datagram, kept below the Ethernet MTU
+#define N2K_MAXIMUM_DATAGRAM 1400
+
+// Yacht Devices RAW line formats
+typedef enum _n2k_format {
+	// <id> <data>, the form a gateway transmits onto the NMEA 2000 network
+	N2K_FORMAT_TRANSMIT,
+	// hh:mm:ss.ddd R <id> <data>, the form a gateway reports the frames it receives, for software that reads its logs
+	N2K_FORMAT_RECEIVED
+} N2K_FORMAT;
+
+// NMEA 2000 output.
+// Encodes the fix as NMEA 2000 PGNs, splits them into CAN frames and sends the frames using the Yacht Devices
+// RAW protocol over UDP. By default the frames are in the form a gateway transmits onto the network. All buffers are preallocated, an epoch
+// is encoded and sent without allocating any memory.
+class N2K_Output {
+
+public:
+	N2K_Output(void);
+	~N2K_Output(void);
+
+	bool Start(const wxString &address, unsigned short port, unsigned char sourceAddress, N2K_FORMAT format);
+	void Stop(void);
+	bool IsRunning(void);
+
+	void Publish(const PositionFix &fix, const std::vector<SatelliteInformation> &satellites);
+
+	unsigned long long GetFrameCount(void);
+
+private:
+	SOCKET udpSocket;
+	sockaddr_in destination;
+	unsigned char sourceAddress;
+	N2K_FORMAT format;
+	bool isRunning;
+
+	// Sequence identifier, links the fields of PGNs from the same epoch
+	unsigned char sid;
+	// Fast packet sequence counter for each fast packet PGN
+	unsigned char gnssSequence;
+	unsigned char satelliteSequence;
+	// When the rapid update PGNs were last sent
+	unsigned long long lastRapidUpdate;
+	unsigned long long frameCount;
+
+	unsigned char payload[N2K_FAST_PACKET_MAXIMUM_LENGTH];
+	CanFrame frames[N2K_FAST_PACKET_MAXIMUM_FRAMES];
+	char datagram[N2K_MAXIMUM_DATAGRAM];
+	unsigned int datagramLength;
+
+	void SendFrames(const CanFrame *canFrames, unsigned int count);
+	void Flush(void);
+};
+
+#endif
@@ -0,0 +1,69 @@
+// Copyright(C) 2024 by Steven Adler
+//
+// This file is part of Windows Sensor Plugin for OpenCPN.
+//
+// Windows Sensor Plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Windows Sensor Plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Windows Sensor Plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// Project: Windows Sensor Plugin
+// Description: NMEA 2000 PGN encoding and fast packet segmentation
+// Owner: twocanplugin@hotmail.com
+// Date: 01/04/2024
+// Version History:
+// 1.0 Initial Release
+
+#ifndef WINDOWS_SENSOR_PLUGIN_N2K_ENCODER_H
+#define WINDOWS_SENSOR_PLUGIN_N2K_ENCODER_H
+
+#include <vector>
+
+// Decoded position fix and satellites
+#include "sensor_plugin_fix.h"
+
+// PGNs transmitted
+#define N2K_PGN_POSITION_RAPID 129025
+#define N2K_PGN_COG_SOG_RAPID 129026
+#define N2K_PGN_GNSS_POSITION 129029
+#define N2K_PGN_SATELLITES_IN_VIEW 129540
+
+// Largest fast packet payload, 6 bytes in the first frame and 7 in each of the following 31 frames
+#define N2K_FAST_PACKET_MAXIMUM_LENGTH 223
+#define N2K_FAST_PACKET_MAXIMUM_FRAMES 32
+// Satellites that fit in PGN 129540, 3 header bytes and 12 bytes per satellite
+#define N2K_MAXIMUM_SATELLITES 18
+
+// A single CAN frame with a 29 bit extended identifier
+typedef struct _can_frame {
+	unsigned int id;
+	unsigned char length;
+	unsigned char data[8];
+} CanFrame;
+
+// Encodes NMEA 2000 PGNs and splits them into CAN frames, independent of how the frames are sent.
+// Payloads and frames are written to buffers supplied by the caller, nothing is allocated.
+class N2K_Encoder {
+
+public:
+	// Split a payload into CAN frames, single frame PGNs must be 8 bytes or less.
+	// Returns the number of frames written, or zero if the payload is too large.
+	static unsigned int Segment(unsigned int pgn, unsigned char priority, unsigned char source, unsigned char sequence,
+		bool isFastPacket, const unsigned char *payload, unsigned int length, CanFrame *frames, unsigned int maximumFrames);
+
+	// Encode each PGN, returns the payload length
+	static unsigned int EncodePositionRapid(const PositionFix &fix, unsigned char *payload);
+	static unsigned int EncodeCogSogRapid(const PositionFix &fix, unsigned char sid, unsigned char *payload);
+	static unsigned int EncodeGnssPosition(const PositionFix &fix, unsigned char sid, unsigned char *payload);
+	static unsigned int EncodeSatellitesInView(const std::vector<SatelliteInformation> &satellites, unsigned char sid, unsigned char *payload);
+};
+
+#endif
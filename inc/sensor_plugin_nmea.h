@@ -0,0 +1,244 @@
+// Copyright(C) 2024 by Steven Adler
+//
+// This file is part of Windows Sensor Plugin for OpenCPN.
+//
+// Windows Sensor Plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Windows Sensor Plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Windows Sensor Plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#ifndef WINDOWS_SENSOR_PLUGIN_NMEA_H
+#define WINDOWS_SENSOR_PLUGIN_NMEA_H
+
+#include <stddef.h>
+#include <atomic>
+#include <vector>
+
+// Satellite information
+#include "sensor_plugin_fix.h"
+
+// NMEA 0183 limits sentences to 82 characters, some receivers exceed it
+#define NMEA_MAXIMUM_LENGTH 128
+#define NMEA_MAXIMUM_FIELDS 40
+#define NMEA_GSA_SATELLITES 12
+#define NMEA_GSV_SATELLITES 4
+// A talker's satellites are dropped if its GSV sequence has not been received for this long, in milliseconds
+#define NMEA_SATELLITE_TIMEOUT 10000
+// Sentences we have sent that are remembered, enough for several seconds of every output at its highest rate
+#define NMEA_ECHO_SLOTS 256
+
+// A field within the sentence, not null terminated
+typedef struct _nmea_field {
+	const char *data;
+	unsigned int length;
+} NmeaField;
+
+enum NMEA_SENTENCE_TYPE {
+	// Framing or checksum error
+	NMEA_INVALID,
+	// Well formed, but not a type that is decoded
+	NMEA_UNKNOWN,
+	NMEA_RMC,
+	NMEA_GGA,
+	NMEA_GLL,
+	NMEA_GSA,
+	NMEA_GSV,
+	NMEA_VTG,
+	NMEA_HDT,
+	NMEA_ZDA
+};
+
+typedef struct _nmea_time {
+	bool isValid;
+	int hours;
+	int minutes;
+	double seconds;
+} NmeaTime;
+
+typedef struct _nmea_date {
+	bool isValid;
+	int day;
+	int month;
+	int year;
+} NmeaDate;
+
+// Latitude and longitude in signed decimal degrees
+typedef struct _nmea_position {
+	bool isValid;
+	double latitude;
+	double longitude;
+} NmeaPosition;
+
+typedef struct _nmea_rmc {
+	NmeaTime time;
+	bool isActive;
+	NmeaPosition position;
+	double speedOverGround;
+	double courseOverGround;
+	bool isCourseValid;
+	NmeaDate date;
+	double magneticVariation;
+	bool isVariationValid;
+	char mode;
+} NmeaRMC;
+
+typedef struct _nmea_gga {
+	NmeaTime time;
+	NmeaPosition position;
+	unsigned int quality;
+	unsigned int satellitesInUse;
+	double hDOP;
+	double altitude;
+	bool isAltitudeValid;
+	double geoidalSeparation;
+	double dgpsAge;
+	unsigned int dgpsReferenceId;
+} NmeaGGA;
+
+typedef struct _nmea_gll {
+	NmeaPosition position;
+	NmeaTime time;
+	bool isActive;
+	char mode;
+} NmeaGLL;
+
+typedef struct _nmea_gsa {
+	char selectionMode;
+	unsigned int fixMode;
+	unsigned int satelliteCount;
+	unsigned int satellites[NMEA_GSA_SATELLITES];
+	double pDOP;
+	double hDOP;
+	double vDOP;
+} NmeaGSA;
+
+typedef struct _nmea_gsv {
+	unsigned int totalSentences;
+	unsigned int sentenceNumber;
+	unsigned int satellitesInView;
+	unsigned int satelliteCount;
+	SatelliteInformation satellites[NMEA_GSV_SATELLITES];
+} NmeaGSV;
+
+typedef struct _nmea_vtg {
+	double courseTrue;
+	bool isCourseTrueValid;
+	double courseMagnetic;
+	bool isCourseMagneticValid;
+	double speedKnots;
+	bool isSpeedValid;
+	char mode;
+} NmeaVTG;
+
+typedef struct _nmea_hdt {
+	double heading;
+	bool isValid;
+} NmeaHDT;
+
+typedef struct _nmea_zda {
+	NmeaTime time;
+	NmeaDate date;
+} NmeaZDA;
+
+// A decoded sentence, the member of the union is selected by type
+typedef struct _nmea_sentence {
+	NMEA_SENTENCE_TYPE type;
+	char talker[3];
+	union {
+		NmeaRMC rmc;
+		NmeaGGA gga;
+		NmeaGLL gll;
+		NmeaGSA gsa;
+		NmeaGSV gsv;
+		NmeaVTG vtg;
+		NmeaHDT hdt;
+		NmeaZDA zda;
+	};
+} NmeaSentence;
+
+// Zero allocation NMEA 0183 parser.
+// Fields are located in place, without copying, using memchr which the runtime library vectorises,
+// and decoded directly into fixed size structures.
+class NMEA_Parser {
+
+public:
+	// Validate the framing and checksum, if present, and locate each field. The first field is the address.
+	static bool Split(const char *sentence, size_t length, NmeaField *fields, unsigned int maximumFields, unsigned int &fieldCount);
+
+	// Split and decode a sentence, false if it is malformed or of a type not decoded
+	static bool Parse(const char *sentence, size_t length, NmeaSentence &result);
+
+	// Field decoders, each returns false if the field is empty or malformed
+	static bool ToDouble(const NmeaField &field, double &value);
+	static bool ToUnsigned(const NmeaField &field, unsigned int &value);
+	static bool ToChar(const NmeaField &field, char &value);
+	static bool ToTime(const NmeaField &field, NmeaTime &value);
+	static bool ToDate(const NmeaField &field, NmeaDate &value);
+	// ddmm.mm or dddmm.mm with a hemisphere
+	static bool ToCoordinate(const NmeaField &field, const NmeaField &hemisphere, double &value);
+
+private:
+	static bool ParseRMC(const NmeaField *fields, unsigned int fieldCount, NmeaRMC &rmc);
+	static bool ParseGGA(const NmeaField *fields, unsigned int fieldCount, NmeaGGA &gga);
+	static bool ParseGLL(const NmeaField *fields, unsigned int fieldCount, NmeaGLL &gll);
+	static bool ParseGSA(const NmeaField *fields, unsigned int fieldCount, NmeaGSA &gsa);
+	static bool ParseGSV(const NmeaField *fields, unsigned int fieldCount, NmeaGSV &gsv);
+	static bool ParseVTG(const NmeaField *fields, unsigned int fieldCount, NmeaVTG &vtg);
+	static bool ParseHDT(const NmeaField *fields, unsigned int fieldCount, NmeaHDT &hdt);
+	static bool ParseZDA(const NmeaField *fields, unsigned int fieldCount, NmeaZDA &zda);
+	static int HexValue(char c);
+};
+
+// Satellites from the GSV sequence of one talker
+typedef struct _talker_satellites {
+	char talker[3];
+	std::vector<SatelliteInformation> pending;
+	std::vector<SatelliteInformation> satellites;
+	// Monotonic milliseconds when the sequence was last completed
+	long long completeTime;
+} TalkerSatellites;
+
+// Assembles the satellites in view from GSV sequences.
+// A multi-constellation receiver sends a sequence per constellation each epoch, eg. GPGSV, GLGSV and then
+// GAGSV, each under its own talker. The latest complete sequence of each talker is kept and they are merged
+// when the epoch's fix is taken, rather than each sequence replacing the previous one.
+class GSV_Assembler {
+
+public:
+	void Clear(void);
+
+	// Returns true if the sentence completes its talker's sequence
+	bool Add(const char *talker, const NmeaGSV &gsv, long long now);
+
+	// Every talker's satellites, omitting those whose sequences are no longer being received
+	void Merge(long long now, std::vector<SatelliteInformation> &satellites);
+
+private:
+	std::vector<TalkerSatellites> talkers;
+};
+
+// OpenCPN passes the sentences we push back to every plugin, including ours.
+// Each sentence sent is remembered by a hash of its text in a small ring, so that its echo can be recognised
+// whatever its talker. Sentences are added from the GUI thread and the sensor threads, without locking.
+class NMEA_Echo_Filter {
+
+public:
+	static void Add(const char *sentence, size_t length);
+	static bool IsEcho(const char *sentence, size_t length);
+
+private:
+	static std::atomic<unsigned long long> hashes[NMEA_ECHO_SLOTS];
+	static std::atomic<unsigned int> nextSlot;
+	static unsigned long long Hash(const char *sentence, size_t length);
+};
+
+#endif
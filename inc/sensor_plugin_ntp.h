@@ -0,0 +1,98 @@
+// Copyright(C) 2024 by Steven Adler
+//
+// This file is part of Windows Sensor Plugin for OpenCPN.
+//
+// Windows Sensor Plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Windows Sensor Plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Windows Sensor Plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#ifndef WINDOWS_SENSOR_PLUGIN_NTP_H
+#define WINDOWS_SENSOR_PLUGIN_NTP_H
+
+// wxWidgets Precompiled Headers
+#include "wx/wxprec.h"
+
+#ifndef  WX_PRECOMP
+#include "wx/wx.h"
+#endif
+#include <wx/string.h>
+
+#include <windows.h>
+#include <time.h>
+#include <string>
+
+// Receive timestamps
+#include "sensor_plugin_fix.h"
+// Sentence parser
+#include "sensor_plugin_nmea.h"
+
+// ntpd's SHM reference clock uses the segment NTP<unit>, units 0 and 1 are normally reserved for root
+#define NTP_DEFAULT_UNIT 2
+// Windows location reports are timestamped to the millisecond, 2^-10 seconds
+#define NTP_PRECISION -10
+// Samples older than this when posted are discarded
+#define NTP_MAXIMUM_AGE_MILLISECONDS 2000
+
+// Layout of the ntpd SHM reference clock segment, refer to ntpd/refclock_shm.c
+// Field types must match those of ntpd built with the same compiler, notably time_t
+typedef struct _ntp_shm_time {
+	int mode;
+	volatile int count;
+	time_t clockTimeStampSec;
+	int clockTimeStampUSec;
+	time_t receiveTimeStampSec;
+	int receiveTimeStampUSec;
+	int leap;
+	int precision;
+	int nsamples;
+	volatile int valid;
+	unsigned int clockTimeStampNSec;
+	unsigned int receiveTimeStampNSec;
+	int dummy[8];
+} NtpShmTime;
+
+// Feeds ntpd with the GNSS time of each fix and the local time at which it was received.
+// The Windows Sensor API does not report the GNSS time directly, so it is taken from the time field of the
+// NMEA 0183 sentence the sensor attaches to its report (RMC, ZDA, GGA or GLL). Sensors that do not
+// attach a sentence cannot be used as a reference clock.
+class NTP_Reference_Clock {
+
+public:
+	NTP_Reference_Clock(void);
+	~NTP_Reference_Clock(void);
+
+	bool Open(int unit);
+	void Close(void);
+	bool IsOpen(void);
+
+	// Post a sample if the sentence carries a time not already posted
+	bool Post(const std::string &sentence, const ReceiveTime &receiveTime);
+
+	unsigned long long GetSampleCount(void);
+
+	// GNSS time in 100 nanosecond intervals since 1601, receiveTime supplies the date if the sentence has none
+	static bool ParseTime(const std::string &sentence, long long receiveTime, long long &clockTime);
+
+private:
+	HANDLE mappingHandle;
+	NtpShmTime *segment;
+
+	// GNSS time of the last sample, so that repeated reports are not posted twice
+	long long lastClockTime;
+	unsigned long long sampleCount;
+	bool isTimeMissingLogged;
+
+	static long long DaysFromCivil(int year, int month, int day);
+};
+
+#endif
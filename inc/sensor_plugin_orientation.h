@@ -0,0 +1,100 @@
+// Copyright(C) 2024 by Steven Adler
+//
+// This file is part of Windows Sensor Plugin for OpenCPN.
+//
+// Windows Sensor Plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Windows Sensor Plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Windows Sensor Plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#ifndef WINDOWS_SENSOR_PLUGIN_ORIENTATION_H
+#define WINDOWS_SENSOR_PLUGIN_ORIENTATION_H
+
+// wxWidgets Precompiled Headers
+#include "wx/wxprec.h"
+
+#ifndef  WX_PRECOMP
+#include "wx/wx.h"
+#endif
+#include <wx/string.h>
+
+// Windows COM and Sensor API
+#include <comutil.h>
+#include <sensorsapi.h>
+#include <sensors.h>
+#include <portabledevicetypes.h>
+#pragma comment(lib,"sensorsapi.lib")
+#pragma comment(lib,"portabledeviceguids.lib")
+
+// OpenCPN include file
+#include "ocpn_plugin.h"
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+// True heading, rate of turn and the sentences that carry them
+#include "sensor_plugin_heading.h"
+
+// Report intervals outside this range are clamped, 50 Hz to 10 Hz
+#define ORIENTATION_MINIMUM_INTERVAL 20
+#define ORIENTATION_MAXIMUM_INTERVAL 100
+
+// Compass and orientation sensors.
+// Runs on its own thread at the native rate of the sensors, independently of the one second position
+// fix. Generates HDG and HDT from a compass and ROT from a gyrometer, or from the change in heading
+// if there is no gyrometer. The sentences are sent directly to OpenCPN.
+// The device is assumed to be lying flat with its top edge facing the bow.
+class Orientation_Sensor {
+
+public:
+	Orientation_Sensor(void);
+	~Orientation_Sensor(void);
+
+	bool Start(void);
+	void Stop(void);
+	bool IsRunning(void);
+
+	// Magnetic variation from the position fix, east is positive
+	void SetMagneticVariation(double variation, bool isValid);
+
+	// Most recent headings, false if the compass has not reported
+	bool GetHeading(double &magneticHeading, double &trueHeading);
+
+	unsigned int GetReportInterval(void);
+
+	// Sensor API helpers, shared with the motion sensor
+	static ISensor *FindSensor(ISensorManager *sensorManager, REFSENSOR_TYPE_ID sensorType);
+	// Request the sensor's minimum report interval, clamped to the given range, returns the interval to poll at
+	static unsigned int SetReportInterval(ISensor *sensor, unsigned int minimumInterval, unsigned int maximumInterval);
+	static bool GetValue(ISensorDataReport *report, REFPROPERTYKEY key, double &value);
+	static long long GetTimeStamp(ISensorDataReport *report);
+	// Append the checksum and send to OpenCPN, may be called from any thread
+	static void SendSentence(wxString sentence);
+
+private:
+	std::thread sensorThread;
+	std::atomic<bool> isRunning;
+	std::atomic<unsigned int> reportInterval;
+
+	// Guards the variation, which is set by the GUI thread, as well as the latest headings
+	std::mutex headingMutex;
+	double magneticVariation;
+	bool isVariationValid;
+	double latestMagneticHeading;
+	double latestTrueHeading;
+	bool hasHeading;
+
+	void SensorLoop(void);
+};
+
+#endif
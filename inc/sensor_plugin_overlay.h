@@ -0,0 +1,127 @@
+// Copyright(C) 2024 by Steven Adler
+//
+// This file is part of Windows Sensor Plugin for OpenCPN.
+//
+// Windows Sensor Plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Windows Sensor Plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Windows Sensor Plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#ifndef WINDOWS_SENSOR_PLUGIN_OVERLAY_H
+#define WINDOWS_SENSOR_PLUGIN_OVERLAY_H
+
+// wxWidgets Precompiled Headers
+#include "wx/wxprec.h"
+
+#ifndef  WX_PRECOMP
+#include "wx/wx.h"
+#endif
+#include <wx/dc.h>
+#include <wx/dcmemory.h>
+
+// OpenGL canvas, the overlays are drawn directly with OpenGL rather than through a device context
+#ifdef ocpnUSE_GL
+#include <wx/glcanvas.h>
+#endif
+
+#include <vector>
+
+// OpenCPN include file
+#include "ocpn_plugin.h"
+
+// Simplified track points at several levels of detail
+#include "sensor_plugin_pyramid.h"
+
+// Own ship breadcrumb trail drawn on the chart canvas
+class Track_Overlay {
+
+public:
+	Track_Overlay(void);
+	~Track_Overlay(void);
+
+	// Add the latest position fix to every level of the pyramid
+	void Add(const TrackPoint &point);
+
+	// Discard the trail
+	void Clear(void);
+
+	// Draw the trail for the given viewport
+	bool Render(wxDC &dc, PlugIn_ViewPort *vp);
+
+	// Draw the trail on the OpenGL canvas
+	bool RenderGL(PlugIn_ViewPort *vp);
+
+	void SetColorScheme(PI_ColorScheme scheme);
+
+private:
+	Track_Pyramid pyramid;
+
+	// The most recent point, joins the last committed point to own ship
+	TrackPoint latestPoint;
+	bool hasLatestPoint;
+
+	// Reused between frames to avoid allocation
+	std::vector<wxPoint> pixels;
+
+	wxPen trackPen;
+
+	void AddPixel(PlugIn_ViewPort *vp, const TrackPoint &point);
+	// Draws with the device context, or with OpenGL if there is no device context
+	bool Draw(wxDC *dc, PlugIn_ViewPort *vp);
+	void DrawPixels(wxDC *dc);
+};
+
+// Larger rings are drawn directly rather than from a cached bitmap
+#define ACCURACY_RING_MAXIMUM_CACHE 512
+// Limits on the number of line segments used to draw the ring with OpenGL
+#define ACCURACY_RING_MINIMUM_SEGMENTS 16
+#define ACCURACY_RING_MAXIMUM_SEGMENTS 360
+
+// Estimated horizontal position error drawn around own ship
+class Accuracy_Overlay {
+
+public:
+	Accuracy_Overlay(void);
+	~Accuracy_Overlay(void);
+
+	// Latest position and horizontal dilution of precision
+	void Update(double latitude, double longitude, double hDOP);
+
+	// User Equivalent Range Error, in metres
+	void SetUERE(double rangeError);
+
+	bool Render(wxDC &dc, PlugIn_ViewPort *vp);
+
+	// Draw the ring on the OpenGL canvas, there is no bitmap to cache
+	bool RenderGL(PlugIn_ViewPort *vp);
+
+	void SetColorScheme(PI_ColorScheme scheme);
+
+private:
+	double latitude;
+	double longitude;
+	double hDOP;
+	double uere;
+	bool hasPosition;
+
+	// Cached ring, only re-rasterised when the radius in pixels or the colour scheme changes
+	wxBitmap ringBitmap;
+	int cachedRadius;
+	PI_ColorScheme colorScheme;
+	PI_ColorScheme cachedColorScheme;
+	wxPen ringPen;
+
+	void Rasterise(int radius);
+	int GetRadius(PlugIn_ViewPort *vp);
+};
+
+#endif
@@ -0,0 +1,57 @@
+// Copyright(C) 2024 by Steven Adler
+//
+// This file is part of Windows Sensor Plugin for OpenCPN.
+//
+// Windows Sensor Plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Windows Sensor Plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Windows Sensor Plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#ifndef WINDOWS_SENSOR_PLUGIN_PUBLISHER_H
+#define WINDOWS_SENSOR_PLUGIN_PUBLISHER_H
+
+// wxWidgets Precompiled Headers
+#include "wx/wxprec.h"
+
+#ifndef  WX_PRECOMP
+#include "wx/wx.h"
+#endif
+
+#include <vector>
+
+// Decoded position fix and satellites
+#include "sensor_plugin_fix.h"
+
+// Segment layout, shared with local readers
+#include "sensor_plugin_shm.h"
+
+// Publishes each fix and satellite snapshot to a named shared memory segment.
+// Other processes on this computer read the latest fix directly from memory, see sensor_plugin_shm.h
+// There is only one writer, the plugin's timer, so the sequence lock never waits.
+class Fix_Publisher {
+
+public:
+	Fix_Publisher(void);
+	~Fix_Publisher(void);
+
+	bool Open(void);
+	void Close(void);
+	bool IsOpen(void);
+
+	void Publish(const PositionFix &fix, const std::vector<SatelliteInformation> &satellites);
+
+private:
+	HANDLE mappingHandle;
+	WindowsSensorSegment *segment;
+};
+
+#endif
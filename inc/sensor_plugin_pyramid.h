@@ -0,0 +1,88 @@
+// Copyright(C) 2024 by Steven Adler
+//
+// This file is part of Windows Sensor Plugin for OpenCPN.
+//
+// Windows Sensor Plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Windows Sensor Plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Windows Sensor Plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// Project: Windows Sensor Plugin
+// Description: Level of detail pyramid for the own ship track overlay
+// Owner: twocanplugin@hotmail.com
+// Date: 01/04/2024
+// Version History:
+// 1.0 Initial Release
+
+#ifndef WINDOWS_SENSOR_PLUGIN_PYRAMID_H
+#define WINDOWS_SENSOR_PLUGIN_PYRAMID_H
+
+#include <deque>
+#include <vector>
+
+// Track points and the streaming simplifier
+#include "sensor_plugin_simplifier.h"
+
+// Number of levels in the pyramid, each level has four times the tolerance of the previous level
+#define TRACK_OVERLAY_LEVELS 6
+// Tolerance of the most detailed level
+#define TRACK_OVERLAY_BASE_TOLERANCE 1.0
+// Points per chunk, each chunk has a bounding box used for culling
+#define TRACK_OVERLAY_CHUNK_SIZE 64
+// Length of the trail, 24 hours
+#define TRACK_OVERLAY_DURATION (24LL * 60 * 60 * 1000)
+
+// A run of consecutive track points and their bounding box
+typedef struct _track_chunk {
+	std::vector<TrackPoint> points;
+	double latitudeMinimum;
+	double latitudeMaximum;
+	double longitudeMinimum;
+	double longitudeMaximum;
+} TrackChunk;
+
+// One level of detail
+typedef struct _track_level {
+	Track_Simplifier simplifier;
+	std::deque<TrackChunk> chunks;
+	double tolerance;
+} TrackLevel;
+
+// The recent track simplified at several tolerances, each level split into chunks that can be culled.
+// Independent of how the track is drawn, so the device context and OpenGL overlays share it.
+class Track_Pyramid {
+
+public:
+	Track_Pyramid(void);
+	~Track_Pyramid(void);
+
+	// Add the latest position fix to every level of the pyramid
+	void Add(const TrackPoint &point);
+
+	// Discard the trail
+	void Clear(void);
+
+	// The coarsest level whose tolerance is less than a pixel at the given scale, in pixels per metre
+	unsigned int SelectLevel(double pixelsPerMetre);
+
+	const std::deque<TrackChunk> &GetChunks(unsigned int level);
+
+	// Whether any of the chunk lies within the bounds, longitudes beyond +/-180 indicate the antimeridian is spanned
+	static bool IsVisible(const TrackChunk &chunk, double latitudeMinimum, double latitudeMaximum,
+		double longitudeMinimum, double longitudeMaximum);
+
+private:
+	TrackLevel levels[TRACK_OVERLAY_LEVELS];
+
+	void AddToLevel(TrackLevel &level, const TrackPoint &point);
+};
+
+#endif
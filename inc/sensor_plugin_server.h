@@ -0,0 +1,97 @@
+// Copyright(C) 2024 by Steven Adler
+//
+// This file is part of Windows Sensor Plugin for OpenCPN.
+//
+// Windows Sensor Plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Windows Sensor Plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Windows Sensor Plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#ifndef WINDOWS_SENSOR_PLUGIN_SERVER_H
+#define WINDOWS_SENSOR_PLUGIN_SERVER_H
+
+// Winsock must be included before windows.h
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "ws2_32.lib")
+
+// wxWidgets Precompiled Headers
+#include "wx/wxprec.h"
+
+#ifndef  WX_PRECOMP
+#include "wx/wx.h"
+#endif
+#include <wx/string.h>
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Default NMEA 0183 over IP port
+#define SERVER_DEFAULT_PORT 10110
+// Connections beyond this are refused
+#define SERVER_MAXIMUM_CLIENTS 512
+// Maximum number of sentences sent in a single gather write
+#define SERVER_MAXIMUM_BUFFERS 64
+
+// Local NMEA 0183 server.
+// A single thread runs a non-blocking event loop that accepts TCP clients on localhost and discards
+// anything they send. Each epoch's sentences are written to every client with a single gather write,
+// a client that can't accept the whole epoch without blocking is disconnected.
+// The same sentences may also be sent as UDP datagrams to a broadcast or multicast address.
+class NMEA_Server {
+
+public:
+	NMEA_Server(void);
+	~NMEA_Server(void);
+
+	bool Start(bool enableTCP, unsigned short tcpPort, bool enableUDP, const wxString &udpAddress, unsigned short udpPort);
+	void Stop(void);
+	bool IsRunning(void);
+
+	// Queue an epoch for transmission, never blocks on the network
+	void Publish(const std::vector<std::string> &sentences);
+
+	unsigned int GetClientCount(void);
+	unsigned long long GetDroppedClients(void);
+
+private:
+	SOCKET listenSocket;
+	SOCKET udpSocket;
+	sockaddr_in udpDestination;
+
+	// Loopback datagram socket used to wake the event loop when an epoch is published
+	SOCKET wakeSocket;
+	sockaddr_in wakeAddress;
+
+	std::vector<SOCKET> clients;
+	std::atomic<unsigned int> clientCount;
+	std::atomic<unsigned long long> droppedClients;
+
+	std::thread loopThread;
+	std::atomic<bool> isRunning;
+
+	// The most recent epoch, if the loop falls behind intermediate epochs are skipped
+	std::mutex epochMutex;
+	std::vector<std::string> pendingEpoch;
+	bool hasPendingEpoch;
+
+	void EventLoop(void);
+	void AcceptClients(void);
+	void SendEpoch(const std::vector<std::string> &sentences);
+	void CloseSockets(void);
+	static void SetNonBlocking(SOCKET s);
+};
+
+#endif
@@ -12,6 +12,10 @@
 // Note wxFormBuilder used to generate UI
 #include "sensor_plugin_settings_base.h"
 
+// Track log export
+#include "sensor_plugin_track.h"
+#include <wx/filedlg.h>
+
 // The Settings checkbox values
 typedef enum _checkbox {
 	GGA,
@@ -27,6 +31,14 @@ extern bool isGLL;
 extern bool isGSV;
 extern bool isRMC;
 extern wxString sensorName;
+extern bool isTrackLog;
+extern bool isTrackOverlay;
+extern bool isAccuracyRing;
+extern bool isSkyPlot;
+extern double exportTolerance;
+extern double speedTolerance;
+extern wxString trackLogFileName;
+extern wxString diagnosticsText;
 
 class Windows_Sensor_Plugin_Settings : public Windows_Sensor_Plugin_Settings_Base {
 	
@@ -38,6 +50,7 @@ protected:
 	//overridden methods from the base class
 	void OnCheckSentence(wxCommandEvent& event);
 	void OnRightClick(wxMouseEvent& event);
+	void OnExport(wxCommandEvent& event);
 	void OnOK(wxCommandEvent& event);
 	void OnCancel(wxCommandEvent& event);
 	
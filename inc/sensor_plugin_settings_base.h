@@ -19,6 +19,7 @@
 #include <wx/statbox.h>
 #include <wx/checkbox.h>
 #include <wx/checklst.h>
+#include <wx/textctrl.h>
 #include <wx/button.h>
 #include <wx/bitmap.h>
 #include <wx/image.h>
@@ -41,12 +42,19 @@ class Windows_Sensor_Plugin_Settings_Base : public wxDialog
 		wxStaticText* lblSensor;
 		wxCheckBox* checkVerbose;
 		wxCheckListBox* chkListSentence;
+		wxCheckBox* checkTrackLog;
+		wxCheckBox* checkTrackOverlay;
+		wxCheckBox* checkAccuracyRing;
+		wxCheckBox* checkSkyPlot;
+		wxTextCtrl* textDiagnostics;
+		wxButton* btnExport;
 		wxButton* btnOK;
 		wxButton* btnCancel;
 
 		// Virtual event handlers, override them in your derived class
 		virtual void OnCheckSentence( wxCommandEvent& event ) { event.Skip(); }
 		virtual void OnRightClick( wxMouseEvent& event ) { event.Skip(); }
+		virtual void OnExport( wxCommandEvent& event ) { event.Skip(); }
 		virtual void OnOK( wxCommandEvent& event ) { event.Skip(); }
 		virtual void OnCancel( wxCommandEvent& event ) { event.Skip(); }
 
@@ -0,0 +1,154 @@
+// Copyright(C) 2024 by Steven Adler
+//
+// This file is part of Windows Sensor Plugin for OpenCPN.
+//
+// Windows Sensor Plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Windows Sensor Plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Windows Sensor Plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+
+// Layout of the shared memory segment to which the plugin publishes each fix, and a reader for it.
+// This header is plain C so that it may be copied into any application on the same computer.
+//
+// The segment is guarded by a sequence lock. The plugin increments the sequence number before and
+// after each update, so it is odd whilst an update is in progress. A reader copies the fix, and if
+// the sequence number was odd or changed during the copy, it simply copies it again.
+// The plugin never waits for a reader.
+//
+// Example:
+//     WindowsSensorSegment *segment = WindowsSensorOpen();
+//     WindowsSensorFix fix;
+//     if ((segment != NULL) && (WindowsSensorRead(segment, &fix))) { ... }
+//     WindowsSensorClose(segment);
+
+#ifndef WINDOWS_SENSOR_PLUGIN_SHM_H
+#define WINDOWS_SENSOR_PLUGIN_SHM_H
+
+#include <windows.h>
+#include <stdint.h>
+#include <string.h>
+
+// Name of the file mapping, session local so no privileges are required
+#define WINDOWS_SENSOR_SHM_NAME "Local\\WindowsSensorFix"
+// "WSFX"
+#define WINDOWS_SENSOR_SHM_MAGIC 0x58465357
+// Incremented whenever the layout changes
+#define WINDOWS_SENSOR_SHM_VERSION 1
+#define WINDOWS_SENSOR_SHM_MAXIMUM_SATELLITES 64
+// Torn reads are retried this many times before giving up
+#define WINDOWS_SENSOR_SHM_MAXIMUM_RETRIES 1000
+
+#pragma pack(push, 8)
+
+typedef struct _windows_sensor_satellite {
+	uint32_t id;
+	float elevation;
+	float azimuth;
+	float snr;
+} WindowsSensorSatellite;
+
+typedef struct _windows_sensor_fix {
+	double latitude;
+	double longitude;
+	double altitude;
+	double speedOverGround; // knots
+	double courseOverGround;
+	double magneticVariation;
+	double hDOP;
+	double vDOP;
+	double pDOP;
+	double geoidalSeparation;
+	int64_t timeStamp; // UTC milliseconds since the epoch
+	uint32_t satellitesInUse;
+	uint32_t satellitesInView;
+	uint32_t fixType;
+	uint32_t fixStatus;
+	uint32_t selectionMode;
+	uint32_t isValid;
+	// Number of valid entries in satellites
+	uint32_t satelliteCount;
+	uint32_t reserved;
+	WindowsSensorSatellite satellites[WINDOWS_SENSOR_SHM_MAXIMUM_SATELLITES];
+} WindowsSensorFix;
+
+typedef struct _windows_sensor_segment {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t size;
+	uint32_t reserved;
+	// Odd whilst the plugin is writing, incremented by two for each fix
+	volatile LONG64 sequence;
+	WindowsSensorFix fix;
+} WindowsSensorSegment;
+
+#pragma pack(pop)
+
+// Map the segment read only, returns NULL if the plugin is not publishing
+static __inline WindowsSensorSegment *WindowsSensorOpen(void) {
+	HANDLE mapping;
+	WindowsSensorSegment *segment;
+
+	mapping = OpenFileMappingA(FILE_MAP_READ, FALSE, WINDOWS_SENSOR_SHM_NAME);
+	if (mapping == NULL) {
+		return NULL;
+	}
+
+	segment = (WindowsSensorSegment *)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, sizeof(WindowsSensorSegment));
+	// The view keeps the mapping alive
+	CloseHandle(mapping);
+	if (segment == NULL) {
+		return NULL;
+	}
+
+	if ((segment->magic != WINDOWS_SENSOR_SHM_MAGIC) || (segment->version != WINDOWS_SENSOR_SHM_VERSION)) {
+		UnmapViewOfFile(segment);
+		return NULL;
+	}
+	return segment;
+}
+
+static __inline void WindowsSensorClose(WindowsSensorSegment *segment) {
+	if (segment != NULL) {
+		UnmapViewOfFile(segment);
+	}
+}
+
+// Copy the latest fix, returns the sequence number of the copy, or zero if no fix has been published
+// or a consistent copy could not be obtained
+static __inline LONG64 WindowsSensorRead(const WindowsSensorSegment *segment, WindowsSensorFix *fix) {
+	LONG64 before;
+	LONG64 after;
+	int i;
+
+	for (i = 0; i < WINDOWS_SENSOR_SHM_MAXIMUM_RETRIES; i++) {
+		before = segment->sequence;
+		if (before & 1) {
+			YieldProcessor();
+			continue;
+		}
+		MemoryBarrier();
+		memcpy(fix, (const void *)&segment->fix, sizeof(WindowsSensorFix));
+		MemoryBarrier();
+		after = segment->sequence;
+		if (before == after) {
+			return before;
+		}
+	}
+	return 0;
+}
+
+// Cheap test whether a new fix has been published since the given sequence number
+static __inline int WindowsSensorHasChanged(const WindowsSensorSegment *segment, LONG64 sequence) {
+	return (segment->sequence != sequence);
+}
+
+#endif
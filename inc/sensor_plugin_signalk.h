@@ -0,0 +1,106 @@
+// Copyright(C) 2024 by Steven Adler
+//
+// This file is part of Windows Sensor Plugin for OpenCPN.
+//
+// Windows Sensor Plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Windows Sensor Plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Windows Sensor Plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#ifndef WINDOWS_SENSOR_PLUGIN_SIGNALK_H
+#define WINDOWS_SENSOR_PLUGIN_SIGNALK_H
+
+// Winsock must be included before windows.h
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "ws2_32.lib")
+
+// wxWidgets Precompiled Headers
+#include "wx/wxprec.h"
+
+#ifndef  WX_PRECOMP
+#include "wx/wx.h"
+#endif
+#include <wx/string.h>
+
+#include <string>
+#include <vector>
+
+// Decoded position fix and satellites
+#include "sensor_plugin_fix.h"
+
+// Streaming JSON writer
+#include "sensor_plugin_json.h"
+
+#define SIGNALK_DEFAULT_PORT 8375
+// Every path is sent at this interval, so that a newly started server learns the values that don't change
+#define SIGNALK_REFRESH_EPOCHS 60
+// Initial size of the message buffer, large enough for a full update with 32 satellites
+#define SIGNALK_BUFFER_SIZE 4096
+
+// Scalar paths whose previous value is retained
+enum SIGNALK_PATHS {
+	SIGNALK_LATITUDE,
+	SIGNALK_LONGITUDE,
+	SIGNALK_SPEED_OVER_GROUND,
+	SIGNALK_COURSE_OVER_GROUND,
+	SIGNALK_ANTENNA_ALTITUDE,
+	SIGNALK_SATELLITES,
+	SIGNALK_HORIZONTAL_DILUTION,
+	SIGNALK_POSITION_DILUTION,
+	SIGNALK_GEOIDAL_SEPARATION,
+	SIGNALK_METHOD_QUALITY,
+	SIGNALK_PATH_COUNT
+};
+
+// Signal K delta output.
+// Each epoch is sent as a single delta message in a UDP datagram, containing only the paths whose
+// values have changed since the previous delta. The message is written by a streaming JSON writer
+// into a buffer that is reused for every epoch.
+class Signal_K_Output {
+
+public:
+	Signal_K_Output(void);
+	~Signal_K_Output(void);
+
+	bool Start(const wxString &address, unsigned short port);
+	void Stop(void);
+	bool IsRunning(void);
+
+	void Publish(const PositionFix &fix, const std::vector<SatelliteInformation> &satellites);
+
+	unsigned long long GetDeltaCount(void);
+
+private:
+	SOCKET udpSocket;
+	sockaddr_in destination;
+	bool isRunning;
+
+	std::string buffer;
+	Json_Writer writer;
+
+	// Values most recently sent, rounded as they were written, NaN if never sent
+	double lastValues[SIGNALK_PATH_COUNT];
+	std::vector<SatelliteInformation> lastSatellites;
+	unsigned int epochCount;
+	unsigned long long deltaCount;
+
+	bool IsChanged(int path, double value, int precision, bool isRefresh);
+	bool IsSatellitesChanged(const std::vector<SatelliteInformation> &satellites, bool isRefresh);
+	void BeginValue(const char *path);
+	void ScalarValue(const char *path, double value, int precision);
+	static double Round(double value, int precision);
+	static const char *MethodQuality(unsigned int fixType);
+	static void FormatTimeStamp(long long timeStamp, char *text, size_t length);
+};
+
+#endif
@@ -0,0 +1,84 @@
+// Copyright(C) 2024 by Steven Adler
+//
+// This file is part of Windows Sensor Plugin for OpenCPN.
+//
+// Windows Sensor Plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Windows Sensor Plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Windows Sensor Plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// Project: Windows Sensor Plugin
+// Description: Streaming track simplification
+// Owner: twocanplugin@hotmail.com
+// Date: 01/04/2024
+// Version History:
+// 1.0 Initial Release
+
+#ifndef WINDOWS_SENSOR_PLUGIN_SIMPLIFIER_H
+#define WINDOWS_SENSOR_PLUGIN_SIMPLIFIER_H
+
+// Maximum number of unconfirmed points held by the simplifier
+// Bounds both memory and the per point cost on long straight legs
+#define TRACK_WINDOW_SIZE 64
+
+// A single track point, time is UTC milliseconds since the epoch
+typedef struct _track_point {
+	double latitude;
+	double longitude;
+	double speedOverGround;
+	double courseOverGround;
+	long long timeStamp;
+} TrackPoint;
+
+// Streaming track simplification.
+// An opening window variant of Douglas-Peucker, the last committed point (the anchor) is joined
+// to the newest point and every buffered point in between must lie within the tolerance of that segment.
+// The distance used is the synchronised euclidean distance, ie. the distance between the buffered
+// point and where it would be on the segment at the same instant, so that speed changes are
+// preserved as well as turns. Points are committed as soon as they become necessary.
+class Track_Simplifier {
+
+public:
+	Track_Simplifier(double toleranceMetres = 5.0, double speedToleranceKnots = 1.0);
+	~Track_Simplifier(void);
+
+	// Feed the next point, returns true if a point has been committed to the output
+	bool Add(const TrackPoint &point, TrackPoint &committed);
+
+	// At the end of the stream commit the last point, if any
+	bool Flush(TrackPoint &committed);
+
+	// Start a new stream
+	void Reset(void);
+
+	void SetTolerance(double toleranceMetres, double speedToleranceKnots);
+
+	// Statistics, used to determine compression ratio
+	unsigned long long pointsIn;
+	unsigned long long pointsOut;
+
+private:
+	double tolerance;
+	double speedTolerance;
+
+	// The last committed point
+	TrackPoint anchor;
+	bool hasAnchor;
+
+	// Points received since the anchor that have not yet been committed
+	TrackPoint window[TRACK_WINDOW_SIZE];
+	unsigned int windowCount;
+
+	// Whether every buffered point is represented by the segment from the anchor to the candidate
+	bool IsRepresentative(const TrackPoint &candidate);
+};
+
+#endif
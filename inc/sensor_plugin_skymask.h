@@ -0,0 +1,91 @@
+// Copyright(C) 2024 by Steven Adler
+//
+// This file is part of Windows Sensor Plugin for OpenCPN.
+//
+// Windows Sensor Plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Windows Sensor Plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Windows Sensor Plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#ifndef WINDOWS_SENSOR_PLUGIN_SKYMASK_H
+#define WINDOWS_SENSOR_PLUGIN_SKYMASK_H
+
+// wxWidgets Precompiled Headers
+#include "wx/wxprec.h"
+
+#ifndef  WX_PRECOMP
+#include "wx/wx.h"
+#endif
+#include <wx/string.h>
+
+#include <vector>
+
+// Satellite snapshot
+#include "sensor_plugin_fix.h"
+
+// Grid of 10 degree cells
+#define SKYMASK_AZIMUTH_CELLS 36
+#define SKYMASK_ELEVATION_CELLS 9
+// Samples required before a cell is classified
+#define SKYMASK_MINIMUM_SAMPLES 30
+// Samples after which the cell average becomes a moving average, so the mask adapts if the antenna is moved
+#define SKYMASK_MAXIMUM_SAMPLES 1000
+// A cell is obstructed if its average is this far below the average for its elevation band
+#define SKYMASK_OBSTRUCTION_MARGIN 8.0
+
+// One cell of the histogram
+typedef struct _skymask_cell {
+	unsigned int samples;
+	float averageSNR;
+	bool isObstructed;
+} SkyMaskCell;
+
+// Learned sky obstruction mask.
+// Accumulates the signal to noise ratio of every satellite in view by azimuth and elevation,
+// cells that are consistently weaker than the rest of their elevation band are considered obstructed.
+class Obstruction_Mask {
+
+public:
+	Obstruction_Mask(void);
+	~Obstruction_Mask(void);
+
+	// Add a satellite snapshot, each satellite is a constant time update
+	void Update(const std::vector<SatelliteInformation> &satellites);
+
+	bool IsObstructed(double azimuth, double elevation);
+	bool IsObstructedCell(unsigned int azimuthCell, unsigned int elevationCell);
+
+	// Fraction of the satellites in the snapshot that lie in clear sky, 1.0 if unknown
+	// Used to weight the quality of a fix
+	double ClearSkyWeight(const std::vector<SatelliteInformation> &satellites);
+
+	// Incremented whenever a cell changes classification, used to redraw the mask
+	unsigned int GetGeneration(void);
+
+	bool Load(const wxString &fileName);
+	bool Save(const wxString &fileName);
+	void Clear(void);
+
+private:
+	SkyMaskCell cells[SKYMASK_AZIMUTH_CELLS][SKYMASK_ELEVATION_CELLS];
+	unsigned int generation;
+
+	// Running totals for each elevation band, avoids rescanning the grid
+	double bandTotal[SKYMASK_ELEVATION_CELLS];
+	unsigned int bandCount[SKYMASK_ELEVATION_CELLS];
+
+	static unsigned int AzimuthCell(double azimuth);
+	static unsigned int ElevationCell(double elevation);
+	void Classify(unsigned int azimuthCell, unsigned int elevationCell);
+};
+
+#endif
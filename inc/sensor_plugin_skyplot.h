@@ -0,0 +1,97 @@
+// Copyright(C) 2024 by Steven Adler
+//
+// This file is part of Windows Sensor Plugin for OpenCPN.
+//
+// Windows Sensor Plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Windows Sensor Plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Windows Sensor Plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#ifndef WINDOWS_SENSOR_PLUGIN_SKYPLOT_H
+#define WINDOWS_SENSOR_PLUGIN_SKYPLOT_H
+
+// wxWidgets Precompiled Headers
+#include "wx/wxprec.h"
+
+#ifndef  WX_PRECOMP
+#include "wx/wx.h"
+#endif
+#include <wx/window.h>
+#include <wx/dcmemory.h>
+#include <wx/timer.h>
+
+#include <vector>
+
+// Satellite snapshot and learned obstruction mask
+#include "sensor_plugin_skymask.h"
+
+// Refresh the display at most twice a second, regardless of the sensor rate
+#define SKYPLOT_REFRESH_INTERVAL 500
+// Number of signal to noise ratio bars
+#define SKYPLOT_MAXIMUM_BARS 24
+// Height of the signal to noise ratio bar chart
+#define SKYPLOT_BAR_HEIGHT 60
+// Size of a satellite symbol
+#define SKYPLOT_SYMBOL_SIZE 20
+
+// Dockable satellite sky plot and signal to noise ratio bar chart
+class Sky_Plot_Panel : public wxWindow {
+
+public:
+	Sky_Plot_Panel(wxWindow *parent);
+	~Sky_Plot_Panel();
+
+	// Latest satellite snapshot, displayed at the next refresh
+	void SetSatellites(const std::vector<SatelliteInformation> &satellites);
+
+	// Obstructed areas of the sky are shaded
+	void SetObstructionMask(Obstruction_Mask *mask);
+
+private:
+	// Satellites currently displayed and those waiting to be displayed
+	std::vector<SatelliteInformation> displayed;
+	std::vector<SatelliteInformation> pending;
+	bool isPending;
+
+	// Range rings, cardinal points and bar chart axis
+	wxBitmap backgroundBitmap;
+	// Background and satellites, copied to the screen when painting
+	wxBitmap compositeBitmap;
+
+	wxTimer refreshTimer;
+
+	Obstruction_Mask *obstructionMask;
+	unsigned int maskGeneration;
+
+	// Sky plot geometry
+	wxPoint centre;
+	int radius;
+
+	void OnPaint(wxPaintEvent &event);
+	void OnSize(wxSizeEvent &event);
+	void OnTimer(wxTimerEvent &event);
+	void OnEraseBackground(wxEraseEvent &event);
+
+	void DrawBackground(void);
+	void DrawObstructions(wxDC &dc);
+	void DrawAll(void);
+	void ApplySnapshot(void);
+
+	bool HasChanged(const SatelliteInformation &previous, const SatelliteInformation &current);
+	wxRect SymbolRect(const SatelliteInformation &satellite);
+	wxRect BarRect(unsigned int index);
+	wxColour SignalColour(double snr);
+	void DrawSatellite(wxDC &dc, const SatelliteInformation &satellite);
+	void DrawBar(wxDC &dc, unsigned int index, const SatelliteInformation &satellite);
+};
+
+#endif
@@ -0,0 +1,110 @@
+// Copyright(C) 2024 by Steven Adler
+//
+// This file is part of Windows Sensor Plugin for OpenCPN.
+//
+// Windows Sensor Plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Windows Sensor Plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Windows Sensor Plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#ifndef WINDOWS_SENSOR_PLUGIN_SOURCES_H
+#define WINDOWS_SENSOR_PLUGIN_SOURCES_H
+
+// wxWidgets Precompiled Headers
+#include "wx/wxprec.h"
+
+#ifndef  WX_PRECOMP
+#include "wx/wx.h"
+#endif
+#include <wx/string.h>
+
+// Windows COM and Sensor API
+#include <comutil.h>
+#include <sensorsapi.h>
+#include <sensors.h>
+#pragma comment(lib,"sensorsapi.lib")
+
+#include <string>
+#include <vector>
+
+// Receive timestamps
+#include "sensor_plugin_fix.h"
+// Each sensor is a source for the arbiter
+#include "sensor_plugin_arbiter.h"
+// Failed Sensor API calls are counted
+#include "sensor_plugin_counters.h"
+
+// How often, in milliseconds, to look for sensors that have been added or removed
+#define SENSOR_RESCAN_INTERVAL 5000
+// How often, in milliseconds, to check whether discovery has completed
+#define SENSOR_DISCOVERY_INTERVAL 100
+
+// A location sensor and the arbiter's index for it
+typedef struct _location_sensor {
+	// NULL whilst the sensor is not present
+	ISensor *sensor;
+	SENSOR_ID id;
+	wxString name;
+	int source;
+	SensorState state;
+	bool isPresent;
+	// When its latest report was received and the sentence, if any, attached to it
+	ReceiveTime receiveTime;
+	std::string sentence;
+} LocationSensor;
+
+// A change in the state of a sensor
+typedef struct _sensor_transition {
+	wxString name;
+	int source;
+	wxString previous;
+	wxString current;
+} SensorTransition;
+
+// Tracks the GPS sensors as they are added, removed, enabled or disabled.
+// Sensors are identified by their id, so a sensor that is unplugged and plugged back in keeps its
+// arbiter source. Nothing is lost if the Sensor API is not yet available, Open may simply be retried.
+class Location_Sensors {
+
+public:
+	Location_Sensors(void);
+	~Location_Sensors(void);
+
+	// Create the sensor manager
+	bool Open(void);
+	void Close(void);
+	bool IsOpen(void);
+
+	// Enumerate the sensors, adding those that have appeared and releasing those that have gone
+	void Rescan(Source_Arbiter &arbiter, std::vector<SensorTransition> &transitions);
+	// Poll the state of each sensor that is present, cheap enough for every epoch
+	void UpdateStates(std::vector<SensorTransition> &transitions);
+
+	std::vector<LocationSensor> &GetSensors(void);
+	unsigned int GetPresentCount(void);
+
+	// Enumerate the sensors with a Sensor Manager of the calling thread's own, so that they may be
+	// discovered off the GUI thread. COM interfaces are bound to their apartment so the sensors cannot be
+	// handed over, but by the time Open is called the Sensor API is loaded and connected to its service.
+	// Returns the number of sensors found.
+	static unsigned int Discover(void);
+
+	static wxString StateName(SensorState state, bool isPresent);
+
+private:
+	ISensorManager *sensorManager;
+	std::vector<LocationSensor> sensors;
+
+	void SetState(LocationSensor &sensor, SensorState state, bool isPresent, std::vector<SensorTransition> &transitions);
+};
+
+#endif
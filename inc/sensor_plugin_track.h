@@ -0,0 +1,61 @@
+// Copyright(C) 2024 by Steven Adler
+//
+// This file is part of Windows Sensor Plugin for OpenCPN.
+//
+// Windows Sensor Plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Windows Sensor Plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Windows Sensor Plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#ifndef WINDOWS_SENSOR_PLUGIN_TRACK_H
+#define WINDOWS_SENSOR_PLUGIN_TRACK_H
+
+// wxWidgets Precompiled Headers
+#include "wx/wxprec.h"
+
+#ifndef  WX_PRECOMP
+#include "wx/wx.h"
+#endif
+#include <wx/string.h>
+#include <wx/file.h>
+
+// Track points and the streaming simplifier
+#include "sensor_plugin_simplifier.h"
+
+// Logged points further apart than this, in milliseconds, are exported as separate track segments, eg. sessions.
+// Longer than a full window at the slowest epoch interval, so that a long straight leg is not split.
+#define TRACK_SEGMENT_GAP 900000
+
+// Track log, retains the simplified track in a CSV file in the OpenCPN private data directory
+class Track_Log {
+
+public:
+	Track_Log(void);
+	~Track_Log(void);
+
+	bool Open(const wxString &fileName, double toleranceMetres, double speedToleranceKnots);
+	void Close(void);
+	bool IsOpen(void);
+
+	// Log a new position fix, only points retained by the simplifier are written
+	void Append(const TrackPoint &point);
+
+	// Export the track log as a GPX track, re-simplifying at the export tolerance
+	static bool ExportGPX(const wxString &logFileName, const wxString &gpxFileName, double toleranceMetres, double speedToleranceKnots);
+
+private:
+	wxFile logFile;
+	Track_Simplifier simplifier;
+	void Write(const TrackPoint &point);
+};
+
+#endif
@@ -46,7 +46,7 @@ extern "C" DECL_EXP void destroy_pi(opencpn_plugin* p) {
 	delete p;
 }
 
-Windows_Sensor_Plugin::Windows_Sensor_Plugin(void *ppimgr) : opencpn_plugin_116(ppimgr), wxTimer(this) {
+Windows_Sensor_Plugin::Windows_Sensor_Plugin(void *ppimgr) : opencpn_plugin_116(ppimgr), wxTimer(this), messageWriter(messageBuffer) {
 	// Load the plugin bitmaps/icons 
 	initialize_images();
 }
@@ -55,6 +55,11 @@ Windows_Sensor_Plugin::~Windows_Sensor_Plugin(void) {
 }
 
 int Windows_Sensor_Plugin::Init(void) {
+	// Used to measure how long until the first fix
+	initTime = GetTickCount64();
+	attachTime = 0;
+	firstFixTime = 0;
+
 	// Maintain a reference to the OpenCPN window
 	// Although we don't actually use it
 	parentWindow = GetOCPNCanvasWindow();
@@ -70,18 +75,131 @@ int Windows_Sensor_Plugin::Init(void) {
 		configSettings->Read(_T("GGA"), &isGGA, 1);
 		configSettings->Read(_T("GSV"), &isGSV, 1);
 		configSettings->Read(_T("RMC"), &isRMC, 1);
+		configSettings->Read(_T("TrackLog"), &isTrackLog, 0);
+		configSettings->Read(_T("TrackOverlay"), &isTrackOverlay, 1);
+		configSettings->Read(_T("AccuracyRing"), &isAccuracyRing, 1);
+		configSettings->Read(_T("UERE"), &uere, 5.0);
+		configSettings->Read(_T("SkyPlot"), &isSkyPlot, 0);
+		configSettings->Read(_T("ServerTCP"), &isServerTCP, 0);
+		configSettings->Read(_T("ServerTCPPort"), &serverTCPPort, SERVER_DEFAULT_PORT);
+		configSettings->Read(_T("ServerUDP"), &isServerUDP, 0);
+		configSettings->Read(_T("ServerUDPAddress"), &serverUDPAddress, _T("255.255.255.255"));
+		configSettings->Read(_T("ServerUDPPort"), &serverUDPPort, SERVER_DEFAULT_PORT);
+		configSettings->Read(_T("GPSD"), &isGPSD, 0);
+		configSettings->Read(_T("GPSDPort"), &gpsdPort, GPSD_DEFAULT_PORT);
+		configSettings->Read(_T("SharedMemory"), &isSharedMemory, 0);
+		configSettings->Read(_T("NTP"), &isNTP, 0);
+		configSettings->Read(_T("NTPUnit"), &ntpUnit, NTP_DEFAULT_UNIT);
+		configSettings->Read(_T("N2K"), &isN2K, 0);
+		configSettings->Read(_T("N2KAddress"), &n2kAddress, _T("127.0.0.1"));
+		configSettings->Read(_T("N2KPort"), &n2kPort, N2K_DEFAULT_PORT);
+		configSettings->Read(_T("N2KSource"), &n2kSource, N2K_DEFAULT_SOURCE);
+		configSettings->Read(_T("N2KFormat"), &n2kFormat, N2K_FORMAT_TRANSMIT);
+		configSettings->Read(_T("SignalK"), &isSignalK, 0);
+		configSettings->Read(_T("SignalKAddress"), &signalKAddress, _T("127.0.0.1"));
+		configSettings->Read(_T("SignalKPort"), &signalKPort, SIGNALK_DEFAULT_PORT);
+		configSettings->Read(_T("Fusion"), &isFusion, 0);
+		configSettings->Read(_T("AdaptiveInterval"), &isAdaptiveInterval, 1);
+		configSettings->Read(_T("BatterySaver"), &batterySaver, BATTERY_SAVER_ON_BATTERY);
+		configSettings->Read(_T("EpochOffset"), &epochOffset, EPOCH_DEFAULT_OFFSET);
+		configSettings->Read(_T("Orientation"), &isOrientation, 0);
+		configSettings->Read(_T("Motion"), &isMotion, 0);
+		configSettings->Read(_T("Barometer"), &isBarometer, 0);
+		configSettings->Read(_T("TrackTolerance"), &trackTolerance, 5.0);
+		configSettings->Read(_T("ExportTolerance"), &exportTolerance, 20.0);
+		configSettings->Read(_T("SpeedTolerance"), &speedTolerance, 1.0);
 	}
 
-	// Initialize the Windows Sensor
-	isRunning = InitializeSensor();
+	// The track log is kept in the OpenCPN private data directory
+	trackLogFileName = *GetpPrivateApplicationDataLocation() + wxFileName::GetPathSeparator() + _T("windows_sensor_track.csv");
+	if (isTrackLog) {
+		trackLog.Open(trackLogFileName, trackTolerance, speedTolerance);
+	}
 
-	// Fetch our position every second
-	if (isRunning == true) {
-		Start(1000, wxTIMER_CONTINUOUS);
+	// Each Windows Sensor is a source for the arbiter, as is any external receiver.
+	// Loading the Sensor API and enumerating the sensors can take seconds, so it is done in the background.
+	sourceArbiter.Clear();
+	selectedSource = -1;
+	sensorTransitions.clear();
+	isAttached = false;
+	isDiscovered = false;
+	discoveredCount = 0;
+	cadence.Reset();
+	epochInterval = CADENCE_NORMAL_INTERVAL;
+	discoveryThread = std::thread([this]() {
+		discoveredCount = Location_Sensors::Discover();
+		isDiscovered = true;
+	});
+	externalSource = sourceArbiter.AddSource(_T("NMEA 0183"), true);
+	externalFix = PositionFix();
+	externalSatellites.clear();
+	externalConstellations.Clear();
+
+	// Optionally serve our sentences to other applications
+	if ((isServerTCP) || (isServerUDP)) {
+		nmeaServer.Start(isServerTCP, serverTCPPort, isServerUDP, serverUDPAddress, serverUDPPort);
+	}
+	if (isGPSD) {
+		gpsdServer.Start(gpsdPort);
+	}
+	if (isSharedMemory) {
+		fixPublisher.Open();
+	}
+	if (isNTP) {
+		ntpClock.Open(ntpUnit);
+	}
+	if (isN2K) {
+		n2kOutput.Start(n2kAddress, n2kPort, n2kSource, n2kFormat == N2K_FORMAT_RECEIVED ? N2K_FORMAT_RECEIVED : N2K_FORMAT_TRANSMIT);
+	}
+	if (isSignalK) {
+		signalKOutput.Start(signalKAddress, signalKPort);
+	}
+
+	// Compass and gyrometer run on their own schedule, even without a position sensor
+	if (isOrientation) {
+		orientationSensor.Start();
+	}
+	if (isMotion) {
+		motionSensor.Start();
+	}
+	if (isBarometer) {
+		barometerSensor.Start();
+	}
+
+	// Wait for discovery, thereafter fetch our position every second, even without a sensor as one may be added
+	Start(SENSOR_DISCOVERY_INTERVAL, wxTIMER_CONTINUOUS);
+	isRunning = true;
+
+	// Draw our track using the current colour scheme
+	trackOverlay.SetColorScheme(PI_GLOBAL_COLOR_SCHEME_DAY);
+	accuracyOverlay.SetColorScheme(PI_GLOBAL_COLOR_SCHEME_DAY);
+	accuracyOverlay.SetUERE(uere);
+
+	// Sky obstruction mask learned from previous sessions
+	obstructionMaskFileName = *GetpPrivateApplicationDataLocation() + wxFileName::GetPathSeparator() + _T("windows_sensor_sky_mask.dat");
+	obstructionMask.Load(obstructionMaskFileName);
+	verboseLogFileName = *GetpPrivateApplicationDataLocation() + wxFileName::GetPathSeparator() + _T("windows_sensor_verbose.log");
+	if (isVerbose) {
+		verboseLog.Open(verboseLogFileName);
 	}
+	maskSaveTime = initTime;
+	latencyTime = initTime;
+	counterTime = initTime;
+	performanceFrequency = 0;
+	acquireTime = 0;
+	isVariationValid = false;
+	pushTicks = 0;
+
+	// Satellite sky plot, docked in the OpenCPN frame
+	skyPlotPanel = nullptr;
+	ShowSkyPlot(isSkyPlot);
 
 	// Notify OpenCPN what events we want to receive callbacks for
-	return (WANTS_CONFIG | WANTS_PREFERENCES);
+#ifdef ocpnUSE_GL
+	return (WANTS_CONFIG | WANTS_PREFERENCES | WANTS_OVERLAY_CALLBACK | WANTS_OPENGL_OVERLAY_CALLBACK | WANTS_NMEA_SENTENCES);
+#else
+	return (WANTS_CONFIG | WANTS_PREFERENCES | WANTS_OVERLAY_CALLBACK | WANTS_NMEA_SENTENCES);
+#endif
 }
 
 // OpenCPN is either closing down, or we have been disabled from the Preferences Dialog
@@ -89,12 +207,34 @@ bool Windows_Sensor_Plugin::DeInit(void) {
 	// Stop our timer and cleanup
 	if (isRunning == true) {
 		Stop();
-		sensor->Release();
-		sensorManager = NULL;
-		CoUninitialize();
+		if (discoveryThread.joinable()) {
+			discoveryThread.join();
+		}
+		if (isAttached) {
+			timeEndPeriod(1);
+			isAttached = false;
+		}
+		nmeaServer.Stop();
+		gpsdServer.Stop();
+		fixPublisher.Close();
+		ntpClock.Close();
+		n2kOutput.Stop();
+		signalKOutput.Stop();
+		locationSensors.Close();
 	}
 	isRunning = false;
 
+	orientationSensor.Stop();
+	motionSensor.Stop();
+	barometerSensor.Stop();
+
+	trackLog.Close();
+	verboseLog.Close();
+
+	ShowSkyPlot(false);
+
+	obstructionMask.Save(obstructionMaskFileName);
+
 	return true;
 }
 
@@ -136,6 +276,7 @@ wxBitmap* Windows_Sensor_Plugin::GetPlugInBitmap() {
 
 void Windows_Sensor_Plugin::ShowPreferencesDialog(wxWindow* parent) {
 
+	diagnosticsText = latencyMonitor.Summary() + _T("\n") + Performance_Counters::Summary(performanceFrequency);
 	settingsDialog = new Windows_Sensor_Plugin_Settings(parent);
 
 	if (settingsDialog->ShowModal() == wxID_OK) {
@@ -147,133 +288,100 @@ void Windows_Sensor_Plugin::ShowPreferencesDialog(wxWindow* parent) {
 			configSettings->Write(_T("GGA"), isGGA);
 			configSettings->Write(_T("GSV"), isGSV);
 			configSettings->Write(_T("RMC"), isRMC);
+			configSettings->Write(_T("TrackLog"), isTrackLog);
+			configSettings->Write(_T("TrackOverlay"), isTrackOverlay);
+			configSettings->Write(_T("AccuracyRing"), isAccuracyRing);
+			configSettings->Write(_T("SkyPlot"), isSkyPlot);
 		}
+
+		// Start or stop logging our track
+		if ((isTrackLog) && (!trackLog.IsOpen())) {
+			trackLog.Open(trackLogFileName, trackTolerance, speedTolerance);
+		}
+		else if ((!isTrackLog) && (trackLog.IsOpen())) {
+			trackLog.Close();
+		}
+
+		// Start or stop verbose logging
+		if ((isVerbose) && (!verboseLog.IsOpen())) {
+			verboseLog.Open(verboseLogFileName);
+		}
+		else if ((!isVerbose) && (verboseLog.IsOpen())) {
+			verboseLog.Close();
+		}
+
+		ShowSkyPlot(isSkyPlot);
 	}
 		
 	delete settingsDialog;
 	settingsDialog = nullptr;
 }
 
-bool Windows_Sensor_Plugin::InitializeSensor() {
-	sensorManager = NULL;
-	HRESULT hr;
-
-	// Unnecessary as COM appears to be initialized by wxWidgets
-	// Initialize the COM Object
-	///hr = CoInitializeEx(0, COINIT_MULTITHREADED);
-	//if (hr != S_OK) {
-	//	wxLogMessage(_T("Windows Sensor Plugin, COM Interface failed 0x%08lx"), hr);
-	//	return false;
-	//}
-
-	// Create an intance of the Sensor COM object
-	hr = CoCreateInstance(CLSID_SensorManager, 0, CLSCTX_ALL, __uuidof(ISensorManager), (void**)&sensorManager);
-
-	if ((hr != S_OK) || (sensorManager == NULL)) {
-		wxLogMessage(_T("Windows Sensor Plugin, Sensor Manager is not initializated."));
-		CoUninitialize();
-		return false;
+// Create or destroy the sky plot pane
+void Windows_Sensor_Plugin::ShowSkyPlot(bool show) {
+	wxAuiManager *auiManager = GetFrameAuiManager();
+	if (auiManager == NULL) {
+		return;
 	}
-	wxLogMessage(_T("Windows Sensor Plugin, Sensor Manager initializated."));
 
-	ISensorCollection *sensorList = NULL;
-
-	// Specifically use a GPS device
-	//hr = sensorManager->GetSensorsByCategory(SENSOR_CATEGORY_LOCATION, &sensorList);
-	hr = sensorManager->GetSensorsByCategory(SENSOR_TYPE_LOCATION_GPS, &sensorList);
-	if ((hr != S_OK) || (sensorList == NULL)) {
-		wxLogMessage(_T("Windows Sensor Plugin, No GPS Sensors found"));
-		CoUninitialize();
-		return false;
+	if ((show) && (skyPlotPanel == nullptr)) {
+		skyPlotPanel = new Sky_Plot_Panel(parentWindow);
+		skyPlotPanel->SetObstructionMask(&obstructionMask);
+		wxAuiPaneInfo paneInfo;
+		paneInfo.Name(_T("WindowsSensorSkyPlot"));
+		paneInfo.Caption(_("GNSS Satellites"));
+		paneInfo.Float();
+		paneInfo.FloatingSize(skyPlotPanel->GetSize());
+		paneInfo.BestSize(skyPlotPanel->GetSize());
+		paneInfo.Dockable(true);
+		paneInfo.CloseButton(false);
+		auiManager->AddPane(skyPlotPanel, paneInfo);
+		auiManager->Update();
 	}
-
-	// BUG BUG Probably unnecessary
-	ULONG sensorsCount = 0;
-	hr = sensorList->GetCount(&sensorsCount);
-	if ((hr != S_OK) || (sensorsCount == 0)) {
-		wxLogMessage(_T("Windows Sensor Plugin, GPS Sensor Count is zero"));
-		sensorList->Release();
-		CoUninitialize();
-		return false;
+	else if ((!show) && (skyPlotPanel != nullptr)) {
+		auiManager->DetachPane(skyPlotPanel);
+		auiManager->Update();
+		skyPlotPanel->Destroy();
+		skyPlotPanel = nullptr;
 	}
+}
 
-	wxLogMessage(_T("Windows Sensor Plugin, Found %i GPS sensor(s)"), sensorsCount);
-
-	// Iterate through the sensors, although we really just use the last one returned
-	for (unsigned int i = 0; i < sensorsCount; i++) {
-		sensor = NULL;
-
-		hr = sensorList->GetAt(i, &sensor);
-		if ((hr != S_OK) || (sensor == NULL)) {
-			continue;
-		}
-
-		BSTR name = NULL;
-		hr = sensor->GetFriendlyName(&name);
-		if ((hr != S_OK) || (name == NULL)) {
-			continue;
-		}
-
-		// Convert the BSTR to a wxString
-		sensorName = wxString::FromUTF8(_bstr_t(name));
-		wxLogMessage(_T("Windows Sensor Plugin, GPS Sensor: %i, Name %s"), i, sensorName);
-
-		// Not really necessary, but useful for debugging purposes
-		SENSOR_ID guid;
-		hr = sensor->GetID(&guid);
-		if (hr == S_OK) {
-
-			wxLogMessage(_T("Windows Sensor Plugin: %08lX-%04hX-%04hX-%02hhX%02hhX-%02hhX%02hhX%02hhX%02hhX%02hhX%02hhX"),
-				guid.Data1, guid.Data2, guid.Data3,
-				guid.Data4[0], guid.Data4[1], guid.Data4[2], guid.Data4[3],
-				guid.Data4[4], guid.Data4[5], guid.Data4[6], guid.Data4[7]);
-		}
-
-		// Not really necessary, but again, useful for debugging purposes
-		SensorState state;
-		hr = sensor->GetState(&state);
-		if (hr == S_OK) {
-
-			wxString sensorState = wxEmptyString;
-
-			switch (state) {
-				case SENSOR_STATE_READY || SENSOR_STATE_MIN:
-					sensorState = "Ready";
-					break;
-				case SENSOR_STATE_NOT_AVAILABLE:
-					sensorState = "Not Available";
-					break;
-				case SENSOR_STATE_INITIALIZING:
-					sensorState = "Initializing";
-					break;
-				case SENSOR_STATE_ERROR:
-					sensorState = "Error";
-					break;
-				case SENSOR_STATE_ACCESS_DENIED:
-					sensorState = "Access Denied";
-					break;
-				case SENSOR_STATE_NO_DATA:
-					sensorState = "No Data";
-					break;
-				default:
-					sensorState = "Unknown";
-					break;
-			}
-
-			wxLogMessage(_T("Windows Sensor Plugin, GPS sensor state: %s"), sensorState);
-		}
+// Draw our breadcrumb trail and accuracy ring
+bool Windows_Sensor_Plugin::RenderOverlayMultiCanvas(wxDC &dc, PlugIn_ViewPort *vp, int canvasIndex) {
+	bool isRendered = false;
+	if (isTrackOverlay) {
+		isRendered |= trackOverlay.Render(dc, vp);
+	}
+	if (isAccuracyRing) {
+		isRendered |= accuracyOverlay.Render(dc, vp);
+	}
+	return isRendered;
+}
 
+// Same again when OpenCPN is using the OpenGL canvas, OpenCPN has already made the context current
+bool Windows_Sensor_Plugin::RenderGLOverlayMultiCanvas(wxGLContext *pcontext, PlugIn_ViewPort *vp, int canvasIndex) {
+	bool isRendered = false;
+	if (isTrackOverlay) {
+		isRendered |= trackOverlay.RenderGL(vp);
 	}
-	return true;
+	if (isAccuracyRing) {
+		isRendered |= accuracyOverlay.RenderGL(vp);
+	}
+	return isRendered;
 }
 
+void Windows_Sensor_Plugin::SetColorScheme(PI_ColorScheme cs) {
+	trackOverlay.SetColorScheme(cs);
+	accuracyOverlay.SetColorScheme(cs);
+}
 
-bool Windows_Sensor_Plugin::GetData(void) {
+bool Windows_Sensor_Plugin::GetData(ISensor *sensor) {
 	HRESULT hr = 0;
 	SensorState state;
 
 	hr = sensor->GetState(&state);
 	if (hr != S_OK) {
+		Performance_Counters::Increment(COUNTER_COM_FAILURES);
 		return false;
 	}
 
@@ -286,14 +394,22 @@ bool Windows_Sensor_Plugin::GetData(void) {
 	hr = sensor->GetData(&sensorData);
 	
 	if ((hr != S_OK) || (sensorData == NULL)) {
+		Performance_Counters::Increment(COUNTER_COM_FAILURES);
 		return false;
 	}
 
+	// Timestamp the report before doing anything else with it
+	CaptureReceiveTime(sensorData);
+	sensorSentence.clear();
+	isVariationValid = false;
+
 	// Iterate through the data values
 	IPortableDeviceKeyCollection *keyList = NULL;
 	hr = sensor->GetSupportedDataFields(&keyList);
 
 	if ((hr != S_OK) || (keyList == NULL)) {
+		Performance_Counters::Increment(COUNTER_COM_FAILURES);
+		sensorData->Release();
 		return false;
 	}
 
@@ -302,6 +418,8 @@ bool Windows_Sensor_Plugin::GetData(void) {
 	
 	if ((hr != S_OK) || (keyCount == 0)) {
 		wxLogMessage(_T("Windows Sensor Plugin, No data values."));
+		keyList->Release();
+		sensorData->Release();
 		return false;
 	}
 
@@ -373,6 +491,7 @@ bool Windows_Sensor_Plugin::GetData(void) {
 
 		else if (sensorDataKey == SENSOR_DATA_TYPE_MAGNETIC_VARIATION) {
 			magneticVariation = sensorDataValue.dblVal;
+			isVariationValid = true;
 		}
 
 		else if (sensorDataKey == SENSOR_DATA_TYPE_SATELLITES_IN_VIEW) {
@@ -404,8 +523,10 @@ bool Windows_Sensor_Plugin::GetData(void) {
 		else if (sensorDataKey == SENSOR_DATA_TYPE_NMEA_SENTENCE) {
 			BSTR sentence = sensorDataValue.bstrVal;
 			wxString nmeaSentence = wxString::FromUTF8(_bstr_t(sentence));
+			// Used for its time field by the NTP reference clock
+			sensorSentence = std::string(nmeaSentence.ToAscii());
 			if (isVerbose) {
-				wxLogMessage(_T("Windows Sensor Plugin, NMEA Sentence: %s"), nmeaSentence);
+				verboseLog.Write(LOG_SENSOR_SENTENCE, sensorSentence.c_str());
 			}
 		}
 
@@ -455,21 +576,56 @@ bool Windows_Sensor_Plugin::GetData(void) {
 		PropVariantClear(&sensorDataValue);
 	}
 	keyList->Release();
+
+	// Take a snapshot of the satellites in view for this epoch
+	satellites.resize(satellitesInView);
+	if (satellitesInView > 0) {
+		GetSatelliteInfo(sensorData, SENSOR_DATA_TYPE_SATELLITES_IN_VIEW_ID, satellites);
+		GetSatelliteInfo(sensorData, SENSOR_DATA_TYPE_SATELLITES_IN_VIEW_AZIMUTH, satellites);
+		GetSatelliteInfo(sensorData, SENSOR_DATA_TYPE_SATELLITES_IN_VIEW_ELEVATION, satellites);
+		GetSatelliteInfo(sensorData, SENSOR_DATA_TYPE_SATELLITES_IN_VIEW_STN_RATIO, satellites);
+	}
+	sensorData->Release();
+
 	return true;
 }
 
+// Sample the monotonic and realtime clocks for the report just received
+void Windows_Sensor_Plugin::CaptureReceiveTime(ISensorDataReport *sensorData) {
+	LARGE_INTEGER counter;
+	FILETIME now;
+	QueryPerformanceCounter(&counter);
+	GetSystemTimePreciseAsFileTime(&now);
+	receiveTime.monotonic = counter.QuadPart;
+	acquireTime = counter.QuadPart;
+	receiveTime.realtime = ((long long)now.dwHighDateTime << 32) | now.dwLowDateTime;
+
+	// The driver timestamps the report when the fix arrives, and keeps returning the same report until it has
+	// another, so a sensor that has lost its fix returns an ever older report. Wind both clocks back by the
+	// age of the report, however old, so that it is treated as such.
+	SYSTEMTIME reportTime;
+	FILETIME reportFileTime;
+	if ((SUCCEEDED(sensorData->GetTimestamp(&reportTime))) && (SystemTimeToFileTime(&reportTime, &reportFileTime))) {
+		long long reportRealtime = ((long long)reportFileTime.dwHighDateTime << 32) | reportFileTime.dwLowDateTime;
+		long long age = receiveTime.realtime - reportRealtime;
+		// A report from the future means the system clock has been stepped back, as does one more than a day
+		// old, in 100 nanosecond units
+		if ((age > 0) && (age < 864000000000LL)) {
+			LARGE_INTEGER frequency;
+			QueryPerformanceFrequency(&frequency);
+			receiveTime.realtime = reportRealtime;
+			receiveTime.monotonic -= (age * frequency.QuadPart) / 10000000LL;
+		}
+	}
+}
+
 // Obtain each satellite's id, azimuth, elevation, signal to noise ratio etc.
 // Used to generate NMEA 0183 GSV sentences
-void Windows_Sensor_Plugin::GetSatelliteInfo(const PROPERTYKEY key, std::vector<SatelliteInformation> &sats) {
+// Uses the same data report as the position fix, so that the satellites match the epoch
+void Windows_Sensor_Plugin::GetSatelliteInfo(ISensorDataReport *sensorData, const PROPERTYKEY key, std::vector<SatelliteInformation> &sats) {
 	PROPVARIANT propertyValue;
 	PropVariantInit(&propertyValue);
-	ISensorDataReport *sensorData = NULL;
 	HRESULT hr;
-	hr = sensor->GetData(&sensorData);
-	if (FAILED(hr) || !sensorData) {
-		wprintf(L"Failed to get location sensor data\n");
-		return;
-	}
 	hr = sensorData->GetSensorValue(key, &propertyValue);
 	if (SUCCEEDED(hr)) {
 		if ((VT_UI1 | VT_VECTOR) == V_VT(&propertyValue)) {
@@ -479,29 +635,38 @@ void Windows_Sensor_Plugin::GetSatelliteInfo(const PROPERTYKEY key, std::vector<
 			// integer variable to store Id
 			unsigned int *id = (unsigned int *)propertyValue.caub.pElems;
 
-			for (unsigned int i = 0; i < satellitesInView; i++) {
+			// The vector is sized in bytes, and may describe fewer satellites than the count reported
+			unsigned int available = IsEqualPropertyKey(key, SENSOR_DATA_TYPE_SATELLITES_IN_VIEW_ID) ?
+				propertyValue.caub.cElems / sizeof(UINT) : propertyValue.caub.cElems / sizeof(double);
+			unsigned int count = wxMin(wxMin(satellitesInView, available), (unsigned int)sats.size());
+
+			for (unsigned int i = 0; i < count; i++) {
 				if (IsEqualPropertyKey(key, SENSOR_DATA_TYPE_SATELLITES_IN_VIEW_ID)) {
 					sats.at(i).id = (unsigned int)*id;
 					if (isVerbose) {
-						wxLogMessage(_T("Windows Sensor Plugin, Satellite Id (%d): %d"), i, *id);
+						LogArgument arguments[] = { LogInteger(i), LogInteger(*id) };
+						verboseLog.Write(LOG_SATELLITE_ID, NULL, 2, arguments);
 					}
 				}
 				if (IsEqualPropertyKey(key, SENSOR_DATA_TYPE_SATELLITES_IN_VIEW_AZIMUTH)) {
 					sats.at(i).azimuth = (int)*element;
 					if (isVerbose) {
-						wxLogMessage(_T("Windows Sensor Plugin, Satellite Azimuth (%d): %f"), i, *element);
+						LogArgument arguments[] = { LogInteger(i), LogNumber(*element) };
+						verboseLog.Write(LOG_SATELLITE_AZIMUTH, NULL, 2, arguments);
 					}
 				}
 				else if (IsEqualPropertyKey(key, SENSOR_DATA_TYPE_SATELLITES_IN_VIEW_ELEVATION)) {
 					sats.at(i).elevation = (int)*element;
 					if (isVerbose) {
-						wxLogMessage(_T("Windows Sensor Plugin, Satellite Elevation (%d): %f"), i, *element);
+						LogArgument arguments[] = { LogInteger(i), LogNumber(*element) };
+						verboseLog.Write(LOG_SATELLITE_ELEVATION, NULL, 2, arguments);
 					}
 				}
 				else if (IsEqualPropertyKey(key, SENSOR_DATA_TYPE_SATELLITES_IN_VIEW_STN_RATIO)) {
 					sats.at(i).snr = (int)*element;
 					if (isVerbose) {
-						wxLogMessage(_T("Windows Sensor Plugin, Satellite SNR (%d): %f"), i, *element);
+						LogArgument arguments[] = { LogInteger(i), LogNumber(*element) };
+						verboseLog.Write(LOG_SATELLITE_SNR, NULL, 2, arguments);
 					}
 				}
 				element++;
@@ -510,7 +675,7 @@ void Windows_Sensor_Plugin::GetSatelliteInfo(const PROPERTYKEY key, std::vector<
 		}
 	}
 	else {
-		wprintf(L"Failed to get property value\n");
+		Performance_Counters::Increment(COUNTER_COM_FAILURES);
 	}
 	PropVariantClear(&propertyValue);
 }
@@ -523,9 +688,331 @@ void Windows_Sensor_Plugin::GetSatelliteInfo(const PROPERTYKEY key, std::vector<
 //                                             | sats
 //                                           fix Qualty
 
+// Sentences from every OpenCPN connection, including those we pushed ourselves
+void Windows_Sensor_Plugin::SetNMEASentence(wxString &sentence) {
+	// Narrow without allocating, anything longer than the buffer cannot be valid
+	size_t length = sentence.length();
+	if (length > NMEA_MAXIMUM_LENGTH) {
+		Performance_Counters::Increment(COUNTER_NMEA_ERRORS);
+		return;
+	}
+	const wchar_t *text = sentence.wc_str();
+	for (size_t i = 0; i < length; i++) {
+		nmeaBuffer[i] = text[i] < 0x80 ? (char)text[i] : '?';
+	}
+	nmeaBuffer[length] = '\0';
+
+	// Forwarding our own sentences would be an echo
+	if (NMEA_Echo_Filter::IsEcho(nmeaBuffer, length)) {
+		return;
+	}
+
+	NmeaSentence decoded;
+	if (!NMEA_Parser::Parse(nmeaBuffer, length, decoded)) {
+		// Most sentence types are simply not of interest
+		if (decoded.type != NMEA_UNKNOWN) {
+			Performance_Counters::Increment(COUNTER_NMEA_ERRORS);
+		}
+		return;
+	}
+
+	Performance_Counters::Increment(COUNTER_NMEA_RECEIVED);
+	UpdateExternalFix(decoded);
+}
+
+// Assemble a fix from an external receiver, the arbiter is updated by each sentence that carries a position
+void Windows_Sensor_Plugin::UpdateExternalFix(const NmeaSentence &sentence) {
+	switch (sentence.type) {
+		case NMEA_RMC:
+			externalFix.isValid = (sentence.rmc.isActive) && (sentence.rmc.position.isValid);
+			if (sentence.rmc.position.isValid) {
+				externalFix.latitude = sentence.rmc.position.latitude;
+				externalFix.longitude = sentence.rmc.position.longitude;
+			}
+			externalFix.speedOverGround = sentence.rmc.speedOverGround;
+			if (sentence.rmc.isCourseValid) {
+				externalFix.courseOverGround = sentence.rmc.courseOverGround;
+			}
+			if (sentence.rmc.isVariationValid) {
+				externalFix.magneticVariation = sentence.rmc.magneticVariation;
+			}
+			externalFix.isVariationValid = sentence.rmc.isVariationValid;
+			// Mode indicator, as an index into GpsSelectionMode
+			externalFix.selectionMode = 0;
+			for (unsigned int i = 0; i < GpsSelectionMode.size(); i++) {
+				if (GpsSelectionMode[i] == sentence.rmc.mode) {
+					externalFix.selectionMode = i;
+				}
+			}
+			// RMC has no quality indicator, assume a GPS fix until a GGA says otherwise
+			if ((externalFix.isValid) && (externalFix.fixType == 0)) {
+				externalFix.fixType = 1;
+			}
+			break;
+		case NMEA_GGA:
+			externalFix.isValid = (sentence.gga.quality > 0) && (sentence.gga.position.isValid);
+			if (sentence.gga.position.isValid) {
+				externalFix.latitude = sentence.gga.position.latitude;
+				externalFix.longitude = sentence.gga.position.longitude;
+			}
+			externalFix.fixType = sentence.gga.quality;
+			externalFix.satellitesInUse = sentence.gga.satellitesInUse;
+			externalFix.hDOP = sentence.gga.hDOP;
+			if (sentence.gga.isAltitudeValid) {
+				externalFix.altitude = sentence.gga.altitude;
+			}
+			externalFix.geoidalSeparation = sentence.gga.geoidalSeparation;
+			externalFix.dgpsAge = sentence.gga.dgpsAge;
+			externalFix.dgpsReferenceId = sentence.gga.dgpsReferenceId;
+			break;
+		case NMEA_GSA:
+			externalFix.pDOP = sentence.gsa.pDOP;
+			externalFix.vDOP = sentence.gsa.vDOP;
+			return;
+		case NMEA_GSV:
+			// Each constellation is a sequence under its own talker, merged with the others when the fix is taken
+			externalConstellations.Add(sentence.talker, sentence.gsv, GetTickCount64());
+			return;
+		default:
+			return;
+	}
+
+	externalFix.fixStatus = externalFix.isValid ? 1 : 0;
+	if (!externalFix.isValid) {
+		Performance_Counters::Increment(COUNTER_REJECTED_FIXES);
+	}
+	long long now = GetTickCount64();
+	externalConstellations.Merge(now, externalSatellites);
+	externalFix.satellitesInView = (unsigned int)externalSatellites.size();
+	externalFix.timeStamp = wxGetUTCTimeMillis().GetValue();
+	sourceArbiter.Update(externalSource, externalFix, externalSatellites, now, obstructionMask.ClearSkyWeight(externalSatellites));
+}
+
+// Load the selected source's fix into the variables from which the sentences are generated
+void Windows_Sensor_Plugin::ApplyFix(const PositionFix &fix, const std::vector<SatelliteInformation> &sourceSatellites) {
+	latitude = fix.latitude;
+	longitude = fix.longitude;
+	altitude = fix.altitude;
+	speedOverGround = fix.speedOverGround;
+	trueHeading = fix.courseOverGround;
+	magneticVariation = fix.magneticVariation;
+	isVariationValid = fix.isVariationValid;
+	hDOP = fix.hDOP;
+	vDOP = fix.vDOP;
+	pDOP = fix.pDOP;
+	geoidalSeparation = fix.geoidalSeparation;
+	dgpsAge = fix.dgpsAge;
+	dgpsReferenceId = fix.dgpsReferenceId;
+	satellitesInUse = fix.satellitesInUse;
+	fixType = fix.fixType;
+	fixStatus = fix.fixStatus;
+	selectionMode = fix.selectionMode;
+	satellites = sourceSatellites;
+	satellitesInView = (unsigned int)satellites.size();
+	currentFix = fix;
+}
+
+// Discovery has completed, the Sensor API is loaded so attaching to the sensors is quick
+void Windows_Sensor_Plugin::AttachSensors(void) {
+	discoveryThread.join();
+	attachTime = GetTickCount64();
+	wxLogMessage(_T("Windows Sensor Plugin, Found %u GPS sensor(s) in %lld ms"), discoveredCount.load(), attachTime - initTime);
+
+	if (locationSensors.Open()) {
+		locationSensors.Rescan(sourceArbiter, sensorTransitions);
+	}
+	else {
+		wxLogMessage(_T("Windows Sensor Plugin, Sensor Manager is not initializated."));
+	}
+	lastRescan = attachTime;
+	if (locationSensors.GetPresentCount() > 0) {
+		sensorName = locationSensors.GetSensors().front().name;
+	}
+
+	isAttached = true;
+	RequestReportInterval();
+
+	// The default timer resolution of 15.6 ms would dominate the jitter
+	timeBeginPeriod(1);
+	LARGE_INTEGER frequency;
+	QueryPerformanceFrequency(&frequency);
+	epochScheduler.Reset(frequency.QuadPart);
+	latencyMonitor.Reset(frequency.QuadPart);
+	performanceFrequency = frequency.QuadPart;
+}
+
+// Time the next epoch from the latest fix, each deadline is computed afresh so nothing accumulates
+void Windows_Sensor_Plugin::ScheduleEpoch(void) {
+	LARGE_INTEGER counter;
+	QueryPerformanceCounter(&counter);
+
+	// Until a sensor reports, the system clock is the best reference
+	if (!epochScheduler.HasReference()) {
+		FILETIME now;
+		GetSystemTimePreciseAsFileTime(&now);
+		epochScheduler.SetReference(((long long)now.dwHighDateTime << 32) | now.dwLowDateTime, counter.QuadPart);
+	}
+
+	long long deadline = epochScheduler.NextEpoch(counter.QuadPart, epochInterval, epochOffset);
+	StartOnce(epochScheduler.Delay(deadline, counter.QuadPart));
+}
+
+// Choose the next epoch interval from the current fix and the power state
+void Windows_Sensor_Plugin::UpdateInterval(bool isValid, long long now) {
+	bool isSaving = (batterySaver == BATTERY_SAVER_ALWAYS) ||
+		((batterySaver == BATTERY_SAVER_ON_BATTERY) && (Adaptive_Cadence::IsOnBattery()));
+	unsigned int interval = cadence.Update(speedOverGround, trueHeading, isValid, now, isSaving);
+	if (interval != epochInterval) {
+		epochInterval = interval;
+		sourceArbiter.SetEpochInterval(epochInterval, now);
+		if (isVerbose) {
+			LogArgument arguments[] = { LogInteger(epochInterval), LogNumber(cadence.GetTurnRate()) };
+			verboseLog.Write(LOG_EPOCH_INTERVAL, NULL, 2, arguments);
+		}
+		RequestReportInterval();
+	}
+}
+
+// Ask each sensor to report as often as we poll, or as near to it as it is able
+void Windows_Sensor_Plugin::RequestReportInterval(void) {
+	std::vector<LocationSensor> &sensors = locationSensors.GetSensors();
+	for (std::vector<LocationSensor>::iterator it = sensors.begin(); it != sensors.end(); ++it) {
+		if (it->sensor != NULL) {
+			Orientation_Sensor::SetReportInterval(it->sensor, epochInterval, CADENCE_SAVER_STATIONARY_INTERVAL);
+		}
+	}
+}
+
 // Generate the required NMEA 0183 sentences
 void Windows_Sensor_Plugin::Notify() {
-	if (GetData()) {
+	Performance_Counters::Increment(COUNTER_TICKS);
+
+	// Nothing to do until the sensors have been discovered
+	if (!isAttached) {
+		if (!isDiscovered) {
+			return;
+		}
+		AttachSensors();
+	}
+	else {
+		LARGE_INTEGER counter;
+		QueryPerformanceCounter(&counter);
+		epochScheduler.Record(counter.QuadPart);
+	}
+
+	// Motion is independent of the position fix
+	if (motionSensor.IsRunning()) {
+		SendMotionMessage();
+	}
+
+	// Look for sensors that have been added or removed, otherwise just follow the state of those present
+	long long now = GetTickCount64();
+	if (now - lastRescan >= SENSOR_RESCAN_INTERVAL) {
+		if (locationSensors.Open()) {
+			locationSensors.Rescan(sourceArbiter, sensorTransitions);
+		}
+		lastRescan = now;
+	}
+	else {
+		locationSensors.UpdateStates(sensorTransitions);
+	}
+	for (std::vector<SensorTransition>::iterator it = sensorTransitions.begin(); it != sensorTransitions.end(); ++it) {
+		wxLogMessage(_T("Windows Sensor Plugin, GPS Sensor %s: %s -> %s"), it->name, it->previous, it->current);
+		SendStateMessage(*it);
+	}
+	// A sensor that has just appeared reports at its default interval
+	if (!sensorTransitions.empty()) {
+		RequestReportInterval();
+	}
+	sensorTransitions.clear();
+
+	// Read every internal sensor, the external receiver updates the arbiter as its sentences arrive
+	std::vector<LocationSensor> &sensors = locationSensors.GetSensors();
+	for (std::vector<LocationSensor>::iterator it = sensors.begin(); it != sensors.end(); ++it) {
+		if (it->sensor == NULL) {
+			continue;
+		}
+		LARGE_INTEGER start;
+		LARGE_INTEGER decoded;
+		QueryPerformanceCounter(&start);
+		bool isReport = GetData(it->sensor);
+		QueryPerformanceCounter(&decoded);
+		Performance_Counters::Add(COUNTER_GETDATA_TIME, decoded.QuadPart - start.QuadPart);
+		// A report with the same timestamp is the one we have already read, it is left to age in the arbiter
+		// so that a sensor that has lost its fix is failed over rather than appearing to be current
+		if ((isReport) && (it->receiveTime.realtime != 0) && (receiveTime.realtime == it->receiveTime.realtime)) {
+			continue;
+		}
+		if (isReport) {
+			Performance_Counters::Increment(COUNTER_REPORTS);
+			latencyMonitor.Record(LATENCY_REPORT, acquireTime - receiveTime.monotonic);
+			latencyMonitor.Record(LATENCY_DECODE, decoded.QuadPart - acquireTime);
+			UpdateFix();
+			if (!currentFix.isValid) {
+				Performance_Counters::Increment(COUNTER_REJECTED_FIXES);
+			}
+			it->receiveTime = receiveTime;
+			it->sentence = sensorSentence;
+			// The arbiter ages and aligns each fix from when the sensor measured it, not when we polled it
+			long long reportTime = now;
+			if (performanceFrequency > 0) {
+				reportTime -= ((acquireTime - receiveTime.monotonic) * 1000) / performanceFrequency;
+			}
+			sourceArbiter.Update(it->source, currentFix, satellites, reportTime, obstructionMask.ClearSkyWeight(satellites));
+		}
+	}
+
+	int source = sourceArbiter.Select(now);
+	if (source != selectedSource) {
+		selectedSource = source;
+		if (source >= 0) {
+			sensorName = sourceArbiter.GetSource(source).name;
+			wxLogMessage(_T("Windows Sensor Plugin, Selected location source: %s"), sensorName);
+		}
+		else {
+			wxLogMessage(_T("Windows Sensor Plugin, No location source has a fix"));
+		}
+	}
+
+	if ((source >= 0) && (firstFixTime == 0)) {
+		firstFixTime = now;
+		wxLogMessage(_T("Windows Sensor Plugin, First fix %lld ms after start up"), firstFixTime - initTime);
+	}
+
+	if (source >= 0) {
+
+		// When several sources have a fix they may be combined, otherwise the selected source is forwarded
+		const GnssSource &selected = sourceArbiter.GetSource(source);
+		if ((isFusion) && (sourceArbiter.Fuse(now, fusedFix, fusedSatellites) > 1)) {
+			fusedFix.timeStamp = wxGetUTCTimeMillis().GetValue();
+			ApplyFix(fusedFix, fusedSatellites);
+		}
+		else {
+			ApplyFix(selected.fix, selected.satellites);
+		}
+
+		// Only an internal sensor provides the receive time and sentence for the reference clock
+		sensorSentence.clear();
+		bool isInternal = false;
+		for (std::vector<LocationSensor>::iterator it = sensors.begin(); it != sensors.end(); ++it) {
+			if (it->source == source) {
+				receiveTime = it->receiveTime;
+				sensorSentence = it->sentence;
+				isInternal = true;
+			}
+		}
+
+		// Epochs follow the GNSS time of the fix if the sensor supplies it, otherwise the phase of its reports.
+		// Either way the boundary maps to when its fix arrives, so each epoch fires just after the fix.
+		if (isInternal) {
+			long long fixTime;
+			if (NTP_Reference_Clock::ParseTime(sensorSentence, receiveTime.realtime, fixTime)) {
+				epochScheduler.SetReference(fixTime, receiveTime.monotonic);
+			}
+			else {
+				epochScheduler.SetReportReference(receiveTime.realtime, receiveTime.monotonic, epochInterval);
+			}
+		}
 
 		double latitudeDegrees = trunc(latitude);
 		double latitudeMinutes = (latitude - latitudeDegrees) * 60;
@@ -535,6 +1022,61 @@ void Windows_Sensor_Plugin::Notify() {
 
 		wxDateTime tm = wxDateTime::Now();
 
+		// Sentences generated for this epoch
+		epochSentences.clear();
+
+		// Used to derive true heading from the compass
+		orientationSensor.SetMagneticVariation(magneticVariation, isVariationValid);
+
+		// Only posts if the sensor reported a new GNSS time
+		if (ntpClock.IsOpen()) {
+			ntpClock.Post(sensorSentence, receiveTime);
+		}
+
+		TrackPoint point;
+		point.latitude = latitude;
+		point.longitude = longitude;
+		point.speedOverGround = speedOverGround;
+		point.courseOverGround = trueHeading;
+		point.timeStamp = wxGetUTCTimeMillis().GetValue();
+
+		// Log our track, the simplifier determines which points are retained
+		if (trackLog.IsOpen()) {
+			trackLog.Append(point);
+		}
+
+		// The trail is maintained even if hidden so that it is complete when shown
+		trackOverlay.Add(point);
+		accuracyOverlay.Update(latitude, longitude, hDOP);
+
+		// Learn which parts of the sky are obstructed
+		obstructionMask.Update(satellites);
+		// Save the mask every 10 minutes in case OpenCPN does not exit cleanly
+		if (now - maskSaveTime >= 600000) {
+			obstructionMask.Save(obstructionMaskFileName);
+			maskSaveTime = now;
+			if (isVerbose) {
+				double mean;
+				double deviation;
+				double maximum;
+				unsigned long long count;
+				epochScheduler.GetJitter(mean, deviation, maximum, count);
+				LogArgument arguments[] = { LogNumber(mean), LogNumber(deviation), LogNumber(maximum),
+					LogInteger((long long)count), LogInteger((long long)epochScheduler.GetMissedCount()) };
+				verboseLog.Write(LOG_EPOCH_JITTER, NULL, 5, arguments);
+			}
+		}
+
+		// The panel throttles its own refresh rate
+		if (skyPlotPanel != nullptr) {
+			skyPlotPanel->SetSatellites(satellites);
+		}
+
+		// Formatting is timed up to the last sentence, less the time spent pushing each one
+		LARGE_INTEGER formatStart;
+		QueryPerformanceCounter(&formatStart);
+		pushTicks = 0;
+
 		if (isGGA) {
 			// $--GGA,hhmmss.ss,llll.ll,a,yyyyy.yy,a,x,xx,x.x,x.x,M,x.x,M,x.x,xxxx*hh<CR><LF>
 			wxString sentence;
@@ -557,17 +1099,9 @@ void Windows_Sensor_Plugin::Notify() {
 					(double)geoidalSeparation);
 			}
 
-			// Calculate & append checksum
-			sentence.Trim();
-			wxString checksum = ComputeChecksum(sentence);
-			sentence.Append(wxT("*"));
-			sentence.Append(checksum);
-			sentence.Append(wxT("\r\n"));
-			// Send to OpenCPN
-			PushNMEABuffer(sentence);
-			if (isVerbose) {
-				wxLogMessage(_T("Windows Sensor Plugin, Generated sentence: %s"), sentence);
-			}
+			// Append checksum and send to OpenCPN
+			SendSentence(sentence);
+			Performance_Counters::Increment(COUNTER_GGA);
 		}
 		if (isGLL) {
 			// $--GLL,llll.ll,a,yyyyy.yy,a,hhmmss.ss,A,a*hh<CR><LF>
@@ -577,17 +1111,9 @@ void Windows_Sensor_Plugin::Notify() {
 				abs(longitudeDegrees), fabs(longitudeMinutes), longitude >= 0 ? 'E' : 'W', tm.Format("%H%M%S.00", wxDateTime::UTC).ToAscii(), 
 				fixStatus == 1 ? 'A' : 'V', GpsSelectionMode.at(selectionMode));
 			
-			// Calculate & append checksum
-			sentence.Trim();
-			wxString checksum = ComputeChecksum(sentence);
-			sentence.Append(wxT("*"));
-			sentence.Append(checksum);
-			sentence.Append(wxT("\r\n"));
-			// Send to OpenCPN
-			PushNMEABuffer(sentence);
-			if (isVerbose) {
-				wxLogMessage(_T("Windows Sensor Plugin, Generated sentence: %s"), sentence);
-			}
+			// Append checksum and send to OpenCPN
+			SendSentence(sentence);
+			Performance_Counters::Increment(COUNTER_GLL);
 		}
 		if (isGSV) {
 			// $--GSV,x,x,x,x,x,x,x,...*hh<CR><LF>
@@ -599,27 +1125,29 @@ void Windows_Sensor_Plugin::Notify() {
 			// sentences| satellites in view
 			//          sentence number
 			wxString sentence;
+			// Every satellite in view, the count reported may exceed those a receiver has described
+			unsigned int gsvSatellites = (unsigned int)satellites.size();
 			int totalSentences;
-			totalSentences = trunc(satellitesInUse / 4) + ((satellitesInUse % 4) == 0 ? 0 : 1);
+			totalSentences = trunc(gsvSatellites / 4) + ((gsvSatellites % 4) == 0 ? 0 : 1);
 			int sentenceNumber;
 			sentenceNumber = 1;
 
-			for (int i = 0; i < satellitesInUse; i++) {
-				sentence += wxString::Format("%02d,%02d,%03d,%02d", satellites.at(i).id,
-					satellites.at(i).elevation, satellites.at(i).azimuth, satellites.at(i).snr);
-				if ((((i + 1) % 4) == 0) || (((((i + 1) % 4) != 0)) && (i == (satellitesInUse - 1)))) {
-					sentence.Prepend(wxString::Format("$GPGSV,%d,%d,%d,", totalSentences, sentenceNumber, satellitesInUse));
-					// Calculate checksum
-					sentence.Trim();
-					wxString checksum = ComputeChecksum(sentence);
-					sentence.Append(wxT("*"));
-					sentence.Append(checksum);
-					sentence.Append(wxT("\r\n"));
-					// Send to OpenCPN
-					PushNMEABuffer(sentence);
-					if (isVerbose) {
-						wxLogMessage(_T("Windows Sensor Plugin, Generated sentence: %s"), sentence);
-					}
+			for (unsigned int i = 0; i < gsvSatellites; i++) {
+				// Up to four satellites per sentence, each is four fields
+				if ((i % 4) != 0) {
+					sentence += wxT(",");
+				}
+				sentence += wxString::Format("%02d,%02.0f,%03.0f,", satellites.at(i).id,
+					satellites.at(i).elevation, satellites.at(i).azimuth);
+				// An empty SNR means the satellite is not being tracked
+				if (satellites.at(i).snr > 0) {
+					sentence += wxString::Format("%02.0f", satellites.at(i).snr);
+				}
+				if ((((i + 1) % 4) == 0) || (((((i + 1) % 4) != 0)) && (i == (gsvSatellites - 1)))) {
+					sentence.Prepend(wxString::Format("$GPGSV,%d,%d,%d,", totalSentences, sentenceNumber, gsvSatellites));
+					// Append checksum and send to OpenCPN
+					SendSentence(sentence);
+					Performance_Counters::Increment(COUNTER_GSV);
 					sentence.Empty();
 					sentenceNumber++;
 				}
@@ -637,21 +1165,191 @@ void Windows_Sensor_Plugin::Notify() {
 				fabs(magneticVariation),  magneticVariation >= 0 ? 'E' : 'W', GpsSelectionMode.at(selectionMode));
 
 
-			// Calculate & append checksum
-			sentence.Trim();
-			wxString checksum = ComputeChecksum(sentence);
-			sentence.Append(wxT("*"));
-			sentence.Append(checksum);
-			sentence.Append(wxT("\r\n"));
-			// Send to OpenCPN
-			PushNMEABuffer(sentence);
-			if (isVerbose) {
-				wxLogMessage(_T("Windows Sensor Plugin, Generated sentence: %s"), sentence);
+			// Append checksum and send to OpenCPN
+			SendSentence(sentence);
+			Performance_Counters::Increment(COUNTER_RMC);
+		}
+
+		LARGE_INTEGER formatEnd;
+		QueryPerformanceCounter(&formatEnd);
+		if (!epochSentences.empty()) {
+			latencyMonitor.Record(LATENCY_FORMAT, formatEnd.QuadPart - formatStart.QuadPart - pushTicks);
+			latencyMonitor.Record(LATENCY_PUSH, pushTicks);
+			// An external receiver's sentences are timestamped in milliseconds as they arrive, too coarse to include
+			if (isInternal) {
+				latencyMonitor.Record(LATENCY_TOTAL, formatEnd.QuadPart - receiveTime.monotonic);
 			}
 		}
+
+		// Send this epoch to any local clients
+		nmeaServer.Publish(epochSentences);
+		gpsdServer.Publish(currentFix, satellites, epochSentences);
+		fixPublisher.Publish(currentFix, satellites);
+		n2kOutput.Publish(currentFix, satellites);
+		signalKOutput.Publish(currentFix, satellites);
+
+		LARGE_INTEGER publishEnd;
+		QueryPerformanceCounter(&publishEnd);
+		latencyMonitor.Record(LATENCY_PUBLISH, publishEnd.QuadPart - formatEnd.QuadPart);
 	}
+
+	if (now - latencyTime >= LATENCY_REPORT_INTERVAL) {
+		SendLatencyMessage();
+		latencyTime = now;
+	}
+	if (now - counterTime >= COUNTER_REPORT_INTERVAL) {
+		SendCountersMessage();
+		counterTime = now;
+	}
+
+	if (isAdaptiveInterval) {
+		UpdateInterval((source >= 0) && (currentFix.isValid), now);
+	}
+	ScheduleEpoch();
+}
+
+// Sensor added, removed, enabled or disabled
+void Windows_Sensor_Plugin::SendStateMessage(const SensorTransition &transition) {
+	messageWriter.Reset();
+	messageWriter.BeginObject();
+	messageWriter.Key("sensor");
+	messageWriter.String(std::string(transition.name.ToUTF8()));
+	messageWriter.Key("source");
+	messageWriter.Integer(transition.source);
+	messageWriter.Key("previous");
+	messageWriter.String(std::string(transition.previous.ToUTF8()));
+	messageWriter.Key("state");
+	messageWriter.String(std::string(transition.current.ToUTF8()));
+	messageWriter.EndObject();
+
+	SendPluginMessage(_T("WINDOWS_SENSOR_STATE"), wxString::FromUTF8(messageBuffer.c_str()));
+}
+
+// Publish attitude and heave for other plugins
+// {"roll":x.x,"pitch":x.x,"yaw":x.x,"heave":x.xx,"significantHeave":x.xx}
+void Windows_Sensor_Plugin::SendMotionMessage(void) {
+	double roll;
+	double pitch;
+	double yaw;
+	if (!motionSensor.GetAttitude(roll, pitch, yaw)) {
+		return;
+	}
+
+	messageWriter.Reset();
+	messageWriter.BeginObject();
+	messageWriter.Key("roll");
+	messageWriter.Number(roll, 1);
+	messageWriter.Key("pitch");
+	messageWriter.Number(pitch, 1);
+	messageWriter.Key("yaw");
+	messageWriter.Number(yaw, 1);
+	// Heave is omitted until its filter has settled
+	double heave;
+	double significantHeave;
+	if (motionSensor.GetHeave(heave, significantHeave)) {
+		messageWriter.Key("heave");
+		messageWriter.Number(heave, 2);
+		messageWriter.Key("significantHeave");
+		messageWriter.Number(significantHeave, 2);
+	}
+	messageWriter.EndObject();
+
+	SendPluginMessage(_T("WINDOWS_SENSOR_MOTION"), wxString::FromUTF8(messageBuffer.c_str()));
+}
+
+// Latency percentiles of each stage since start up, in milliseconds
+// {"report":{"count":n,"p50":x.xxx,"p90":x.xxx,"p99":x.xxx,"max":x.xxx},"decode":{...},...}
+void Windows_Sensor_Plugin::SendLatencyMessage(void) {
+	messageWriter.Reset();
+	latencyMonitor.Write(messageWriter);
+
+	SendPluginMessage(_T("WINDOWS_SENSOR_LATENCY"), wxString::FromUTF8(messageBuffer.c_str()));
 }
 
+// Performance counters since OpenCPN loaded the plugin, start up times and epoch jitter in milliseconds
+// {"counters":{"ticks":n,...},"attach":n,"firstFix":n,"epochs":n,"jitterMean":x.xx,"jitterDeviation":x.xx,"jitterMaximum":x.xx,"missedEpochs":n}
+void Windows_Sensor_Plugin::SendCountersMessage(void) {
+	double mean;
+	double deviation;
+	double maximum;
+	unsigned long long count;
+	epochScheduler.GetJitter(mean, deviation, maximum, count);
+
+	messageWriter.Reset();
+	messageWriter.BeginObject();
+	messageWriter.Key("counters");
+	Performance_Counters::Write(messageWriter, performanceFrequency);
+	if (isAttached) {
+		messageWriter.Key("attach");
+		messageWriter.Integer(attachTime - initTime);
+	}
+	if (firstFixTime != 0) {
+		messageWriter.Key("firstFix");
+		messageWriter.Integer(firstFixTime - initTime);
+	}
+	messageWriter.Key("epochs");
+	messageWriter.Integer((long long)count);
+	messageWriter.Key("jitterMean");
+	messageWriter.Number(mean, 2);
+	messageWriter.Key("jitterDeviation");
+	messageWriter.Number(deviation, 2);
+	messageWriter.Key("jitterMaximum");
+	messageWriter.Number(maximum, 2);
+	messageWriter.Key("missedEpochs");
+	messageWriter.Integer((long long)epochScheduler.GetMissedCount());
+	messageWriter.EndObject();
+
+	SendPluginMessage(_T("WINDOWS_SENSOR_COUNTERS"), wxString::FromUTF8(messageBuffer.c_str()));
+}
+
+// Copy the values obtained from the sensor into the fix used by the non NMEA 0183 outputs
+void Windows_Sensor_Plugin::UpdateFix(void) {
+	currentFix.latitude = latitude;
+	currentFix.longitude = longitude;
+	currentFix.altitude = altitude;
+	currentFix.speedOverGround = speedOverGround;
+	currentFix.courseOverGround = trueHeading;
+	currentFix.magneticVariation = magneticVariation;
+	currentFix.isVariationValid = isVariationValid;
+	currentFix.hDOP = hDOP;
+	currentFix.vDOP = vDOP;
+	currentFix.pDOP = pDOP;
+	currentFix.geoidalSeparation = geoidalSeparation;
+	currentFix.dgpsAge = dgpsAge;
+	currentFix.dgpsReferenceId = dgpsReferenceId;
+	currentFix.satellitesInUse = satellitesInUse;
+	currentFix.satellitesInView = satellitesInView;
+	currentFix.fixType = fixType;
+	currentFix.fixStatus = fixStatus;
+	currentFix.selectionMode = selectionMode;
+	currentFix.timeStamp = wxGetUTCTimeMillis().GetValue();
+	// As per the RMC sentence
+	currentFix.isValid = (fixStatus == 1);
+}
+
+
+void Windows_Sensor_Plugin::SendSentence(wxString sentence) {
+	// Calculate & append checksum
+	sentence.Trim();
+	wxString checksum = ComputeChecksum(sentence);
+	sentence.Append(wxT("*"));
+	sentence.Append(checksum);
+	sentence.Append(wxT("\r\n"));
+	// Retained for the local NMEA server, and remembered so that OpenCPN's echo of it is ignored
+	epochSentences.push_back(std::string(sentence.ToAscii()));
+	NMEA_Echo_Filter::Add(epochSentences.back().c_str(), epochSentences.back().length());
+	// Send to OpenCPN
+	LARGE_INTEGER pushStart;
+	LARGE_INTEGER pushEnd;
+	QueryPerformanceCounter(&pushStart);
+	PushNMEABuffer(sentence);
+	QueryPerformanceCounter(&pushEnd);
+	pushTicks += pushEnd.QuadPart - pushStart.QuadPart;
+	Performance_Counters::Add(COUNTER_BYTES_PUSHED, sentence.length());
+	if (isVerbose) {
+		verboseLog.Write(LOG_GENERATED_SENTENCE, epochSentences.back().c_str());
+	}
+}
 
 // Shamelessly copied from somewhere, another plugin ?
 wxString Windows_Sensor_Plugin::ComputeChecksum(wxString sentence) {
@@ -0,0 +1,231 @@
+// Copyright(C) 2024 by Steven Adler
+//
+// This file is part of Windows Sensor Plugin for OpenCPN.
+//
+// Windows Sensor Plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Windows Sensor Plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Windows Sensor Plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// Project: Windows Sensor Plugin
+// Description: Madgwick attitude and heading reference system
+// Owner: twocanplugin@hotmail.com
+// Date: 01/04/2024
+// Version History:
+// 1.0 Initial Release
+
+// Adapted from the reference implementation by Sebastian Madgwick
+// Refer to https://x-io.co.uk/open-source-imu-and-ahrs-algorithms/
+
+#include "sensor_plugin_ahrs.h"
+
+#include <math.h>
+
+#define AHRS_RADIANS_TO_DEGREES (180.0 / 3.14159265358979323846)
+
+Madgwick_Filter::Madgwick_Filter(double beta) : beta(beta) {
+	Reset();
+}
+
+Madgwick_Filter::~Madgwick_Filter(void) {
+}
+
+void Madgwick_Filter::Reset(void) {
+	q.w = 1.0;
+	q.x = 0.0;
+	q.y = 0.0;
+	q.z = 0.0;
+}
+
+Quaternion Madgwick_Filter::GetQuaternion(void) {
+	return q;
+}
+
+void Madgwick_Filter::Update(const Vector3 &gyroscope, const Vector3 &accelerometer, const Vector3 &magnetometer, double elapsed) {
+	double ax = accelerometer.x;
+	double ay = accelerometer.y;
+	double az = accelerometer.z;
+	double mx = magnetometer.x;
+	double my = magnetometer.y;
+	double mz = magnetometer.z;
+
+	// Without a magnetic field reading, fall back to the inertial only update
+	double magnetometerNorm = sqrt(mx * mx + my * my + mz * mz);
+	if (magnetometerNorm == 0.0) {
+		Update(gyroscope, accelerometer, elapsed);
+		return;
+	}
+
+	double q0 = q.w;
+	double q1 = q.x;
+	double q2 = q.y;
+	double q3 = q.z;
+
+	// Rate of change of quaternion from gyroscope
+	double qDot1 = 0.5 * (-q1 * gyroscope.x - q2 * gyroscope.y - q3 * gyroscope.z);
+	double qDot2 = 0.5 * (q0 * gyroscope.x + q2 * gyroscope.z - q3 * gyroscope.y);
+	double qDot3 = 0.5 * (q0 * gyroscope.y - q1 * gyroscope.z + q3 * gyroscope.x);
+	double qDot4 = 0.5 * (q0 * gyroscope.z + q1 * gyroscope.y - q2 * gyroscope.x);
+
+	// The accelerometer correction is only valid if there is a reading
+	double accelerometerNorm = sqrt(ax * ax + ay * ay + az * az);
+	if (accelerometerNorm > 0.0) {
+		ax /= accelerometerNorm;
+		ay /= accelerometerNorm;
+		az /= accelerometerNorm;
+		mx /= magnetometerNorm;
+		my /= magnetometerNorm;
+		mz /= magnetometerNorm;
+
+		// Auxiliary variables to avoid repeated arithmetic
+		double _2q0mx = 2.0 * q0 * mx;
+		double _2q0my = 2.0 * q0 * my;
+		double _2q0mz = 2.0 * q0 * mz;
+		double _2q1mx = 2.0 * q1 * mx;
+		double _2q0 = 2.0 * q0;
+		double _2q1 = 2.0 * q1;
+		double _2q2 = 2.0 * q2;
+		double _2q3 = 2.0 * q3;
+		double _2q0q2 = 2.0 * q0 * q2;
+		double _2q2q3 = 2.0 * q2 * q3;
+		double q0q0 = q0 * q0;
+		double q0q1 = q0 * q1;
+		double q0q2 = q0 * q2;
+		double q0q3 = q0 * q3;
+		double q1q1 = q1 * q1;
+		double q1q2 = q1 * q2;
+		double q1q3 = q1 * q3;
+		double q2q2 = q2 * q2;
+		double q2q3 = q2 * q3;
+		double q3q3 = q3 * q3;
+
+		// Reference direction of the earth's magnetic field
+		double hx = mx * q0q0 - _2q0my * q3 + _2q0mz * q2 + mx * q1q1 + _2q1 * my * q2 + _2q1 * mz * q3 - mx * q2q2 - mx * q3q3;
+		double hy = _2q0mx * q3 + my * q0q0 - _2q0mz * q1 + _2q1mx * q2 - my * q1q1 + my * q2q2 + _2q2 * mz * q3 - my * q3q3;
+		double _2bx = sqrt(hx * hx + hy * hy);
+		double _2bz = -_2q0mx * q2 + _2q0my * q1 + mz * q0q0 + _2q1mx * q3 - mz * q1q1 + _2q2 * my * q3 - mz * q2q2 + mz * q3q3;
+		double _4bx = 2.0 * _2bx;
+		double _4bz = 2.0 * _2bz;
+
+		// Gradient descent corrective step
+		double s0 = -_2q2 * (2.0 * q1q3 - _2q0q2 - ax) + _2q1 * (2.0 * q0q1 + _2q2q3 - ay) - _2bz * q2 * (_2bx * (0.5 - q2q2 - q3q3) + _2bz * (q1q3 - q0q2) - mx) + (-_2bx * q3 + _2bz * q1) * (_2bx * (q1q2 - q0q3) + _2bz * (q0q1 + q2q3) - my) + _2bx * q2 * (_2bx * (q0q2 + q1q3) + _2bz * (0.5 - q1q1 - q2q2) - mz);
+		double s1 = _2q3 * (2.0 * q1q3 - _2q0q2 - ax) + _2q0 * (2.0 * q0q1 + _2q2q3 - ay) - 4.0 * q1 * (1 - 2.0 * q1q1 - 2.0 * q2q2 - az) + _2bz * q3 * (_2bx * (0.5 - q2q2 - q3q3) + _2bz * (q1q3 - q0q2) - mx) + (_2bx * q2 + _2bz * q0) * (_2bx * (q1q2 - q0q3) + _2bz * (q0q1 + q2q3) - my) + (_2bx * q3 - _4bz * q1) * (_2bx * (q0q2 + q1q3) + _2bz * (0.5 - q1q1 - q2q2) - mz);
+		double s2 = -_2q0 * (2.0 * q1q3 - _2q0q2 - ax) + _2q3 * (2.0 * q0q1 + _2q2q3 - ay) - 4.0 * q2 * (1 - 2.0 * q1q1 - 2.0 * q2q2 - az) + (-_4bx * q2 - _2bz * q0) * (_2bx * (0.5 - q2q2 - q3q3) + _2bz * (q1q3 - q0q2) - mx) + (_2bx * q1 + _2bz * q3) * (_2bx * (q1q2 - q0q3) + _2bz * (q0q1 + q2q3) - my) + (_2bx * q0 - _4bz * q2) * (_2bx * (q0q2 + q1q3) + _2bz * (0.5 - q1q1 - q2q2) - mz);
+		double s3 = _2q1 * (2.0 * q1q3 - _2q0q2 - ax) + _2q2 * (2.0 * q0q1 + _2q2q3 - ay) + (-_4bx * q3 + _2bz * q1) * (_2bx * (0.5 - q2q2 - q3q3) + _2bz * (q1q3 - q0q2) - mx) + (-_2bx * q0 + _2bz * q2) * (_2bx * (q1q2 - q0q3) + _2bz * (q0q1 + q2q3) - my) + _2bx * q1 * (_2bx * (q0q2 + q1q3) + _2bz * (0.5 - q1q1 - q2q2) - mz);
+		double sNorm = sqrt(s0 * s0 + s1 * s1 + s2 * s2 + s3 * s3);
+		if (sNorm > 0.0) {
+			qDot1 -= beta * s0 / sNorm;
+			qDot2 -= beta * s1 / sNorm;
+			qDot3 -= beta * s2 / sNorm;
+			qDot4 -= beta * s3 / sNorm;
+		}
+	}
+
+	Integrate(qDot1, qDot2, qDot3, qDot4, elapsed);
+}
+
+void Madgwick_Filter::Update(const Vector3 &gyroscope, const Vector3 &accelerometer, double elapsed) {
+	double ax = accelerometer.x;
+	double ay = accelerometer.y;
+	double az = accelerometer.z;
+
+	double q0 = q.w;
+	double q1 = q.x;
+	double q2 = q.y;
+	double q3 = q.z;
+
+	double qDot1 = 0.5 * (-q1 * gyroscope.x - q2 * gyroscope.y - q3 * gyroscope.z);
+	double qDot2 = 0.5 * (q0 * gyroscope.x + q2 * gyroscope.z - q3 * gyroscope.y);
+	double qDot3 = 0.5 * (q0 * gyroscope.y - q1 * gyroscope.z + q3 * gyroscope.x);
+	double qDot4 = 0.5 * (q0 * gyroscope.z + q1 * gyroscope.y - q2 * gyroscope.x);
+
+	double accelerometerNorm = sqrt(ax * ax + ay * ay + az * az);
+	if (accelerometerNorm > 0.0) {
+		ax /= accelerometerNorm;
+		ay /= accelerometerNorm;
+		az /= accelerometerNorm;
+
+		double _2q0 = 2.0 * q0;
+		double _2q1 = 2.0 * q1;
+		double _2q2 = 2.0 * q2;
+		double _2q3 = 2.0 * q3;
+		double _4q0 = 4.0 * q0;
+		double _4q1 = 4.0 * q1;
+		double _4q2 = 4.0 * q2;
+		double _8q1 = 8.0 * q1;
+		double _8q2 = 8.0 * q2;
+		double q0q0 = q0 * q0;
+		double q1q1 = q1 * q1;
+		double q2q2 = q2 * q2;
+		double q3q3 = q3 * q3;
+
+		double s0 = _4q0 * q2q2 + _2q2 * ax + _4q0 * q1q1 - _2q1 * ay;
+		double s1 = _4q1 * q3q3 - _2q3 * ax + 4.0 * q0q0 * q1 - _2q0 * ay - _4q1 + _8q1 * q1q1 + _8q1 * q2q2 + _4q1 * az;
+		double s2 = 4.0 * q0q0 * q2 + _2q0 * ax + _4q2 * q3q3 - _2q3 * ay - _4q2 + _8q2 * q1q1 + _8q2 * q2q2 + _4q2 * az;
+		double s3 = 4.0 * q1q1 * q3 - _2q1 * ax + 4.0 * q2q2 * q3 - _2q2 * ay;
+		double sNorm = sqrt(s0 * s0 + s1 * s1 + s2 * s2 + s3 * s3);
+		if (sNorm > 0.0) {
+			qDot1 -= beta * s0 / sNorm;
+			qDot2 -= beta * s1 / sNorm;
+			qDot3 -= beta * s2 / sNorm;
+			qDot4 -= beta * s3 / sNorm;
+		}
+	}
+
+	Integrate(qDot1, qDot2, qDot3, qDot4, elapsed);
+}
+
+void Madgwick_Filter::Integrate(double qDot1, double qDot2, double qDot3, double qDot4, double elapsed) {
+	q.w += qDot1 * elapsed;
+	q.x += qDot2 * elapsed;
+	q.y += qDot3 * elapsed;
+	q.z += qDot4 * elapsed;
+
+	double norm = sqrt(q.w * q.w + q.x * q.x + q.y * q.y + q.z * q.z);
+	if (norm > 0.0) {
+		q.w /= norm;
+		q.x /= norm;
+		q.y /= norm;
+		q.z /= norm;
+	}
+	else {
+		Reset();
+	}
+}
+
+void Madgwick_Filter::GetEulerAngles(double &roll, double &pitch, double &yaw) {
+	// Rotation about the forward axis lifts the port side
+	roll = atan2(2.0 * (q.w * q.x + q.y * q.z), 1.0 - 2.0 * (q.x * q.x + q.y * q.y)) * AHRS_RADIANS_TO_DEGREES;
+
+	// Rotation about the port axis lowers the bow
+	double sinPitch = 2.0 * (q.w * q.y - q.z * q.x);
+	sinPitch = sinPitch > 1.0 ? 1.0 : (sinPitch < -1.0 ? -1.0 : sinPitch);
+	pitch = -asin(sinPitch) * AHRS_RADIANS_TO_DEGREES;
+
+	// Rotation about the up axis is anticlockwise
+	yaw = -atan2(2.0 * (q.w * q.z + q.x * q.y), 1.0 - 2.0 * (q.y * q.y + q.z * q.z)) * AHRS_RADIANS_TO_DEGREES;
+	if (yaw < 0.0) {
+		yaw += 360.0;
+	}
+}
+
+// v' = q v q*
+Vector3 Madgwick_Filter::Rotate(const Quaternion &q, const Vector3 &v) {
+	// t = 2 (q.xyz x v)
+	double tx = 2.0 * (q.y * v.z - q.z * v.y);
+	double ty = 2.0 * (q.z * v.x - q.x * v.z);
+	double tz = 2.0 * (q.x * v.y - q.y * v.x);
+	Vector3 result;
+	result.x = v.x + q.w * tx + (q.y * tz - q.z * ty);
+	result.y = v.y + q.w * ty + (q.z * tx - q.x * tz);
+	result.z = v.z + q.w * tz + (q.x * ty - q.y * tx);
+	return result;
+}
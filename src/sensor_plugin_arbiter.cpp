@@ -0,0 +1,325 @@
+// Copyright(C) 2024 by Steven Adler
+//
+// This file is part of Windows Sensor Plugin for OpenCPN.
+//
+// Windows Sensor Plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Windows Sensor Plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Windows Sensor Plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// Project: Windows Sensor Plugin
+// Description: Location source arbitration
+// Owner: twocanplugin@hotmail.com
+// Date: 01/04/2024
+// Version History:
+// 1.0 Initial Release
+
+#include "sensor_plugin_arbiter.h"
+
+#include <wx/math.h>
+
+// Metres per degree of latitude
+#define ARBITER_METRES_PER_DEGREE 111120.0
+#define ARBITER_METRES_PER_KNOT 0.514444
+
+Source_Arbiter::Source_Arbiter(void) {
+	Clear();
+}
+
+Source_Arbiter::~Source_Arbiter(void) {
+}
+
+void Source_Arbiter::Clear(void) {
+	sources.clear();
+	selected = -1;
+	challenger = -1;
+	challengerEpochs = 0;
+	timeout = ARBITER_SOURCE_TIMEOUT;
+	pendingTimeout = ARBITER_SOURCE_TIMEOUT;
+	pendingSince = 0;
+}
+
+int Source_Arbiter::AddSource(const wxString &name, bool isExternal) {
+	GnssSource source;
+	source.name = name;
+	source.isExternal = isExternal;
+	source.fix = PositionFix();
+	source.receiveTime = 0;
+	source.residual = 0.0;
+	source.fusionResidual = 0.0;
+	source.clearSkyWeight = 1.0;
+	source.alignedLatitude = 0.0;
+	source.alignedLongitude = 0.0;
+	source.score = 0.0;
+	source.updateCount = 0;
+	sources.push_back(source);
+	return (int)sources.size() - 1;
+}
+
+void Source_Arbiter::Update(int source, const PositionFix &fix, const std::vector<SatelliteInformation> &satellites, long long now, double clearSkyWeight) {
+	if ((source < 0) || (source >= (int)sources.size())) {
+		return;
+	}
+	GnssSource &current = sources[source];
+
+	// Compare the new fix with where the previous one said we would be
+	if ((fix.isValid) && (current.fix.isValid) && (current.receiveTime > 0)) {
+		double interval = (now - current.receiveTime) / 1000.0;
+		if (interval < (timeout / 1000.0)) {
+			double predictedLatitude;
+			double predictedLongitude;
+			Propagate(current.fix, interval, predictedLatitude, predictedLongitude);
+			double error = Distance(fix.latitude, fix.longitude, predictedLatitude, predictedLongitude);
+			current.residual += ARBITER_SCORE_SMOOTHING * (error - current.residual);
+		}
+	}
+	else if (!fix.isValid) {
+		current.residual = 0.0;
+		current.fusionResidual = 0.0;
+	}
+
+	current.fix = fix;
+	current.satellites = satellites;
+	current.clearSkyWeight = clearSkyWeight;
+	current.receiveTime = now;
+	current.updateCount++;
+}
+
+void Source_Arbiter::SetEpochInterval(unsigned int interval, long long now) {
+	long long required = wxMax((long long)ARBITER_SOURCE_TIMEOUT, (long long)interval * ARBITER_TIMEOUT_EPOCHS);
+	pendingTimeout = required;
+	pendingSince = now;
+	// The report each sensor holds may be as old as the previous interval, so a shorter timeout waits for that long
+	if (required >= timeout) {
+		timeout = required;
+	}
+}
+
+int Source_Arbiter::Select(long long now) {
+	if ((pendingTimeout < timeout) && (now - pendingSince >= timeout)) {
+		timeout = pendingTimeout;
+	}
+
+	int best = -1;
+	for (unsigned int i = 0; i < sources.size(); i++) {
+		double score = Score(sources[i], now);
+		// Losing the fix is acted upon immediately, improvements are smoothed
+		if (score <= 0.0) {
+			sources[i].score = 0.0;
+		}
+		else if (sources[i].score <= 0.0) {
+			sources[i].score = score;
+		}
+		else {
+			sources[i].score += ARBITER_SCORE_SMOOTHING * (score - sources[i].score);
+		}
+		if ((sources[i].score > 0.0) && ((best < 0) || (sources[i].score > sources[best].score))) {
+			best = (int)i;
+		}
+	}
+
+	// Failover
+	if ((selected < 0) || (sources[selected].score <= 0.0)) {
+		selected = best;
+		challenger = -1;
+		challengerEpochs = 0;
+		return selected;
+	}
+
+	// Hysteresis
+	if ((best != selected) && (sources[best].score > sources[selected].score * (1.0 + ARBITER_SWITCH_MARGIN))) {
+		if (best == challenger) {
+			challengerEpochs++;
+		}
+		else {
+			challenger = best;
+			challengerEpochs = 1;
+		}
+		if (challengerEpochs >= ARBITER_SWITCH_EPOCHS) {
+			selected = best;
+			challenger = -1;
+			challengerEpochs = 0;
+		}
+	}
+	else {
+		challenger = -1;
+		challengerEpochs = 0;
+	}
+	return selected;
+}
+
+unsigned int Source_Arbiter::Fuse(long long now, PositionFix &fused, std::vector<SatelliteInformation> &satellites) {
+	// Positions are combined as offsets in metres from the first source, avoiding any wrap at 180 degrees
+	double referenceLatitude = 0.0;
+	double referenceLongitude = 0.0;
+	double metresPerDegreeLongitude = ARBITER_METRES_PER_DEGREE;
+	double totalWeight = 0.0;
+	double north = 0.0;
+	double east = 0.0;
+	double altitude = 0.0;
+	double velocityNorth = 0.0;
+	double velocityEast = 0.0;
+	int heaviest = -1;
+	double heaviestWeight = 0.0;
+	unsigned int count = 0;
+
+	for (unsigned int i = 0; i < sources.size(); i++) {
+		GnssSource &source = sources[i];
+		if (Score(source, now) <= 0.0) {
+			continue;
+		}
+
+		// Align to now by dead reckoning from when the fix was measured, internal sensors supply the time of
+		// their report and the external receiver the time its sentence arrived
+		Propagate(source.fix, (now - source.receiveTime) / 1000.0, source.alignedLatitude, source.alignedLongitude);
+
+		double hDOP = source.fix.hDOP > 0.0 ? source.fix.hDOP : ARBITER_DEFAULT_HDOP;
+		double sigma = hDOP * ARBITER_UERE;
+		double variance = (sigma * sigma) + (source.residual * source.residual) + (source.fusionResidual * source.fusionResidual);
+		double weight = 1.0 / variance;
+
+		if (count == 0) {
+			referenceLatitude = source.alignedLatitude;
+			referenceLongitude = source.alignedLongitude;
+			metresPerDegreeLongitude = ARBITER_METRES_PER_DEGREE * cos(referenceLatitude * M_PI / 180.0);
+		}
+		double longitudeOffset = source.alignedLongitude - referenceLongitude;
+		if (longitudeOffset > 180.0) {
+			longitudeOffset -= 360.0;
+		}
+		else if (longitudeOffset < -180.0) {
+			longitudeOffset += 360.0;
+		}
+
+		double course = source.fix.courseOverGround * M_PI / 180.0;
+		north += weight * (source.alignedLatitude - referenceLatitude) * ARBITER_METRES_PER_DEGREE;
+		east += weight * longitudeOffset * metresPerDegreeLongitude;
+		altitude += weight * source.fix.altitude;
+		velocityNorth += weight * source.fix.speedOverGround * cos(course);
+		velocityEast += weight * source.fix.speedOverGround * sin(course);
+		totalWeight += weight;
+		if (weight > heaviestWeight) {
+			heaviest = (int)i;
+			heaviestWeight = weight;
+		}
+		count++;
+	}
+
+	if (count < 2) {
+		return count;
+	}
+
+	// The heaviest source provides everything that is not averaged, including HDOP. Receivers on the same
+	// boat tracking the same satellites share most of their errors, so fusing them is no more precise.
+	fused = sources[heaviest].fix;
+	satellites = sources[heaviest].satellites;
+
+	fused.latitude = referenceLatitude + (north / totalWeight) / ARBITER_METRES_PER_DEGREE;
+	fused.longitude = referenceLongitude + (east / totalWeight) / metresPerDegreeLongitude;
+	if (fused.longitude > 180.0) {
+		fused.longitude -= 360.0;
+	}
+	else if (fused.longitude < -180.0) {
+		fused.longitude += 360.0;
+	}
+	fused.altitude = altitude / totalWeight;
+	fused.speedOverGround = sqrt((velocityNorth * velocityNorth) + (velocityEast * velocityEast)) / totalWeight;
+	if (fused.speedOverGround > 0.0) {
+		fused.courseOverGround = atan2(velocityEast, velocityNorth) * 180.0 / M_PI;
+		if (fused.courseOverGround < 0.0) {
+			fused.courseOverGround += 360.0;
+		}
+	}
+
+	// Sources that disagree with the consensus carry less weight next time
+	for (unsigned int i = 0; i < sources.size(); i++) {
+		GnssSource &source = sources[i];
+		if (Score(source, now) > 0.0) {
+			double error = Distance(source.alignedLatitude, source.alignedLongitude, fused.latitude, fused.longitude);
+			source.fusionResidual += ARBITER_SCORE_SMOOTHING * (error - source.fusionResidual);
+		}
+	}
+	return count;
+}
+
+int Source_Arbiter::GetSelected(void) {
+	return selected;
+}
+
+unsigned int Source_Arbiter::GetSourceCount(void) {
+	return (unsigned int)sources.size();
+}
+
+const GnssSource &Source_Arbiter::GetSource(int source) {
+	return sources[source];
+}
+
+double Source_Arbiter::Score(const GnssSource &source, long long now) {
+	if ((!source.fix.isValid) || (source.receiveTime == 0)) {
+		return 0.0;
+	}
+	long long age = now - source.receiveTime;
+	if ((age < 0) || (age >= timeout)) {
+		return 0.0;
+	}
+
+	double hDOP = source.fix.hDOP > 0.0 ? source.fix.hDOP : ARBITER_DEFAULT_HDOP;
+	double ageWeight = 1.0 - ((double)age / timeout);
+	double consistencyWeight = 1.0 / (1.0 + (source.residual / ARBITER_CONSISTENCY_DISTANCE));
+	// A source whose satellites are all obstructed is penalised, not excluded
+	double skyWeight = (1.0 - ARBITER_CLEAR_SKY_SHARE) + (ARBITER_CLEAR_SKY_SHARE * source.clearSkyWeight);
+	return QualityWeight(source.fix.fixType) * (1.0 / (1.0 + hDOP)) * ageWeight * consistencyWeight * skyWeight;
+}
+
+// Fix type as per the GGA quality indicator, only called for valid fixes
+double Source_Arbiter::QualityWeight(unsigned int fixType) {
+	switch (fixType) {
+		case 1: // GPS
+			return 1.0;
+		case 2: // Differential
+		case 3: // PPS
+			return 1.25;
+		case 4: // RTK fixed
+			return 1.5;
+		case 5: // RTK float
+			return 1.4;
+		case 6: // Dead reckoning
+			return 0.25;
+		case 7: // Manual
+		case 8: // Simulator
+			return 0.1;
+		default:
+			// Some sensors do not report the fix type
+			return 1.0;
+	}
+}
+
+// Dead reckon a fix forward by the given number of seconds
+void Source_Arbiter::Propagate(const PositionFix &fix, double interval, double &latitude, double &longitude) {
+	double distance = fix.speedOverGround * ARBITER_METRES_PER_KNOT * interval;
+	double course = fix.courseOverGround * M_PI / 180.0;
+	latitude = fix.latitude + (distance * cos(course)) / ARBITER_METRES_PER_DEGREE;
+	longitude = fix.longitude + (distance * sin(course)) / (ARBITER_METRES_PER_DEGREE * cos(fix.latitude * M_PI / 180.0));
+}
+
+// Equirectangular approximation, ample for the short distances involved
+double Source_Arbiter::Distance(double latitude1, double longitude1, double latitude2, double longitude2) {
+	double longitudeDifference = longitude2 - longitude1;
+	if (longitudeDifference > 180.0) {
+		longitudeDifference -= 360.0;
+	}
+	else if (longitudeDifference < -180.0) {
+		longitudeDifference += 360.0;
+	}
+	double x = longitudeDifference * cos(((latitude1 + latitude2) / 2.0) * M_PI / 180.0);
+	double y = latitude2 - latitude1;
+	return sqrt((x * x) + (y * y)) * ARBITER_METRES_PER_DEGREE;
+}
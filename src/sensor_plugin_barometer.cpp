@@ -0,0 +1,255 @@
+// Copyright(C) 2024 by Steven Adler
+//
+// This file is part of Windows Sensor Plugin for OpenCPN.
+//
+// Windows Sensor Plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Windows Sensor Plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Windows Sensor Plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// Project: Windows Sensor Plugin
+// Description: Barometric pressure sensor and pressure tendency
+// Owner: twocanplugin@hotmail.com
+// Date: 01/04/2024
+// Version History:
+// 1.0 Initial Release
+
+#include "sensor_plugin_barometer.h"
+
+#include <chrono>
+
+Pressure_History::Pressure_History(void) {
+	Clear();
+}
+
+Pressure_History::~Pressure_History(void) {
+}
+
+void Pressure_History::Clear(void) {
+	historyIndex = 0;
+	historyCount = 0;
+	shortSum = 0.0;
+	longSum = 0.0;
+}
+
+// Value added the given number of minutes before the most recent
+double Pressure_History::GetAgo(unsigned int minutes) {
+	return history[(historyIndex + BAROMETER_HISTORY_SIZE - 1 - minutes) % BAROMETER_HISTORY_SIZE];
+}
+
+void Pressure_History::Add(double pressure) {
+	// Values leaving each window are subtracted before the new value is written, as
+	// when the buffer is full the oldest value occupies the slot being written
+	if (historyCount >= BAROMETER_SHORT_WINDOW) {
+		shortSum -= GetAgo(BAROMETER_SHORT_WINDOW - 1);
+	}
+	if (historyCount >= BAROMETER_LONG_WINDOW) {
+		longSum -= GetAgo(BAROMETER_LONG_WINDOW - 1);
+	}
+	else {
+		historyCount++;
+	}
+
+	history[historyIndex] = pressure;
+	historyIndex = (historyIndex + 1) % BAROMETER_HISTORY_SIZE;
+	shortSum += pressure;
+	longSum += pressure;
+}
+
+bool Pressure_History::GetTendency(unsigned int minutes, double &tendency) {
+	if ((minutes >= historyCount) || (minutes >= BAROMETER_HISTORY_SIZE)) {
+		return false;
+	}
+	tendency = GetAgo(0) - GetAgo(minutes);
+	return true;
+}
+
+bool Pressure_History::GetShortMean(double &mean) {
+	unsigned int count = historyCount < BAROMETER_SHORT_WINDOW ? historyCount : BAROMETER_SHORT_WINDOW;
+	if (count == 0) {
+		return false;
+	}
+	mean = shortSum / count;
+	return true;
+}
+
+bool Pressure_History::GetLongMean(double &mean) {
+	if (historyCount == 0) {
+		return false;
+	}
+	mean = longSum / historyCount;
+	return true;
+}
+
+Barometer_Sensor::Barometer_Sensor(void) : messageWriter(messageBuffer) {
+	isRunning = false;
+}
+
+Barometer_Sensor::~Barometer_Sensor(void) {
+	Stop();
+}
+
+bool Barometer_Sensor::Start(void) {
+	if (isRunning) {
+		return true;
+	}
+	isRunning = true;
+	sensorThread = std::thread(&Barometer_Sensor::SensorLoop, this);
+	return true;
+}
+
+void Barometer_Sensor::Stop(void) {
+	isRunning = false;
+	if (sensorThread.joinable()) {
+		sensorThread.join();
+	}
+}
+
+bool Barometer_Sensor::IsRunning(void) {
+	return isRunning;
+}
+
+// Sensor objects are created on this thread so that they belong to its COM apartment
+void Barometer_Sensor::SensorLoop(void) {
+	bool isComInitialized = SUCCEEDED(CoInitializeEx(NULL, COINIT_MULTITHREADED));
+
+	ISensorManager *sensorManager = NULL;
+	ISensor *barometer = NULL;
+	ISensor *thermometer = NULL;
+
+	HRESULT hr = CoCreateInstance(CLSID_SensorManager, 0, CLSCTX_ALL, __uuidof(ISensorManager), (void**)&sensorManager);
+	if ((hr == S_OK) && (sensorManager != NULL)) {
+		barometer = Orientation_Sensor::FindSensor(sensorManager, SENSOR_TYPE_BAROMETER);
+		thermometer = Orientation_Sensor::FindSensor(sensorManager, SENSOR_TYPE_ENVIRONMENTAL_TEMPERATURE);
+	}
+
+	if (barometer == NULL) {
+		wxLogMessage(_T("Windows Sensor Plugin, No barometer found"));
+		if (thermometer != NULL) {
+			thermometer->Release();
+		}
+		if (sensorManager != NULL) {
+			sensorManager->Release();
+		}
+		if (isComInitialized) {
+			CoUninitialize();
+		}
+		isRunning = false;
+		return;
+	}
+
+	pressureHistory.Clear();
+	double pressureSum = 0.0;
+	unsigned int pressureSamples = 0;
+	unsigned int sampleCount = 0;
+
+	while (isRunning) {
+		ISensorDataReport *report = NULL;
+		bool isPressure = false;
+		double pressure = 0.0;
+		bool isTemperature = false;
+		double temperature = 0.0;
+
+		if ((barometer->GetData(&report) == S_OK) && (report != NULL)) {
+			isPressure = Orientation_Sensor::GetValue(report, SENSOR_DATA_TYPE_ATMOSPHERIC_PRESSURE_BAR, pressure);
+			report->Release();
+			report = NULL;
+		}
+
+		if ((thermometer != NULL) && (thermometer->GetData(&report) == S_OK) && (report != NULL)) {
+			isTemperature = Orientation_Sensor::GetValue(report, SENSOR_DATA_TYPE_TEMPERATURE_CELSIUS, temperature);
+			report->Release();
+			report = NULL;
+		}
+
+		if (isPressure) {
+			pressureSum += pressure;
+			pressureSamples++;
+			if (pressureSamples == BAROMETER_AVERAGE_SAMPLES) {
+				pressureHistory.Add(pressureSum / pressureSamples);
+				pressureSum = 0.0;
+				pressureSamples = 0;
+			}
+
+			sampleCount++;
+			if ((sampleCount % BAROMETER_OUTPUT_SAMPLES) == 1) {
+				SendOutput(pressure, isTemperature, temperature);
+			}
+		}
+
+		// Sleep in short steps so that Stop is not delayed by the sample interval
+		for (int i = 0; (i < BAROMETER_SAMPLE_INTERVAL / 100) && (isRunning); i++) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(100));
+		}
+	}
+
+	barometer->Release();
+	if (thermometer != NULL) {
+		thermometer->Release();
+	}
+	sensorManager->Release();
+	if (isComInitialized) {
+		CoUninitialize();
+	}
+}
+
+void Barometer_Sensor::SendOutput(double pressure, bool isTemperature, double temperature) {
+	// $--XDR,P,x.x,B,c--c*hh<CR><LF>, pressure in bar
+	Orientation_Sensor::SendSentence(wxString::Format("$IIXDR,P,%.5f,B,Barometer", pressure));
+	if (isTemperature) {
+		Orientation_Sensor::SendSentence(wxString::Format("$IIXDR,C,%.1f,C,TempAir", temperature));
+	}
+
+	// $--MDA,x.x,I,x.x,B,x.x,C,x.x,C,x.x,x.x,x.x,C,x.x,T,x.x,M,x.x,N,x.x,M*hh<CR><LF>
+	if (isTemperature) {
+		Orientation_Sensor::SendSentence(wxString::Format("$IIMDA,%.2f,I,%.4f,B,%.1f,C,,C,,,,C,,T,,M,,N,,M",
+			pressure * BAROMETER_BAR_TO_INHG, pressure, temperature));
+	}
+	else {
+		Orientation_Sensor::SendSentence(wxString::Format("$IIMDA,%.2f,I,%.4f,B,,C,,C,,,,C,,T,,M,,N,,M",
+			pressure * BAROMETER_BAR_TO_INHG, pressure));
+	}
+
+	// {"pressure":x.x,"temperature":x.x,"tendency3h":x.x,"tendency24h":x.x,"mean3h":x.x,"mean24h":x.x}
+	// Pressures in hectopascals, tendencies are omitted until there is sufficient history
+	double value;
+	messageWriter.Reset();
+	messageWriter.BeginObject();
+	messageWriter.Key("pressure");
+	messageWriter.Number(pressure * 1000.0, 1);
+	if (isTemperature) {
+		messageWriter.Key("temperature");
+		messageWriter.Number(temperature, 1);
+	}
+	if (pressureHistory.GetTendency(BAROMETER_SHORT_WINDOW, value)) {
+		messageWriter.Key("tendency3h");
+		messageWriter.Number(value * 1000.0, 1);
+	}
+	if (pressureHistory.GetTendency(BAROMETER_LONG_WINDOW - 1, value)) {
+		messageWriter.Key("tendency24h");
+		messageWriter.Number(value * 1000.0, 1);
+	}
+	if (pressureHistory.GetShortMean(value)) {
+		messageWriter.Key("mean3h");
+		messageWriter.Number(value * 1000.0, 1);
+	}
+	if (pressureHistory.GetLongMean(value)) {
+		messageWriter.Key("mean24h");
+		messageWriter.Number(value * 1000.0, 1);
+	}
+	messageWriter.EndObject();
+
+	// Plugin messages must be sent from the GUI thread
+	std::string message = messageBuffer;
+	wxTheApp->CallAfter([message]() {
+		SendPluginMessage(_T("WINDOWS_SENSOR_BAROMETER"), wxString::FromUTF8(message.c_str()));
+	});
+}
@@ -0,0 +1,145 @@
+// Copyright(C) 2024 by Steven Adler
+//
+// This file is part of Windows Sensor Plugin for OpenCPN.
+//
+// Windows Sensor Plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Windows Sensor Plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Windows Sensor Plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// Project: Windows Sensor Plugin
+// Description: Adaptive epoch interval
+// Owner: twocanplugin@hotmail.com
+// Date: 01/04/2024
+// Version History:
+// 1.0 Initial Release
+
+#include "sensor_plugin_cadence.h"
+
+#include <math.h>
+
+Adaptive_Cadence::Adaptive_Cadence(void) {
+	Reset();
+}
+
+Adaptive_Cadence::~Adaptive_Cadence(void) {
+}
+
+void Adaptive_Cadence::Reset(void) {
+	tier = CADENCE_NORMAL;
+	pendingTier = CADENCE_NORMAL;
+	pendingSince = 0;
+	interval = CADENCE_NORMAL_INTERVAL;
+	turnRate = 0.0;
+	lastCourse = 0.0;
+	lastTime = 0;
+	hasCourse = false;
+}
+
+unsigned int Adaptive_Cadence::Update(double speedOverGround, double courseOverGround, bool isValid, long long now, bool isSaving) {
+	// Turn rate from the change in course, allowing for the wrap at north
+	if ((isValid) && (speedOverGround >= CADENCE_TURN_SPEED)) {
+		if ((hasCourse) && (now > lastTime)) {
+			double change = courseOverGround - lastCourse;
+			if (change > 180.0) {
+				change -= 360.0;
+			}
+			else if (change < -180.0) {
+				change += 360.0;
+			}
+			double rate = change * 1000.0 / (now - lastTime);
+			turnRate += CADENCE_TURN_SMOOTHING * (rate - turnRate);
+		}
+		lastCourse = courseOverGround;
+		lastTime = now;
+		hasCourse = true;
+	}
+	else {
+		turnRate = 0.0;
+		hasCourse = false;
+	}
+
+	CADENCE_TIER indicated = Indicated(speedOverGround, isValid);
+	if (indicated != pendingTier) {
+		pendingTier = indicated;
+		pendingSince = now;
+	}
+
+	if (indicated > tier) {
+		tier = indicated;
+	}
+	else if (indicated < tier) {
+		long long delay = indicated == CADENCE_STATIONARY ? CADENCE_STATIONARY_DELAY : CADENCE_SLOWDOWN_DELAY;
+		if (now - pendingSince >= delay) {
+			tier = indicated;
+		}
+	}
+
+	interval = Interval(tier, isSaving);
+	return interval;
+}
+
+CADENCE_TIER Adaptive_Cadence::Indicated(double speedOverGround, bool isValid) {
+	// Without a fix keep looking at the normal rate
+	if (!isValid) {
+		return CADENCE_NORMAL;
+	}
+
+	double rate = fabs(turnRate);
+	double ratio = tier == CADENCE_MANOEUVRE ? CADENCE_EXIT_RATIO : 1.0;
+	if ((speedOverGround >= CADENCE_MANOEUVRE_SPEED * ratio) || (rate >= CADENCE_MANOEUVRE_TURN_RATE * ratio)) {
+		return CADENCE_MANOEUVRE;
+	}
+	ratio = tier >= CADENCE_FAST ? CADENCE_EXIT_RATIO : 1.0;
+	if ((speedOverGround >= CADENCE_FAST_SPEED * ratio) || (rate >= CADENCE_FAST_TURN_RATE * ratio)) {
+		return CADENCE_FAST;
+	}
+	// Stationary is left once clearly moving
+	ratio = tier == CADENCE_STATIONARY ? 1.0 / CADENCE_EXIT_RATIO : 1.0;
+	if (speedOverGround < CADENCE_STATIONARY_SPEED * ratio) {
+		return CADENCE_STATIONARY;
+	}
+	return CADENCE_NORMAL;
+}
+
+unsigned int Adaptive_Cadence::Interval(CADENCE_TIER tier, bool isSaving) {
+	switch (tier) {
+		case CADENCE_MANOEUVRE:
+			return isSaving ? CADENCE_SAVER_MINIMUM_INTERVAL : CADENCE_MANOEUVRE_INTERVAL;
+		case CADENCE_FAST:
+			return isSaving ? CADENCE_SAVER_MINIMUM_INTERVAL : CADENCE_FAST_INTERVAL;
+		case CADENCE_STATIONARY:
+			return isSaving ? CADENCE_SAVER_STATIONARY_INTERVAL : CADENCE_STATIONARY_INTERVAL;
+		default:
+			return isSaving ? CADENCE_SAVER_NORMAL_INTERVAL : CADENCE_NORMAL_INTERVAL;
+	}
+}
+
+unsigned int Adaptive_Cadence::GetInterval(void) {
+	return interval;
+}
+
+CADENCE_TIER Adaptive_Cadence::GetTier(void) {
+	return tier;
+}
+
+double Adaptive_Cadence::GetTurnRate(void) {
+	return turnRate;
+}
+
+bool Adaptive_Cadence::IsOnBattery(void) {
+	SYSTEM_POWER_STATUS status;
+	if (!GetSystemPowerStatus(&status)) {
+		return false;
+	}
+	// SystemStatusFlag is set whilst Windows battery saver is on
+	return (status.ACLineStatus == 0) || (status.SystemStatusFlag == 1);
+}
@@ -0,0 +1,106 @@
+// Copyright(C) 2024 by Steven Adler
+//
+// This file is part of Windows Sensor Plugin for OpenCPN.
+//
+// Windows Sensor Plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Windows Sensor Plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Windows Sensor Plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// Project: Windows Sensor Plugin
+// Description: Per thread performance counters
+// Owner: twocanplugin@hotmail.com
+// Date: 01/04/2024
+// Version History:
+// 1.0 Initial Release
+
+#include "sensor_plugin_counters.h"
+
+static const char *counterNames[COUNTER_COUNT] = { "ticks", "reports", "gga", "gll", "gsv", "rmc", "bytesPushed",
+	"rejectedFixes", "comFailures", "getDataTime", "nmeaReceived", "nmeaErrors", "logDropped" };
+
+// Aligned so that no two threads write the same cache line
+typedef struct alignas(64) _counter_block {
+	std::atomic<unsigned long long> values[COUNTER_COUNT];
+} CounterBlock;
+
+// Static storage, so zero initialised before any thread can use them
+static CounterBlock counterBlocks[COUNTER_MAXIMUM_THREADS];
+static std::atomic<unsigned int> counterBlockCount(0);
+static thread_local CounterBlock *localBlock = NULL;
+
+static CounterBlock *SharedBlock(void) {
+	return &counterBlocks[COUNTER_MAXIMUM_THREADS - 1];
+}
+
+// Claimed on a thread's first increment
+static CounterBlock *LocalBlock(void) {
+	if (localBlock == NULL) {
+		unsigned int index = counterBlockCount.fetch_add(1);
+		localBlock = index < (COUNTER_MAXIMUM_THREADS - 1) ? &counterBlocks[index] : SharedBlock();
+	}
+	return localBlock;
+}
+
+void Performance_Counters::Increment(PERFORMANCE_COUNTER counter) {
+	Add(counter, 1);
+}
+
+void Performance_Counters::Add(PERFORMANCE_COUNTER counter, unsigned long long value) {
+	CounterBlock *block = LocalBlock();
+	std::atomic<unsigned long long> &total = block->values[counter];
+	// Only the shared block has more than one writer
+	if (block == SharedBlock()) {
+		total.fetch_add(value, std::memory_order_relaxed);
+	}
+	else {
+		total.store(total.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+	}
+}
+
+unsigned long long Performance_Counters::Get(PERFORMANCE_COUNTER counter) {
+	unsigned long long total = 0;
+	for (unsigned int i = 0; i < COUNTER_MAXIMUM_THREADS; i++) {
+		total += counterBlocks[i].values[counter].load(std::memory_order_relaxed);
+	}
+	return total;
+}
+
+const char *Performance_Counters::CounterName(PERFORMANCE_COUNTER counter) {
+	return counterNames[counter];
+}
+
+void Performance_Counters::Write(Json_Writer &writer, long long frequency) {
+	writer.BeginObject();
+	for (unsigned int i = 0; i < COUNTER_COUNT; i++) {
+		writer.Key(counterNames[i]);
+		if ((i == COUNTER_GETDATA_TIME) && (frequency > 0)) {
+			writer.Number(((double)Get(COUNTER_GETDATA_TIME) * 1000.0) / (double)frequency, 3);
+		}
+		else {
+			writer.Integer((long long)Get((PERFORMANCE_COUNTER)i));
+		}
+	}
+	writer.EndObject();
+}
+
+wxString Performance_Counters::Summary(long long frequency) {
+	wxString summary;
+	for (unsigned int i = 0; i < COUNTER_COUNT; i++) {
+		if ((i == COUNTER_GETDATA_TIME) && (frequency > 0)) {
+			summary += wxString::Format("%-14s %14.3f ms\n", counterNames[i], ((double)Get(COUNTER_GETDATA_TIME) * 1000.0) / (double)frequency);
+		}
+		else {
+			summary += wxString::Format("%-14s %14llu\n", counterNames[i], Get((PERFORMANCE_COUNTER)i));
+		}
+	}
+	return summary;
+}
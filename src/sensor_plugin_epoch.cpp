@@ -0,0 +1,161 @@
+// Copyright(C) 2024 by Steven Adler
+//
+// This file is part of Windows Sensor Plugin for OpenCPN.
+//
+// Windows Sensor Plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Windows Sensor Plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Windows Sensor Plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// Project: Windows Sensor Plugin
+// Description: Epoch scheduler aligned to UTC
+// Owner: twocanplugin@hotmail.com
+// Date: 01/04/2024
+// Version History:
+// 1.0 Initial Release
+
+#include "sensor_plugin_epoch.h"
+
+#include <math.h>
+
+// 100 nanosecond intervals
+#define EPOCH_TICKS_PER_SECOND 10000000LL
+#define EPOCH_TICKS_PER_MILLISECOND 10000LL
+
+Epoch_Scheduler::Epoch_Scheduler(void) {
+	Reset(EPOCH_TICKS_PER_SECOND);
+}
+
+Epoch_Scheduler::~Epoch_Scheduler(void) {
+}
+
+void Epoch_Scheduler::Reset(long long frequency) {
+	this->frequency = frequency > 0 ? frequency : EPOCH_TICKS_PER_SECOND;
+	referenceOffset = 0.0;
+	hasReference = false;
+	isReportLocked = false;
+	scheduled = 0;
+	scheduledPeriod = 0;
+	count = 0;
+	mean = 0.0;
+	sumSquares = 0.0;
+	maximum = 0.0;
+	missed = 0;
+}
+
+// Split so that the multiplication cannot overflow after a long uptime
+long long Epoch_Scheduler::ToHundredNanoseconds(long long ticks) {
+	return ((ticks / frequency) * EPOCH_TICKS_PER_SECOND) + (((ticks % frequency) * EPOCH_TICKS_PER_SECOND) / frequency);
+}
+
+long long Epoch_Scheduler::ToTicks(long long hundredNanoseconds) {
+	return ((hundredNanoseconds / EPOCH_TICKS_PER_SECOND) * frequency) +
+		(((hundredNanoseconds % EPOCH_TICKS_PER_SECOND) * frequency) / EPOCH_TICKS_PER_SECOND);
+}
+
+void Epoch_Scheduler::SetReference(long long utc, long long monotonic) {
+	isReportLocked = false;
+	UpdateOffset((double)(utc - ToHundredNanoseconds(monotonic)));
+}
+
+// The system clock bears no relation to when the receiver computed its fix, so the report is taken to belong
+// to the boundary at or before it. Thereafter it is kept to the same boundary as the reports drift either side
+// of one, or the system clock is stepped, as only the phase of the reports matters.
+void Epoch_Scheduler::SetReportReference(long long realtime, long long monotonic, unsigned int interval) {
+	long long period = (long long)interval * EPOCH_TICKS_PER_MILLISECOND;
+	if (period <= 0) {
+		period = EPOCH_TICKS_PER_SECOND;
+	}
+	double offset = (double)((realtime - (realtime % period)) - ToHundredNanoseconds(monotonic));
+	if (!isReportLocked) {
+		referenceOffset = offset;
+		hasReference = true;
+		isReportLocked = true;
+		return;
+	}
+	offset -= floor(((offset - referenceOffset) / period) + 0.5) * period;
+	UpdateOffset(offset);
+}
+
+void Epoch_Scheduler::UpdateOffset(double offset) {
+	if ((!hasReference) || (fabs(offset - referenceOffset) > EPOCH_REFERENCE_STEP)) {
+		referenceOffset = offset;
+		hasReference = true;
+	}
+	else {
+		referenceOffset += EPOCH_REFERENCE_SMOOTHING * (offset - referenceOffset);
+	}
+}
+
+bool Epoch_Scheduler::HasReference(void) {
+	return hasReference;
+}
+
+long long Epoch_Scheduler::NextEpoch(long long now, unsigned int interval, unsigned int offset) {
+	long long period = (long long)interval * EPOCH_TICKS_PER_MILLISECOND;
+	long long phase = (long long)offset * EPOCH_TICKS_PER_MILLISECOND;
+	if (period <= 0) {
+		period = EPOCH_TICKS_PER_SECOND;
+	}
+	phase %= period;
+
+	long long monotonicNow = ToHundredNanoseconds(now);
+	long long utcNow = monotonicNow + (long long)referenceOffset;
+	long long next = (((utcNow - phase) / period) + 1) * period + phase;
+	if (next - utcNow < EPOCH_MINIMUM_DELAY * EPOCH_TICKS_PER_MILLISECOND) {
+		next += period;
+	}
+
+	scheduled = ToTicks(next - (long long)referenceOffset);
+	scheduledPeriod = ToTicks(period);
+	return scheduled;
+}
+
+unsigned int Epoch_Scheduler::Delay(long long deadline, long long now) {
+	if (deadline <= now) {
+		return 0;
+	}
+	return (unsigned int)(((deadline - now) * 1000 + frequency - 1) / frequency);
+}
+
+void Epoch_Scheduler::Record(long long actual) {
+	if (scheduled == 0) {
+		return;
+	}
+
+	// Whole periods late are missed epochs rather than jitter
+	long long lateness = actual - scheduled;
+	if ((scheduledPeriod > 0) && (lateness >= scheduledPeriod)) {
+		missed += lateness / scheduledPeriod;
+		lateness %= scheduledPeriod;
+	}
+	scheduled = 0;
+
+	double milliseconds = (lateness * 1000.0) / frequency;
+	count++;
+	double delta = milliseconds - mean;
+	mean += delta / count;
+	sumSquares += delta * (milliseconds - mean);
+	if (fabs(milliseconds) > maximum) {
+		maximum = fabs(milliseconds);
+	}
+}
+
+void Epoch_Scheduler::GetJitter(double &mean, double &deviation, double &maximum, unsigned long long &count) {
+	mean = this->mean;
+	deviation = this->count > 1 ? sqrt(sumSquares / (this->count - 1)) : 0.0;
+	maximum = this->maximum;
+	count = this->count;
+}
+
+unsigned long long Epoch_Scheduler::GetMissedCount(void) {
+	return missed;
+}
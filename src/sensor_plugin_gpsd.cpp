@@ -0,0 +1,453 @@
+// Copyright(C) 2024 by Steven Adler
+//
+// This file is part of Windows Sensor Plugin for OpenCPN.
+//
+// Windows Sensor Plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Windows Sensor Plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Windows Sensor Plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// Project: Windows Sensor Plugin
+// Description: gpsd protocol compatible server
+// Owner: twocanplugin@hotmail.com
+// Date: 01/04/2024
+// Version History:
+// 1.0 Initial Release
+
+// Refer to https://gpsd.gitlab.io/gpsd/gpsd_json.html
+
+#include "sensor_plugin_gpsd.h"
+
+#include <wx/datetime.h>
+
+#include <ctype.h>
+
+// Name reported as the device path
+#define GPSD_DEVICE "windows_sensor"
+
+// gpsd terminates each report with CR LF
+static const char reportTerminator[] = "\r\n";
+
+GPSD_Server::GPSD_Server(void) {
+	listenSocket = INVALID_SOCKET;
+	wakeSocket = INVALID_SOCKET;
+	clientCount = 0;
+	isRunning = false;
+	hasPendingEpoch = false;
+}
+
+GPSD_Server::~GPSD_Server(void) {
+	Stop();
+}
+
+bool GPSD_Server::Start(unsigned short port) {
+	if (isRunning) {
+		Stop();
+	}
+
+	WSADATA wsaData;
+	if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
+		wxLogMessage(_T("Windows Sensor Plugin, Winsock initialization failed"));
+		return false;
+	}
+
+	// Wake socket, bound to an ephemeral loopback port
+	wakeSocket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	memset(&wakeAddress, 0, sizeof(wakeAddress));
+	wakeAddress.sin_family = AF_INET;
+	wakeAddress.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	wakeAddress.sin_port = 0;
+	int addressLength = sizeof(wakeAddress);
+	if ((wakeSocket == INVALID_SOCKET) ||
+		(bind(wakeSocket, (sockaddr *)&wakeAddress, sizeof(wakeAddress)) == SOCKET_ERROR) ||
+		(getsockname(wakeSocket, (sockaddr *)&wakeAddress, &addressLength) == SOCKET_ERROR)) {
+		wxLogMessage(_T("Windows Sensor Plugin, gpsd wake socket failed: %d"), WSAGetLastError());
+		CloseSockets();
+		return false;
+	}
+	u_long nonBlocking = 1;
+	ioctlsocket(wakeSocket, FIONBIO, &nonBlocking);
+
+	// Like gpsd, only listen on localhost
+	listenSocket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	sockaddr_in listenAddress;
+	memset(&listenAddress, 0, sizeof(listenAddress));
+	listenAddress.sin_family = AF_INET;
+	listenAddress.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	listenAddress.sin_port = htons(port);
+	if ((listenSocket == INVALID_SOCKET) ||
+		(bind(listenSocket, (sockaddr *)&listenAddress, sizeof(listenAddress)) == SOCKET_ERROR) ||
+		(listen(listenSocket, SOMAXCONN) == SOCKET_ERROR)) {
+		wxLogMessage(_T("Windows Sensor Plugin, Unable to listen on gpsd port %d: %d"), port, WSAGetLastError());
+		CloseSockets();
+		return false;
+	}
+	ioctlsocket(listenSocket, FIONBIO, &nonBlocking);
+	wxLogMessage(_T("Windows Sensor Plugin, gpsd server listening on port %d"), port);
+
+	isRunning = true;
+	loopThread = std::thread(&GPSD_Server::EventLoop, this);
+	return true;
+}
+
+void GPSD_Server::Stop(void) {
+	if (!isRunning) {
+		return;
+	}
+	isRunning = false;
+
+	char wake = 0;
+	sendto(wakeSocket, &wake, sizeof(wake), 0, (sockaddr *)&wakeAddress, sizeof(wakeAddress));
+	if (loopThread.joinable()) {
+		loopThread.join();
+	}
+
+	CloseSockets();
+}
+
+void GPSD_Server::CloseSockets(void) {
+	for (std::vector<GpsdClient>::iterator it = clients.begin(); it != clients.end(); ++it) {
+		closesocket(it->socket);
+	}
+	clients.clear();
+	clientCount = 0;
+
+	if (listenSocket != INVALID_SOCKET) {
+		closesocket(listenSocket);
+		listenSocket = INVALID_SOCKET;
+	}
+	if (wakeSocket != INVALID_SOCKET) {
+		closesocket(wakeSocket);
+		wakeSocket = INVALID_SOCKET;
+	}
+	WSACleanup();
+}
+
+bool GPSD_Server::IsRunning(void) {
+	return isRunning;
+}
+
+unsigned int GPSD_Server::GetClientCount(void) {
+	return clientCount;
+}
+
+// ISO 8601 UTC time with milliseconds
+std::string GPSD_Server::FormatTime(long long timeStamp) {
+	wxDateTime time = wxDateTime(wxLongLong(timeStamp));
+	return std::string(wxString::Format("%s.%03dZ", time.Format("%Y-%m-%dT%H:%M:%S", wxDateTime::UTC), (int)(timeStamp % 1000)).ToAscii());
+}
+
+std::string GPSD_Server::VersionReport(void) {
+	return "{\"class\":\"VERSION\",\"release\":\"3.25\",\"rev\":\"windows_sensor\",\"proto_major\":3,\"proto_minor\":15}";
+}
+
+std::string GPSD_Server::DevicesReport(void) {
+	return "{\"class\":\"DEVICES\",\"devices\":[{\"class\":\"DEVICE\",\"path\":\"" GPSD_DEVICE "\",\"driver\":\"Windows Sensor\",\"flags\":1,\"native\":0}]}";
+}
+
+std::string GPSD_Server::WatchReport(const GpsdClient &client) {
+	return std::string(wxString::Format("{\"class\":\"WATCH\",\"enable\":%s,\"json\":%s,\"nmea\":%s,\"raw\":0,\"scaled\":false,\"timing\":false,\"split24\":false,\"pps\":false}",
+		client.isWatching ? "true" : "false", client.isJSON ? "true" : "false", client.isNMEA ? "true" : "false").ToAscii());
+}
+
+// Serialised on the caller's thread, once per epoch regardless of the number of clients
+void GPSD_Server::Publish(const PositionFix &fix, const std::vector<SatelliteInformation> &satellites, const std::vector<std::string> &sentences) {
+	if (!isRunning) {
+		return;
+	}
+
+	std::string time = FormatTime(fix.timeStamp);
+
+	// Mode 1 = no fix, 2 = 2D, 3 = 3D
+	int mode = 1;
+	if (fix.isValid) {
+		mode = (fix.vDOP > 0.0) ? 3 : 2;
+	}
+
+	wxString tpv = wxString::Format("{\"class\":\"TPV\",\"device\":\"%s\",\"mode\":%d,\"time\":\"%s\"", GPSD_DEVICE, mode, time.c_str());
+	if (mode > 1) {
+		tpv += wxString::Format(",\"lat\":%.9f,\"lon\":%.9f,\"track\":%.2f,\"speed\":%.3f",
+			fix.latitude, fix.longitude, fix.courseOverGround, fix.speedOverGround * 0.514444);
+		// Most sensors never report variation, omitted rather than claiming zero
+		if (fix.isVariationValid) {
+			tpv += wxString::Format(",\"magvar\":%.1f", fix.magneticVariation);
+		}
+	}
+	if (mode == 3) {
+		tpv += wxString::Format(",\"altMSL\":%.3f,\"altHAE\":%.3f,\"geoidSep\":%.3f",
+			fix.altitude, fix.altitude + fix.geoidalSeparation, fix.geoidalSeparation);
+	}
+	tpv += "}";
+
+	// The sensor does not report which satellites are used in the solution,
+	// so assume those with a signal are being used
+	wxString sky = wxString::Format("{\"class\":\"SKY\",\"device\":\"%s\",\"time\":\"%s\",\"hdop\":%.2f,\"vdop\":%.2f,\"pdop\":%.2f,\"nSat\":%d,\"uSat\":%d,\"satellites\":[",
+		GPSD_DEVICE, time.c_str(), fix.hDOP, fix.vDOP, fix.pDOP, (int)satellites.size(), fix.satellitesInUse);
+	for (std::vector<SatelliteInformation>::const_iterator it = satellites.begin(); it != satellites.end(); ++it) {
+		sky += wxString::Format("%s{\"PRN\":%d,\"el\":%.0f,\"az\":%.0f,\"ss\":%.0f,\"used\":%s}", (it == satellites.begin()) ? "" : ",",
+			it->id, it->elevation, it->azimuth, it->snr, (it->snr > 0.0) ? "true" : "false");
+	}
+	sky += "]}";
+
+	{
+		std::lock_guard<std::mutex> lock(epochMutex);
+		pendingTPV = std::string(tpv.ToAscii());
+		pendingSKY = std::string(sky.ToAscii());
+		pendingSentences = sentences;
+		hasPendingEpoch = true;
+	}
+
+	char wake = 1;
+	sendto(wakeSocket, &wake, sizeof(wake), 0, (sockaddr *)&wakeAddress, sizeof(wakeAddress));
+}
+
+bool GPSD_Server::SendString(SOCKET s, const std::string &text) {
+	WSABUF buffers[2];
+	buffers[0].buf = (CHAR *)text.data();
+	buffers[0].len = (ULONG)text.size();
+	buffers[1].buf = (CHAR *)reportTerminator;
+	buffers[1].len = 2;
+	DWORD bytesSent = 0;
+	return ((WSASend(s, buffers, 2, &bytesSent, 0, NULL, NULL) != SOCKET_ERROR) && (bytesSent == (text.size() + 2)));
+}
+
+void GPSD_Server::AcceptClients(void) {
+	while (true) {
+		SOCKET s = accept(listenSocket, NULL, NULL);
+		if (s == INVALID_SOCKET) {
+			return;
+		}
+		if (clients.size() >= GPSD_MAXIMUM_CLIENTS) {
+			closesocket(s);
+			continue;
+		}
+		u_long nonBlocking = 1;
+		ioctlsocket(s, FIONBIO, &nonBlocking);
+		BOOL noDelay = TRUE;
+		setsockopt(s, IPPROTO_TCP, TCP_NODELAY, (const char *)&noDelay, sizeof(noDelay));
+
+		// gpsd announces itself as soon as a client connects
+		if (!SendString(s, VersionReport())) {
+			closesocket(s);
+			continue;
+		}
+
+		GpsdClient client;
+		client.socket = s;
+		client.isWatching = false;
+		client.isJSON = true;
+		client.isNMEA = false;
+		clients.push_back(client);
+	}
+}
+
+// Commands are of the form ?NAME; or ?NAME={json};
+bool GPSD_Server::ExecuteCommand(GpsdClient &client, const std::string &command) {
+	if (command.compare(0, 8, "?VERSION") == 0) {
+		return SendString(client.socket, VersionReport());
+	}
+
+	if (command.compare(0, 8, "?DEVICES") == 0) {
+		return SendString(client.socket, DevicesReport());
+	}
+
+	if (command.compare(0, 6, "?WATCH") == 0) {
+		// Only the commonly used members are recognised, enable defaults to true
+		std::string json = MemberValue(command, "json");
+		client.isWatching = (MemberValue(command, "enable") != "false");
+		if ((MemberValue(command, "nmea") == "true") || (MemberValue(command, "raw") == "1")) {
+			client.isNMEA = true;
+			client.isJSON = (json == "true");
+		}
+		else {
+			client.isNMEA = false;
+			client.isJSON = (json != "false");
+		}
+		return (SendString(client.socket, DevicesReport()) && SendString(client.socket, WatchReport(client)));
+	}
+
+	if (command.compare(0, 5, "?POLL") == 0) {
+		std::string poll = "{\"class\":\"POLL\",\"active\":";
+		if (currentTPV.empty()) {
+			poll += "0,\"tpv\":[],\"sky\":[]}";
+		}
+		else {
+			poll += "1,\"tpv\":[" + currentTPV + "],\"sky\":[" + currentSKY + "]}";
+		}
+		return SendString(client.socket, poll);
+	}
+
+	return SendString(client.socket, "{\"class\":\"ERROR\",\"message\":\"Unrecognized request\"}");
+}
+
+// Literal value of a member such as "enable": false, allowing whitespace either side of the colon.
+// Returns an empty string if the member is absent.
+std::string GPSD_Server::MemberValue(const std::string &command, const char *key) {
+	std::string name = std::string("\"") + key + "\"";
+	size_t position = command.find(name);
+	if (position == std::string::npos) {
+		return std::string();
+	}
+	position += name.length();
+	while ((position < command.length()) && (isspace((unsigned char)command[position]))) {
+		position++;
+	}
+	if ((position >= command.length()) || (command[position] != ':')) {
+		return std::string();
+	}
+	position++;
+	while ((position < command.length()) && (isspace((unsigned char)command[position]))) {
+		position++;
+	}
+	size_t end = position;
+	while ((end < command.length()) && (command[end] != ',') && (command[end] != '}') && (!isspace((unsigned char)command[end]))) {
+		end++;
+	}
+	return command.substr(position, end - position);
+}
+
+// Returns false if the client has disconnected or misbehaved
+bool GPSD_Server::ReadCommands(GpsdClient &client) {
+	char buffer[512];
+	while (true) {
+		int length = recv(client.socket, buffer, sizeof(buffer), 0);
+		if (length == 0) {
+			return false;
+		}
+		if (length == SOCKET_ERROR) {
+			return (WSAGetLastError() == WSAEWOULDBLOCK);
+		}
+
+		for (int i = 0; i < length; i++) {
+			char c = buffer[i];
+			if ((c == '\r') || (c == '\n')) {
+				continue;
+			}
+			client.command.push_back(c);
+			if (c == ';') {
+				bool result = ExecuteCommand(client, client.command);
+				client.command.clear();
+				if (!result) {
+					return false;
+				}
+			}
+			else if (client.command.size() > GPSD_MAXIMUM_COMMAND) {
+				return false;
+			}
+		}
+	}
+}
+
+void GPSD_Server::SendEpoch(void) {
+	// The same buffers are written to every watching client
+	WSABUF reports[4];
+	reports[0].buf = (CHAR *)currentTPV.data();
+	reports[0].len = (ULONG)currentTPV.size();
+	reports[1].buf = (CHAR *)reportTerminator;
+	reports[1].len = 2;
+	reports[2].buf = (CHAR *)currentSKY.data();
+	reports[2].len = (ULONG)currentSKY.size();
+	reports[3].buf = (CHAR *)reportTerminator;
+	reports[3].len = 2;
+	DWORD reportsLength = reports[0].len + reports[2].len + 4;
+
+	std::vector<WSABUF> sentences;
+	DWORD sentencesLength = 0;
+	for (std::vector<std::string>::const_iterator it = currentSentences.begin(); it != currentSentences.end(); ++it) {
+		WSABUF buffer;
+		buffer.buf = (CHAR *)it->data();
+		buffer.len = (ULONG)it->size();
+		sentences.push_back(buffer);
+		sentencesLength += buffer.len;
+	}
+
+	// Slow clients are disconnected rather than blocking the others
+	for (std::vector<GpsdClient>::iterator it = clients.begin(); it != clients.end();) {
+		bool isOk = true;
+		DWORD bytesSent = 0;
+		if ((it->isWatching) && (it->isJSON)) {
+			isOk = ((WSASend(it->socket, reports, 4, &bytesSent, 0, NULL, NULL) != SOCKET_ERROR) && (bytesSent == reportsLength));
+		}
+		if ((isOk) && (it->isWatching) && (it->isNMEA) && (!sentences.empty())) {
+			isOk = ((WSASend(it->socket, &sentences[0], (DWORD)sentences.size(), &bytesSent, 0, NULL, NULL) != SOCKET_ERROR) && (bytesSent == sentencesLength));
+		}
+		if (!isOk) {
+			closesocket(it->socket);
+			it = clients.erase(it);
+		}
+		else {
+			++it;
+		}
+	}
+}
+
+void GPSD_Server::EventLoop(void) {
+	std::vector<WSAPOLLFD> pollList;
+	char discard[64];
+
+	while (isRunning) {
+		pollList.clear();
+		WSAPOLLFD entry;
+		entry.events = POLLRDNORM;
+		entry.revents = 0;
+		entry.fd = wakeSocket;
+		pollList.push_back(entry);
+		entry.fd = listenSocket;
+		pollList.push_back(entry);
+		for (std::vector<GpsdClient>::const_iterator it = clients.begin(); it != clients.end(); ++it) {
+			entry.fd = it->socket;
+			pollList.push_back(entry);
+		}
+
+		int result = WSAPoll(&pollList[0], (ULONG)pollList.size(), 1000);
+		if ((result <= 0) || (!isRunning)) {
+			continue;
+		}
+
+		// Process commands, the poll list and client list are in the same order
+		size_t index = 2;
+		for (std::vector<GpsdClient>::iterator it = clients.begin(); it != clients.end(); index++) {
+			if ((pollList.at(index).revents & (POLLRDNORM | POLLHUP | POLLERR | POLLNVAL)) && (!ReadCommands(*it))) {
+				closesocket(it->socket);
+				it = clients.erase(it);
+			}
+			else {
+				++it;
+			}
+		}
+
+		if (pollList.at(1).revents & POLLRDNORM) {
+			AcceptClients();
+		}
+
+		if (pollList.at(0).revents & POLLRDNORM) {
+			while (recv(wakeSocket, discard, sizeof(discard), 0) > 0) {
+			}
+
+			bool hasEpoch = false;
+			{
+				std::lock_guard<std::mutex> lock(epochMutex);
+				if (hasPendingEpoch) {
+					currentTPV.swap(pendingTPV);
+					currentSKY.swap(pendingSKY);
+					currentSentences.swap(pendingSentences);
+					hasPendingEpoch = false;
+					hasEpoch = true;
+				}
+			}
+			if (hasEpoch) {
+				SendEpoch();
+			}
+		}
+
+		clientCount = (unsigned int)clients.size();
+	}
+}
@@ -0,0 +1,96 @@
+// Copyright(C) 2024 by Steven Adler
+//
+// This file is part of Windows Sensor Plugin for OpenCPN.
+//
+// Windows Sensor Plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Windows Sensor Plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Windows Sensor Plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// Project: Windows Sensor Plugin
+// Description: Heading and rate of turn from compass and gyrometer readings
+// Owner: twocanplugin@hotmail.com
+// Date: 01/04/2024
+// Version History:
+// 1.0 Initial Release
+
+#include "sensor_plugin_heading.h"
+
+#include <math.h>
+#include <stdio.h>
+
+Heading_Estimator::Heading_Estimator(void) {
+	Reset();
+}
+
+Heading_Estimator::~Heading_Estimator(void) {
+}
+
+void Heading_Estimator::Reset(void) {
+	previousHeading = 0.0;
+	previousTimeStamp = 0;
+	filteredRate = 0.0;
+}
+
+bool Heading_Estimator::Update(double heading, long long timeStamp, double &rateOfTurn) {
+	bool isValid = false;
+	if ((previousTimeStamp != 0) && (timeStamp > previousTimeStamp)) {
+		double elapsed = (timeStamp - previousTimeStamp) / 1e7;
+		// Shortest way round, so that passing through north is not a turn of nearly 360 degrees
+		double change = fmod(heading - previousHeading + 540.0, 360.0) - 180.0;
+		double alpha = elapsed / (ORIENTATION_RATE_TIME_CONSTANT + elapsed);
+		filteredRate += alpha * (((change / elapsed) * 60.0) - filteredRate);
+		rateOfTurn = filteredRate;
+		isValid = true;
+	}
+	previousHeading = heading;
+	previousTimeStamp = timeStamp;
+	return isValid;
+}
+
+bool Heading_Estimator::TrueHeading(double magneticHeading, double variation, bool isVariationValid, double &trueHeading) {
+	if (!isVariationValid) {
+		return false;
+	}
+	trueHeading = fmod(magneticHeading + variation + 360.0, 360.0);
+	return true;
+}
+
+// Counter clockwise about the device's Z axis is positive, turning to starboard is positive for NMEA 0183
+double Heading_Estimator::GyrometerRate(double angularVelocity) {
+	return -angularVelocity * 60.0;
+}
+
+// $--HDG,x.x,x.x,a,x.x,a*hh<CR><LF>
+std::string Heading_Estimator::FormatHDG(double magneticHeading, double variation, bool isVariationValid) {
+	char sentence[48];
+	if (isVariationValid) {
+		snprintf(sentence, sizeof(sentence), "$IIHDG,%.1f,,,%.1f,%c", magneticHeading, fabs(variation), variation >= 0 ? 'E' : 'W');
+	}
+	else {
+		snprintf(sentence, sizeof(sentence), "$IIHDG,%.1f,,,,", magneticHeading);
+	}
+	return sentence;
+}
+
+// $--HDT,x.x,T*hh<CR><LF>
+std::string Heading_Estimator::FormatHDT(double trueHeading) {
+	char sentence[32];
+	snprintf(sentence, sizeof(sentence), "$IIHDT,%.1f,T", trueHeading);
+	return sentence;
+}
+
+// $--ROT,x.x,A*hh<CR><LF>, degrees per minute
+std::string Heading_Estimator::FormatROT(double rateOfTurn) {
+	char sentence[32];
+	snprintf(sentence, sizeof(sentence), "$IIROT,%.1f,A", rateOfTurn);
+	return sentence;
+}
@@ -0,0 +1,115 @@
+// Copyright(C) 2024 by Steven Adler
+//
+// This file is part of Windows Sensor Plugin for OpenCPN.
+//
+// Windows Sensor Plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Windows Sensor Plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Windows Sensor Plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// Project: Windows Sensor Plugin
+// Description: Heave estimation
+// Owner: twocanplugin@hotmail.com
+// Date: 01/04/2024
+// Version History:
+// 1.0 Initial Release
+
+#include "sensor_plugin_heave.h"
+
+#include <math.h>
+
+#define HEAVE_TWO_PI 6.283185307179586
+
+Heave_Estimator::Heave_Estimator(void) {
+	Reset();
+}
+
+Heave_Estimator::~Heave_Estimator(void) {
+}
+
+void Heave_Estimator::Reset(void) {
+	accelerationFilter.input = 0.0;
+	accelerationFilter.output = 0.0;
+	velocityFilter = accelerationFilter;
+	displacementFilter = accelerationFilter;
+	lowPassAcceleration = 0.0;
+	velocity = 0.0;
+	displacement = 0.0;
+	heave = 0.0;
+	runningTime = 0.0;
+	historyIndex = 0;
+	historyCount = 0;
+	historySum = 0.0;
+	historySumOfSquares = 0.0;
+}
+
+// y[n] = a (y[n-1] + x[n] - x[n-1]), where a = RC / (RC + dt)
+double Heave_Estimator::ApplyHighPass(HighPass &filter, double input, double elapsed) {
+	double timeConstant = HEAVE_HIGH_PASS_PERIOD / HEAVE_TWO_PI;
+	double alpha = timeConstant / (timeConstant + elapsed);
+	filter.output = alpha * (filter.output + input - filter.input);
+	filter.input = input;
+	return filter.output;
+}
+
+void Heave_Estimator::Process(double verticalAcceleration, double elapsed) {
+	if (elapsed <= 0.0) {
+		return;
+	}
+
+	// Band pass the acceleration
+	double timeConstant = HEAVE_LOW_PASS_PERIOD / HEAVE_TWO_PI;
+	lowPassAcceleration += (elapsed / (timeConstant + elapsed)) * (verticalAcceleration - lowPassAcceleration);
+	double acceleration = ApplyHighPass(accelerationFilter, lowPassAcceleration, elapsed);
+
+	// Integrate twice, removing the drift after each integration
+	velocity += acceleration * elapsed;
+	double filteredVelocity = ApplyHighPass(velocityFilter, velocity, elapsed);
+	displacement += filteredVelocity * elapsed;
+	heave = ApplyHighPass(displacementFilter, displacement, elapsed);
+
+	runningTime += elapsed;
+	if (!IsSettled()) {
+		return;
+	}
+
+	// Replace the oldest sample once the buffer is full
+	if (historyCount == HEAVE_BUFFER_SIZE) {
+		double oldest = history[historyIndex];
+		historySum -= oldest;
+		historySumOfSquares -= oldest * oldest;
+	}
+	else {
+		historyCount++;
+	}
+	history[historyIndex] = heave;
+	historySum += heave;
+	historySumOfSquares += heave * heave;
+	historyIndex = (historyIndex + 1) % HEAVE_BUFFER_SIZE;
+}
+
+double Heave_Estimator::GetHeave(void) {
+	return heave;
+}
+
+double Heave_Estimator::GetSignificantHeave(void) {
+	if (historyCount < 2) {
+		return 0.0;
+	}
+	double mean = historySum / historyCount;
+	double variance = (historySumOfSquares / historyCount) - (mean * mean);
+	// Rounding in the running sums can make a tiny variance negative
+	return variance > 0.0 ? 4.0 * sqrt(variance) : 0.0;
+}
+
+bool Heave_Estimator::IsSettled(void) {
+	return (runningTime >= HEAVE_SETTLING_TIME);
+}
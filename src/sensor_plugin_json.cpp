@@ -0,0 +1,161 @@
+// Copyright(C) 2024 by Steven Adler
+//
+// This file is part of Windows Sensor Plugin for OpenCPN.
+//
+// Windows Sensor Plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Windows Sensor Plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Windows Sensor Plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// Project: Windows Sensor Plugin
+// Description: Streaming JSON writer
+// Owner: twocanplugin@hotmail.com
+// Date: 01/04/2024
+// Version History:
+// 1.0 Initial Release
+
+#include "sensor_plugin_json.h"
+
+#include <math.h>
+#include <stdio.h>
+
+Json_Writer::Json_Writer(std::string &buffer) : buffer(buffer) {
+	Reset();
+}
+
+Json_Writer::~Json_Writer(void) {
+}
+
+void Json_Writer::Reset(void) {
+	buffer.clear();
+	depth = 0;
+	isFirst[0] = true;
+	isAfterKey = false;
+}
+
+// Values following a key, or the first value in an object or array, are not preceded by a comma
+void Json_Writer::Separator(void) {
+	if (isAfterKey) {
+		isAfterKey = false;
+		return;
+	}
+	if (!isFirst[depth]) {
+		buffer += ',';
+	}
+	isFirst[depth] = false;
+}
+
+void Json_Writer::BeginObject(void) {
+	Separator();
+	buffer += '{';
+	if (depth < JSON_MAXIMUM_DEPTH - 1) {
+		depth++;
+	}
+	isFirst[depth] = true;
+}
+
+void Json_Writer::EndObject(void) {
+	buffer += '}';
+	if (depth > 0) {
+		depth--;
+	}
+}
+
+void Json_Writer::BeginArray(void) {
+	Separator();
+	buffer += '[';
+	if (depth < JSON_MAXIMUM_DEPTH - 1) {
+		depth++;
+	}
+	isFirst[depth] = true;
+}
+
+void Json_Writer::EndArray(void) {
+	buffer += ']';
+	if (depth > 0) {
+		depth--;
+	}
+}
+
+void Json_Writer::Key(const char *key) {
+	Separator();
+	buffer += '"';
+	buffer += key;
+	buffer += "\":";
+	isAfterKey = true;
+}
+
+void Json_Writer::String(const char *value) {
+	Separator();
+	buffer += '"';
+	for (const char *c = value; *c != '\0'; c++) {
+		switch (*c) {
+			case '"':
+				buffer += "\\\"";
+				break;
+			case '\\':
+				buffer += "\\\\";
+				break;
+			case '\n':
+				buffer += "\\n";
+				break;
+			case '\r':
+				buffer += "\\r";
+				break;
+			case '\t':
+				buffer += "\\t";
+				break;
+			default:
+				if ((unsigned char)*c < 0x20) {
+					char escape[8];
+					snprintf(escape, sizeof(escape), "\\u%04x", (unsigned char)*c);
+					buffer += escape;
+				}
+				else {
+					buffer += *c;
+				}
+				break;
+		}
+	}
+	buffer += '"';
+}
+
+void Json_Writer::String(const std::string &value) {
+	String(value.c_str());
+}
+
+void Json_Writer::Number(double value, int precision) {
+	if ((isnan(value)) || (isinf(value))) {
+		Null();
+		return;
+	}
+	Separator();
+	char number[32];
+	snprintf(number, sizeof(number), "%.*f", precision, value);
+	buffer += number;
+}
+
+void Json_Writer::Integer(long long value) {
+	Separator();
+	char number[32];
+	snprintf(number, sizeof(number), "%lld", value);
+	buffer += number;
+}
+
+void Json_Writer::Boolean(bool value) {
+	Separator();
+	buffer += value ? "true" : "false";
+}
+
+void Json_Writer::Null(void) {
+	Separator();
+	buffer += "null";
+}
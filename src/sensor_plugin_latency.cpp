@@ -0,0 +1,194 @@
+// Copyright(C) 2024 by Steven Adler
+//
+// This file is part of Windows Sensor Plugin for OpenCPN.
+//
+// Windows Sensor Plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Windows Sensor Plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Windows Sensor Plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// Project: Windows Sensor Plugin
+// Description: Latency histograms for each stage from sensor report to OpenCPN
+// Owner: twocanplugin@hotmail.com
+// Date: 01/04/2024
+// Version History:
+// 1.0 Initial Release
+
+#include "sensor_plugin_latency.h"
+
+#include <math.h>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#define LATENCY_MICROSECONDS_PER_SECOND 1000000LL
+
+static const char *stageNames[LATENCY_STAGES] = { "report", "decode", "format", "push", "publish", "total" };
+
+// Index of the most significant bit set, the value must not be zero
+static unsigned int HighestBit(unsigned long long value) {
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanReverse64(&index, value);
+	return (unsigned int)index;
+#else
+	return 63 - (unsigned int)__builtin_clzll(value);
+#endif
+}
+
+Latency_Histogram::Latency_Histogram(void) {
+	Clear();
+}
+
+Latency_Histogram::~Latency_Histogram(void) {
+}
+
+void Latency_Histogram::Clear(void) {
+	for (unsigned int i = 0; i < LATENCY_BUCKETS; i++) {
+		buckets[i].store(0, std::memory_order_relaxed);
+	}
+	count.store(0, std::memory_order_relaxed);
+	maximum.store(0, std::memory_order_relaxed);
+}
+
+// Values below LATENCY_SUB_BUCKETS index directly, otherwise the octave is given by the most significant bit
+// and the sub bucket by the LATENCY_SUB_BUCKET_BITS bits that follow it
+unsigned int Latency_Histogram::BucketIndex(unsigned long long value) {
+	if (value < LATENCY_SUB_BUCKETS) {
+		return (unsigned int)value;
+	}
+	unsigned int bit = HighestBit(value);
+	unsigned int octave = bit - LATENCY_SUB_BUCKET_BITS + 1;
+	if (octave > LATENCY_OCTAVES) {
+		return LATENCY_BUCKETS - 1;
+	}
+	unsigned int subBucket = (unsigned int)(value >> (bit - LATENCY_SUB_BUCKET_BITS)) & (LATENCY_SUB_BUCKETS - 1);
+	return (octave * LATENCY_SUB_BUCKETS) + subBucket;
+}
+
+double Latency_Histogram::BucketValue(unsigned int index) {
+	unsigned int octave = index / LATENCY_SUB_BUCKETS;
+	unsigned int subBucket = index % LATENCY_SUB_BUCKETS;
+	if (octave == 0) {
+		return (double)subBucket;
+	}
+	double width = (double)(1ULL << (octave - 1));
+	return ((double)(LATENCY_SUB_BUCKETS + subBucket) * width) + (width / 2.0);
+}
+
+void Latency_Histogram::Record(unsigned long long microseconds) {
+	buckets[BucketIndex(microseconds)].fetch_add(1, std::memory_order_relaxed);
+	count.fetch_add(1, std::memory_order_relaxed);
+	// Another thread may raise the maximum between the load and the exchange, hence the loop
+	unsigned long long previous = maximum.load(std::memory_order_relaxed);
+	while ((microseconds > previous) && (!maximum.compare_exchange_weak(previous, microseconds, std::memory_order_relaxed))) {
+	}
+}
+
+unsigned long long Latency_Histogram::GetCount(void) {
+	return count.load(std::memory_order_relaxed);
+}
+
+unsigned long long Latency_Histogram::GetMaximum(void) {
+	return maximum.load(std::memory_order_relaxed);
+}
+
+double Latency_Histogram::Percentile(double percentage) {
+	// Sum the buckets rather than use count, so that a concurrent Record cannot leave the target unreachable
+	unsigned long long total = 0;
+	for (unsigned int i = 0; i < LATENCY_BUCKETS; i++) {
+		total += buckets[i].load(std::memory_order_relaxed);
+	}
+	if (total == 0) {
+		return 0.0;
+	}
+
+	unsigned long long target = (unsigned long long)ceil((percentage / 100.0) * (double)total);
+	if (target < 1) {
+		target = 1;
+	}
+
+	unsigned long long cumulative = 0;
+	for (unsigned int i = 0; i < LATENCY_BUCKETS; i++) {
+		cumulative += buckets[i].load(std::memory_order_relaxed);
+		if (cumulative >= target) {
+			// The midpoint may exceed the largest value actually recorded
+			double value = BucketValue(i);
+			double largest = (double)GetMaximum();
+			return value < largest ? value : largest;
+		}
+	}
+	return (double)GetMaximum();
+}
+
+Latency_Monitor::Latency_Monitor(void) {
+	frequency = LATENCY_MICROSECONDS_PER_SECOND;
+}
+
+Latency_Monitor::~Latency_Monitor(void) {
+}
+
+void Latency_Monitor::Reset(long long frequency) {
+	this->frequency = frequency > 0 ? frequency : LATENCY_MICROSECONDS_PER_SECOND;
+	for (unsigned int i = 0; i < LATENCY_STAGES; i++) {
+		histograms[i].Clear();
+	}
+}
+
+void Latency_Monitor::Record(LATENCY_STAGE stage, long long ticks) {
+	if (ticks < 0) {
+		return;
+	}
+	// Split so that the multiplication cannot overflow
+	long long microseconds = ((ticks / frequency) * LATENCY_MICROSECONDS_PER_SECOND) + (((ticks % frequency) * LATENCY_MICROSECONDS_PER_SECOND) / frequency);
+	histograms[stage].Record((unsigned long long)microseconds);
+}
+
+Latency_Histogram &Latency_Monitor::GetHistogram(LATENCY_STAGE stage) {
+	return histograms[stage];
+}
+
+const char *Latency_Monitor::StageName(LATENCY_STAGE stage) {
+	return stageNames[stage];
+}
+
+void Latency_Monitor::Write(Json_Writer &writer) {
+	writer.BeginObject();
+	for (unsigned int i = 0; i < LATENCY_STAGES; i++) {
+		Latency_Histogram &histogram = histograms[i];
+		writer.Key(stageNames[i]);
+		writer.BeginObject();
+		writer.Key("count");
+		writer.Integer((long long)histogram.GetCount());
+		writer.Key("p50");
+		writer.Number(histogram.Percentile(50.0) / 1000.0, 3);
+		writer.Key("p90");
+		writer.Number(histogram.Percentile(90.0) / 1000.0, 3);
+		writer.Key("p99");
+		writer.Number(histogram.Percentile(99.0) / 1000.0, 3);
+		writer.Key("max");
+		writer.Number((double)histogram.GetMaximum() / 1000.0, 3);
+		writer.EndObject();
+	}
+	writer.EndObject();
+}
+
+wxString Latency_Monitor::Summary(void) {
+	wxString summary;
+	for (unsigned int i = 0; i < LATENCY_STAGES; i++) {
+		Latency_Histogram &histogram = histograms[i];
+		summary += wxString::Format("%-8s p50 %8.3f  p90 %8.3f  p99 %8.3f  max %8.3f ms  (%llu)\n", stageNames[i],
+			histogram.Percentile(50.0) / 1000.0, histogram.Percentile(90.0) / 1000.0, histogram.Percentile(99.0) / 1000.0,
+			(double)histogram.GetMaximum() / 1000.0, histogram.GetCount());
+	}
+	return summary;
+}
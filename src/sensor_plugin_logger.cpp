@@ -0,0 +1,287 @@
+// Copyright(C) 2024 by Steven Adler
+//
+// This file is part of Windows Sensor Plugin for OpenCPN.
+//
+// Windows Sensor Plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Windows Sensor Plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Windows Sensor Plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// Project: Windows Sensor Plugin
+// Description: Asynchronous verbose log
+// Owner: twocanplugin@hotmail.com
+// Date: 01/04/2024
+// Version History:
+// 1.0 Initial Release
+
+#include "sensor_plugin_logger.h"
+#include "sensor_plugin_counters.h"
+
+#include <windows.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <chrono>
+
+// Indexed by LOG_MESSAGE
+static const char *logFormats[LOG_MESSAGES] = {
+	"NMEA Sentence: %s",
+	"Satellite Id (%lld): %lld",
+	"Satellite Azimuth (%lld): %f",
+	"Satellite Elevation (%lld): %f",
+	"Satellite SNR (%lld): %f",
+	"Epoch interval %lld ms, Turn rate %.1f",
+	"Epoch jitter mean %.2f ms, deviation %.2f ms, maximum %.2f ms, %llu epochs, %llu missed",
+	"Generated sentence: %s",
+	"%llu messages dropped"
+};
+
+Async_Logger::Async_Logger(void) {
+	for (unsigned long long i = 0; i < LOGGER_CAPACITY; i++) {
+		slots[i].sequence.store(i, std::memory_order_relaxed);
+	}
+	head.store(0, std::memory_order_relaxed);
+	tail = 0;
+	isOpen = false;
+	isRunning = false;
+	droppedCount = 0;
+	reportedDropped = 0;
+	fileSize = 0;
+}
+
+Async_Logger::~Async_Logger(void) {
+	Close();
+}
+
+bool Async_Logger::Open(const wxString &fileName) {
+	if (IsOpen()) {
+		return true;
+	}
+
+	this->fileName = fileName;
+	if (!logFile.Open(fileName, wxFile::write_append)) {
+		wxLogMessage(_T("Windows Sensor Plugin, Unable to open verbose log %s"), fileName);
+		return false;
+	}
+	fileSize = logFile.Length();
+	wxLogMessage(_T("Windows Sensor Plugin, Verbose log %s"), fileName);
+
+	isRunning = true;
+	writerThread = std::thread(&Async_Logger::WriterLoop, this);
+	isOpen = true;
+	return true;
+}
+
+// Records already in the ring are written before the file is closed
+void Async_Logger::Close(void) {
+	if (!IsOpen()) {
+		return;
+	}
+	isOpen = false;
+	isRunning = false;
+	if (writerThread.joinable()) {
+		writerThread.join();
+	}
+	logFile.Close();
+}
+
+bool Async_Logger::IsOpen(void) {
+	return isOpen.load(std::memory_order_relaxed);
+}
+
+unsigned long long Async_Logger::GetDroppedCount(void) {
+	return droppedCount.load(std::memory_order_relaxed);
+}
+
+// Claim a slot by advancing head, fill it, then publish it by advancing its sequence number.
+// A slot whose sequence number lags the position is still waiting to be read, so the ring is full.
+bool Async_Logger::Write(LOG_MESSAGE message, const char *text, unsigned int argumentCount, const LogArgument *arguments) {
+	if (!IsOpen()) {
+		return false;
+	}
+
+	LogSlot *slot;
+	unsigned long long position = head.load(std::memory_order_relaxed);
+	for (;;) {
+		slot = &slots[position & (LOGGER_CAPACITY - 1)];
+		long long difference = (long long)slot->sequence.load(std::memory_order_acquire) - (long long)position;
+		if (difference == 0) {
+			if (head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+				break;
+			}
+		}
+		else if (difference < 0) {
+			droppedCount.fetch_add(1, std::memory_order_relaxed);
+			Performance_Counters::Increment(COUNTER_LOG_DROPPED);
+			return false;
+		}
+		else {
+			position = head.load(std::memory_order_relaxed);
+		}
+	}
+
+	LogRecord &record = slot->record;
+	FILETIME now;
+	GetSystemTimePreciseAsFileTime(&now);
+	record.timeStamp = ((long long)now.dwHighDateTime << 32) | now.dwLowDateTime;
+	record.message = message;
+	record.argumentCount = argumentCount < LOGGER_MAXIMUM_ARGUMENTS ? argumentCount : LOGGER_MAXIMUM_ARGUMENTS;
+	for (unsigned int i = 0; i < record.argumentCount; i++) {
+		record.arguments[i] = arguments[i];
+	}
+	// Sentences are logged without their line ending
+	size_t length = 0;
+	if (text != NULL) {
+		while ((length < LOGGER_TEXT_LENGTH - 1) && (text[length] != '\0') && (text[length] != '\r') && (text[length] != '\n')) {
+			record.text[length] = text[length];
+			length++;
+		}
+	}
+	record.text[length] = '\0';
+
+	slot->sequence.store(position + 1, std::memory_order_release);
+	return true;
+}
+
+// Only called by the writer thread
+bool Async_Logger::Read(LogRecord &record) {
+	LogSlot &slot = slots[tail & (LOGGER_CAPACITY - 1)];
+	if (slot.sequence.load(std::memory_order_acquire) != tail + 1) {
+		return false;
+	}
+	record = slot.record;
+	// Free for the writer that wraps round to it
+	slot.sequence.store(tail + LOGGER_CAPACITY, std::memory_order_release);
+	tail++;
+	return true;
+}
+
+void Async_Logger::WriterLoop(void) {
+	std::string buffer;
+	for (;;) {
+		// Sampled before draining, so that nothing logged before Close is lost
+		bool isStopping = !isRunning.load();
+		Drain(buffer);
+		if (isStopping) {
+			break;
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(LOGGER_WRITE_INTERVAL));
+	}
+}
+
+// Format everything in the ring and append it to the file with a single write
+void Async_Logger::Drain(std::string &buffer) {
+	LogRecord record;
+	std::string line;
+	buffer.clear();
+	while (Read(record)) {
+		Format(record, line);
+		buffer += line;
+	}
+
+	unsigned long long dropped = GetDroppedCount();
+	if (dropped != reportedDropped) {
+		FILETIME now;
+		GetSystemTimePreciseAsFileTime(&now);
+		record.timeStamp = ((long long)now.dwHighDateTime << 32) | now.dwLowDateTime;
+		record.message = LOG_DROPPED;
+		record.argumentCount = 1;
+		record.arguments[0].integer = (long long)(dropped - reportedDropped);
+		record.text[0] = '\0';
+		Format(record, line);
+		buffer += line;
+		reportedDropped = dropped;
+	}
+
+	if (buffer.empty()) {
+		return;
+	}
+	if (fileSize >= LOGGER_MAXIMUM_FILE_SIZE) {
+		Rotate();
+	}
+	if (logFile.IsOpened()) {
+		logFile.Write(buffer.data(), buffer.size());
+		fileSize += buffer.size();
+	}
+}
+
+// windows_sensor.log becomes windows_sensor.log.1, and so on, the oldest is deleted
+void Async_Logger::Rotate(void) {
+	logFile.Close();
+	wxString oldest = wxString::Format(_T("%s.%d"), fileName, LOGGER_FILES);
+	if (wxFileExists(oldest)) {
+		wxRemoveFile(oldest);
+	}
+	for (int i = LOGGER_FILES - 1; i >= 1; i--) {
+		wxString previous = wxString::Format(_T("%s.%d"), fileName, i);
+		if (wxFileExists(previous)) {
+			wxRenameFile(previous, wxString::Format(_T("%s.%d"), fileName, i + 1));
+		}
+	}
+	wxRenameFile(fileName, fileName + _T(".1"));
+	logFile.Open(fileName, wxFile::write);
+	fileSize = 0;
+}
+
+// Each conversion in the format takes the next argument, or the text for %s
+void Async_Logger::Format(const LogRecord &record, std::string &line) {
+	char buffer[LOGGER_TEXT_LENGTH + 64];
+
+	FILETIME fileTime;
+	SYSTEMTIME time;
+	fileTime.dwLowDateTime = (DWORD)(record.timeStamp & 0xFFFFFFFF);
+	fileTime.dwHighDateTime = (DWORD)(record.timeStamp >> 32);
+	FileTimeToSystemTime(&fileTime, &time);
+	snprintf(buffer, sizeof(buffer), "%04d-%02d-%02d %02d:%02d:%02d.%03d ", time.wYear, time.wMonth, time.wDay,
+		time.wHour, time.wMinute, time.wSecond, time.wMilliseconds);
+	line = buffer;
+
+	const char *format = record.message < LOG_MESSAGES ? logFormats[record.message] : "Unknown message";
+	unsigned int argument = 0;
+	const char *p = format;
+	while (*p != '\0') {
+		if (*p != '%') {
+			line += *p++;
+			continue;
+		}
+		if (p[1] == '%') {
+			line += '%';
+			p += 2;
+			continue;
+		}
+
+		// The specification, up to and including its conversion character
+		const char *start = p++;
+		while ((*p != '\0') && (strchr("diuxXfFeEgGs", *p) == NULL)) {
+			p++;
+		}
+		if (*p == '\0') {
+			break;
+		}
+		char conversion = *p++;
+		std::string specification(start, p - start);
+
+		if (conversion == 's') {
+			snprintf(buffer, sizeof(buffer), specification.c_str(), record.text);
+		}
+		else if (argument >= record.argumentCount) {
+			buffer[0] = '\0';
+		}
+		else if (strchr("fFeEgG", conversion) != NULL) {
+			snprintf(buffer, sizeof(buffer), specification.c_str(), record.arguments[argument++].number);
+		}
+		else {
+			snprintf(buffer, sizeof(buffer), specification.c_str(), record.arguments[argument++].integer);
+		}
+		line += buffer;
+	}
+	line += '\n';
+}
@@ -0,0 +1,268 @@
+// Copyright(C) 2024 by Steven Adler
+//
+// This file is part of Windows Sensor Plugin for OpenCPN.
+//
+// Windows Sensor Plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Windows Sensor Plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Windows Sensor Plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// Project: Windows Sensor Plugin
+// Description: Motion sensor, roll, pitch and yaw from the inertial sensors
+// Owner: twocanplugin@hotmail.com
+// Date: 01/04/2024
+// Version History:
+// 1.0 Initial Release
+
+#include "sensor_plugin_motion.h"
+
+#include <wx/math.h>
+#include <chrono>
+
+#define MOTION_DEGREES_TO_RADIANS (M_PI / 180.0)
+
+Motion_Sensor::Motion_Sensor(void) {
+	isRunning = false;
+	sampleInterval = 0;
+	sampleCount = 0;
+	latestRoll = 0.0;
+	latestPitch = 0.0;
+	latestYaw = 0.0;
+	hasAttitude = false;
+	latestHeave = 0.0;
+	latestSignificantHeave = 0.0;
+	hasHeave = false;
+}
+
+Motion_Sensor::~Motion_Sensor(void) {
+	Stop();
+}
+
+bool Motion_Sensor::Start(void) {
+	if (isRunning) {
+		return true;
+	}
+	isRunning = true;
+	sensorThread = std::thread(&Motion_Sensor::SensorLoop, this);
+	return true;
+}
+
+void Motion_Sensor::Stop(void) {
+	isRunning = false;
+	if (sensorThread.joinable()) {
+		sensorThread.join();
+	}
+}
+
+bool Motion_Sensor::IsRunning(void) {
+	return isRunning;
+}
+
+bool Motion_Sensor::GetAttitude(double &roll, double &pitch, double &yaw) {
+	std::lock_guard<std::mutex> lock(attitudeMutex);
+	roll = latestRoll;
+	pitch = latestPitch;
+	yaw = latestYaw;
+	return hasAttitude;
+}
+
+bool Motion_Sensor::GetHeave(double &heave, double &significantHeave) {
+	std::lock_guard<std::mutex> lock(attitudeMutex);
+	heave = latestHeave;
+	significantHeave = latestSignificantHeave;
+	return hasHeave;
+}
+
+unsigned int Motion_Sensor::GetSampleInterval(void) {
+	return sampleInterval;
+}
+
+unsigned long long Motion_Sensor::GetSampleCount(void) {
+	return sampleCount;
+}
+
+// Sensor objects are created on this thread so that they belong to its COM apartment
+void Motion_Sensor::SensorLoop(void) {
+	bool isComInitialized = SUCCEEDED(CoInitializeEx(NULL, COINIT_MULTITHREADED));
+
+	ISensorManager *sensorManager = NULL;
+	ISensor *accelerometer = NULL;
+	ISensor *gyrometer = NULL;
+	ISensor *magnetometer = NULL;
+
+	HRESULT hr = CoCreateInstance(CLSID_SensorManager, 0, CLSCTX_ALL, __uuidof(ISensorManager), (void**)&sensorManager);
+	if ((hr == S_OK) && (sensorManager != NULL)) {
+		accelerometer = Orientation_Sensor::FindSensor(sensorManager, SENSOR_TYPE_ACCELEROMETER_3D);
+		gyrometer = Orientation_Sensor::FindSensor(sensorManager, SENSOR_TYPE_GYROMETER_3D);
+		magnetometer = Orientation_Sensor::FindSensor(sensorManager, SENSOR_TYPE_COMPASS_3D);
+	}
+
+	if ((accelerometer == NULL) || (gyrometer == NULL)) {
+		wxLogMessage(_T("Windows Sensor Plugin, Motion sensor requires an accelerometer and a gyrometer"));
+		if (accelerometer != NULL) {
+			accelerometer->Release();
+		}
+		if (gyrometer != NULL) {
+			gyrometer->Release();
+		}
+		if (magnetometer != NULL) {
+			magnetometer->Release();
+		}
+		if (sensorManager != NULL) {
+			sensorManager->Release();
+		}
+		if (isComInitialized) {
+			CoUninitialize();
+		}
+		isRunning = false;
+		return;
+	}
+
+	unsigned int interval = Orientation_Sensor::SetReportInterval(accelerometer, MOTION_MINIMUM_INTERVAL, MOTION_MAXIMUM_INTERVAL);
+	unsigned int gyrometerInterval = Orientation_Sensor::SetReportInterval(gyrometer, MOTION_MINIMUM_INTERVAL, MOTION_MAXIMUM_INTERVAL);
+	interval = gyrometerInterval < interval ? gyrometerInterval : interval;
+	if (magnetometer != NULL) {
+		Orientation_Sensor::SetReportInterval(magnetometer, MOTION_MAGNETOMETER_MINIMUM_INTERVAL, MOTION_MAGNETOMETER_MAXIMUM_INTERVAL);
+	}
+	sampleInterval = interval;
+	wxLogMessage(_T("Windows Sensor Plugin, Motion sensor sampling every %u ms%s"), interval,
+		magnetometer == NULL ? _T(", no magnetometer, yaw is unreferenced") : _T(""));
+
+	// The default timer resolution of 15.6 ms is too coarse for the sample interval
+	timeBeginPeriod(1);
+
+	LARGE_INTEGER frequency;
+	QueryPerformanceFrequency(&frequency);
+	LARGE_INTEGER previousSample;
+	previousSample.QuadPart = 0;
+	LARGE_INTEGER previousOutput;
+	previousOutput.QuadPart = 0;
+	long long lastAccelerometerTime = 0;
+
+	filter.Reset();
+	heaveEstimator.Reset();
+	Vector3 gyroscope = { 0.0, 0.0, 0.0 };
+	Vector3 magneticField = { 0.0, 0.0, 0.0 };
+
+	while (isRunning) {
+		ISensorDataReport *report = NULL;
+		bool isNewSample = false;
+		Vector3 acceleration;
+
+		if ((accelerometer->GetData(&report) == S_OK) && (report != NULL)) {
+			long long reportTime = Orientation_Sensor::GetTimeStamp(report);
+			if ((reportTime != lastAccelerometerTime) && (GetVector(report, SENSOR_DATA_TYPE_ACCELERATION_X_G,
+				SENSOR_DATA_TYPE_ACCELERATION_Y_G, SENSOR_DATA_TYPE_ACCELERATION_Z_G, acceleration))) {
+				lastAccelerometerTime = reportTime;
+				isNewSample = true;
+			}
+			report->Release();
+			report = NULL;
+		}
+
+		// The most recent rates and field are used with each acceleration sample
+		Vector3 value;
+		if ((gyrometer->GetData(&report) == S_OK) && (report != NULL)) {
+			if (GetVector(report, SENSOR_DATA_TYPE_ANGULAR_VELOCITY_X_DEGREES_PER_SECOND,
+				SENSOR_DATA_TYPE_ANGULAR_VELOCITY_Y_DEGREES_PER_SECOND, SENSOR_DATA_TYPE_ANGULAR_VELOCITY_Z_DEGREES_PER_SECOND, value)) {
+				// Device x right, y top edge, z out of the screen, to body x forward, y port, z up
+				gyroscope.x = value.y * MOTION_DEGREES_TO_RADIANS;
+				gyroscope.y = -value.x * MOTION_DEGREES_TO_RADIANS;
+				gyroscope.z = value.z * MOTION_DEGREES_TO_RADIANS;
+			}
+			report->Release();
+			report = NULL;
+		}
+
+		if ((magnetometer != NULL) && (magnetometer->GetData(&report) == S_OK) && (report != NULL)) {
+			if (GetVector(report, SENSOR_DATA_TYPE_MAGNETIC_FIELD_STRENGTH_X_MILLIGAUSS,
+				SENSOR_DATA_TYPE_MAGNETIC_FIELD_STRENGTH_Y_MILLIGAUSS, SENSOR_DATA_TYPE_MAGNETIC_FIELD_STRENGTH_Z_MILLIGAUSS, value)) {
+				magneticField.x = value.y;
+				magneticField.y = -value.x;
+				magneticField.z = value.z;
+			}
+			report->Release();
+			report = NULL;
+		}
+
+		if (isNewSample) {
+			LARGE_INTEGER now;
+			QueryPerformanceCounter(&now);
+			double elapsed = previousSample.QuadPart == 0 ? 0.0 : (double)(now.QuadPart - previousSample.QuadPart) / frequency.QuadPart;
+			previousSample = now;
+
+			// Windows reports gravity as -1 g on the axis facing up, the filter expects the reaction to gravity
+			Vector3 reaction;
+			reaction.x = -acceleration.y;
+			reaction.y = acceleration.x;
+			reaction.z = -acceleration.z;
+
+			if ((elapsed > 0.0) && (elapsed < MOTION_MAXIMUM_ELAPSED)) {
+				filter.Update(gyroscope, reaction, magneticField, elapsed);
+				sampleCount++;
+
+				double roll;
+				double pitch;
+				double yaw;
+				filter.GetEulerAngles(roll, pitch, yaw);
+
+				// Vertical acceleration in the earth frame, less gravity
+				Vector3 earthReaction = Madgwick_Filter::Rotate(filter.GetQuaternion(), reaction);
+				heaveEstimator.Process((earthReaction.z - 1.0) * HEAVE_GRAVITY, elapsed);
+				bool isHeaveSettled = heaveEstimator.IsSettled();
+				double heave = heaveEstimator.GetHeave();
+
+				{
+					std::lock_guard<std::mutex> lock(attitudeMutex);
+					latestRoll = roll;
+					latestPitch = pitch;
+					latestYaw = yaw;
+					hasAttitude = true;
+					if (isHeaveSettled) {
+						latestHeave = heave;
+						latestSignificantHeave = heaveEstimator.GetSignificantHeave();
+						hasHeave = true;
+					}
+				}
+
+				// $--XDR,a,x.x,a,c--c,...*hh<CR><LF>, angular displacement in degrees
+				if (((now.QuadPart - previousOutput.QuadPart) * 1000) / frequency.QuadPart >= MOTION_OUTPUT_INTERVAL) {
+					previousOutput = now;
+					Orientation_Sensor::SendSentence(wxString::Format("$IIXDR,A,%.1f,D,ROLL,A,%.1f,D,PTCH,A,%.1f,D,YAW", roll, pitch, yaw));
+					// Linear displacement in metres
+					if (isHeaveSettled) {
+						Orientation_Sensor::SendSentence(wxString::Format("$IIXDR,D,%.2f,M,HEAVE", heave));
+					}
+				}
+			}
+		}
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(interval));
+	}
+
+	timeEndPeriod(1);
+
+	accelerometer->Release();
+	gyrometer->Release();
+	if (magnetometer != NULL) {
+		magnetometer->Release();
+	}
+	sensorManager->Release();
+	if (isComInitialized) {
+		CoUninitialize();
+	}
+}
+
+bool Motion_Sensor::GetVector(ISensorDataReport *report, REFPROPERTYKEY keyX, REFPROPERTYKEY keyY, REFPROPERTYKEY keyZ, Vector3 &value) {
+	return (Orientation_Sensor::GetValue(report, keyX, value.x)) &&
+		(Orientation_Sensor::GetValue(report, keyY, value.y)) &&
+		(Orientation_Sensor::GetValue(report, keyZ, value.z));
+}
@@ -0,0 +1,179 @@
+// Copyright(C) 2024 by Steven Adler
+//
+// This file is part of Windows Sensor Plugin for OpenCPN.
+//
+// Windows Sensor Plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Windows Sensor Plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Windows Sensor Plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// Project: Windows Sensor Plugin
+// Description: NMEA 2000 output
+// Owner: twocanplugin@hotmail.com
+// Date: 01/04/2024
+// Version History:
+// 1.0 Initial Release
+
+// Refer to https://www.yachtd.com/downloads/ydwg02.pdf for the RAW protocol
+
+#include "sensor_plugin_n2k.h"
+
+#include <stdio.h>
+
+N2K_Output::N2K_Output(void) {
+	udpSocket = INVALID_SOCKET;
+	sourceAddress = N2K_DEFAULT_SOURCE;
+	format = N2K_FORMAT_TRANSMIT;
+	isRunning = false;
+	sid = 0;
+	gnssSequence = 0;
+	satelliteSequence = 0;
+	lastRapidUpdate = 0;
+	frameCount = 0;
+	datagramLength = 0;
+}
+
+N2K_Output::~N2K_Output(void) {
+	Stop();
+}
+
+bool N2K_Output::Start(const wxString &address, unsigned short port, unsigned char source, N2K_FORMAT format) {
+	if (isRunning) {
+		Stop();
+	}
+
+	WSADATA wsaData;
+	if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
+		wxLogMessage(_T("Windows Sensor Plugin, Winsock initialization failed"));
+		return false;
+	}
+
+	memset(&destination, 0, sizeof(destination));
+	destination.sin_family = AF_INET;
+	destination.sin_port = htons(port);
+	if (inet_pton(AF_INET, address.ToAscii(), &destination.sin_addr) != 1) {
+		wxLogMessage(_T("Windows Sensor Plugin, Invalid NMEA 2000 address %s"), address);
+		WSACleanup();
+		return false;
+	}
+
+	udpSocket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	if (udpSocket == INVALID_SOCKET) {
+		wxLogMessage(_T("Windows Sensor Plugin, Unable to create NMEA 2000 socket: %d"), WSAGetLastError());
+		WSACleanup();
+		return false;
+	}
+	u_long nonBlocking = 1;
+	ioctlsocket(udpSocket, FIONBIO, &nonBlocking);
+	BOOL broadcast = TRUE;
+	setsockopt(udpSocket, SOL_SOCKET, SO_BROADCAST, (const char *)&broadcast, sizeof(broadcast));
+
+	sourceAddress = source;
+	this->format = format;
+	lastRapidUpdate = 0;
+	frameCount = 0;
+	datagramLength = 0;
+	isRunning = true;
+	wxLogMessage(_T("Windows Sensor Plugin, NMEA 2000 output sending to %s:%d"), address, port);
+	return true;
+}
+
+void N2K_Output::Stop(void) {
+	if (!isRunning) {
+		return;
+	}
+	isRunning = false;
+	closesocket(udpSocket);
+	udpSocket = INVALID_SOCKET;
+	WSACleanup();
+	wxLogMessage(_T("Windows Sensor Plugin, NMEA 2000 output stopped, %llu frames sent"), frameCount);
+}
+
+bool N2K_Output::IsRunning(void) {
+	return isRunning;
+}
+
+unsigned long long N2K_Output::GetFrameCount(void) {
+	return frameCount;
+}
+
+void N2K_Output::Publish(const PositionFix &fix, const std::vector<SatelliteInformation> &satellites) {
+	if (!isRunning) {
+		return;
+	}
+
+	unsigned int length;
+	unsigned int count;
+	sid = (sid + 1) % 253;
+
+	if (fix.isValid) {
+		unsigned long long now = GetTickCount64();
+		if (now - lastRapidUpdate >= N2K_RAPID_INTERVAL) {
+			lastRapidUpdate = now;
+
+			length = N2K_Encoder::EncodePositionRapid(fix, payload);
+			count = N2K_Encoder::Segment(N2K_PGN_POSITION_RAPID, 2, sourceAddress, 0, false, payload, length, frames, N2K_FAST_PACKET_MAXIMUM_FRAMES);
+			SendFrames(frames, count);
+
+			length = N2K_Encoder::EncodeCogSogRapid(fix, sid, payload);
+			count = N2K_Encoder::Segment(N2K_PGN_COG_SOG_RAPID, 2, sourceAddress, 0, false, payload, length, frames, N2K_FAST_PACKET_MAXIMUM_FRAMES);
+			SendFrames(frames, count);
+		}
+
+		length = N2K_Encoder::EncodeGnssPosition(fix, sid, payload);
+		count = N2K_Encoder::Segment(N2K_PGN_GNSS_POSITION, 3, sourceAddress, gnssSequence, true, payload, length, frames, N2K_FAST_PACKET_MAXIMUM_FRAMES);
+		gnssSequence = (gnssSequence + 1) & 0x07;
+		SendFrames(frames, count);
+	}
+
+	length = N2K_Encoder::EncodeSatellitesInView(satellites, sid, payload);
+	count = N2K_Encoder::Segment(N2K_PGN_SATELLITES_IN_VIEW, 6, sourceAddress, satelliteSequence, true, payload, length, frames, N2K_FAST_PACKET_MAXIMUM_FRAMES);
+	satelliteSequence = (satelliteSequence + 1) & 0x07;
+	SendFrames(frames, count);
+
+	Flush();
+}
+
+// Format each frame as a Yacht Devices RAW line, 09F80100 00 01 02 03 04 05 06 07 to be transmitted,
+// or hh:mm:ss.ddd R 09F80100 00 01 02 03 04 05 06 07 as if received
+void N2K_Output::SendFrames(const CanFrame *canFrames, unsigned int count) {
+	SYSTEMTIME now;
+	GetSystemTime(&now);
+	for (unsigned int i = 0; i < count; i++) {
+		// Longest line is 50 characters
+		if (datagramLength + 64 > N2K_MAXIMUM_DATAGRAM) {
+			Flush();
+		}
+		const CanFrame &frame = canFrames[i];
+		char *line = &datagram[datagramLength];
+		int written;
+		if (format == N2K_FORMAT_RECEIVED) {
+			written = snprintf(line, N2K_MAXIMUM_DATAGRAM - datagramLength, "%02d:%02d:%02d.%03d R %08X",
+				now.wHour, now.wMinute, now.wSecond, now.wMilliseconds, frame.id);
+		}
+		else {
+			written = snprintf(line, N2K_MAXIMUM_DATAGRAM - datagramLength, "%08X", frame.id);
+		}
+		for (unsigned int j = 0; j < frame.length; j++) {
+			written += snprintf(line + written, N2K_MAXIMUM_DATAGRAM - datagramLength - written, " %02X", frame.data[j]);
+		}
+		written += snprintf(line + written, N2K_MAXIMUM_DATAGRAM - datagramLength - written, "\r\n");
+		datagramLength += written;
+		frameCount++;
+	}
+}
+
+void N2K_Output::Flush(void) {
+	if (datagramLength > 0) {
+		sendto(udpSocket, datagram, datagramLength, 0, (sockaddr *)&destination, sizeof(destination));
+		datagramLength = 0;
+	}
+}
@@ -0,0 +1,182 @@
+// Copyright(C) 2024 by Steven Adler
+//
+// This file is part of Windows Sensor Plugin for OpenCPN.
+//
+// Windows Sensor Plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Windows Sensor Plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Windows Sensor Plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// Project: Windows Sensor Plugin
+// Description: NMEA 2000 PGN encoding and fast packet segmentation
+// Owner: twocanplugin@hotmail.com
+// Date: 01/04/2024
+// Version History:
+// 1.0 Initial Release
+
+// Refer to https://canboat.github.io/canboat/canboat.html for the PGN definitions
+
+#include "sensor_plugin_n2k_encoder.h"
+
+#include <math.h>
+#include <string.h>
+
+// Values used by NMEA 2000 to indicate data not available
+#define N2K_NOT_AVAILABLE_INT32 0x7FFFFFFF
+#define N2K_NOT_AVAILABLE_UINT16 0xFFFF
+
+#define N2K_KNOTS_TO_MS 0.514444
+#define N2K_PI 3.14159265358979323846
+#define N2K_DEGREES_TO_RADIANS (N2K_PI / 180.0)
+
+// Little endian encoders, each advances the write position
+static inline void WriteByte(unsigned char *&p, unsigned char value) {
+	*p++ = value;
+}
+
+static inline void WriteUInt16(unsigned char *&p, unsigned short value) {
+	*p++ = value & 0xFF;
+	*p++ = (value >> 8) & 0xFF;
+}
+
+static inline void WriteUInt32(unsigned char *&p, unsigned int value) {
+	for (int i = 0; i < 4; i++) {
+		*p++ = (value >> (i * 8)) & 0xFF;
+	}
+}
+
+static inline void WriteUInt64(unsigned char *&p, unsigned long long value) {
+	for (int i = 0; i < 8; i++) {
+		*p++ = (value >> (i * 8)) & 0xFF;
+	}
+}
+
+// Angles are transmitted in radians with a resolution of 1e-4
+static inline unsigned short AngleToUInt16(double degrees) {
+	double radians = fmod(degrees, 360.0) * N2K_DEGREES_TO_RADIANS;
+	if (radians < 0.0) {
+		radians += 2.0 * N2K_PI;
+	}
+	return (unsigned short)lround(radians * 10000.0);
+}
+
+unsigned int N2K_Encoder::Segment(unsigned int pgn, unsigned char priority, unsigned char source, unsigned char sequence,
+	bool isFastPacket, const unsigned char *payload, unsigned int length, CanFrame *frames, unsigned int maximumFrames) {
+	// All of our PGNs are PDU2 (broadcast), so the PGN maps directly into the identifier
+	unsigned int id = ((priority & 0x07) << 26) | ((pgn & 0x3FFFF) << 8) | source;
+
+	if (!isFastPacket) {
+		if ((length > 8) || (maximumFrames == 0)) {
+			return 0;
+		}
+		frames[0].id = id;
+		frames[0].length = 8;
+		memset(frames[0].data, 0xFF, 8);
+		memcpy(frames[0].data, payload, length);
+		return 1;
+	}
+
+	if ((length > N2K_FAST_PACKET_MAXIMUM_LENGTH) || (maximumFrames == 0)) {
+		return 0;
+	}
+
+	// First frame carries the sequence, frame counter, total length and 6 data bytes,
+	// the following frames carry the sequence, frame counter and 7 data bytes.
+	unsigned int frameCount = 0;
+	unsigned int offset = 0;
+	while ((offset < length) || (frameCount == 0)) {
+		if (frameCount == maximumFrames) {
+			return 0;
+		}
+		CanFrame *frame = &frames[frameCount];
+		frame->id = id;
+		frame->length = 8;
+		memset(frame->data, 0xFF, 8);
+		frame->data[0] = ((sequence & 0x07) << 5) | (frameCount & 0x1F);
+		unsigned int start = 1;
+		if (frameCount == 0) {
+			frame->data[1] = (unsigned char)length;
+			start = 2;
+		}
+		unsigned int available = 8 - start;
+		unsigned int remaining = length - offset;
+		unsigned int copy = remaining < available ? remaining : available;
+		memcpy(&frame->data[start], &payload[offset], copy);
+		offset += copy;
+		frameCount++;
+	}
+	return frameCount;
+}
+
+// PGN 129025 Position, Rapid Update
+unsigned int N2K_Encoder::EncodePositionRapid(const PositionFix &fix, unsigned char *payload) {
+	unsigned char *p = payload;
+	WriteUInt32(p, (unsigned int)(int)llround(fix.latitude * 1e7));
+	WriteUInt32(p, (unsigned int)(int)llround(fix.longitude * 1e7));
+	return (unsigned int)(p - payload);
+}
+
+// PGN 129026 COG & SOG, Rapid Update
+unsigned int N2K_Encoder::EncodeCogSogRapid(const PositionFix &fix, unsigned char sid, unsigned char *payload) {
+	unsigned char *p = payload;
+	WriteByte(p, sid);
+	// COG reference true, 6 reserved bits
+	WriteByte(p, 0xFC);
+	WriteUInt16(p, AngleToUInt16(fix.courseOverGround));
+	WriteUInt16(p, (unsigned short)lround(fix.speedOverGround * N2K_KNOTS_TO_MS * 100.0));
+	WriteUInt16(p, N2K_NOT_AVAILABLE_UINT16);
+	return (unsigned int)(p - payload);
+}
+
+// PGN 129029 GNSS Position Data
+unsigned int N2K_Encoder::EncodeGnssPosition(const PositionFix &fix, unsigned char sid, unsigned char *payload) {
+	unsigned char *p = payload;
+	WriteByte(p, sid);
+	// Days since 1970 and seconds since midnight with a resolution of 1e-4
+	WriteUInt16(p, (unsigned short)(fix.timeStamp / 86400000LL));
+	WriteUInt32(p, (unsigned int)((fix.timeStamp % 86400000LL) * 10));
+	WriteUInt64(p, (unsigned long long)llround(fix.latitude * 1e16));
+	WriteUInt64(p, (unsigned long long)llround(fix.longitude * 1e16));
+	WriteUInt64(p, (unsigned long long)llround(fix.altitude * 1e6));
+	// GNSS type GPS, method matches the GGA fix quality, no GNSS, GNSS fix or DGNSS fix
+	WriteByte(p, (unsigned char)(((fix.fixType > 2 ? 1 : fix.fixType) << 4) | 0x00));
+	// Integrity no checking, 6 reserved bits
+	WriteByte(p, 0xFC);
+	WriteByte(p, (unsigned char)fix.satellitesInUse);
+	WriteUInt16(p, (unsigned short)(short)lround(fix.hDOP * 100.0));
+	WriteUInt16(p, (unsigned short)(short)lround(fix.pDOP * 100.0));
+	WriteUInt32(p, (unsigned int)(int)lround(fix.geoidalSeparation * 100.0));
+	// No reference stations
+	WriteByte(p, 0);
+	return (unsigned int)(p - payload);
+}
+
+// PGN 129540 GNSS Satellites in View
+unsigned int N2K_Encoder::EncodeSatellitesInView(const std::vector<SatelliteInformation> &satellites, unsigned char sid, unsigned char *payload) {
+	unsigned char *p = payload;
+	size_t count = satellites.size() < N2K_MAXIMUM_SATELLITES ? satellites.size() : N2K_MAXIMUM_SATELLITES;
+	WriteByte(p, sid);
+	// Range residual mode not available, 6 reserved bits
+	WriteByte(p, 0xFF);
+	WriteByte(p, (unsigned char)count);
+	for (size_t i = 0; i < count; i++) {
+		const SatelliteInformation &satellite = satellites[i];
+		WriteByte(p, (unsigned char)satellite.id);
+		WriteUInt16(p, (unsigned short)(short)lround(satellite.elevation * N2K_DEGREES_TO_RADIANS * 10000.0));
+		WriteUInt16(p, AngleToUInt16(satellite.azimuth));
+		WriteUInt16(p, (unsigned short)lround(satellite.snr * 100.0));
+		WriteUInt32(p, N2K_NOT_AVAILABLE_INT32);
+		// The sensor does not report which satellites are used, as per the gpsd output assume those with a signal are.
+		// Status used or not tracked, 4 reserved bits
+		WriteByte(p, satellite.snr > 0.0 ? 0xF2 : 0xF0);
+	}
+	return (unsigned int)(p - payload);
+}
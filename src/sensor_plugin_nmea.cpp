@@ -0,0 +1,542 @@
+// Copyright(C) 2024 by Steven Adler
+//
+// This file is part of Windows Sensor Plugin for OpenCPN.
+//
+// Windows Sensor Plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Windows Sensor Plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Windows Sensor Plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// Project: Windows Sensor Plugin
+// Description: Zero allocation NMEA 0183 parser
+// Owner: twocanplugin@hotmail.com
+// Date: 01/04/2024
+// Version History:
+// 1.0 Initial Release
+
+#include "sensor_plugin_nmea.h"
+
+#include <string.h>
+
+int NMEA_Parser::HexValue(char c) {
+	if ((c >= '0') && (c <= '9')) {
+		return c - '0';
+	}
+	if ((c >= 'A') && (c <= 'F')) {
+		return c - 'A' + 10;
+	}
+	if ((c >= 'a') && (c <= 'f')) {
+		return c - 'a' + 10;
+	}
+	return -1;
+}
+
+bool NMEA_Parser::Split(const char *sentence, size_t length, NmeaField *fields, unsigned int maximumFields, unsigned int &fieldCount) {
+	fieldCount = 0;
+
+	// Ignore the line terminator and anything after a null
+	const char *terminator = (const char *)memchr(sentence, '\0', length);
+	if (terminator != NULL) {
+		length = terminator - sentence;
+	}
+	while ((length > 0) && ((sentence[length - 1] == '\r') || (sentence[length - 1] == '\n'))) {
+		length--;
+	}
+
+	if ((length < 6) || (length > NMEA_MAXIMUM_LENGTH) || ((sentence[0] != '$') && (sentence[0] != '!'))) {
+		return false;
+	}
+
+	// The checksum is optional for some sentences, but if present must be correct
+	const char *start = sentence + 1;
+	const char *end = sentence + length;
+	const char *asterisk = (const char *)memchr(start, '*', end - start);
+	if (asterisk != NULL) {
+		if (end - asterisk != 3) {
+			return false;
+		}
+		int high = HexValue(asterisk[1]);
+		int low = HexValue(asterisk[2]);
+		if ((high < 0) || (low < 0)) {
+			return false;
+		}
+		unsigned char checksum = 0;
+		for (const char *c = start; c < asterisk; c++) {
+			checksum ^= (unsigned char)*c;
+		}
+		if (checksum != ((high << 4) | low)) {
+			return false;
+		}
+		end = asterisk;
+	}
+
+	// Locate each comma
+	while (fieldCount < maximumFields) {
+		const char *comma = (const char *)memchr(start, ',', end - start);
+		const char *fieldEnd = comma != NULL ? comma : end;
+		fields[fieldCount].data = start;
+		fields[fieldCount].length = (unsigned int)(fieldEnd - start);
+		fieldCount++;
+		if (comma == NULL) {
+			return true;
+		}
+		start = comma + 1;
+	}
+	// Too many fields
+	return false;
+}
+
+bool NMEA_Parser::Parse(const char *sentence, size_t length, NmeaSentence &result) {
+	NmeaField fields[NMEA_MAXIMUM_FIELDS];
+	unsigned int fieldCount;
+
+	result.type = NMEA_INVALID;
+	if (!Split(sentence, length, fields, NMEA_MAXIMUM_FIELDS, fieldCount)) {
+		return false;
+	}
+
+	// Address is a two character talker and three character sentence formatter, eg. GPRMC,
+	// except for proprietary sentences which are a P followed by a manufacturer's own format, eg. PSRFTXT
+	const NmeaField &address = fields[0];
+	if ((address.length >= 2) && (address.data[0] == 'P')) {
+		result.type = NMEA_UNKNOWN;
+		result.talker[0] = 'P';
+		result.talker[1] = '\0';
+		return false;
+	}
+	if (address.length != 5) {
+		return false;
+	}
+	result.type = NMEA_UNKNOWN;
+	result.talker[0] = address.data[0];
+	result.talker[1] = address.data[1];
+	result.talker[2] = '\0';
+
+	const char *formatter = address.data + 2;
+	if (memcmp(formatter, "RMC", 3) == 0) {
+		result.type = NMEA_RMC;
+		return ParseRMC(fields, fieldCount, result.rmc);
+	}
+	if (memcmp(formatter, "GGA", 3) == 0) {
+		result.type = NMEA_GGA;
+		return ParseGGA(fields, fieldCount, result.gga);
+	}
+	if (memcmp(formatter, "GLL", 3) == 0) {
+		result.type = NMEA_GLL;
+		return ParseGLL(fields, fieldCount, result.gll);
+	}
+	if (memcmp(formatter, "GSA", 3) == 0) {
+		result.type = NMEA_GSA;
+		return ParseGSA(fields, fieldCount, result.gsa);
+	}
+	if (memcmp(formatter, "GSV", 3) == 0) {
+		result.type = NMEA_GSV;
+		return ParseGSV(fields, fieldCount, result.gsv);
+	}
+	if (memcmp(formatter, "VTG", 3) == 0) {
+		result.type = NMEA_VTG;
+		return ParseVTG(fields, fieldCount, result.vtg);
+	}
+	if (memcmp(formatter, "HDT", 3) == 0) {
+		result.type = NMEA_HDT;
+		return ParseHDT(fields, fieldCount, result.hdt);
+	}
+	if (memcmp(formatter, "ZDA", 3) == 0) {
+		result.type = NMEA_ZDA;
+		return ParseZDA(fields, fieldCount, result.zda);
+	}
+	return false;
+}
+
+// Decimal number with an optional sign and fraction, no exponent as NMEA 0183 does not use them
+bool NMEA_Parser::ToDouble(const NmeaField &field, double &value) {
+	const char *c = field.data;
+	const char *end = field.data + field.length;
+	if (c == end) {
+		return false;
+	}
+
+	bool isNegative = false;
+	if ((*c == '-') || (*c == '+')) {
+		isNegative = (*c == '-');
+		c++;
+	}
+
+	double result = 0.0;
+	bool hasDigits = false;
+	while ((c < end) && (*c >= '0') && (*c <= '9')) {
+		result = (result * 10.0) + (*c - '0');
+		hasDigits = true;
+		c++;
+	}
+	if ((c < end) && (*c == '.')) {
+		c++;
+		double scale = 0.1;
+		while ((c < end) && (*c >= '0') && (*c <= '9')) {
+			result += (*c - '0') * scale;
+			scale *= 0.1;
+			hasDigits = true;
+			c++;
+		}
+	}
+	if ((!hasDigits) || (c != end)) {
+		return false;
+	}
+	value = isNegative ? -result : result;
+	return true;
+}
+
+bool NMEA_Parser::ToUnsigned(const NmeaField &field, unsigned int &value) {
+	if (field.length == 0) {
+		return false;
+	}
+	unsigned int result = 0;
+	for (unsigned int i = 0; i < field.length; i++) {
+		char c = field.data[i];
+		if ((c < '0') || (c > '9')) {
+			return false;
+		}
+		result = (result * 10) + (c - '0');
+	}
+	value = result;
+	return true;
+}
+
+bool NMEA_Parser::ToChar(const NmeaField &field, char &value) {
+	if (field.length != 1) {
+		return false;
+	}
+	value = field.data[0];
+	return true;
+}
+
+// hhmmss.ss
+bool NMEA_Parser::ToTime(const NmeaField &field, NmeaTime &value) {
+	value.isValid = false;
+	if (field.length < 6) {
+		return false;
+	}
+	NmeaField hours = { field.data, 2 };
+	NmeaField minutes = { field.data + 2, 2 };
+	NmeaField seconds = { field.data + 4, field.length - 4 };
+	unsigned int h;
+	unsigned int m;
+	if ((!ToUnsigned(hours, h)) || (!ToUnsigned(minutes, m)) || (!ToDouble(seconds, value.seconds))) {
+		return false;
+	}
+	if ((h > 23) || (m > 59) || (value.seconds >= 61.0)) {
+		return false;
+	}
+	value.hours = h;
+	value.minutes = m;
+	value.isValid = true;
+	return true;
+}
+
+// ddmmyy
+bool NMEA_Parser::ToDate(const NmeaField &field, NmeaDate &value) {
+	value.isValid = false;
+	if (field.length != 6) {
+		return false;
+	}
+	NmeaField day = { field.data, 2 };
+	NmeaField month = { field.data + 2, 2 };
+	NmeaField year = { field.data + 4, 2 };
+	unsigned int d;
+	unsigned int m;
+	unsigned int y;
+	if ((!ToUnsigned(day, d)) || (!ToUnsigned(month, m)) || (!ToUnsigned(year, y))) {
+		return false;
+	}
+	if ((d < 1) || (d > 31) || (m < 1) || (m > 12)) {
+		return false;
+	}
+	value.day = d;
+	value.month = m;
+	value.year = 2000 + y;
+	value.isValid = true;
+	return true;
+}
+
+bool NMEA_Parser::ToCoordinate(const NmeaField &field, const NmeaField &hemisphere, double &value) {
+	double raw;
+	char direction;
+	if ((!ToDouble(field, raw)) || (!ToChar(hemisphere, direction))) {
+		return false;
+	}
+	double degrees = (double)(int)(raw / 100.0);
+	double minutes = raw - (degrees * 100.0);
+	if (minutes >= 60.0) {
+		return false;
+	}
+	value = degrees + (minutes / 60.0);
+	if ((direction == 'S') || (direction == 'W')) {
+		value = -value;
+	}
+	else if ((direction != 'N') && (direction != 'E')) {
+		return false;
+	}
+	return true;
+}
+
+// $--RMC,hhmmss.ss,A,llll.ll,a,yyyyy.yy,a,x.x,x.x,xxxxxx,x.x,a,a*hh
+bool NMEA_Parser::ParseRMC(const NmeaField *fields, unsigned int fieldCount, NmeaRMC &rmc) {
+	if (fieldCount < 12) {
+		return false;
+	}
+	char status = 'V';
+	ToTime(fields[1], rmc.time);
+	ToChar(fields[2], status);
+	rmc.isActive = (status == 'A');
+	rmc.position.isValid = (ToCoordinate(fields[3], fields[4], rmc.position.latitude)) &&
+		(ToCoordinate(fields[5], fields[6], rmc.position.longitude));
+	if (!ToDouble(fields[7], rmc.speedOverGround)) {
+		rmc.speedOverGround = 0.0;
+	}
+	rmc.isCourseValid = ToDouble(fields[8], rmc.courseOverGround);
+	ToDate(fields[9], rmc.date);
+	char direction;
+	rmc.isVariationValid = (ToDouble(fields[10], rmc.magneticVariation)) && (ToChar(fields[11], direction));
+	if ((rmc.isVariationValid) && (direction == 'W')) {
+		rmc.magneticVariation = -rmc.magneticVariation;
+	}
+	// Mode indicator was added in NMEA 0183 version 2.3
+	rmc.mode = 'A';
+	if (fieldCount > 12) {
+		ToChar(fields[12], rmc.mode);
+	}
+	return true;
+}
+
+// $--GGA,hhmmss.ss,llll.ll,a,yyyyy.yy,a,x,xx,x.x,x.x,M,x.x,M,x.x,xxxx*hh
+bool NMEA_Parser::ParseGGA(const NmeaField *fields, unsigned int fieldCount, NmeaGGA &gga) {
+	if (fieldCount < 15) {
+		return false;
+	}
+	ToTime(fields[1], gga.time);
+	gga.position.isValid = (ToCoordinate(fields[2], fields[3], gga.position.latitude)) &&
+		(ToCoordinate(fields[4], fields[5], gga.position.longitude));
+	if (!ToUnsigned(fields[6], gga.quality)) {
+		gga.quality = 0;
+	}
+	if (!ToUnsigned(fields[7], gga.satellitesInUse)) {
+		gga.satellitesInUse = 0;
+	}
+	if (!ToDouble(fields[8], gga.hDOP)) {
+		gga.hDOP = 0.0;
+	}
+	gga.isAltitudeValid = ToDouble(fields[9], gga.altitude);
+	if (!ToDouble(fields[11], gga.geoidalSeparation)) {
+		gga.geoidalSeparation = 0.0;
+	}
+	if (!ToDouble(fields[13], gga.dgpsAge)) {
+		gga.dgpsAge = 0.0;
+	}
+	if (!ToUnsigned(fields[14], gga.dgpsReferenceId)) {
+		gga.dgpsReferenceId = 0;
+	}
+	return true;
+}
+
+// $--GLL,llll.ll,a,yyyyy.yy,a,hhmmss.ss,A,a*hh
+bool NMEA_Parser::ParseGLL(const NmeaField *fields, unsigned int fieldCount, NmeaGLL &gll) {
+	if (fieldCount < 7) {
+		return false;
+	}
+	gll.position.isValid = (ToCoordinate(fields[1], fields[2], gll.position.latitude)) &&
+		(ToCoordinate(fields[3], fields[4], gll.position.longitude));
+	ToTime(fields[5], gll.time);
+	char status = 'V';
+	ToChar(fields[6], status);
+	gll.isActive = (status == 'A');
+	gll.mode = 'A';
+	if (fieldCount > 7) {
+		ToChar(fields[7], gll.mode);
+	}
+	return true;
+}
+
+// $--GSA,a,x,xx,xx,xx,xx,xx,xx,xx,xx,xx,xx,xx,xx,x.x,x.x,x.x*hh
+bool NMEA_Parser::ParseGSA(const NmeaField *fields, unsigned int fieldCount, NmeaGSA &gsa) {
+	if (fieldCount < 18) {
+		return false;
+	}
+	if (!ToChar(fields[1], gsa.selectionMode)) {
+		gsa.selectionMode = 'A';
+	}
+	if (!ToUnsigned(fields[2], gsa.fixMode)) {
+		gsa.fixMode = 1;
+	}
+	gsa.satelliteCount = 0;
+	for (unsigned int i = 0; i < NMEA_GSA_SATELLITES; i++) {
+		if (ToUnsigned(fields[3 + i], gsa.satellites[gsa.satelliteCount])) {
+			gsa.satelliteCount++;
+		}
+	}
+	if (!ToDouble(fields[15], gsa.pDOP)) {
+		gsa.pDOP = 0.0;
+	}
+	if (!ToDouble(fields[16], gsa.hDOP)) {
+		gsa.hDOP = 0.0;
+	}
+	if (!ToDouble(fields[17], gsa.vDOP)) {
+		gsa.vDOP = 0.0;
+	}
+	return true;
+}
+
+// $--GSV,x,x,x,x,x,x,x,...*hh, up to four satellites of id, elevation, azimuth and snr
+bool NMEA_Parser::ParseGSV(const NmeaField *fields, unsigned int fieldCount, NmeaGSV &gsv) {
+	if (fieldCount < 4) {
+		return false;
+	}
+	if ((!ToUnsigned(fields[1], gsv.totalSentences)) || (!ToUnsigned(fields[2], gsv.sentenceNumber)) ||
+		(!ToUnsigned(fields[3], gsv.satellitesInView))) {
+		return false;
+	}
+	gsv.satelliteCount = 0;
+	for (unsigned int i = 4; (i + 3 < fieldCount) && (gsv.satelliteCount < NMEA_GSV_SATELLITES); i += 4) {
+		SatelliteInformation &satellite = gsv.satellites[gsv.satelliteCount];
+		if (!ToUnsigned(fields[i], satellite.id)) {
+			continue;
+		}
+		if (!ToDouble(fields[i + 1], satellite.elevation)) {
+			satellite.elevation = 0.0;
+		}
+		if (!ToDouble(fields[i + 2], satellite.azimuth)) {
+			satellite.azimuth = 0.0;
+		}
+		// Null if the satellite is not being tracked
+		if (!ToDouble(fields[i + 3], satellite.snr)) {
+			satellite.snr = 0.0;
+		}
+		gsv.satelliteCount++;
+	}
+	return true;
+}
+
+// $--VTG,x.x,T,x.x,M,x.x,N,x.x,K,a*hh
+bool NMEA_Parser::ParseVTG(const NmeaField *fields, unsigned int fieldCount, NmeaVTG &vtg) {
+	if (fieldCount < 9) {
+		return false;
+	}
+	vtg.isCourseTrueValid = ToDouble(fields[1], vtg.courseTrue);
+	vtg.isCourseMagneticValid = ToDouble(fields[3], vtg.courseMagnetic);
+	vtg.isSpeedValid = ToDouble(fields[5], vtg.speedKnots);
+	if (!vtg.isSpeedValid) {
+		double speedKmh;
+		vtg.isSpeedValid = ToDouble(fields[7], speedKmh);
+		vtg.speedKnots = speedKmh / 1.852;
+	}
+	vtg.mode = 'A';
+	if (fieldCount > 9) {
+		ToChar(fields[9], vtg.mode);
+	}
+	return true;
+}
+
+// $--HDT,x.x,T*hh
+bool NMEA_Parser::ParseHDT(const NmeaField *fields, unsigned int fieldCount, NmeaHDT &hdt) {
+	if (fieldCount < 3) {
+		return false;
+	}
+	hdt.isValid = ToDouble(fields[1], hdt.heading);
+	return true;
+}
+
+// $--ZDA,hhmmss.ss,xx,xx,xxxx,xx,xx*hh
+bool NMEA_Parser::ParseZDA(const NmeaField *fields, unsigned int fieldCount, NmeaZDA &zda) {
+	if (fieldCount < 5) {
+		return false;
+	}
+	ToTime(fields[1], zda.time);
+	unsigned int day;
+	unsigned int month;
+	unsigned int year;
+	zda.date.isValid = (ToUnsigned(fields[2], day)) && (ToUnsigned(fields[3], month)) && (ToUnsigned(fields[4], year)) &&
+		(day >= 1) && (day <= 31) && (month >= 1) && (month <= 12);
+	if (zda.date.isValid) {
+		zda.date.day = day;
+		zda.date.month = month;
+		zda.date.year = year;
+	}
+	return true;
+}
+
+std::atomic<unsigned long long> NMEA_Echo_Filter::hashes[NMEA_ECHO_SLOTS];
+std::atomic<unsigned int> NMEA_Echo_Filter::nextSlot(0);
+
+// FNV-1a of the sentence, without the line terminator which OpenCPN may remove. Zero marks an empty slot.
+unsigned long long NMEA_Echo_Filter::Hash(const char *sentence, size_t length) {
+	while ((length > 0) && ((sentence[length - 1] == '\r') || (sentence[length - 1] == '\n'))) {
+		length--;
+	}
+	unsigned long long hash = 14695981039346656037ULL;
+	for (size_t i = 0; i < length; i++) {
+		hash ^= (unsigned char)sentence[i];
+		hash *= 1099511628211ULL;
+	}
+	return hash != 0 ? hash : 1;
+}
+
+void NMEA_Echo_Filter::Add(const char *sentence, size_t length) {
+	unsigned int slot = nextSlot.fetch_add(1, std::memory_order_relaxed) % NMEA_ECHO_SLOTS;
+	hashes[slot].store(Hash(sentence, length), std::memory_order_relaxed);
+}
+
+bool NMEA_Echo_Filter::IsEcho(const char *sentence, size_t length) {
+	unsigned long long hash = Hash(sentence, length);
+	for (unsigned int i = 0; i < NMEA_ECHO_SLOTS; i++) {
+		if (hashes[i].load(std::memory_order_relaxed) == hash) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void GSV_Assembler::Clear(void) {
+	talkers.clear();
+}
+
+bool GSV_Assembler::Add(const char *talker, const NmeaGSV &gsv, long long now) {
+	std::vector<TalkerSatellites>::iterator it = talkers.begin();
+	while ((it != talkers.end()) && (memcmp(it->talker, talker, 2) != 0)) {
+		++it;
+	}
+	if (it == talkers.end()) {
+		TalkerSatellites added;
+		memcpy(added.talker, talker, sizeof(added.talker));
+		added.completeTime = 0;
+		it = talkers.insert(talkers.end(), added);
+	}
+
+	// Satellites span a sequence of sentences
+	if (gsv.sentenceNumber == 1) {
+		it->pending.clear();
+	}
+	it->pending.insert(it->pending.end(), gsv.satellites, gsv.satellites + gsv.satelliteCount);
+	if (gsv.sentenceNumber != gsv.totalSentences) {
+		return false;
+	}
+	it->satellites.swap(it->pending);
+	it->pending.clear();
+	it->completeTime = now;
+	return true;
+}
+
+void GSV_Assembler::Merge(long long now, std::vector<SatelliteInformation> &satellites) {
+	satellites.clear();
+	for (std::vector<TalkerSatellites>::iterator it = talkers.begin(); it != talkers.end(); ++it) {
+		if ((it->completeTime != 0) && (now - it->completeTime < NMEA_SATELLITE_TIMEOUT)) {
+			satellites.insert(satellites.end(), it->satellites.begin(), it->satellites.end());
+		}
+	}
+}
@@ -0,0 +1,228 @@
+// Copyright(C) 2024 by Steven Adler
+//
+// This file is part of Windows Sensor Plugin for OpenCPN.
+//
+// Windows Sensor Plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Windows Sensor Plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Windows Sensor Plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// Project: Windows Sensor Plugin
+// Description: NTP shared memory reference clock
+// Owner: twocanplugin@hotmail.com
+// Date: 01/04/2024
+// Version History:
+// 1.0 Initial Release
+
+// Refer to https://doc.ntp.org/documentation/drivers/driver28/
+
+#include "sensor_plugin_ntp.h"
+
+
+// 100 nanosecond intervals
+#define NTP_TICKS_PER_SECOND 10000000LL
+#define NTP_TICKS_PER_DAY (86400LL * NTP_TICKS_PER_SECOND)
+// Days between 1601-01-01 and 1970-01-01
+#define NTP_FILETIME_EPOCH_DAYS 134774LL
+
+NTP_Reference_Clock::NTP_Reference_Clock(void) {
+	mappingHandle = NULL;
+	segment = nullptr;
+	lastClockTime = 0;
+	sampleCount = 0;
+	isTimeMissingLogged = false;
+}
+
+NTP_Reference_Clock::~NTP_Reference_Clock(void) {
+	Close();
+}
+
+bool NTP_Reference_Clock::Open(int unit) {
+	if (IsOpen()) {
+		Close();
+	}
+
+	// ntpd runs as a service in session 0, so the segment must be in the global namespace.
+	// ntpd normally creates it, otherwise creating it requires the SeCreateGlobalPrivilege.
+	wxString segmentName = wxString::Format(_T("Global\\NTP%d"), unit);
+	mappingHandle = OpenFileMapping(FILE_MAP_WRITE, FALSE, segmentName.wc_str());
+	if (mappingHandle == NULL) {
+		mappingHandle = CreateFileMapping(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, sizeof(NtpShmTime), segmentName.wc_str());
+	}
+	if (mappingHandle == NULL) {
+		wxLogMessage(_T("Windows Sensor Plugin, NTP segment %s unavailable: %lu"), segmentName, GetLastError());
+		return false;
+	}
+
+	segment = (NtpShmTime *)MapViewOfFile(mappingHandle, FILE_MAP_WRITE, 0, 0, sizeof(NtpShmTime));
+	if (segment == nullptr) {
+		wxLogMessage(_T("Windows Sensor Plugin, NTP segment %s mapping failed: %lu"), segmentName, GetLastError());
+		CloseHandle(mappingHandle);
+		mappingHandle = NULL;
+		return false;
+	}
+
+	lastClockTime = 0;
+	isTimeMissingLogged = false;
+	wxLogMessage(_T("Windows Sensor Plugin, NTP reference clock using segment %s"), segmentName);
+	return true;
+}
+
+void NTP_Reference_Clock::Close(void) {
+	if (segment != nullptr) {
+		segment->valid = 0;
+		UnmapViewOfFile(segment);
+		segment = nullptr;
+	}
+	if (mappingHandle != NULL) {
+		CloseHandle(mappingHandle);
+		mappingHandle = NULL;
+	}
+}
+
+bool NTP_Reference_Clock::IsOpen(void) {
+	return (segment != nullptr);
+}
+
+unsigned long long NTP_Reference_Clock::GetSampleCount(void) {
+	return sampleCount;
+}
+
+bool NTP_Reference_Clock::Post(const std::string &sentence, const ReceiveTime &receiveTime) {
+	if (segment == nullptr) {
+		return false;
+	}
+
+	long long clockTime;
+	if (!ParseTime(sentence, receiveTime.realtime, clockTime)) {
+		if (!isTimeMissingLogged) {
+			wxLogMessage(_T("Windows Sensor Plugin, Sensor does not report GNSS time, NTP reference clock unavailable"));
+			isTimeMissingLogged = true;
+		}
+		return false;
+	}
+
+	// The sensor repeats its last report until a new fix arrives
+	if (clockTime == lastClockTime) {
+		return false;
+	}
+	lastClockTime = clockTime;
+
+	// A stale sample is worse than none
+	LARGE_INTEGER now;
+	LARGE_INTEGER frequency;
+	QueryPerformanceCounter(&now);
+	QueryPerformanceFrequency(&frequency);
+	if (((now.QuadPart - receiveTime.monotonic) * 1000) / frequency.QuadPart > NTP_MAXIMUM_AGE_MILLISECONDS) {
+		return false;
+	}
+
+	// Convert to seconds and nanoseconds since 1970
+	long long clockTicks = clockTime - (NTP_FILETIME_EPOCH_DAYS * NTP_TICKS_PER_DAY);
+	long long receiveTicks = receiveTime.realtime - (NTP_FILETIME_EPOCH_DAYS * NTP_TICKS_PER_DAY);
+
+	// Mode 1, ntpd discards the sample if count changes whilst it is reading
+	segment->valid = 0;
+	segment->count++;
+	MemoryBarrier();
+	segment->mode = 1;
+	segment->clockTimeStampSec = (time_t)(clockTicks / NTP_TICKS_PER_SECOND);
+	segment->clockTimeStampUSec = (int)((clockTicks % NTP_TICKS_PER_SECOND) / 10);
+	segment->clockTimeStampNSec = (unsigned int)((clockTicks % NTP_TICKS_PER_SECOND) * 100);
+	segment->receiveTimeStampSec = (time_t)(receiveTicks / NTP_TICKS_PER_SECOND);
+	segment->receiveTimeStampUSec = (int)((receiveTicks % NTP_TICKS_PER_SECOND) / 10);
+	segment->receiveTimeStampNSec = (unsigned int)((receiveTicks % NTP_TICKS_PER_SECOND) * 100);
+	// Leap second warnings are not available from the sensor
+	segment->leap = 0;
+	segment->precision = NTP_PRECISION;
+	segment->nsamples = 3;
+	MemoryBarrier();
+	segment->count++;
+	segment->valid = 1;
+
+	sampleCount++;
+	return true;
+}
+
+// Days since 1970-01-01 of a proleptic Gregorian date
+// Refer to http://howardhinnant.github.io/date_algorithms.html
+long long NTP_Reference_Clock::DaysFromCivil(int year, int month, int day) {
+	year -= month <= 2;
+	long long era = (year >= 0 ? year : year - 399) / 400;
+	long long yearOfEra = year - era * 400;
+	long long dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+	long long dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+	return era * 146097 + dayOfEra - 719468;
+}
+
+bool NTP_Reference_Clock::ParseTime(const std::string &sentence, long long receiveTime, long long &clockTime) {
+	// Time is taken from RMC, ZDA, GGA or GLL, the latter two carry no date
+	NmeaSentence decoded;
+	if (!NMEA_Parser::Parse(sentence.data(), sentence.size(), decoded)) {
+		return false;
+	}
+
+	const NmeaTime *timeOfDay;
+	const NmeaDate *date = NULL;
+	switch (decoded.type) {
+		case NMEA_RMC:
+			if ((!decoded.rmc.isActive) || (!decoded.rmc.date.isValid)) {
+				return false;
+			}
+			timeOfDay = &decoded.rmc.time;
+			date = &decoded.rmc.date;
+			break;
+		case NMEA_ZDA:
+			if (!decoded.zda.date.isValid) {
+				return false;
+			}
+			timeOfDay = &decoded.zda.time;
+			date = &decoded.zda.date;
+			break;
+		case NMEA_GGA:
+			if (decoded.gga.quality == 0) {
+				return false;
+			}
+			timeOfDay = &decoded.gga.time;
+			break;
+		case NMEA_GLL:
+			if (!decoded.gll.isActive) {
+				return false;
+			}
+			timeOfDay = &decoded.gll.time;
+			break;
+		default:
+			return false;
+	}
+
+	if (!timeOfDay->isValid) {
+		return false;
+	}
+	int hours = timeOfDay->hours;
+	int minutes = timeOfDay->minutes;
+	double seconds = timeOfDay->seconds;
+	long long timeTicks = ((hours * 3600LL) + (minutes * 60LL)) * NTP_TICKS_PER_SECOND + (long long)(seconds * NTP_TICKS_PER_SECOND + 0.5);
+
+	if (date != NULL) {
+		clockTime = (DaysFromCivil(date->year, date->month, date->day) + NTP_FILETIME_EPOCH_DAYS) * NTP_TICKS_PER_DAY + timeTicks;
+	}
+	else {
+		// No date, use the day the sentence was received, allowing for midnight having passed either way
+		clockTime = (receiveTime / NTP_TICKS_PER_DAY) * NTP_TICKS_PER_DAY + timeTicks;
+		if (clockTime - receiveTime > NTP_TICKS_PER_DAY / 2) {
+			clockTime -= NTP_TICKS_PER_DAY;
+		}
+		else if (receiveTime - clockTime > NTP_TICKS_PER_DAY / 2) {
+			clockTime += NTP_TICKS_PER_DAY;
+		}
+	}
+	return true;
+}
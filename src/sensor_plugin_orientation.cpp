@@ -0,0 +1,319 @@
+// Copyright(C) 2024 by Steven Adler
+//
+// This file is part of Windows Sensor Plugin for OpenCPN.
+//
+// Windows Sensor Plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Windows Sensor Plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Windows Sensor Plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// Project: Windows Sensor Plugin
+// Description: Compass and orientation sensors
+// Owner: twocanplugin@hotmail.com
+// Date: 01/04/2024
+// Version History:
+// 1.0 Initial Release
+
+// Refer to https://learn.microsoft.com/en-us/windows/win32/sensorsapi/sensor-categories--types--and-data-fields
+
+#include "sensor_plugin_orientation.h"
+#include "sensor_plugin_nmea.h"
+
+#include <chrono>
+#include <string>
+
+Orientation_Sensor::Orientation_Sensor(void) {
+	isRunning = false;
+	reportInterval = 0;
+	magneticVariation = 0.0;
+	isVariationValid = false;
+	latestMagneticHeading = 0.0;
+	latestTrueHeading = 0.0;
+	hasHeading = false;
+}
+
+Orientation_Sensor::~Orientation_Sensor(void) {
+	Stop();
+}
+
+bool Orientation_Sensor::Start(void) {
+	if (isRunning) {
+		return true;
+	}
+	isRunning = true;
+	sensorThread = std::thread(&Orientation_Sensor::SensorLoop, this);
+	return true;
+}
+
+void Orientation_Sensor::Stop(void) {
+	isRunning = false;
+	if (sensorThread.joinable()) {
+		sensorThread.join();
+	}
+}
+
+bool Orientation_Sensor::IsRunning(void) {
+	return isRunning;
+}
+
+void Orientation_Sensor::SetMagneticVariation(double variation, bool isValid) {
+	std::lock_guard<std::mutex> lock(headingMutex);
+	magneticVariation = variation;
+	isVariationValid = isValid;
+}
+
+bool Orientation_Sensor::GetHeading(double &magneticHeading, double &trueHeading) {
+	std::lock_guard<std::mutex> lock(headingMutex);
+	magneticHeading = latestMagneticHeading;
+	trueHeading = latestTrueHeading;
+	return hasHeading;
+}
+
+unsigned int Orientation_Sensor::GetReportInterval(void) {
+	return reportInterval;
+}
+
+// Sensor objects are created on this thread so that they belong to its COM apartment
+void Orientation_Sensor::SensorLoop(void) {
+	bool isComInitialized = SUCCEEDED(CoInitializeEx(NULL, COINIT_MULTITHREADED));
+
+	ISensorManager *sensorManager = NULL;
+	ISensor *compass = NULL;
+	ISensor *gyrometer = NULL;
+
+	HRESULT hr = CoCreateInstance(CLSID_SensorManager, 0, CLSCTX_ALL, __uuidof(ISensorManager), (void**)&sensorManager);
+	if ((hr == S_OK) && (sensorManager != NULL)) {
+		compass = FindSensor(sensorManager, SENSOR_TYPE_COMPASS_3D);
+		gyrometer = FindSensor(sensorManager, SENSOR_TYPE_GYROMETER_3D);
+	}
+
+	if ((compass == NULL) && (gyrometer == NULL)) {
+		wxLogMessage(_T("Windows Sensor Plugin, No compass or gyrometer found"));
+		if (sensorManager != NULL) {
+			sensorManager->Release();
+		}
+		if (isComInitialized) {
+			CoUninitialize();
+		}
+		isRunning = false;
+		return;
+	}
+
+	// Poll at the fastest rate supported by either sensor
+	unsigned int interval = ORIENTATION_MAXIMUM_INTERVAL;
+	if (compass != NULL) {
+		unsigned int compassInterval = SetReportInterval(compass, ORIENTATION_MINIMUM_INTERVAL, ORIENTATION_MAXIMUM_INTERVAL);
+		interval = compassInterval < interval ? compassInterval : interval;
+	}
+	if (gyrometer != NULL) {
+		unsigned int gyrometerInterval = SetReportInterval(gyrometer, ORIENTATION_MINIMUM_INTERVAL, ORIENTATION_MAXIMUM_INTERVAL);
+		interval = gyrometerInterval < interval ? gyrometerInterval : interval;
+	}
+	reportInterval = interval;
+	wxLogMessage(_T("Windows Sensor Plugin, Orientation sensors %s%s reporting every %u ms"),
+		compass != NULL ? _T("compass ") : _T(""), gyrometer != NULL ? _T("gyrometer ") : _T(""), interval);
+
+	long long lastCompassTime = 0;
+	long long lastGyrometerTime = 0;
+	Heading_Estimator headingEstimator;
+
+	while (isRunning) {
+		ISensorDataReport *report = NULL;
+
+		bool isNewHeading = false;
+		bool isTrueValid = false;
+		double magneticHeading = 0.0;
+		double trueHeading = 0.0;
+		long long headingTime = 0;
+
+		if ((compass != NULL) && (compass->GetData(&report) == S_OK) && (report != NULL)) {
+			// The sensor repeats its last report until there is a new one
+			headingTime = GetTimeStamp(report);
+			if (headingTime != lastCompassTime) {
+				lastCompassTime = headingTime;
+				if ((GetValue(report, SENSOR_DATA_TYPE_MAGNETIC_HEADING_COMPENSATED_MAGNETIC_NORTH_DEGREES, magneticHeading)) ||
+					(GetValue(report, SENSOR_DATA_TYPE_MAGNETIC_HEADING_MAGNETIC_NORTH_DEGREES, magneticHeading))) {
+					isNewHeading = true;
+					// Only available if the sensor knows our location
+					isTrueValid = GetValue(report, SENSOR_DATA_TYPE_MAGNETIC_HEADING_COMPENSATED_TRUE_NORTH_DEGREES, trueHeading);
+				}
+			}
+			report->Release();
+			report = NULL;
+		}
+
+		bool isNewRate = false;
+		double rateOfTurn = 0.0;
+
+		if ((gyrometer != NULL) && (gyrometer->GetData(&report) == S_OK) && (report != NULL)) {
+			long long rateTime = GetTimeStamp(report);
+			double angularVelocity;
+			if ((rateTime != lastGyrometerTime) && (GetValue(report, SENSOR_DATA_TYPE_ANGULAR_VELOCITY_Z_DEGREES_PER_SECOND, angularVelocity))) {
+				lastGyrometerTime = rateTime;
+				rateOfTurn = Heading_Estimator::GyrometerRate(angularVelocity);
+				isNewRate = true;
+			}
+			report->Release();
+			report = NULL;
+		}
+
+		if (isNewHeading) {
+			double variation;
+			bool isVariation;
+			{
+				std::lock_guard<std::mutex> lock(headingMutex);
+				variation = magneticVariation;
+				isVariation = isVariationValid;
+			}
+
+			if (!isTrueValid) {
+				isTrueValid = Heading_Estimator::TrueHeading(magneticHeading, variation, isVariation, trueHeading);
+			}
+
+			SendSentence(Heading_Estimator::FormatHDG(magneticHeading, variation, isVariation));
+			if (isTrueValid) {
+				SendSentence(Heading_Estimator::FormatHDT(trueHeading));
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(headingMutex);
+				latestMagneticHeading = magneticHeading;
+				latestTrueHeading = isTrueValid ? trueHeading : magneticHeading;
+				hasHeading = true;
+			}
+
+			// Without a gyrometer, derive the rate of turn from successive headings
+			if (gyrometer == NULL) {
+				isNewRate = headingEstimator.Update(magneticHeading, headingTime, rateOfTurn);
+			}
+		}
+
+		if (isNewRate) {
+			SendSentence(Heading_Estimator::FormatROT(rateOfTurn));
+		}
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(interval));
+	}
+
+	if (compass != NULL) {
+		compass->Release();
+	}
+	if (gyrometer != NULL) {
+		gyrometer->Release();
+	}
+	sensorManager->Release();
+	if (isComInitialized) {
+		CoUninitialize();
+	}
+}
+
+// Use the first sensor of the given type
+ISensor *Orientation_Sensor::FindSensor(ISensorManager *sensorManager, REFSENSOR_TYPE_ID sensorType) {
+	ISensorCollection *sensorList = NULL;
+	ISensor *sensor = NULL;
+
+	HRESULT hr = sensorManager->GetSensorsByType(sensorType, &sensorList);
+	if ((hr != S_OK) || (sensorList == NULL)) {
+		return NULL;
+	}
+
+	ULONG sensorsCount = 0;
+	hr = sensorList->GetCount(&sensorsCount);
+	if ((hr == S_OK) && (sensorsCount > 0)) {
+		hr = sensorList->GetAt(0, &sensor);
+		if (hr != S_OK) {
+			sensor = NULL;
+		}
+	}
+	sensorList->Release();
+
+	if (sensor != NULL) {
+		BSTR name = NULL;
+		if ((sensor->GetFriendlyName(&name) == S_OK) && (name != NULL)) {
+			wxLogMessage(_T("Windows Sensor Plugin, Orientation Sensor: %s"), wxString::FromUTF8(_bstr_t(name)));
+			SysFreeString(name);
+		}
+	}
+	return sensor;
+}
+
+// Request the sensor's minimum report interval, returns the interval to poll at
+unsigned int Orientation_Sensor::SetReportInterval(ISensor *sensor, unsigned int minimumInterval, unsigned int maximumInterval) {
+	unsigned int interval = maximumInterval;
+
+	PROPVARIANT sensorInterval;
+	PropVariantInit(&sensorInterval);
+	if ((sensor->GetProperty(SENSOR_PROPERTY_MIN_REPORT_INTERVAL, &sensorInterval) == S_OK) && (sensorInterval.vt == VT_UI4)) {
+		interval = sensorInterval.ulVal;
+	}
+	PropVariantClear(&sensorInterval);
+
+	if (interval < minimumInterval) {
+		interval = minimumInterval;
+	}
+	if (interval > maximumInterval) {
+		interval = maximumInterval;
+	}
+
+	IPortableDeviceValues *properties = NULL;
+	IPortableDeviceValues *results = NULL;
+	if (CoCreateInstance(CLSID_PortableDeviceValues, NULL, CLSCTX_INPROC_SERVER, IID_PPV_ARGS(&properties)) == S_OK) {
+		properties->SetUnsignedIntegerValue(SENSOR_PROPERTY_CURRENT_REPORT_INTERVAL, interval);
+		sensor->SetProperties(properties, &results);
+		if (results != NULL) {
+			results->Release();
+		}
+		properties->Release();
+	}
+	return interval;
+}
+
+// Sensors report either single or double precision values
+bool Orientation_Sensor::GetValue(ISensorDataReport *report, REFPROPERTYKEY key, double &value) {
+	bool isValid = false;
+	PROPVARIANT propertyValue;
+	PropVariantInit(&propertyValue);
+	if (report->GetSensorValue(key, &propertyValue) == S_OK) {
+		if (propertyValue.vt == VT_R8) {
+			value = propertyValue.dblVal;
+			isValid = true;
+		}
+		else if (propertyValue.vt == VT_R4) {
+			value = propertyValue.fltVal;
+			isValid = true;
+		}
+	}
+	PropVariantClear(&propertyValue);
+	return isValid;
+}
+
+// Report timestamp in 100 nanosecond intervals
+long long Orientation_Sensor::GetTimeStamp(ISensorDataReport *report) {
+	SYSTEMTIME reportTime;
+	FILETIME fileTime;
+	if ((report->GetTimestamp(&reportTime) == S_OK) && (SystemTimeToFileTime(&reportTime, &fileTime))) {
+		return ((long long)fileTime.dwHighDateTime << 32) | fileTime.dwLowDateTime;
+	}
+	return 0;
+}
+
+// Append the checksum and hand the sentence to the GUI thread, OpenCPN's NMEA handling is not thread safe
+void Orientation_Sensor::SendSentence(wxString sentence) {
+	unsigned char checksum = 0;
+	for (wxString::const_iterator it = sentence.begin() + 1; it != sentence.end(); ++it) {
+		checksum ^= static_cast<unsigned char> (*it);
+	}
+	std::string text = std::string(sentence.ToAscii()) + std::string(wxString::Format(wxT("*%02X\r\n"), checksum).ToAscii());
+	NMEA_Echo_Filter::Add(text.c_str(), text.length());
+	wxTheApp->CallAfter([text]() {
+		PushNMEABuffer(wxString(text.c_str(), wxConvUTF8));
+	});
+}
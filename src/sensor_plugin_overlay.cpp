@@ -0,0 +1,274 @@
+// Copyright(C) 2024 by Steven Adler
+//
+// This file is part of Windows Sensor Plugin for OpenCPN.
+//
+// Windows Sensor Plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Windows Sensor Plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Windows Sensor Plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// Project: Windows Sensor Plugin
+// Description: Own ship track overlay
+// Owner: twocanplugin@hotmail.com
+// Date: 01/04/2024
+// Version History:
+// 1.0 Initial Release
+
+#include "sensor_plugin_overlay.h"
+
+#include <wx/math.h>
+
+Track_Overlay::Track_Overlay(void) {
+	hasLatestPoint = false;
+	trackPen = wxPen(wxColour(197, 69, 195), 2, wxPENSTYLE_SOLID);
+}
+
+Track_Overlay::~Track_Overlay(void) {
+}
+
+void Track_Overlay::SetColorScheme(PI_ColorScheme scheme) {
+	// Use the same colour as the chart's magenta, it is adjusted for day, dusk and night
+	wxColour colour;
+	if (GetGlobalColor(_T("CHMGD"), &colour)) {
+		trackPen = wxPen(colour, 2, wxPENSTYLE_SOLID);
+	}
+}
+
+void Track_Overlay::Clear(void) {
+	pyramid.Clear();
+	hasLatestPoint = false;
+}
+
+void Track_Overlay::Add(const TrackPoint &point) {
+	latestPoint = point;
+	hasLatestPoint = true;
+	pyramid.Add(point);
+}
+
+void Track_Overlay::AddPixel(PlugIn_ViewPort *vp, const TrackPoint &point) {
+	wxPoint pixel;
+	GetCanvasPixLL(vp, &pixel, point.latitude, point.longitude);
+	// Consecutive points that fall on the same pixel add nothing
+	if ((pixels.empty()) || (pixels.back() != pixel)) {
+		pixels.push_back(pixel);
+	}
+}
+
+void Track_Overlay::DrawPixels(wxDC *dc) {
+	if (pixels.size() < 2) {
+		return;
+	}
+	if (dc != NULL) {
+		dc->DrawLines(pixels.size(), &pixels[0]);
+		return;
+	}
+#ifdef ocpnUSE_GL
+	glBegin(GL_LINE_STRIP);
+	for (std::vector<wxPoint>::const_iterator it = pixels.begin(); it != pixels.end(); ++it) {
+		glVertex2i(it->x, it->y);
+	}
+	glEnd();
+#endif
+}
+
+bool Track_Overlay::Render(wxDC &dc, PlugIn_ViewPort *vp) {
+	return Draw(&dc, vp);
+}
+
+bool Track_Overlay::RenderGL(PlugIn_ViewPort *vp) {
+#ifdef ocpnUSE_GL
+	if ((!hasLatestPoint) || (vp == NULL)) {
+		return false;
+	}
+
+	// The canvas projection is already in pixels, save its state as OpenCPN continues drawing after us
+	glPushAttrib(GL_COLOR_BUFFER_BIT | GL_LINE_BIT | GL_ENABLE_BIT | GL_HINT_BIT);
+	glEnable(GL_LINE_SMOOTH);
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	glHint(GL_LINE_SMOOTH_HINT, GL_NICEST);
+	wxColour colour = trackPen.GetColour();
+	glColor4ub(colour.Red(), colour.Green(), colour.Blue(), colour.Alpha());
+	glLineWidth(trackPen.GetWidth());
+
+	bool isRendered = Draw(NULL, vp);
+
+	glPopAttrib();
+	return isRendered;
+#else
+	return false;
+#endif
+}
+
+bool Track_Overlay::Draw(wxDC *dc, PlugIn_ViewPort *vp) {
+	if ((!hasLatestPoint) || (vp == NULL)) {
+		return false;
+	}
+
+	const std::deque<TrackChunk> &chunks = pyramid.GetChunks(pyramid.SelectLevel(vp->view_scale_ppm));
+
+	if (dc != NULL) {
+		dc->SetPen(trackPen);
+	}
+
+	for (std::deque<TrackChunk>::const_iterator it = chunks.begin(); it != chunks.end(); ++it) {
+		if (!Track_Pyramid::IsVisible(*it, vp->lat_min, vp->lat_max, vp->lon_min, vp->lon_max)) {
+			continue;
+		}
+		pixels.clear();
+		for (std::vector<TrackPoint>::const_iterator point = it->points.begin(); point != it->points.end(); ++point) {
+			AddPixel(vp, *point);
+		}
+		DrawPixels(dc);
+	}
+
+	// Join the last committed point to own ship
+	if (!chunks.empty()) {
+		pixels.clear();
+		AddPixel(vp, chunks.back().points.back());
+		AddPixel(vp, latestPoint);
+		DrawPixels(dc);
+	}
+
+	return true;
+}
+
+// Colour used for the transparent background of the cached ring
+static const wxColour maskColour(1, 1, 1);
+
+Accuracy_Overlay::Accuracy_Overlay(void) {
+	hasPosition = false;
+	uere = 5.0;
+	cachedRadius = 0;
+	colorScheme = PI_GLOBAL_COLOR_SCHEME_DAY;
+	cachedColorScheme = PI_GLOBAL_COLOR_SCHEME_DAY;
+	ringPen = wxPen(wxColour(0, 0, 255), 2, wxPENSTYLE_SHORT_DASH);
+}
+
+Accuracy_Overlay::~Accuracy_Overlay(void) {
+}
+
+void Accuracy_Overlay::Update(double latitude, double longitude, double hDOP) {
+	this->latitude = latitude;
+	this->longitude = longitude;
+	this->hDOP = hDOP;
+	hasPosition = true;
+}
+
+void Accuracy_Overlay::SetUERE(double rangeError) {
+	uere = rangeError;
+}
+
+void Accuracy_Overlay::SetColorScheme(PI_ColorScheme scheme) {
+	colorScheme = scheme;
+	wxColour colour;
+	if (GetGlobalColor(_T("UINFB"), &colour)) {
+		ringPen = wxPen(colour, 2, wxPENSTYLE_SHORT_DASH);
+	}
+}
+
+void Accuracy_Overlay::Rasterise(int radius) {
+	int size = (2 * radius) + 4;
+	ringBitmap = wxBitmap(size, size);
+
+	wxMemoryDC memoryDC(ringBitmap);
+	memoryDC.SetBackground(wxBrush(maskColour));
+	memoryDC.Clear();
+	memoryDC.SetPen(ringPen);
+	memoryDC.SetBrush(*wxTRANSPARENT_BRUSH);
+	memoryDC.DrawCircle(size / 2, size / 2, radius);
+	memoryDC.SelectObject(wxNullBitmap);
+
+	ringBitmap.SetMask(new wxMask(ringBitmap, maskColour));
+
+	cachedRadius = radius;
+	cachedColorScheme = colorScheme;
+}
+
+// Radius of the ring in pixels, zero if there is nothing worth drawing
+int Accuracy_Overlay::GetRadius(PlugIn_ViewPort *vp) {
+	if ((!hasPosition) || (vp == NULL) || (hDOP <= 0.0)) {
+		return 0;
+	}
+
+	// Estimated horizontal error is the HDOP multiplied by the range error
+	int radius = (int)((hDOP * uere * vp->view_scale_ppm) + 0.5);
+
+	// Too small to be of any use
+	if (radius < 2) {
+		return 0;
+	}
+	return radius;
+}
+
+bool Accuracy_Overlay::Render(wxDC &dc, PlugIn_ViewPort *vp) {
+	int radius = GetRadius(vp);
+	if (radius == 0) {
+		return false;
+	}
+
+	wxPoint centre;
+	GetCanvasPixLL(vp, &centre, latitude, longitude);
+
+	// Don't cache huge bitmaps when zoomed right in
+	if (radius > ACCURACY_RING_MAXIMUM_CACHE) {
+		dc.SetPen(ringPen);
+		dc.SetBrush(*wxTRANSPARENT_BRUSH);
+		dc.DrawCircle(centre, radius);
+		return true;
+	}
+
+	if ((radius != cachedRadius) || (colorScheme != cachedColorScheme)) {
+		Rasterise(radius);
+	}
+
+	dc.DrawBitmap(ringBitmap, centre.x - (ringBitmap.GetWidth() / 2), centre.y - (ringBitmap.GetHeight() / 2), true);
+	return true;
+}
+
+bool Accuracy_Overlay::RenderGL(PlugIn_ViewPort *vp) {
+#ifdef ocpnUSE_GL
+	int radius = GetRadius(vp);
+	if (radius == 0) {
+		return false;
+	}
+
+	wxPoint centre;
+	GetCanvasPixLL(vp, &centre, latitude, longitude);
+
+	// Roughly one segment every two pixels of circumference, so the ring looks round at any size
+	int segments = wxMax(ACCURACY_RING_MINIMUM_SEGMENTS, wxMin(ACCURACY_RING_MAXIMUM_SEGMENTS, radius * 3));
+
+	glPushAttrib(GL_COLOR_BUFFER_BIT | GL_LINE_BIT | GL_ENABLE_BIT | GL_HINT_BIT);
+	glEnable(GL_LINE_SMOOTH);
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	glHint(GL_LINE_SMOOTH_HINT, GL_NICEST);
+	// Short dashes to match the pen used on the device context
+	glEnable(GL_LINE_STIPPLE);
+	glLineStipple(2, 0x0F0F);
+	wxColour colour = ringPen.GetColour();
+	glColor4ub(colour.Red(), colour.Green(), colour.Blue(), colour.Alpha());
+	glLineWidth(ringPen.GetWidth());
+
+	glBegin(GL_LINE_LOOP);
+	for (int i = 0; i < segments; i++) {
+		double angle = (2.0 * M_PI * i) / segments;
+		glVertex2d(centre.x + (radius * cos(angle)), centre.y + (radius * sin(angle)));
+	}
+	glEnd();
+
+	glPopAttrib();
+	return true;
+#else
+	return false;
+#endif
+}
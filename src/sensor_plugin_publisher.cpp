@@ -0,0 +1,134 @@
+// Copyright(C) 2024 by Steven Adler
+//
+// This file is part of Windows Sensor Plugin for OpenCPN.
+//
+// Windows Sensor Plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Windows Sensor Plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Windows Sensor Plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// Project: Windows Sensor Plugin
+// Description: Shared memory fix publisher
+// Owner: twocanplugin@hotmail.com
+// Date: 01/04/2024
+// Version History:
+// 1.0 Initial Release
+
+#include "sensor_plugin_publisher.h"
+
+Fix_Publisher::Fix_Publisher(void) {
+	mappingHandle = NULL;
+	segment = nullptr;
+}
+
+Fix_Publisher::~Fix_Publisher(void) {
+	Close();
+}
+
+bool Fix_Publisher::Open(void) {
+	if (IsOpen()) {
+		return true;
+	}
+
+	// Backed by the paging file, so the segment disappears when the last process unmaps it
+	mappingHandle = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, sizeof(WindowsSensorSegment), WINDOWS_SENSOR_SHM_NAME);
+	if (mappingHandle == NULL) {
+		wxLogMessage(_T("Windows Sensor Plugin, Shared memory creation failed: %lu"), GetLastError());
+		return false;
+	}
+
+	segment = (WindowsSensorSegment *)MapViewOfFile(mappingHandle, FILE_MAP_WRITE, 0, 0, sizeof(WindowsSensorSegment));
+	if (segment == nullptr) {
+		wxLogMessage(_T("Windows Sensor Plugin, Shared memory mapping failed: %lu"), GetLastError());
+		CloseHandle(mappingHandle);
+		mappingHandle = NULL;
+		return false;
+	}
+
+	// A reader may still hold a previous instance of the segment, continue its sequence so that
+	// it sees the new fixes as changes. Readers only check the sequence once they have mapped the
+	// segment, so it is made odd while the fix is cleared, exactly as when publishing a fix.
+	LONG64 sequence = segment->sequence;
+	if (sequence & 1) {
+		sequence++;
+	}
+	InterlockedExchange64(&segment->sequence, sequence + 1);
+	segment->magic = 0;
+	memset(&segment->fix, 0, sizeof(WindowsSensorFix));
+	segment->version = WINDOWS_SENSOR_SHM_VERSION;
+	segment->size = sizeof(WindowsSensorSegment);
+	segment->reserved = 0;
+	segment->magic = WINDOWS_SENSOR_SHM_MAGIC;
+	InterlockedExchange64(&segment->sequence, sequence + 2);
+
+	wxLogMessage(_T("Windows Sensor Plugin, Publishing fixes to shared memory %s"), WINDOWS_SENSOR_SHM_NAME);
+	return true;
+}
+
+void Fix_Publisher::Close(void) {
+	if (segment != nullptr) {
+		UnmapViewOfFile(segment);
+		segment = nullptr;
+	}
+	if (mappingHandle != NULL) {
+		CloseHandle(mappingHandle);
+		mappingHandle = NULL;
+	}
+}
+
+bool Fix_Publisher::IsOpen(void) {
+	return (segment != nullptr);
+}
+
+void Fix_Publisher::Publish(const PositionFix &fix, const std::vector<SatelliteInformation> &satellites) {
+	if (segment == nullptr) {
+		return;
+	}
+
+	// Odd, readers retry until the update is complete. InterlockedExchange64 is a full barrier,
+	// so none of the following stores can be seen before it.
+	LONG64 sequence = segment->sequence;
+	InterlockedExchange64(&segment->sequence, sequence + 1);
+
+	WindowsSensorFix *target = &segment->fix;
+	target->latitude = fix.latitude;
+	target->longitude = fix.longitude;
+	target->altitude = fix.altitude;
+	target->speedOverGround = fix.speedOverGround;
+	target->courseOverGround = fix.courseOverGround;
+	target->magneticVariation = fix.magneticVariation;
+	target->hDOP = fix.hDOP;
+	target->vDOP = fix.vDOP;
+	target->pDOP = fix.pDOP;
+	target->geoidalSeparation = fix.geoidalSeparation;
+	target->timeStamp = fix.timeStamp;
+	target->satellitesInUse = fix.satellitesInUse;
+	target->satellitesInView = fix.satellitesInView;
+	target->fixType = fix.fixType;
+	target->fixStatus = fix.fixStatus;
+	target->selectionMode = fix.selectionMode;
+	target->isValid = fix.isValid ? 1 : 0;
+
+	size_t count = satellites.size();
+	if (count > WINDOWS_SENSOR_SHM_MAXIMUM_SATELLITES) {
+		count = WINDOWS_SENSOR_SHM_MAXIMUM_SATELLITES;
+	}
+	for (size_t i = 0; i < count; i++) {
+		target->satellites[i].id = satellites[i].id;
+		target->satellites[i].elevation = (float)satellites[i].elevation;
+		target->satellites[i].azimuth = (float)satellites[i].azimuth;
+		target->satellites[i].snr = (float)satellites[i].snr;
+	}
+	target->satelliteCount = (uint32_t)count;
+
+	// Even again, the update is visible as a whole
+	InterlockedExchange64(&segment->sequence, sequence + 2);
+}
@@ -0,0 +1,128 @@
+// Copyright(C) 2024 by Steven Adler
+//
+// This file is part of Windows Sensor Plugin for OpenCPN.
+//
+// Windows Sensor Plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Windows Sensor Plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Windows Sensor Plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// Project: Windows Sensor Plugin
+// Description: Level of detail pyramid for the own ship track overlay
+// Owner: twocanplugin@hotmail.com
+// Date: 01/04/2024
+// Version History:
+// 1.0 Initial Release
+
+#include "sensor_plugin_pyramid.h"
+
+// Extend the chunk's bounding box to include the point
+static void ExtendBounds(TrackChunk &chunk, const TrackPoint &point) {
+	if (point.latitude < chunk.latitudeMinimum) {
+		chunk.latitudeMinimum = point.latitude;
+	}
+	if (point.latitude > chunk.latitudeMaximum) {
+		chunk.latitudeMaximum = point.latitude;
+	}
+	if (point.longitude < chunk.longitudeMinimum) {
+		chunk.longitudeMinimum = point.longitude;
+	}
+	if (point.longitude > chunk.longitudeMaximum) {
+		chunk.longitudeMaximum = point.longitude;
+	}
+}
+
+Track_Pyramid::Track_Pyramid(void) {
+	// Each level is four times coarser than the previous level
+	double tolerance = TRACK_OVERLAY_BASE_TOLERANCE;
+	for (unsigned int i = 0; i < TRACK_OVERLAY_LEVELS; i++) {
+		levels[i].tolerance = tolerance;
+		// Large speed tolerance, only the shape of the track matters when drawing
+		levels[i].simplifier.SetTolerance(tolerance, 1000.0);
+		tolerance *= 4.0;
+	}
+}
+
+Track_Pyramid::~Track_Pyramid(void) {
+}
+
+void Track_Pyramid::Clear(void) {
+	for (unsigned int i = 0; i < TRACK_OVERLAY_LEVELS; i++) {
+		levels[i].simplifier.Reset();
+		levels[i].chunks.clear();
+	}
+}
+
+void Track_Pyramid::Add(const TrackPoint &point) {
+	for (unsigned int i = 0; i < TRACK_OVERLAY_LEVELS; i++) {
+		AddToLevel(levels[i], point);
+	}
+}
+
+void Track_Pyramid::AddToLevel(TrackLevel &level, const TrackPoint &point) {
+	TrackPoint committed;
+	if (!level.simplifier.Add(point, committed)) {
+		return;
+	}
+
+	// Start a new chunk, it begins with the last point of the previous chunk so that the trail is continuous
+	if ((level.chunks.empty()) || (level.chunks.back().points.size() == TRACK_OVERLAY_CHUNK_SIZE)) {
+		TrackChunk chunk;
+		chunk.points.reserve(TRACK_OVERLAY_CHUNK_SIZE);
+		chunk.latitudeMinimum = committed.latitude;
+		chunk.latitudeMaximum = committed.latitude;
+		chunk.longitudeMinimum = committed.longitude;
+		chunk.longitudeMaximum = committed.longitude;
+		if (!level.chunks.empty()) {
+			const TrackPoint &previous = level.chunks.back().points.back();
+			chunk.points.push_back(previous);
+			ExtendBounds(chunk, previous);
+		}
+		level.chunks.push_back(chunk);
+	}
+
+	TrackChunk &chunk = level.chunks.back();
+	chunk.points.push_back(committed);
+	ExtendBounds(chunk, committed);
+
+	// Discard whole chunks that are older than the length of the trail
+	while ((level.chunks.size() > 1) && (level.chunks.front().points.back().timeStamp < (committed.timeStamp - TRACK_OVERLAY_DURATION))) {
+		level.chunks.pop_front();
+	}
+}
+
+unsigned int Track_Pyramid::SelectLevel(double pixelsPerMetre) {
+	for (int i = TRACK_OVERLAY_LEVELS - 1; i > 0; i--) {
+		if ((levels[i].tolerance * pixelsPerMetre) <= 1.0) {
+			return i;
+		}
+	}
+	return 0;
+}
+
+const std::deque<TrackChunk> &Track_Pyramid::GetChunks(unsigned int level) {
+	return levels[level < TRACK_OVERLAY_LEVELS ? level : TRACK_OVERLAY_LEVELS - 1].chunks;
+}
+
+bool Track_Pyramid::IsVisible(const TrackChunk &chunk, double latitudeMinimum, double latitudeMaximum,
+	double longitudeMinimum, double longitudeMaximum) {
+	if ((chunk.latitudeMaximum < latitudeMinimum) || (chunk.latitudeMinimum > latitudeMaximum)) {
+		return false;
+	}
+	// Don't attempt to cull by longitude if the viewport spans the antimeridian
+	if ((longitudeMinimum < -180.0) || (longitudeMaximum > 180.0) || (longitudeMinimum > longitudeMaximum)) {
+		return true;
+	}
+	if ((chunk.longitudeMaximum < longitudeMinimum) || (chunk.longitudeMinimum > longitudeMaximum)) {
+		return false;
+	}
+	return true;
+}
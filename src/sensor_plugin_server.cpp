@@ -0,0 +1,326 @@
+// Copyright(C) 2024 by Steven Adler
+//
+// This file is part of Windows Sensor Plugin for OpenCPN.
+//
+// Windows Sensor Plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Windows Sensor Plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Windows Sensor Plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// Project: Windows Sensor Plugin
+// Description: Local NMEA 0183 TCP & UDP server
+// Owner: twocanplugin@hotmail.com
+// Date: 01/04/2024
+// Version History:
+// 1.0 Initial Release
+
+#include "sensor_plugin_server.h"
+
+#include <algorithm>
+
+NMEA_Server::NMEA_Server(void) {
+	listenSocket = INVALID_SOCKET;
+	udpSocket = INVALID_SOCKET;
+	wakeSocket = INVALID_SOCKET;
+	clientCount = 0;
+	droppedClients = 0;
+	isRunning = false;
+	hasPendingEpoch = false;
+}
+
+NMEA_Server::~NMEA_Server(void) {
+	Stop();
+}
+
+void NMEA_Server::SetNonBlocking(SOCKET s) {
+	u_long nonBlocking = 1;
+	ioctlsocket(s, FIONBIO, &nonBlocking);
+}
+
+bool NMEA_Server::Start(bool enableTCP, unsigned short tcpPort, bool enableUDP, const wxString &udpAddress, unsigned short udpPort) {
+	if (isRunning) {
+		Stop();
+	}
+
+	if ((!enableTCP) && (!enableUDP)) {
+		return false;
+	}
+
+	WSADATA wsaData;
+	if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
+		wxLogMessage(_T("Windows Sensor Plugin, Winsock initialization failed"));
+		return false;
+	}
+
+	// Wake socket, bound to an ephemeral loopback port
+	wakeSocket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	memset(&wakeAddress, 0, sizeof(wakeAddress));
+	wakeAddress.sin_family = AF_INET;
+	wakeAddress.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	wakeAddress.sin_port = 0;
+	int addressLength = sizeof(wakeAddress);
+	if ((wakeSocket == INVALID_SOCKET) ||
+		(bind(wakeSocket, (sockaddr *)&wakeAddress, sizeof(wakeAddress)) == SOCKET_ERROR) ||
+		(getsockname(wakeSocket, (sockaddr *)&wakeAddress, &addressLength) == SOCKET_ERROR)) {
+		wxLogMessage(_T("Windows Sensor Plugin, Server wake socket failed: %d"), WSAGetLastError());
+		CloseSockets();
+		return false;
+	}
+	SetNonBlocking(wakeSocket);
+
+	// TCP server, only accepts connections from this computer
+	if (enableTCP) {
+		listenSocket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+		sockaddr_in listenAddress;
+		memset(&listenAddress, 0, sizeof(listenAddress));
+		listenAddress.sin_family = AF_INET;
+		listenAddress.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		listenAddress.sin_port = htons(tcpPort);
+		if ((listenSocket == INVALID_SOCKET) ||
+			(bind(listenSocket, (sockaddr *)&listenAddress, sizeof(listenAddress)) == SOCKET_ERROR) ||
+			(listen(listenSocket, SOMAXCONN) == SOCKET_ERROR)) {
+			wxLogMessage(_T("Windows Sensor Plugin, Unable to listen on TCP port %d: %d"), tcpPort, WSAGetLastError());
+			CloseSockets();
+			return false;
+		}
+		SetNonBlocking(listenSocket);
+		wxLogMessage(_T("Windows Sensor Plugin, NMEA server listening on TCP port %d"), tcpPort);
+	}
+
+	// UDP broadcast or multicast
+	if (enableUDP) {
+		memset(&udpDestination, 0, sizeof(udpDestination));
+		udpDestination.sin_family = AF_INET;
+		udpDestination.sin_port = htons(udpPort);
+		if (inet_pton(AF_INET, udpAddress.ToAscii(), &udpDestination.sin_addr) != 1) {
+			wxLogMessage(_T("Windows Sensor Plugin, Invalid UDP address %s"), udpAddress);
+			CloseSockets();
+			return false;
+		}
+
+		udpSocket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+		if (udpSocket == INVALID_SOCKET) {
+			wxLogMessage(_T("Windows Sensor Plugin, Unable to create UDP socket: %d"), WSAGetLastError());
+			CloseSockets();
+			return false;
+		}
+		SetNonBlocking(udpSocket);
+
+		if (IN_MULTICAST(ntohl(udpDestination.sin_addr.s_addr))) {
+			// Keep multicast on the local network and deliver to this computer too
+			DWORD ttl = 1;
+			DWORD loop = 1;
+			setsockopt(udpSocket, IPPROTO_IP, IP_MULTICAST_TTL, (const char *)&ttl, sizeof(ttl));
+			setsockopt(udpSocket, IPPROTO_IP, IP_MULTICAST_LOOP, (const char *)&loop, sizeof(loop));
+		}
+		else {
+			BOOL broadcast = TRUE;
+			setsockopt(udpSocket, SOL_SOCKET, SO_BROADCAST, (const char *)&broadcast, sizeof(broadcast));
+		}
+		wxLogMessage(_T("Windows Sensor Plugin, NMEA server sending UDP to %s:%d"), udpAddress, udpPort);
+	}
+
+	isRunning = true;
+	loopThread = std::thread(&NMEA_Server::EventLoop, this);
+	return true;
+}
+
+void NMEA_Server::Stop(void) {
+	if (!isRunning) {
+		return;
+	}
+	isRunning = false;
+
+	// Wake the event loop so that it notices it should exit
+	char wake = 0;
+	sendto(wakeSocket, &wake, sizeof(wake), 0, (sockaddr *)&wakeAddress, sizeof(wakeAddress));
+	if (loopThread.joinable()) {
+		loopThread.join();
+	}
+
+	CloseSockets();
+	wxLogMessage(_T("Windows Sensor Plugin, NMEA server stopped, %llu slow clients dropped"), GetDroppedClients());
+}
+
+void NMEA_Server::CloseSockets(void) {
+	for (std::vector<SOCKET>::iterator it = clients.begin(); it != clients.end(); ++it) {
+		closesocket(*it);
+	}
+	clients.clear();
+	clientCount = 0;
+
+	if (listenSocket != INVALID_SOCKET) {
+		closesocket(listenSocket);
+		listenSocket = INVALID_SOCKET;
+	}
+	if (udpSocket != INVALID_SOCKET) {
+		closesocket(udpSocket);
+		udpSocket = INVALID_SOCKET;
+	}
+	if (wakeSocket != INVALID_SOCKET) {
+		closesocket(wakeSocket);
+		wakeSocket = INVALID_SOCKET;
+	}
+	WSACleanup();
+}
+
+bool NMEA_Server::IsRunning(void) {
+	return isRunning;
+}
+
+unsigned int NMEA_Server::GetClientCount(void) {
+	return clientCount;
+}
+
+unsigned long long NMEA_Server::GetDroppedClients(void) {
+	return droppedClients;
+}
+
+void NMEA_Server::Publish(const std::vector<std::string> &sentences) {
+	if (!isRunning) {
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> lock(epochMutex);
+		pendingEpoch = sentences;
+		hasPendingEpoch = true;
+	}
+	char wake = 1;
+	sendto(wakeSocket, &wake, sizeof(wake), 0, (sockaddr *)&wakeAddress, sizeof(wakeAddress));
+}
+
+void NMEA_Server::AcceptClients(void) {
+	while (true) {
+		SOCKET client = accept(listenSocket, NULL, NULL);
+		if (client == INVALID_SOCKET) {
+			// WSAEWOULDBLOCK, no more pending connections
+			return;
+		}
+		if (clients.size() >= SERVER_MAXIMUM_CLIENTS) {
+			closesocket(client);
+			continue;
+		}
+		SetNonBlocking(client);
+		BOOL noDelay = TRUE;
+		setsockopt(client, IPPROTO_TCP, TCP_NODELAY, (const char *)&noDelay, sizeof(noDelay));
+		clients.push_back(client);
+	}
+}
+
+void NMEA_Server::SendEpoch(const std::vector<std::string> &sentences) {
+	// Gather the sentences without copying them into a single buffer
+	WSABUF buffers[SERVER_MAXIMUM_BUFFERS];
+	DWORD bufferCount = 0;
+	DWORD totalLength = 0;
+	for (std::vector<std::string>::const_iterator it = sentences.begin(); (it != sentences.end()) && (bufferCount < SERVER_MAXIMUM_BUFFERS); ++it) {
+		buffers[bufferCount].buf = (CHAR *)it->data();
+		buffers[bufferCount].len = (ULONG)it->size();
+		totalLength += buffers[bufferCount].len;
+		bufferCount++;
+	}
+	if (bufferCount == 0) {
+		return;
+	}
+
+	// Clients that cannot take the whole epoch are too slow and are dropped
+	for (std::vector<SOCKET>::iterator it = clients.begin(); it != clients.end();) {
+		DWORD bytesSent = 0;
+		if ((WSASend(*it, buffers, bufferCount, &bytesSent, 0, NULL, NULL) == SOCKET_ERROR) || (bytesSent != totalLength)) {
+			closesocket(*it);
+			it = clients.erase(it);
+			droppedClients++;
+		}
+		else {
+			++it;
+		}
+	}
+	clientCount = (unsigned int)clients.size();
+
+	// One datagram per sentence, as expected by most NMEA 0183 UDP listeners
+	if (udpSocket != INVALID_SOCKET) {
+		for (DWORD i = 0; i < bufferCount; i++) {
+			DWORD bytesSent = 0;
+			WSASendTo(udpSocket, &buffers[i], 1, &bytesSent, 0, (sockaddr *)&udpDestination, sizeof(udpDestination), NULL, NULL);
+		}
+	}
+}
+
+void NMEA_Server::EventLoop(void) {
+	std::vector<WSAPOLLFD> pollList;
+	std::vector<std::string> epoch;
+	char discard[512];
+
+	while (isRunning) {
+		// Rebuild the poll list, the wake socket first, then the listening socket and clients
+		pollList.clear();
+		WSAPOLLFD entry;
+		entry.fd = wakeSocket;
+		entry.events = POLLRDNORM;
+		entry.revents = 0;
+		pollList.push_back(entry);
+		if (listenSocket != INVALID_SOCKET) {
+			entry.fd = listenSocket;
+			pollList.push_back(entry);
+		}
+		size_t firstClient = pollList.size();
+		for (std::vector<SOCKET>::const_iterator it = clients.begin(); it != clients.end(); ++it) {
+			entry.fd = *it;
+			pollList.push_back(entry);
+		}
+
+		int result = WSAPoll(&pollList[0], (ULONG)pollList.size(), 1000);
+		if ((result == SOCKET_ERROR) || (!isRunning)) {
+			continue;
+		}
+		if (result == 0) {
+			continue;
+		}
+
+		// Detect clients that have disconnected, anything they send is discarded
+		std::vector<SOCKET> closed;
+		for (size_t i = firstClient; i < pollList.size(); i++) {
+			if (pollList.at(i).revents & (POLLRDNORM | POLLHUP | POLLERR | POLLNVAL)) {
+				int length = recv(pollList.at(i).fd, discard, sizeof(discard), 0);
+				if ((length == 0) || ((length == SOCKET_ERROR) && (WSAGetLastError() != WSAEWOULDBLOCK))) {
+					closed.push_back(pollList.at(i).fd);
+				}
+			}
+		}
+		for (std::vector<SOCKET>::const_iterator it = closed.begin(); it != closed.end(); ++it) {
+			closesocket(*it);
+			clients.erase(std::remove(clients.begin(), clients.end(), *it), clients.end());
+		}
+
+		if ((listenSocket != INVALID_SOCKET) && (pollList.at(1).revents & POLLRDNORM)) {
+			AcceptClients();
+		}
+		clientCount = (unsigned int)clients.size();
+
+		if (pollList.at(0).revents & POLLRDNORM) {
+			// Drain all of the wake notifications
+			while (recv(wakeSocket, discard, sizeof(discard), 0) > 0) {
+			}
+
+			bool hasEpoch = false;
+			{
+				std::lock_guard<std::mutex> lock(epochMutex);
+				if (hasPendingEpoch) {
+					epoch.swap(pendingEpoch);
+					hasPendingEpoch = false;
+					hasEpoch = true;
+				}
+			}
+			if (hasEpoch) {
+				SendEpoch(epoch);
+			}
+		}
+	}
+}
@@ -42,6 +42,7 @@ Windows_Sensor_Plugin_Settings::Windows_Sensor_Plugin_Settings(wxWindow* parent)
 
 	// Populate the values of the dialog
 	lblSensor->SetLabel(wxString::Format("%s", sensorName));
+	checkVerbose->SetValue(isVerbose);
 	// Note the order of the check list box elements
 	// GGA
 	chkListSentence->Check(CHECKBOX::GGA, isGGA);
@@ -51,6 +52,14 @@ Windows_Sensor_Plugin_Settings::Windows_Sensor_Plugin_Settings(wxWindow* parent)
 	chkListSentence->Check(CHECKBOX::GSV, isGSV);
 	//RMC
 	chkListSentence->Check(CHECKBOX::RMC, isRMC);
+	// Track Log
+	checkTrackLog->SetValue(isTrackLog);
+	checkTrackOverlay->SetValue(isTrackOverlay);
+	checkAccuracyRing->SetValue(isAccuracyRing);
+	// Satellites
+	checkSkyPlot->SetValue(isSkyPlot);
+	// Diagnostics, a snapshot taken as the dialog was opened
+	textDiagnostics->SetValue(diagnosticsText);
 }
 
 Windows_Sensor_Plugin_Settings::~Windows_Sensor_Plugin_Settings() {
@@ -69,12 +78,28 @@ void Windows_Sensor_Plugin_Settings::OnRightClick(wxMouseEvent& event) {
 	}
 }
 
+void Windows_Sensor_Plugin_Settings::OnExport(wxCommandEvent& event) {
+	wxFileDialog fileDialog(this, _("Export Track"), wxEmptyString, _T("windows_sensor_track.gpx"),
+		_T("GPX files (*.gpx)|*.gpx"), wxFD_SAVE | wxFD_OVERWRITE_PROMPT);
+	if (fileDialog.ShowModal() == wxID_OK) {
+		// The export tolerance is usually coarser than that used for logging
+		if (!Track_Log::ExportGPX(trackLogFileName, fileDialog.GetPath(), exportTolerance, speedTolerance)) {
+			wxMessageBox(_("Unable to export the track log"), _("Windows Sensor Plugin"), wxICON_ERROR | wxOK, this);
+		}
+	}
+}
+
 void Windows_Sensor_Plugin_Settings::OnOK(wxCommandEvent& event) {
+	isVerbose = checkVerbose->GetValue();
 	// Note the order of the check list elements
 	isGGA = chkListSentence->IsChecked(CHECKBOX::GGA);
 	isGLL = chkListSentence->IsChecked(CHECKBOX::GLL);
 	isGSV = chkListSentence->IsChecked(CHECKBOX::GSV);
 	isRMC = chkListSentence->IsChecked(CHECKBOX::RMC);
+	isTrackLog = checkTrackLog->GetValue();
+	isTrackOverlay = checkTrackOverlay->GetValue();
+	isAccuracyRing = checkAccuracyRing->GetValue();
+	isSkyPlot = checkSkyPlot->GetValue();
 	EndModal(wxID_OK);
 }
 
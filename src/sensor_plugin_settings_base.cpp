@@ -50,6 +50,44 @@ Windows_Sensor_Plugin_Settings_Base::Windows_Sensor_Plugin_Settings_Base( wxWind
 
 	sizerPanelSettings->Add( sizerSentences, 1, wxEXPAND, 5 );
 
+	wxStaticBoxSizer* sizerTrack;
+	sizerTrack = new wxStaticBoxSizer( new wxStaticBox( panelSettings, wxID_ANY, wxT("Track Log") ), wxHORIZONTAL );
+
+	checkTrackLog = new wxCheckBox( sizerTrack->GetStaticBox(), wxID_ANY, wxT("Log Track"), wxDefaultPosition, wxDefaultSize, 0 );
+	sizerTrack->Add( checkTrackLog, 1, wxALL, 5 );
+
+	checkTrackOverlay = new wxCheckBox( sizerTrack->GetStaticBox(), wxID_ANY, wxT("Show Track"), wxDefaultPosition, wxDefaultSize, 0 );
+	sizerTrack->Add( checkTrackOverlay, 1, wxALL, 5 );
+
+	checkAccuracyRing = new wxCheckBox( sizerTrack->GetStaticBox(), wxID_ANY, wxT("Show Accuracy"), wxDefaultPosition, wxDefaultSize, 0 );
+	sizerTrack->Add( checkAccuracyRing, 1, wxALL, 5 );
+
+	btnExport = new wxButton( sizerTrack->GetStaticBox(), wxID_ANY, wxT("Export GPX..."), wxDefaultPosition, wxDefaultSize, 0 );
+	sizerTrack->Add( btnExport, 0, wxALL, 5 );
+
+
+	sizerPanelSettings->Add( sizerTrack, 0, wxEXPAND, 5 );
+
+	wxStaticBoxSizer* sizerSatellites;
+	sizerSatellites = new wxStaticBoxSizer( new wxStaticBox( panelSettings, wxID_ANY, wxT("Satellites") ), wxHORIZONTAL );
+
+	checkSkyPlot = new wxCheckBox( sizerSatellites->GetStaticBox(), wxID_ANY, wxT("Show Sky Plot"), wxDefaultPosition, wxDefaultSize, 0 );
+	sizerSatellites->Add( checkSkyPlot, 0, wxALL, 5 );
+
+
+	sizerPanelSettings->Add( sizerSatellites, 0, wxEXPAND, 5 );
+
+	wxStaticBoxSizer* sizerDiagnostics;
+	sizerDiagnostics = new wxStaticBoxSizer( new wxStaticBox( panelSettings, wxID_ANY, wxT("Diagnostics") ), wxVERTICAL );
+
+	textDiagnostics = new wxTextCtrl( sizerDiagnostics->GetStaticBox(), wxID_ANY, wxEmptyString, wxDefaultPosition, wxSize( -1,120 ), wxTE_MULTILINE|wxTE_READONLY|wxTE_DONTWRAP );
+	textDiagnostics->SetFont( wxFont( wxNORMAL_FONT->GetPointSize(), wxFONTFAMILY_TELETYPE, wxFONTSTYLE_NORMAL, wxFONTWEIGHT_NORMAL, false, wxEmptyString ) );
+
+	sizerDiagnostics->Add( textDiagnostics, 1, wxALL|wxEXPAND, 5 );
+
+
+	sizerPanelSettings->Add( sizerDiagnostics, 1, wxEXPAND, 5 );
+
 	wxBoxSizer* sizerButtons;
 	sizerButtons = new wxBoxSizer( wxHORIZONTAL );
 
@@ -80,6 +118,7 @@ Windows_Sensor_Plugin_Settings_Base::Windows_Sensor_Plugin_Settings_Base( wxWind
 	// Connect Events
 	chkListSentence->Connect( wxEVT_COMMAND_CHECKLISTBOX_TOGGLED, wxCommandEventHandler( Windows_Sensor_Plugin_Settings_Base::OnCheckSentence ), NULL, this );
 	chkListSentence->Connect( wxEVT_RIGHT_DOWN, wxMouseEventHandler( Windows_Sensor_Plugin_Settings_Base::OnRightClick ), NULL, this );
+	btnExport->Connect( wxEVT_COMMAND_BUTTON_CLICKED, wxCommandEventHandler( Windows_Sensor_Plugin_Settings_Base::OnExport ), NULL, this );
 	btnOK->Connect( wxEVT_COMMAND_BUTTON_CLICKED, wxCommandEventHandler( Windows_Sensor_Plugin_Settings_Base::OnOK ), NULL, this );
 	btnCancel->Connect( wxEVT_COMMAND_BUTTON_CLICKED, wxCommandEventHandler( Windows_Sensor_Plugin_Settings_Base::OnCancel ), NULL, this );
 }
@@ -89,6 +128,7 @@ Windows_Sensor_Plugin_Settings_Base::~Windows_Sensor_Plugin_Settings_Base()
 	// Disconnect Events
 	chkListSentence->Disconnect( wxEVT_COMMAND_CHECKLISTBOX_TOGGLED, wxCommandEventHandler( Windows_Sensor_Plugin_Settings_Base::OnCheckSentence ), NULL, this );
 	chkListSentence->Disconnect( wxEVT_RIGHT_DOWN, wxMouseEventHandler( Windows_Sensor_Plugin_Settings_Base::OnRightClick ), NULL, this );
+	btnExport->Disconnect( wxEVT_COMMAND_BUTTON_CLICKED, wxCommandEventHandler( Windows_Sensor_Plugin_Settings_Base::OnExport ), NULL, this );
 	btnOK->Disconnect( wxEVT_COMMAND_BUTTON_CLICKED, wxCommandEventHandler( Windows_Sensor_Plugin_Settings_Base::OnOK ), NULL, this );
 	btnCancel->Disconnect( wxEVT_COMMAND_BUTTON_CLICKED, wxCommandEventHandler( Windows_Sensor_Plugin_Settings_Base::OnCancel ), NULL, this );
 
@@ -0,0 +1,290 @@
+// Copyright(C) 2024 by Steven Adler
+//
+// This file is part of Windows Sensor Plugin for OpenCPN.
+//
+// Windows Sensor Plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Windows Sensor Plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Windows Sensor Plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// Project: Windows Sensor Plugin
+// Description: Signal K delta output
+// Owner: twocanplugin@hotmail.com
+// Date: 01/04/2024
+// Version History:
+// 1.0 Initial Release
+
+// Refer to https://signalk.org/specification/1.7.0/doc/data_model.html
+
+#include "sensor_plugin_signalk.h"
+
+#include <wx/math.h>
+#include <time.h>
+#include <stdio.h>
+
+#define SIGNALK_KNOTS_TO_MS 0.514444
+#define SIGNALK_DEGREES_TO_RADIANS (M_PI / 180.0)
+
+Signal_K_Output::Signal_K_Output(void) : writer(buffer) {
+	udpSocket = INVALID_SOCKET;
+	isRunning = false;
+	epochCount = 0;
+	deltaCount = 0;
+	buffer.reserve(SIGNALK_BUFFER_SIZE);
+	for (int i = 0; i < SIGNALK_PATH_COUNT; i++) {
+		lastValues[i] = NAN;
+	}
+}
+
+Signal_K_Output::~Signal_K_Output(void) {
+	Stop();
+}
+
+bool Signal_K_Output::Start(const wxString &address, unsigned short port) {
+	if (isRunning) {
+		Stop();
+	}
+
+	WSADATA wsaData;
+	if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
+		wxLogMessage(_T("Windows Sensor Plugin, Winsock initialization failed"));
+		return false;
+	}
+
+	memset(&destination, 0, sizeof(destination));
+	destination.sin_family = AF_INET;
+	destination.sin_port = htons(port);
+	if (inet_pton(AF_INET, address.ToAscii(), &destination.sin_addr) != 1) {
+		wxLogMessage(_T("Windows Sensor Plugin, Invalid Signal K address %s"), address);
+		WSACleanup();
+		return false;
+	}
+
+	udpSocket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	if (udpSocket == INVALID_SOCKET) {
+		wxLogMessage(_T("Windows Sensor Plugin, Unable to create Signal K socket: %d"), WSAGetLastError());
+		WSACleanup();
+		return false;
+	}
+	u_long nonBlocking = 1;
+	ioctlsocket(udpSocket, FIONBIO, &nonBlocking);
+	BOOL broadcast = TRUE;
+	setsockopt(udpSocket, SOL_SOCKET, SO_BROADCAST, (const char *)&broadcast, sizeof(broadcast));
+
+	// Send everything in the first delta
+	epochCount = 0;
+	deltaCount = 0;
+	isRunning = true;
+	wxLogMessage(_T("Windows Sensor Plugin, Signal K output sending to %s:%d"), address, port);
+	return true;
+}
+
+void Signal_K_Output::Stop(void) {
+	if (!isRunning) {
+		return;
+	}
+	isRunning = false;
+	closesocket(udpSocket);
+	udpSocket = INVALID_SOCKET;
+	WSACleanup();
+	wxLogMessage(_T("Windows Sensor Plugin, Signal K output stopped, %llu deltas sent"), deltaCount);
+}
+
+bool Signal_K_Output::IsRunning(void) {
+	return isRunning;
+}
+
+unsigned long long Signal_K_Output::GetDeltaCount(void) {
+	return deltaCount;
+}
+
+// {"context":"vessels.self","updates":[{"$source":"windows_sensor","timestamp":"...","values":[{"path":"...","value":...},...]}]}
+void Signal_K_Output::Publish(const PositionFix &fix, const std::vector<SatelliteInformation> &satellites) {
+	if (!isRunning) {
+		return;
+	}
+
+	bool isRefresh = ((epochCount % SIGNALK_REFRESH_EPOCHS) == 0);
+	epochCount++;
+
+	char timeStamp[32];
+	FormatTimeStamp(fix.timeStamp, timeStamp, sizeof(timeStamp));
+
+	writer.Reset();
+	writer.BeginObject();
+	writer.Key("context");
+	writer.String("vessels.self");
+	writer.Key("updates");
+	writer.BeginArray();
+	writer.BeginObject();
+	writer.Key("$source");
+	writer.String("windows_sensor");
+	writer.Key("timestamp");
+	writer.String(timeStamp);
+	writer.Key("values");
+	writer.BeginArray();
+	size_t emptyLength = buffer.size();
+
+	if (fix.isValid) {
+		// Both components are compared, so that both retained values are updated
+		bool isLatitudeChanged = IsChanged(SIGNALK_LATITUDE, fix.latitude, 7, isRefresh);
+		bool isLongitudeChanged = IsChanged(SIGNALK_LONGITUDE, fix.longitude, 7, isRefresh);
+		if (isLatitudeChanged || isLongitudeChanged) {
+			BeginValue("navigation.position");
+			writer.BeginObject();
+			writer.Key("latitude");
+			writer.Number(fix.latitude, 7);
+			writer.Key("longitude");
+			writer.Number(fix.longitude, 7);
+			writer.EndObject();
+			writer.EndObject();
+		}
+
+		double speedOverGround = fix.speedOverGround * SIGNALK_KNOTS_TO_MS;
+		if (IsChanged(SIGNALK_SPEED_OVER_GROUND, speedOverGround, 2, isRefresh)) {
+			ScalarValue("navigation.speedOverGround", speedOverGround, 2);
+		}
+
+		double courseOverGround = fix.courseOverGround * SIGNALK_DEGREES_TO_RADIANS;
+		if (IsChanged(SIGNALK_COURSE_OVER_GROUND, courseOverGround, 4, isRefresh)) {
+			ScalarValue("navigation.courseOverGroundTrue", courseOverGround, 4);
+		}
+
+		if (IsChanged(SIGNALK_ANTENNA_ALTITUDE, fix.altitude, 1, isRefresh)) {
+			ScalarValue("navigation.gnss.antennaAltitude", fix.altitude, 1);
+		}
+
+		if (IsChanged(SIGNALK_GEOIDAL_SEPARATION, fix.geoidalSeparation, 1, isRefresh)) {
+			ScalarValue("navigation.gnss.geoidalSeparation", fix.geoidalSeparation, 1);
+		}
+	}
+
+	if (IsChanged(SIGNALK_SATELLITES, fix.satellitesInUse, 0, isRefresh)) {
+		ScalarValue("navigation.gnss.satellites", fix.satellitesInUse, 0);
+	}
+
+	if (IsChanged(SIGNALK_HORIZONTAL_DILUTION, fix.hDOP, 2, isRefresh)) {
+		ScalarValue("navigation.gnss.horizontalDilution", fix.hDOP, 2);
+	}
+
+	if (IsChanged(SIGNALK_POSITION_DILUTION, fix.pDOP, 2, isRefresh)) {
+		ScalarValue("navigation.gnss.positionDilution", fix.pDOP, 2);
+	}
+
+	if (IsChanged(SIGNALK_METHOD_QUALITY, fix.fixType, 0, isRefresh)) {
+		BeginValue("navigation.gnss.methodQuality");
+		writer.String(MethodQuality(fix.fixType));
+		writer.EndObject();
+	}
+
+	if (IsSatellitesChanged(satellites, isRefresh)) {
+		BeginValue("navigation.gnss.satellitesInView");
+		writer.BeginObject();
+		writer.Key("count");
+		writer.Integer(satellites.size());
+		writer.Key("satellites");
+		writer.BeginArray();
+		for (std::vector<SatelliteInformation>::const_iterator it = satellites.begin(); it != satellites.end(); ++it) {
+			writer.BeginObject();
+			writer.Key("id");
+			writer.Integer(it->id);
+			writer.Key("elevation");
+			writer.Number(it->elevation * SIGNALK_DEGREES_TO_RADIANS, 4);
+			writer.Key("azimuth");
+			writer.Number(it->azimuth * SIGNALK_DEGREES_TO_RADIANS, 4);
+			writer.Key("SNR");
+			writer.Number(it->snr, 0);
+			writer.EndObject();
+		}
+		writer.EndArray();
+		writer.EndObject();
+		writer.EndObject();
+	}
+
+	// Nothing has changed
+	if (buffer.size() == emptyLength) {
+		return;
+	}
+
+	writer.EndArray();
+	writer.EndObject();
+	writer.EndArray();
+	writer.EndObject();
+
+	sendto(udpSocket, buffer.data(), (int)buffer.size(), 0, (sockaddr *)&destination, sizeof(destination));
+	deltaCount++;
+}
+
+// Compared at the precision written, otherwise the noise in every fix would change every path
+bool Signal_K_Output::IsChanged(int path, double value, int precision, bool isRefresh) {
+	double rounded = Round(value, precision);
+	// NaN never compares equal, so a path that has never been sent is always changed
+	if ((!isRefresh) && (rounded == lastValues[path])) {
+		return false;
+	}
+	lastValues[path] = rounded;
+	return true;
+}
+
+bool Signal_K_Output::IsSatellitesChanged(const std::vector<SatelliteInformation> &satellites, bool isRefresh) {
+	bool isChanged = isRefresh || (satellites.size() != lastSatellites.size());
+	for (size_t i = 0; (!isChanged) && (i < satellites.size()); i++) {
+		isChanged = (satellites[i].id != lastSatellites[i].id) ||
+			(Round(satellites[i].elevation * SIGNALK_DEGREES_TO_RADIANS, 4) != Round(lastSatellites[i].elevation * SIGNALK_DEGREES_TO_RADIANS, 4)) ||
+			(Round(satellites[i].azimuth * SIGNALK_DEGREES_TO_RADIANS, 4) != Round(lastSatellites[i].azimuth * SIGNALK_DEGREES_TO_RADIANS, 4)) ||
+			(Round(satellites[i].snr, 0) != Round(lastSatellites[i].snr, 0));
+	}
+	if (isChanged) {
+		// Reuses the existing capacity
+		lastSatellites.assign(satellites.begin(), satellites.end());
+	}
+	return isChanged;
+}
+
+// Opens the value object, the caller writes the value and closes it
+void Signal_K_Output::BeginValue(const char *path) {
+	writer.BeginObject();
+	writer.Key("path");
+	writer.String(path);
+	writer.Key("value");
+}
+
+void Signal_K_Output::ScalarValue(const char *path, double value, int precision) {
+	BeginValue(path);
+	writer.Number(value, precision);
+	writer.EndObject();
+}
+
+// As written by the JSON writer with the given number of decimal places
+double Signal_K_Output::Round(double value, int precision) {
+	double scale = pow(10.0, precision);
+	return round(value * scale) / scale;
+}
+
+const char *Signal_K_Output::MethodQuality(unsigned int fixType) {
+	switch (fixType) {
+		case 0:
+			return "no GPS";
+		case 2:
+			return "DGNSS fix";
+		default:
+			return "GNSS Fix";
+	}
+}
+
+// ISO 8601, eg. 2024-04-01T12:34:56.789Z
+void Signal_K_Output::FormatTimeStamp(long long timeStamp, char *text, size_t length) {
+	time_t seconds = (time_t)(timeStamp / 1000);
+	struct tm utc;
+	gmtime_s(&utc, &seconds);
+	snprintf(text, length, "%04d-%02d-%02dT%02d:%02d:%02d.%03dZ", utc.tm_year + 1900, utc.tm_mon + 1, utc.tm_mday,
+		utc.tm_hour, utc.tm_min, utc.tm_sec, (int)(timeStamp % 1000));
+}
@@ -0,0 +1,134 @@
+// Copyright(C) 2024 by Steven Adler
+//
+// This file is part of Windows Sensor Plugin for OpenCPN.
+//
+// Windows Sensor Plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Windows Sensor Plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Windows Sensor Plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// Project: Windows Sensor Plugin
+// Description: Streaming track simplification
+// Owner: twocanplugin@hotmail.com
+// Date: 01/04/2024
+// Version History:
+// 1.0 Initial Release
+
+#include "sensor_plugin_simplifier.h"
+
+#include <math.h>
+
+// Length of one degree of latitude (mean earth radius)
+#define METRES_PER_DEGREE 111195.08
+#define TRACK_PI 3.14159265358979323846
+
+// Project a point onto a local plane centred on the origin, returns metres east & north
+static void ProjectPoint(const TrackPoint &origin, double cosLatitude, const TrackPoint &point, double &x, double &y) {
+	double deltaLongitude = point.longitude - origin.longitude;
+	// Handle crossing the antimeridian
+	if (deltaLongitude > 180.0) {
+		deltaLongitude -= 360.0;
+	}
+	else if (deltaLongitude < -180.0) {
+		deltaLongitude += 360.0;
+	}
+	x = deltaLongitude * METRES_PER_DEGREE * cosLatitude;
+	y = (point.latitude - origin.latitude) * METRES_PER_DEGREE;
+}
+
+Track_Simplifier::Track_Simplifier(double toleranceMetres, double speedToleranceKnots) {
+	SetTolerance(toleranceMetres, speedToleranceKnots);
+	Reset();
+}
+
+Track_Simplifier::~Track_Simplifier(void) {
+}
+
+void Track_Simplifier::SetTolerance(double toleranceMetres, double speedToleranceKnots) {
+	tolerance = toleranceMetres;
+	speedTolerance = speedToleranceKnots;
+}
+
+void Track_Simplifier::Reset(void) {
+	hasAnchor = false;
+	windowCount = 0;
+	pointsIn = 0;
+	pointsOut = 0;
+}
+
+bool Track_Simplifier::IsRepresentative(const TrackPoint &candidate) {
+	double cosLatitude = cos(anchor.latitude * TRACK_PI / 180.0);
+	double candidateX, candidateY;
+	ProjectPoint(anchor, cosLatitude, candidate, candidateX, candidateY);
+
+	long long duration = candidate.timeStamp - anchor.timeStamp;
+
+	for (unsigned int i = 0; i < windowCount; i++) {
+		// Fraction of the way along the segment at which this point should be
+		double fraction = 0.0;
+		if (duration > 0) {
+			fraction = (double)(window[i].timeStamp - anchor.timeStamp) / (double)duration;
+		}
+
+		double x, y;
+		ProjectPoint(anchor, cosLatitude, window[i], x, y);
+		double deltaX = x - (fraction * candidateX);
+		double deltaY = y - (fraction * candidateY);
+		if (((deltaX * deltaX) + (deltaY * deltaY)) > (tolerance * tolerance)) {
+			return false;
+		}
+
+		double expectedSpeed = anchor.speedOverGround + (fraction * (candidate.speedOverGround - anchor.speedOverGround));
+		if (fabs(window[i].speedOverGround - expectedSpeed) > speedTolerance) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool Track_Simplifier::Add(const TrackPoint &point, TrackPoint &committed) {
+	pointsIn++;
+
+	// The first point of a stream is always retained
+	if (!hasAnchor) {
+		anchor = point;
+		hasAnchor = true;
+		committed = point;
+		pointsOut++;
+		return true;
+	}
+
+	// If the new point can no longer represent the buffered points, or the window is full,
+	// the last buffered point becomes the new anchor
+	if ((windowCount > 0) && ((windowCount == TRACK_WINDOW_SIZE) || (!IsRepresentative(point)))) {
+		anchor = window[windowCount - 1];
+		committed = anchor;
+		pointsOut++;
+		window[0] = point;
+		windowCount = 1;
+		return true;
+	}
+
+	window[windowCount] = point;
+	windowCount++;
+	return false;
+}
+
+bool Track_Simplifier::Flush(TrackPoint &committed) {
+	if (windowCount == 0) {
+		return false;
+	}
+	anchor = window[windowCount - 1];
+	committed = anchor;
+	pointsOut++;
+	windowCount = 0;
+	return true;
+}
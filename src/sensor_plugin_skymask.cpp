@@ -0,0 +1,189 @@
+// Copyright(C) 2024 by Steven Adler
+//
+// This file is part of Windows Sensor Plugin for OpenCPN.
+//
+// Windows Sensor Plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Windows Sensor Plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Windows Sensor Plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// Project: Windows Sensor Plugin
+// Description: Learned sky obstruction mask
+// Owner: twocanplugin@hotmail.com
+// Date: 01/04/2024
+// Version History:
+// 1.0 Initial Release
+
+#include "sensor_plugin_skymask.h"
+
+#include <wx/file.h>
+#include <wx/math.h>
+
+// Identifies the file format, increment the version if the cell layout changes
+static const char skyMaskMagic[4] = { 'W', 'S', 'S', 'M' };
+static const unsigned int skyMaskVersion = 1;
+
+Obstruction_Mask::Obstruction_Mask(void) {
+	Clear();
+}
+
+Obstruction_Mask::~Obstruction_Mask(void) {
+}
+
+void Obstruction_Mask::Clear(void) {
+	for (unsigned int i = 0; i < SKYMASK_AZIMUTH_CELLS; i++) {
+		for (unsigned int j = 0; j < SKYMASK_ELEVATION_CELLS; j++) {
+			cells[i][j].samples = 0;
+			cells[i][j].averageSNR = 0.0f;
+			cells[i][j].isObstructed = false;
+		}
+	}
+	for (unsigned int j = 0; j < SKYMASK_ELEVATION_CELLS; j++) {
+		bandTotal[j] = 0.0;
+		bandCount[j] = 0;
+	}
+	generation = 0;
+}
+
+unsigned int Obstruction_Mask::AzimuthCell(double azimuth) {
+	double normalised = fmod(azimuth, 360.0);
+	if (normalised < 0.0) {
+		normalised += 360.0;
+	}
+	unsigned int cell = (unsigned int)(normalised * SKYMASK_AZIMUTH_CELLS / 360.0);
+	return wxMin(cell, SKYMASK_AZIMUTH_CELLS - 1);
+}
+
+unsigned int Obstruction_Mask::ElevationCell(double elevation) {
+	double clamped = wxMax(0.0, wxMin(90.0, elevation));
+	unsigned int cell = (unsigned int)(clamped * SKYMASK_ELEVATION_CELLS / 90.0);
+	return wxMin(cell, SKYMASK_ELEVATION_CELLS - 1);
+}
+
+void Obstruction_Mask::Update(const std::vector<SatelliteInformation> &satellites) {
+	for (std::vector<SatelliteInformation>::const_iterator it = satellites.begin(); it != satellites.end(); ++it) {
+		// Ignore satellites below the horizon, or without a position
+		if ((it->elevation < 0.0) || (it->elevation > 90.0) || ((it->azimuth == 0.0) && (it->elevation == 0.0))) {
+			continue;
+		}
+
+		unsigned int azimuthCell = AzimuthCell(it->azimuth);
+		unsigned int elevationCell = ElevationCell(it->elevation);
+		SkyMaskCell &cell = cells[azimuthCell][elevationCell];
+
+		// A satellite in view but not tracked counts as zero signal
+		float snr = (float)wxMax(0.0, it->snr);
+
+		if (cell.samples == 0) {
+			bandCount[elevationCell]++;
+		}
+		if (cell.samples < SKYMASK_MAXIMUM_SAMPLES) {
+			cell.samples++;
+		}
+		float previous = cell.averageSNR;
+		cell.averageSNR += (snr - cell.averageSNR) / (float)cell.samples;
+		bandTotal[elevationCell] += (cell.averageSNR - previous);
+
+		Classify(azimuthCell, elevationCell);
+	}
+}
+
+void Obstruction_Mask::Classify(unsigned int azimuthCell, unsigned int elevationCell) {
+	SkyMaskCell &cell = cells[azimuthCell][elevationCell];
+	bool isObstructed = false;
+	if ((cell.samples >= SKYMASK_MINIMUM_SAMPLES) && (bandCount[elevationCell] > 1)) {
+		double bandAverage = bandTotal[elevationCell] / bandCount[elevationCell];
+		isObstructed = (cell.averageSNR < (bandAverage - SKYMASK_OBSTRUCTION_MARGIN));
+	}
+	if (isObstructed != cell.isObstructed) {
+		cell.isObstructed = isObstructed;
+		generation++;
+	}
+}
+
+bool Obstruction_Mask::IsObstructedCell(unsigned int azimuthCell, unsigned int elevationCell) {
+	if ((azimuthCell >= SKYMASK_AZIMUTH_CELLS) || (elevationCell >= SKYMASK_ELEVATION_CELLS)) {
+		return false;
+	}
+	return cells[azimuthCell][elevationCell].isObstructed;
+}
+
+bool Obstruction_Mask::IsObstructed(double azimuth, double elevation) {
+	return IsObstructedCell(AzimuthCell(azimuth), ElevationCell(elevation));
+}
+
+double Obstruction_Mask::ClearSkyWeight(const std::vector<SatelliteInformation> &satellites) {
+	if (satellites.empty()) {
+		return 1.0;
+	}
+	unsigned int clear = 0;
+	for (std::vector<SatelliteInformation>::const_iterator it = satellites.begin(); it != satellites.end(); ++it) {
+		if (!IsObstructed(it->azimuth, it->elevation)) {
+			clear++;
+		}
+	}
+	return (double)clear / (double)satellites.size();
+}
+
+unsigned int Obstruction_Mask::GetGeneration(void) {
+	return generation;
+}
+
+bool Obstruction_Mask::Save(const wxString &fileName) {
+	wxFile file;
+	if (!file.Open(fileName, wxFile::write)) {
+		return false;
+	}
+	file.Write(skyMaskMagic, sizeof(skyMaskMagic));
+	file.Write(&skyMaskVersion, sizeof(skyMaskVersion));
+	file.Write(cells, sizeof(cells));
+	file.Close();
+	return true;
+}
+
+bool Obstruction_Mask::Load(const wxString &fileName) {
+	if (!wxFile::Exists(fileName)) {
+		return false;
+	}
+	wxFile file;
+	if (!file.Open(fileName, wxFile::read)) {
+		return false;
+	}
+
+	char magic[4];
+	unsigned int version;
+	if ((file.Read(magic, sizeof(magic)) != sizeof(magic)) || (memcmp(magic, skyMaskMagic, sizeof(magic)) != 0) ||
+		(file.Read(&version, sizeof(version)) != sizeof(version)) || (version != skyMaskVersion)) {
+		wxLogMessage(_T("Windows Sensor Plugin, Invalid sky mask %s"), fileName);
+		return false;
+	}
+
+	SkyMaskCell loaded[SKYMASK_AZIMUTH_CELLS][SKYMASK_ELEVATION_CELLS];
+	if (file.Read(loaded, sizeof(loaded)) != sizeof(loaded)) {
+		wxLogMessage(_T("Windows Sensor Plugin, Invalid sky mask %s"), fileName);
+		return false;
+	}
+
+	Clear();
+	memcpy(cells, loaded, sizeof(cells));
+
+	// Rebuild the elevation band totals
+	for (unsigned int i = 0; i < SKYMASK_AZIMUTH_CELLS; i++) {
+		for (unsigned int j = 0; j < SKYMASK_ELEVATION_CELLS; j++) {
+			if (cells[i][j].samples > 0) {
+				bandTotal[j] += cells[i][j].averageSNR;
+				bandCount[j]++;
+			}
+		}
+	}
+	generation++;
+	return true;
+}
@@ -0,0 +1,319 @@
+// Copyright(C) 2024 by Steven Adler
+//
+// This file is part of Windows Sensor Plugin for OpenCPN.
+//
+// Windows Sensor Plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Windows Sensor Plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Windows Sensor Plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// Project: Windows Sensor Plugin
+// Description: Satellite sky plot and signal to noise ratio panel
+// Owner: twocanplugin@hotmail.com
+// Date: 01/04/2024
+// Version History:
+// 1.0 Initial Release
+
+#include "sensor_plugin_skyplot.h"
+
+#include <wx/dcclient.h>
+#include <wx/math.h>
+
+Sky_Plot_Panel::Sky_Plot_Panel(wxWindow *parent) : wxWindow(parent, wxID_ANY, wxDefaultPosition, wxSize(240, 240 + SKYPLOT_BAR_HEIGHT)), refreshTimer(this) {
+	isPending = false;
+	radius = 0;
+	obstructionMask = NULL;
+	maskGeneration = 0;
+
+	SetBackgroundStyle(wxBG_STYLE_PAINT);
+
+	Connect(wxEVT_PAINT, wxPaintEventHandler(Sky_Plot_Panel::OnPaint), NULL, this);
+	Connect(wxEVT_SIZE, wxSizeEventHandler(Sky_Plot_Panel::OnSize), NULL, this);
+	Connect(wxEVT_ERASE_BACKGROUND, wxEraseEventHandler(Sky_Plot_Panel::OnEraseBackground), NULL, this);
+	Connect(wxEVT_TIMER, wxTimerEventHandler(Sky_Plot_Panel::OnTimer), NULL, this);
+
+	DrawBackground();
+	DrawAll();
+
+	refreshTimer.Start(SKYPLOT_REFRESH_INTERVAL, wxTIMER_CONTINUOUS);
+}
+
+Sky_Plot_Panel::~Sky_Plot_Panel() {
+	refreshTimer.Stop();
+	Disconnect(wxEVT_PAINT, wxPaintEventHandler(Sky_Plot_Panel::OnPaint), NULL, this);
+	Disconnect(wxEVT_SIZE, wxSizeEventHandler(Sky_Plot_Panel::OnSize), NULL, this);
+	Disconnect(wxEVT_ERASE_BACKGROUND, wxEraseEventHandler(Sky_Plot_Panel::OnEraseBackground), NULL, this);
+	Disconnect(wxEVT_TIMER, wxTimerEventHandler(Sky_Plot_Panel::OnTimer), NULL, this);
+}
+
+// Called at the sensor rate, the snapshot is only displayed when the refresh timer fires
+void Sky_Plot_Panel::SetSatellites(const std::vector<SatelliteInformation> &satellites) {
+	pending = satellites;
+	isPending = true;
+}
+
+void Sky_Plot_Panel::SetObstructionMask(Obstruction_Mask *mask) {
+	obstructionMask = mask;
+	DrawBackground();
+	DrawAll();
+	Refresh(false);
+}
+
+void Sky_Plot_Panel::OnTimer(wxTimerEvent &event) {
+	if (!IsShownOnScreen()) {
+		return;
+	}
+
+	// The mask changes rarely, but when it does the cached background must be redrawn
+	if ((obstructionMask != NULL) && (obstructionMask->GetGeneration() != maskGeneration)) {
+		DrawBackground();
+		displayed = pending;
+		DrawAll();
+		Refresh(false);
+		isPending = false;
+		return;
+	}
+
+	if (isPending) {
+		ApplySnapshot();
+		isPending = false;
+	}
+}
+
+void Sky_Plot_Panel::OnEraseBackground(wxEraseEvent &event) {
+	// Everything is drawn from the composite bitmap, prevents flicker
+}
+
+void Sky_Plot_Panel::OnPaint(wxPaintEvent &event) {
+	// Only the invalidated region is actually copied to the screen
+	wxPaintDC dc(this);
+	dc.DrawBitmap(compositeBitmap, 0, 0, false);
+}
+
+void Sky_Plot_Panel::OnSize(wxSizeEvent &event) {
+	DrawBackground();
+	DrawAll();
+	Refresh(false);
+	event.Skip();
+}
+
+// Range rings at 0, 30 and 60 degrees elevation, cardinal points and the bar chart axis
+void Sky_Plot_Panel::DrawBackground(void) {
+	wxSize size = GetClientSize();
+	if ((size.GetWidth() < 1) || (size.GetHeight() < SKYPLOT_BAR_HEIGHT + 1)) {
+		size = wxSize(240, 240 + SKYPLOT_BAR_HEIGHT);
+	}
+
+	int plotHeight = size.GetHeight() - SKYPLOT_BAR_HEIGHT;
+	radius = (wxMin(size.GetWidth(), plotHeight) / 2) - (SKYPLOT_SYMBOL_SIZE / 2) - 2;
+	if (radius < 10) {
+		radius = 10;
+	}
+	centre = wxPoint(size.GetWidth() / 2, plotHeight / 2);
+
+	backgroundBitmap = wxBitmap(size.GetWidth(), size.GetHeight());
+	wxMemoryDC dc(backgroundBitmap);
+	dc.SetBackground(wxBrush(GetBackgroundColour()));
+	dc.Clear();
+
+	DrawObstructions(dc);
+
+	dc.SetPen(wxPen(wxColour(128, 128, 128), 1));
+	dc.SetBrush(*wxTRANSPARENT_BRUSH);
+	for (int i = 1; i <= 3; i++) {
+		dc.DrawCircle(centre, (radius * i) / 3);
+	}
+	dc.DrawLine(centre.x - radius, centre.y, centre.x + radius, centre.y);
+	dc.DrawLine(centre.x, centre.y - radius, centre.x, centre.y + radius);
+
+	dc.SetTextForeground(GetForegroundColour());
+	dc.DrawText(_T("N"), centre.x + 2, centre.y - radius);
+	dc.DrawText(_T("S"), centre.x + 2, centre.y + radius - dc.GetCharHeight());
+	dc.DrawText(_T("E"), centre.x + radius - dc.GetCharWidth(), centre.y - dc.GetCharHeight());
+	dc.DrawText(_T("W"), centre.x - radius, centre.y - dc.GetCharHeight());
+
+	dc.DrawLine(0, plotHeight + SKYPLOT_BAR_HEIGHT - 14, size.GetWidth(), plotHeight + SKYPLOT_BAR_HEIGHT - 14);
+	dc.SelectObject(wxNullBitmap);
+
+	compositeBitmap = wxBitmap(size.GetWidth(), size.GetHeight());
+}
+
+// Shade each obstructed cell of the mask as an annular sector
+void Sky_Plot_Panel::DrawObstructions(wxDC &dc) {
+	if (obstructionMask == NULL) {
+		return;
+	}
+	maskGeneration = obstructionMask->GetGeneration();
+
+	dc.SetPen(*wxTRANSPARENT_PEN);
+	dc.SetBrush(wxBrush(wxColour(200, 200, 200)));
+
+	double azimuthStep = 360.0 / SKYMASK_AZIMUTH_CELLS;
+	double elevationStep = 90.0 / SKYMASK_ELEVATION_CELLS;
+
+	for (unsigned int i = 0; i < SKYMASK_AZIMUTH_CELLS; i++) {
+		for (unsigned int j = 0; j < SKYMASK_ELEVATION_CELLS; j++) {
+			if (!obstructionMask->IsObstructedCell(i, j)) {
+				continue;
+			}
+			double outer = radius * (90.0 - (j * elevationStep)) / 90.0;
+			double inner = radius * (90.0 - ((j + 1) * elevationStep)) / 90.0;
+			wxPoint sector[6];
+			for (int k = 0; k < 3; k++) {
+				double azimuth = ((i * azimuthStep) + (k * azimuthStep / 2.0)) * M_PI / 180.0;
+				sector[k] = wxPoint(centre.x + (int)(outer * sin(azimuth)), centre.y - (int)(outer * cos(azimuth)));
+				sector[5 - k] = wxPoint(centre.x + (int)(inner * sin(azimuth)), centre.y - (int)(inner * cos(azimuth)));
+			}
+			dc.DrawPolygon(6, sector);
+		}
+	}
+}
+
+// Redraw everything, only used when the panel is resized or the mask changes
+void Sky_Plot_Panel::DrawAll(void) {
+	wxMemoryDC dc(compositeBitmap);
+	dc.DrawBitmap(backgroundBitmap, 0, 0, false);
+	for (unsigned int i = 0; i < displayed.size(); i++) {
+		DrawSatellite(dc, displayed.at(i));
+		DrawBar(dc, i, displayed.at(i));
+	}
+	dc.SelectObject(wxNullBitmap);
+}
+
+bool Sky_Plot_Panel::HasChanged(const SatelliteInformation &previous, const SatelliteInformation &current) {
+	// Compare at display resolution, sub-degree movement is not visible
+	return ((previous.id != current.id) ||
+		((int)previous.azimuth != (int)current.azimuth) ||
+		((int)previous.elevation != (int)current.elevation) ||
+		((int)previous.snr != (int)current.snr));
+}
+
+// Only satellites whose values have changed are redrawn
+void Sky_Plot_Panel::ApplySnapshot(void) {
+	std::vector<wxRect> dirtyRects;
+	std::vector<bool> isBarDirty(SKYPLOT_MAXIMUM_BARS, false);
+
+	size_t count = wxMax(displayed.size(), pending.size());
+	for (size_t i = 0; i < count; i++) {
+		bool hasPrevious = (i < displayed.size());
+		bool hasCurrent = (i < pending.size());
+		if ((hasPrevious) && (hasCurrent) && (!HasChanged(displayed.at(i), pending.at(i)))) {
+			continue;
+		}
+		if (hasPrevious) {
+			dirtyRects.push_back(SymbolRect(displayed.at(i)));
+		}
+		if (hasCurrent) {
+			dirtyRects.push_back(SymbolRect(pending.at(i)));
+		}
+		if (i < SKYPLOT_MAXIMUM_BARS) {
+			dirtyRects.push_back(BarRect(i));
+			isBarDirty.at(i) = true;
+		}
+	}
+
+	displayed = pending;
+
+	if (dirtyRects.empty()) {
+		return;
+	}
+
+	wxMemoryDC backgroundDC(backgroundBitmap);
+	wxMemoryDC dc(compositeBitmap);
+
+	// Restore the background beneath every changed area
+	for (std::vector<wxRect>::const_iterator it = dirtyRects.begin(); it != dirtyRects.end(); ++it) {
+		dc.Blit(it->GetPosition(), it->GetSize(), &backgroundDC, it->GetPosition());
+	}
+
+	// Redraw changed satellites, and any unchanged satellite that overlaps a restored area
+	for (unsigned int i = 0; i < displayed.size(); i++) {
+		wxRect symbolRect = SymbolRect(displayed.at(i));
+		for (std::vector<wxRect>::const_iterator it = dirtyRects.begin(); it != dirtyRects.end(); ++it) {
+			if (symbolRect.Intersects(*it)) {
+				DrawSatellite(dc, displayed.at(i));
+				break;
+			}
+		}
+		if ((i < SKYPLOT_MAXIMUM_BARS) && (isBarDirty.at(i))) {
+			DrawBar(dc, i, displayed.at(i));
+		}
+	}
+
+	dc.SelectObject(wxNullBitmap);
+	backgroundDC.SelectObject(wxNullBitmap);
+
+	for (std::vector<wxRect>::const_iterator it = dirtyRects.begin(); it != dirtyRects.end(); ++it) {
+		RefreshRect(*it, false);
+	}
+}
+
+wxRect Sky_Plot_Panel::SymbolRect(const SatelliteInformation &satellite) {
+	// Satellites below the horizon are drawn on the outer ring
+	double elevation = wxMax(0.0, wxMin(90.0, satellite.elevation));
+	double distance = radius * (90.0 - elevation) / 90.0;
+	double azimuth = satellite.azimuth * M_PI / 180.0;
+	int x = centre.x + (int)(distance * sin(azimuth));
+	int y = centre.y - (int)(distance * cos(azimuth));
+	return wxRect(x - (SKYPLOT_SYMBOL_SIZE / 2), y - (SKYPLOT_SYMBOL_SIZE / 2), SKYPLOT_SYMBOL_SIZE, SKYPLOT_SYMBOL_SIZE);
+}
+
+wxRect Sky_Plot_Panel::BarRect(unsigned int index) {
+	wxSize size = GetClientSize();
+	int width = wxMax(1, size.GetWidth() / SKYPLOT_MAXIMUM_BARS);
+	return wxRect(index * width, size.GetHeight() - SKYPLOT_BAR_HEIGHT, width, SKYPLOT_BAR_HEIGHT);
+}
+
+wxColour Sky_Plot_Panel::SignalColour(double snr) {
+	if (snr <= 0.0) {
+		// Not being tracked
+		return wxColour(160, 160, 160);
+	}
+	if (snr < 20.0) {
+		return wxColour(220, 0, 0);
+	}
+	if (snr < 30.0) {
+		return wxColour(230, 160, 0);
+	}
+	return wxColour(0, 170, 0);
+}
+
+void Sky_Plot_Panel::DrawSatellite(wxDC &dc, const SatelliteInformation &satellite) {
+	wxRect rect = SymbolRect(satellite);
+	dc.SetPen(*wxBLACK_PEN);
+	dc.SetBrush(wxBrush(SignalColour(satellite.snr)));
+	dc.DrawEllipse(rect);
+
+	wxString label = wxString::Format("%d", satellite.id);
+	wxSize extent = dc.GetTextExtent(label);
+	dc.SetTextForeground(*wxBLACK);
+	dc.DrawText(label, rect.x + ((rect.width - extent.GetWidth()) / 2), rect.y + ((rect.height - extent.GetHeight()) / 2));
+}
+
+// Signal to noise ratio is scaled to 50 dB-Hz
+void Sky_Plot_Panel::DrawBar(wxDC &dc, unsigned int index, const SatelliteInformation &satellite) {
+	wxRect rect = BarRect(index);
+	int labelHeight = 14;
+	int barHeight = (int)((rect.height - labelHeight) * wxMin(satellite.snr, 50.0) / 50.0);
+	if (barHeight > 0) {
+		dc.SetPen(*wxTRANSPARENT_PEN);
+		dc.SetBrush(wxBrush(SignalColour(satellite.snr)));
+		dc.DrawRectangle(rect.x + 1, rect.y + rect.height - labelHeight - barHeight, rect.width - 2, barHeight);
+	}
+
+	wxFont previousFont = dc.GetFont();
+	wxFont font = previousFont;
+	font.SetPointSize(7);
+	dc.SetFont(font);
+	dc.SetTextForeground(GetForegroundColour());
+	dc.DrawText(wxString::Format("%d", satellite.id), rect.x, rect.y + rect.height - labelHeight);
+	dc.SetFont(previousFont);
+}
@@ -0,0 +1,259 @@
+// Copyright(C) 2024 by Steven Adler
+//
+// This file is part of Windows Sensor Plugin for OpenCPN.
+//
+// Windows Sensor Plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Windows Sensor Plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Windows Sensor Plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// Project: Windows Sensor Plugin
+// Description: Location sensor discovery and state
+// Owner: twocanplugin@hotmail.com
+// Date: 01/04/2024
+// Version History:
+// 1.0 Initial Release
+
+#include "sensor_plugin_sources.h"
+
+Location_Sensors::Location_Sensors(void) {
+	sensorManager = NULL;
+}
+
+Location_Sensors::~Location_Sensors(void) {
+	Close();
+}
+
+bool Location_Sensors::Open(void) {
+	if (IsOpen()) {
+		return true;
+	}
+
+	HRESULT hr = CoCreateInstance(CLSID_SensorManager, 0, CLSCTX_ALL, __uuidof(ISensorManager), (void**)&sensorManager);
+	if ((hr != S_OK) || (sensorManager == NULL)) {
+		Performance_Counters::Increment(COUNTER_COM_FAILURES);
+		sensorManager = NULL;
+		return false;
+	}
+	wxLogMessage(_T("Windows Sensor Plugin, Sensor Manager initializated."));
+	return true;
+}
+
+void Location_Sensors::Close(void) {
+	for (std::vector<LocationSensor>::iterator it = sensors.begin(); it != sensors.end(); ++it) {
+		if (it->sensor != NULL) {
+			it->sensor->Release();
+			it->sensor = NULL;
+		}
+	}
+	sensors.clear();
+	if (sensorManager != NULL) {
+		sensorManager->Release();
+		sensorManager = NULL;
+	}
+}
+
+bool Location_Sensors::IsOpen(void) {
+	return (sensorManager != NULL);
+}
+
+std::vector<LocationSensor> &Location_Sensors::GetSensors(void) {
+	return sensors;
+}
+
+unsigned int Location_Sensors::GetPresentCount(void) {
+	unsigned int count = 0;
+	for (std::vector<LocationSensor>::iterator it = sensors.begin(); it != sensors.end(); ++it) {
+		if (it->isPresent) {
+			count++;
+		}
+	}
+	return count;
+}
+
+void Location_Sensors::Rescan(Source_Arbiter &arbiter, std::vector<SensorTransition> &transitions) {
+	if (!IsOpen()) {
+		return;
+	}
+
+	// Fails with HRESULT_FROM_WIN32(ERROR_NOT_FOUND) if there are no GPS sensors
+	ISensorCollection *sensorList = NULL;
+	ULONG sensorsCount = 0;
+	HRESULT hr = sensorManager->GetSensorsByCategory(SENSOR_TYPE_LOCATION_GPS, &sensorList);
+	if ((hr == S_OK) && (sensorList != NULL)) {
+		sensorList->GetCount(&sensorsCount);
+	}
+	else if (hr != HRESULT_FROM_WIN32(ERROR_NOT_FOUND)) {
+		Performance_Counters::Increment(COUNTER_COM_FAILURES);
+	}
+
+	std::vector<bool> isFound(sensors.size(), false);
+
+	for (ULONG i = 0; i < sensorsCount; i++) {
+		ISensor *sensor = NULL;
+		hr = sensorList->GetAt(i, &sensor);
+		if ((hr != S_OK) || (sensor == NULL)) {
+			continue;
+		}
+
+		SENSOR_ID id;
+		if (sensor->GetID(&id) != S_OK) {
+			sensor->Release();
+			continue;
+		}
+
+		unsigned int j = 0;
+		while ((j < sensors.size()) && (!IsEqualGUID(sensors[j].id, id))) {
+			j++;
+		}
+
+		if (j == sensors.size()) {
+			LocationSensor locationSensor;
+			locationSensor.sensor = NULL;
+			locationSensor.id = id;
+			locationSensor.name = wxString::Format(_T("GPS %u"), j);
+			BSTR friendlyName = NULL;
+			hr = sensor->GetFriendlyName(&friendlyName);
+			if ((hr == S_OK) && (friendlyName != NULL)) {
+				locationSensor.name = wxString::FromUTF8(_bstr_t(friendlyName));
+				SysFreeString(friendlyName);
+			}
+			locationSensor.source = arbiter.AddSource(locationSensor.name, false);
+			locationSensor.state = SENSOR_STATE_NOT_AVAILABLE;
+			locationSensor.isPresent = false;
+			locationSensor.receiveTime.monotonic = 0;
+			locationSensor.receiveTime.realtime = 0;
+			sensors.push_back(locationSensor);
+			isFound.push_back(false);
+
+			wxLogMessage(_T("Windows Sensor Plugin, GPS Sensor: %u, Name %s, Id %08lX-%04hX-%04hX-%02hhX%02hhX-%02hhX%02hhX%02hhX%02hhX%02hhX%02hhX"),
+				j, locationSensor.name, id.Data1, id.Data2, id.Data3, id.Data4[0], id.Data4[1], id.Data4[2], id.Data4[3],
+				id.Data4[4], id.Data4[5], id.Data4[6], id.Data4[7]);
+		}
+
+		isFound[j] = true;
+		LocationSensor &locationSensor = sensors[j];
+		if (locationSensor.sensor == NULL) {
+			// Newly found, or plugged back in
+			locationSensor.sensor = sensor;
+		}
+		else {
+			sensor->Release();
+		}
+
+		SensorState state;
+		if (locationSensor.sensor->GetState(&state) != S_OK) {
+			state = SENSOR_STATE_ERROR;
+		}
+		SetState(locationSensor, state, true, transitions);
+	}
+
+	if (sensorList != NULL) {
+		sensorList->Release();
+	}
+
+	// Those no longer enumerated have been removed or disabled
+	for (unsigned int j = 0; j < sensors.size(); j++) {
+		if ((!isFound[j]) && (sensors[j].sensor != NULL)) {
+			sensors[j].sensor->Release();
+			sensors[j].sensor = NULL;
+			SetState(sensors[j], SENSOR_STATE_NOT_AVAILABLE, false, transitions);
+		}
+	}
+}
+
+unsigned int Location_Sensors::Discover(void) {
+	HRESULT initialized = CoInitializeEx(NULL, COINIT_MULTITHREADED);
+
+	ISensorManager *manager = NULL;
+	ULONG sensorsCount = 0;
+	HRESULT hr = CoCreateInstance(CLSID_SensorManager, 0, CLSCTX_ALL, __uuidof(ISensorManager), (void**)&manager);
+	if ((hr == S_OK) && (manager != NULL)) {
+		ISensorCollection *sensorList = NULL;
+		hr = manager->GetSensorsByCategory(SENSOR_TYPE_LOCATION_GPS, &sensorList);
+		if ((hr == S_OK) && (sensorList != NULL)) {
+			sensorList->GetCount(&sensorsCount);
+			// Touching each sensor connects it, so that the first state and report are not delayed
+			for (ULONG i = 0; i < sensorsCount; i++) {
+				ISensor *sensor = NULL;
+				if ((sensorList->GetAt(i, &sensor) == S_OK) && (sensor != NULL)) {
+					SensorState state;
+					sensor->GetState(&state);
+					sensor->Release();
+				}
+			}
+			sensorList->Release();
+		}
+		else if (hr != HRESULT_FROM_WIN32(ERROR_NOT_FOUND)) {
+			Performance_Counters::Increment(COUNTER_COM_FAILURES);
+		}
+		manager->Release();
+	}
+	else {
+		Performance_Counters::Increment(COUNTER_COM_FAILURES);
+	}
+
+	if (SUCCEEDED(initialized)) {
+		CoUninitialize();
+	}
+	return sensorsCount;
+}
+
+void Location_Sensors::UpdateStates(std::vector<SensorTransition> &transitions) {
+	for (std::vector<LocationSensor>::iterator it = sensors.begin(); it != sensors.end(); ++it) {
+		if (it->sensor == NULL) {
+			continue;
+		}
+		SensorState state;
+		if (it->sensor->GetState(&state) != S_OK) {
+			state = SENSOR_STATE_ERROR;
+		}
+		SetState(*it, state, true, transitions);
+	}
+}
+
+void Location_Sensors::SetState(LocationSensor &sensor, SensorState state, bool isPresent, std::vector<SensorTransition> &transitions) {
+	if ((sensor.state == state) && (sensor.isPresent == isPresent)) {
+		return;
+	}
+
+	SensorTransition transition;
+	transition.name = sensor.name;
+	transition.source = sensor.source;
+	transition.previous = StateName(sensor.state, sensor.isPresent);
+	transition.current = StateName(state, isPresent);
+	transitions.push_back(transition);
+
+	sensor.state = state;
+	sensor.isPresent = isPresent;
+}
+
+wxString Location_Sensors::StateName(SensorState state, bool isPresent) {
+	if (!isPresent) {
+		return _T("Not Present");
+	}
+	switch (state) {
+		case SENSOR_STATE_READY:
+			return _T("Ready");
+		case SENSOR_STATE_NOT_AVAILABLE:
+			return _T("Not Available");
+		case SENSOR_STATE_NO_DATA:
+			return _T("No Data");
+		case SENSOR_STATE_INITIALIZING:
+			return _T("Initializing");
+		case SENSOR_STATE_ACCESS_DENIED:
+			return _T("Access Denied");
+		case SENSOR_STATE_ERROR:
+			return _T("Error");
+		default:
+			return _T("Unknown");
+	}
+}
@@ -0,0 +1,154 @@
+// Copyright(C) 2024 by Steven Adler
+//
+// This file is part of Windows Sensor Plugin for OpenCPN.
+//
+// Windows Sensor Plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Windows Sensor Plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Windows Sensor Plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// Project: Windows Sensor Plugin
+// Description: Track log and GPX export
+// Owner: twocanplugin@hotmail.com
+// Date: 01/04/2024
+// Version History:
+// 1.0 Initial Release
+
+#include "sensor_plugin_track.h"
+
+#include <wx/datetime.h>
+#include <wx/ffile.h>
+#include <wx/wfstream.h>
+#include <wx/txtstrm.h>
+#include <wx/tokenzr.h>
+
+Track_Log::Track_Log(void) {
+}
+
+Track_Log::~Track_Log(void) {
+	Close();
+}
+
+bool Track_Log::Open(const wxString &fileName, double toleranceMetres, double speedToleranceKnots) {
+	simplifier.SetTolerance(toleranceMetres, speedToleranceKnots);
+	simplifier.Reset();
+	if (!logFile.Open(fileName, wxFile::write_append)) {
+		wxLogMessage(_T("Windows Sensor Plugin, Unable to open track log %s"), fileName);
+		return false;
+	}
+	return true;
+}
+
+bool Track_Log::IsOpen(void) {
+	return logFile.IsOpened();
+}
+
+void Track_Log::Close(void) {
+	if (logFile.IsOpened()) {
+		TrackPoint point;
+		if (simplifier.Flush(point)) {
+			Write(point);
+		}
+		logFile.Close();
+		wxLogMessage(_T("Windows Sensor Plugin, Track log retained %llu of %llu points"), simplifier.pointsOut, simplifier.pointsIn);
+	}
+}
+
+void Track_Log::Append(const TrackPoint &point) {
+	TrackPoint committed;
+	if (simplifier.Add(point, committed)) {
+		Write(committed);
+	}
+}
+
+// Time (ms), Latitude, Longitude, SOG, COG
+void Track_Log::Write(const TrackPoint &point) {
+	logFile.Write(wxString::Format("%lld,%.7f,%.7f,%.2f,%.1f\n", point.timeStamp,
+		point.latitude, point.longitude, point.speedOverGround, point.courseOverGround));
+}
+
+static void WriteGPXPoint(wxFFile &gpxFile, const TrackPoint &point) {
+	gpxFile.Write(wxString::Format("<trkpt lat=\"%.7f\" lon=\"%.7f\"><time>%s</time></trkpt>\n", point.latitude, point.longitude,
+		wxDateTime(wxLongLong(point.timeStamp)).Format("%Y-%m-%dT%H:%M:%SZ", wxDateTime::UTC)));
+}
+
+// Read the track log line by line so that memory use does not depend on the length of the log
+bool Track_Log::ExportGPX(const wxString &logFileName, const wxString &gpxFileName, double toleranceMetres, double speedToleranceKnots) {
+	wxFileInputStream inputStream(logFileName);
+	if (!inputStream.IsOk()) {
+		return false;
+	}
+	wxTextInputStream textStream(inputStream);
+
+	wxFFile gpxFile(gpxFileName, "w");
+	if (!gpxFile.IsOpened()) {
+		return false;
+	}
+
+	gpxFile.Write("<?xml version=\"1.0\" encoding=\"utf-8\"?>\n");
+	gpxFile.Write("<gpx version=\"1.1\" creator=\"Windows Sensor Plugin\" xmlns=\"http://www.topografix.com/GPX/1/1\">\n");
+	gpxFile.Write("<trk><name>Windows Sensor</name><trkseg>\n");
+
+	Track_Simplifier exportSimplifier(toleranceMetres, speedToleranceKnots);
+	TrackPoint point;
+	TrackPoint committed;
+	long long previousTime = 0;
+	bool hasPrevious = false;
+	unsigned long long pointsIn = 0;
+	unsigned long long pointsOut = 0;
+
+	while (!inputStream.Eof()) {
+		wxString line = textStream.ReadLine();
+		wxStringTokenizer tokenizer(line, ",");
+		if (tokenizer.CountTokens() != 5) {
+			continue;
+		}
+		wxLongLong_t timeStamp;
+		if ((!tokenizer.GetNextToken().ToLongLong(&timeStamp)) ||
+			(!tokenizer.GetNextToken().ToCDouble(&point.latitude)) ||
+			(!tokenizer.GetNextToken().ToCDouble(&point.longitude)) ||
+			(!tokenizer.GetNextToken().ToCDouble(&point.speedOverGround)) ||
+			(!tokenizer.GetNextToken().ToCDouble(&point.courseOverGround))) {
+			continue;
+		}
+		point.timeStamp = timeStamp;
+
+		// Sessions are appended to the same log. Rather than joining them with a straight line across the gap,
+		// each is a segment of its own, simplified separately.
+		if ((hasPrevious) && ((point.timeStamp - previousTime > TRACK_SEGMENT_GAP) || (point.timeStamp < previousTime))) {
+			if (exportSimplifier.Flush(committed)) {
+				WriteGPXPoint(gpxFile, committed);
+			}
+			gpxFile.Write("</trkseg><trkseg>\n");
+			pointsIn += exportSimplifier.pointsIn;
+			pointsOut += exportSimplifier.pointsOut;
+			exportSimplifier.Reset();
+		}
+		previousTime = point.timeStamp;
+		hasPrevious = true;
+
+		if (exportSimplifier.Add(point, committed)) {
+			WriteGPXPoint(gpxFile, committed);
+		}
+	}
+
+	if (exportSimplifier.Flush(committed)) {
+		WriteGPXPoint(gpxFile, committed);
+	}
+	pointsIn += exportSimplifier.pointsIn;
+	pointsOut += exportSimplifier.pointsOut;
+
+	gpxFile.Write("</trkseg></trk>\n</gpx>\n");
+	gpxFile.Close();
+
+	wxLogMessage(_T("Windows Sensor Plugin, Exported %llu of %llu track points"), pointsOut, pointsIn);
+	return true;
+}
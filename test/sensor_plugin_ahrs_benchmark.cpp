@@ -0,0 +1,72 @@
+// Copyright(C) 2024 by Steven Adler
+//
+// This file is part of Windows Sensor Plugin for OpenCPN.
+//
+// Windows Sensor Plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Windows Sensor Plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Windows Sensor Plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// Project: Windows Sensor Plugin
+// Description: Attitude filter updates per second, replaying an IMU dataset
+// Owner: twocanplugin@hotmail.com
+// Date: 01/04/2024
+// Version History:
+// 1.0 Initial Release
+
+// Usage: sensor_plugin_ahrs_benchmark [seconds | dataset.csv]
+// Without a recorded dataset, replays the given number of seconds of a simulated seaway at 200 Hz
+
+#include "sensor_plugin_ahrs.h"
+#include "sensor_plugin_imu_replay.h"
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+
+int main(int argc, char *argv[]) {
+	std::vector<ImuSample> samples;
+	double duration = 3600.0;
+	if (argc > 1) {
+		if (!ImuLoadDataset(argv[1], samples)) {
+			duration = atof(argv[1]);
+		}
+	}
+	if (samples.empty()) {
+		if (duration <= 0.0) {
+			printf("Usage: %s [seconds | dataset.csv]\n", argv[0]);
+			return 1;
+		}
+		ImuRollingSea(duration, 200.0, samples);
+	}
+
+	Madgwick_Filter filter;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (std::vector<ImuSample>::const_iterator it = samples.begin(); it != samples.end(); ++it) {
+		filter.Update(it->gyroscope, it->accelerometer, it->magnetometer, it->elapsed);
+	}
+	std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+	double roll;
+	double pitch;
+	double yaw;
+	filter.GetEulerAngles(roll, pitch, yaw);
+
+	double seconds = std::chrono::duration<double>(end - start).count();
+	printf("%zu samples in %.3f seconds, %.0f updates per second\n", samples.size(), seconds, seconds > 0.0 ? samples.size() / seconds : 0.0);
+	printf("Final attitude, roll %.2f, pitch %.2f, yaw %.2f\n", roll, pitch, yaw);
+
+	// A diverged filter is not worth timing
+	if ((roll != roll) || (pitch != pitch) || (yaw != yaw)) {
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,142 @@
+// Copyright(C) 2024 by Steven Adler
+//
+// This file is part of Windows Sensor Plugin for OpenCPN.
+//
+// Windows Sensor Plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Windows Sensor Plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Windows Sensor Plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// Project: Windows Sensor Plugin
+// Description: Standalone tests for the Madgwick attitude filter, using replayed IMU samples
+// Owner: twocanplugin@hotmail.com
+// Date: 01/04/2024
+// Version History:
+// 1.0 Initial Release
+
+#include "sensor_plugin_ahrs.h"
+#include "sensor_plugin_imu_replay.h"
+
+#include <math.h>
+#include <stdio.h>
+
+// Sample rate of the motion sensors, Hz
+#define TEST_RATE 200.0
+
+static int failures = 0;
+
+#define CHECK_CLOSE(expected, actual, tolerance) CheckClose((double)(expected), (double)(actual), (tolerance), #actual, __LINE__)
+
+static void CheckClose(double expected, double actual, double tolerance, const char *expression, int line) {
+	if (!(fabs(expected - actual) <= tolerance)) {
+		printf("Line %d: %s is %.6f, expected %.6f\n", line, expression, actual, expected);
+		failures++;
+	}
+}
+
+static void TestRotate(void) {
+	// A quarter turn to starboard takes the bow from north to east, which is negative y in the earth frame
+	Quaternion q = ImuFromEulerAngles(0.0, 0.0, 90.0);
+	Vector3 forward = { 1.0, 0.0, 0.0 };
+	Vector3 rotated = Madgwick_Filter::Rotate(q, forward);
+	CHECK_CLOSE(0.0, rotated.x, 1e-9);
+	CHECK_CLOSE(-1.0, rotated.y, 1e-9);
+	CHECK_CLOSE(0.0, rotated.z, 1e-9);
+
+	// The conjugate undoes the rotation
+	Vector3 restored = Madgwick_Filter::Rotate(ImuConjugate(q), rotated);
+	CHECK_CLOSE(1.0, restored.x, 1e-9);
+	CHECK_CLOSE(0.0, restored.y, 1e-9);
+}
+
+// From the identity, a stationary sensor converges on its attitude
+static void TestConvergence(void) {
+	Madgwick_Filter filter;
+	ImuSample sample = ImuStationary(10.0, -5.0, 60.0, 1.0 / TEST_RATE);
+	for (unsigned int i = 0; i < 60 * TEST_RATE; i++) {
+		filter.Update(sample.gyroscope, sample.accelerometer, sample.magnetometer, sample.elapsed);
+	}
+	double roll;
+	double pitch;
+	double yaw;
+	filter.GetEulerAngles(roll, pitch, yaw);
+	CHECK_CLOSE(10.0, roll, 0.1);
+	CHECK_CLOSE(-5.0, pitch, 0.1);
+	CHECK_CLOSE(60.0, yaw, 0.1);
+
+	// The quaternion remains a unit quaternion
+	Quaternion q = filter.GetQuaternion();
+	CHECK_CLOSE(1.0, (q.w * q.w) + (q.x * q.x) + (q.y * q.y) + (q.z * q.z), 1e-9);
+
+	filter.Reset();
+	filter.GetEulerAngles(roll, pitch, yaw);
+	CHECK_CLOSE(0.0, roll, 1e-9);
+	CHECK_CLOSE(0.0, pitch, 1e-9);
+	CHECK_CLOSE(0.0, yaw, 1e-9);
+}
+
+// Without a magnetometer, roll and pitch are still referenced to gravity
+static void TestInertialOnly(void) {
+	Madgwick_Filter filter;
+	ImuSample sample = ImuStationary(-20.0, 8.0, 0.0, 1.0 / TEST_RATE);
+	Vector3 none = { 0.0, 0.0, 0.0 };
+	for (unsigned int i = 0; i < 60 * TEST_RATE; i++) {
+		filter.Update(sample.gyroscope, sample.accelerometer, none, sample.elapsed);
+	}
+	double roll;
+	double pitch;
+	double yaw;
+	filter.GetEulerAngles(roll, pitch, yaw);
+	CHECK_CLOSE(-20.0, roll, 0.1);
+	CHECK_CLOSE(8.0, pitch, 0.1);
+}
+
+// Replay a vessel in a seaway, once converged the attitude follows the motion closely
+static void TestRollingSea(void) {
+	std::vector<ImuSample> samples;
+	ImuRollingSea(180.0, TEST_RATE, samples);
+
+	Madgwick_Filter filter;
+	double worstRoll = 0.0;
+	double worstPitch = 0.0;
+	double worstYaw = 0.0;
+	for (size_t i = 0; i < samples.size(); i++) {
+		const ImuSample &sample = samples[i];
+		filter.Update(sample.gyroscope, sample.accelerometer, sample.magnetometer, sample.elapsed);
+		if (i < 60 * TEST_RATE) {
+			continue;
+		}
+		double roll;
+		double pitch;
+		double yaw;
+		filter.GetEulerAngles(roll, pitch, yaw);
+		worstRoll = fmax(worstRoll, fabs(roll - sample.roll));
+		worstPitch = fmax(worstPitch, fabs(pitch - sample.pitch));
+		worstYaw = fmax(worstYaw, fabs(yaw - sample.yaw));
+	}
+	CHECK_CLOSE(0.0, worstRoll, 0.5);
+	CHECK_CLOSE(0.0, worstPitch, 0.5);
+	CHECK_CLOSE(0.0, worstYaw, 0.5);
+}
+
+int main(void) {
+	TestRotate();
+	TestConvergence();
+	TestInertialOnly();
+	TestRollingSea();
+
+	if (failures > 0) {
+		printf("%d checks failed\n", failures);
+		return 1;
+	}
+	printf("All checks passed\n");
+	return 0;
+}
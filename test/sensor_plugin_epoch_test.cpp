@@ -0,0 +1,192 @@
+// Copyright(C) 2024 by Steven Adler
+//
+// This file is part of Windows Sensor Plugin for OpenCPN.
+//
+// Windows Sensor Plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Windows Sensor Plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Windows Sensor Plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// Project: Windows Sensor Plugin
+// Description: Standalone tests for the epoch scheduler, using a simulated clock
+// Owner: twocanplugin@hotmail.com
+// Date: 01/04/2024
+// Version History:
+// 1.0 Initial Release
+
+#include "sensor_plugin_epoch.h"
+
+#include <math.h>
+#include <stdio.h>
+
+// Simulated monotonic clock of one tick per microsecond
+#define TEST_FREQUENCY 1000000LL
+// A UTC midnight, in 100 nanosecond intervals since 1601
+#define TEST_MIDNIGHT (864000000000LL * 154000LL)
+#define TEST_SECOND 10000000LL
+#define TEST_MILLISECOND 10000LL
+
+static int failures = 0;
+
+#define CHECK_EQUAL(expected, actual) CheckEqual((long long)(expected), (long long)(actual), #actual, __LINE__)
+
+static void CheckEqual(long long expected, long long actual, const char *expression, int line) {
+	if (expected != actual) {
+		printf("Line %d: %s is %lld, expected %lld\n", line, expression, actual, expected);
+		failures++;
+	}
+}
+
+// Epochs fall on multiples of the interval since midnight, plus the offset
+static void TestBoundaryAlignment(void) {
+	Epoch_Scheduler scheduler;
+	scheduler.Reset(TEST_FREQUENCY);
+	CHECK_EQUAL(false, scheduler.HasReference());
+
+	// 00:00:03.300 UTC at 5 seconds monotonic
+	scheduler.SetReference(TEST_MIDNIGHT + (3 * TEST_SECOND) + (300 * TEST_MILLISECOND), 5000000);
+	CHECK_EQUAL(true, scheduler.HasReference());
+
+	long long deadline = scheduler.NextEpoch(5000000, 1000, 50);
+	CHECK_EQUAL(5750000, deadline);
+	CHECK_EQUAL(750, scheduler.Delay(deadline, 5000000));
+
+	deadline = scheduler.NextEpoch(5000000, 200, 50);
+	CHECK_EQUAL(5150000, deadline);
+
+	// Offsets longer than the interval wrap
+	deadline = scheduler.NextEpoch(5000000, 200, 250);
+	CHECK_EQUAL(5150000, deadline);
+
+	// A boundary closer than the minimum delay is skipped rather than fired late
+	deadline = scheduler.NextEpoch(5749500, 1000, 50);
+	CHECK_EQUAL(6750000, deadline);
+
+	// Each deadline is computed afresh, so a thousand epochs later it has not drifted
+	deadline = scheduler.NextEpoch(5000000 + (999 * 1000000LL) + 1, 1000, 50);
+	CHECK_EQUAL(5750000 + (999 * 1000000LL), deadline);
+
+	// The deadline has passed
+	CHECK_EQUAL(0, scheduler.Delay(deadline, deadline + 1));
+	// and is rounded up to the next millisecond
+	CHECK_EQUAL(1, scheduler.Delay(deadline, deadline - 1));
+}
+
+// Small changes in the offset between the clocks are smoothed, a step is adopted at once
+static void TestClockStep(void) {
+	Epoch_Scheduler scheduler;
+	scheduler.Reset(TEST_FREQUENCY);
+	scheduler.SetReference(TEST_MIDNIGHT + (3 * TEST_SECOND) + (300 * TEST_MILLISECOND), 5000000);
+
+	// A report 10 ms late moves the epochs by a tenth of that
+	scheduler.SetReference(TEST_MIDNIGHT + (4 * TEST_SECOND) + (310 * TEST_MILLISECOND), 6000000);
+	CHECK_EQUAL(6749000, scheduler.NextEpoch(6000000, 1000, 50));
+
+	// The system clock is stepped forward by five seconds and a half
+	scheduler.SetReference(TEST_MIDNIGHT + (10 * TEST_SECOND) + (800 * TEST_MILLISECOND), 7000000);
+	CHECK_EQUAL(7250000, scheduler.NextEpoch(7000000, 1000, 50));
+
+	// and back again
+	scheduler.SetReference(TEST_MIDNIGHT + (5 * TEST_SECOND) + (300 * TEST_MILLISECOND), 8000000);
+	CHECK_EQUAL(8750000, scheduler.NextEpoch(8000000, 1000, 50));
+
+	// Resetting discards the reference
+	scheduler.Reset(TEST_FREQUENCY);
+	CHECK_EQUAL(false, scheduler.HasReference());
+}
+
+// Without a GNSS time the epochs follow the phase of the reports, whatever the system clock says
+static void TestReportPhase(void) {
+	Epoch_Scheduler scheduler;
+	scheduler.Reset(TEST_FREQUENCY);
+
+	// A report at 00:00:03.990 by the system clock, received at 5 seconds monotonic
+	scheduler.SetReportReference(TEST_MIDNIGHT + (3 * TEST_SECOND) + (990 * TEST_MILLISECOND), 5000000, 1000);
+	CHECK_EQUAL(true, scheduler.HasReference());
+	CHECK_EQUAL(5050000, scheduler.NextEpoch(5000000, 1000, 50));
+
+	// The system clock has drifted, so the next report is just after the following second
+	scheduler.SetReportReference(TEST_MIDNIGHT + (5 * TEST_SECOND) + (10 * TEST_MILLISECOND), 6000000, 1000);
+	CHECK_EQUAL(6050000, scheduler.NextEpoch(6000000, 1000, 50));
+
+	// The system clock is stepped back by 1.4 seconds
+	scheduler.SetReportReference(TEST_MIDNIGHT + (4 * TEST_SECOND) + (600 * TEST_MILLISECOND), 7000000, 1000);
+	CHECK_EQUAL(7050000, scheduler.NextEpoch(7000000, 1000, 50));
+
+	// A report 10 ms late moves the epochs by a tenth of that
+	scheduler.SetReportReference(TEST_MIDNIGHT + (6 * TEST_SECOND) + (610 * TEST_MILLISECOND), 8010000, 1000);
+	CHECK_EQUAL(8051000, scheduler.NextEpoch(8010000, 1000, 50));
+
+	// A shorter interval keeps the same phase
+	scheduler.SetReportReference(TEST_MIDNIGHT + (7 * TEST_SECOND) + (370 * TEST_MILLISECOND), 9001000, 200);
+	CHECK_EQUAL(9051000, scheduler.NextEpoch(9001000, 200, 50));
+
+	// A GNSS time takes over, and a report without one locks to its phase at once
+	scheduler.SetReference(TEST_MIDNIGHT + (8 * TEST_SECOND), 10001000);
+	CHECK_EQUAL(10051000, scheduler.NextEpoch(10001000, 1000, 50));
+	scheduler.SetReportReference(TEST_MIDNIGHT + (8 * TEST_SECOND) + (500 * TEST_MILLISECOND), 11000000, 1000);
+	CHECK_EQUAL(11050000, scheduler.NextEpoch(11000000, 1000, 50));
+}
+
+// Lateness within a period is jitter, whole periods are missed epochs
+static void TestMissedEpochs(void) {
+	Epoch_Scheduler scheduler;
+	scheduler.Reset(TEST_FREQUENCY);
+	scheduler.SetReference(TEST_MIDNIGHT + (3 * TEST_SECOND) + (300 * TEST_MILLISECOND), 5000000);
+
+	// Nothing is recorded unless an epoch was scheduled
+	scheduler.Record(5000000);
+
+	double mean;
+	double deviation;
+	double maximum;
+	unsigned long long count;
+	scheduler.GetJitter(mean, deviation, maximum, count);
+	CHECK_EQUAL(0, count);
+
+	// 2 ms late
+	long long deadline = scheduler.NextEpoch(5000000, 1000, 50);
+	scheduler.Record(deadline + 2000);
+	// 4 ms late
+	deadline = scheduler.NextEpoch(deadline + 2000, 1000, 50);
+	scheduler.Record(deadline + 4000);
+	scheduler.GetJitter(mean, deviation, maximum, count);
+	CHECK_EQUAL(2, count);
+	CHECK_EQUAL(3000, llround(mean * 1000.0));
+	CHECK_EQUAL(4000, llround(maximum * 1000.0));
+	CHECK_EQUAL(0, scheduler.GetMissedCount());
+
+	// OpenCPN was busy for two and a half periods
+	deadline = scheduler.NextEpoch(deadline + 4000, 1000, 50);
+	scheduler.Record(deadline + 2500000);
+	scheduler.GetJitter(mean, deviation, maximum, count);
+	CHECK_EQUAL(3, count);
+	CHECK_EQUAL(2, scheduler.GetMissedCount());
+	CHECK_EQUAL(500000, llround(maximum * 1000.0));
+
+	// Recorded only once
+	scheduler.Record(deadline + 2500000);
+	scheduler.GetJitter(mean, deviation, maximum, count);
+	CHECK_EQUAL(3, count);
+}
+
+int main(void) {
+	TestBoundaryAlignment();
+	TestClockStep();
+	TestReportPhase();
+	TestMissedEpochs();
+	if (failures > 0) {
+		printf("%d checks failed\n", failures);
+		return 1;
+	}
+	printf("All checks passed\n");
+	return 0;
+}
@@ -0,0 +1,176 @@
+// Copyright(C) 2024 by Steven Adler
+//
+// This file is part of Windows Sensor Plugin for OpenCPN.
+//
+// Windows Sensor Plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Windows Sensor Plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Windows Sensor Plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// Project: Windows Sensor Plugin
+// Description: Standalone tests for the heading and rate of turn derived from the compass and gyrometer
+// Owner: twocanplugin@hotmail.com
+// Date: 01/04/2024
+// Version History:
+// 1.0 Initial Release
+
+#include "sensor_plugin_heading.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+// Sensor timestamps are in 100 nanosecond units
+#define TEST_TICKS_PER_SECOND 10000000LL
+// 2024-01-01 00:00:00 UTC as a Windows file time
+#define TEST_START_TIME 133485408000000000LL
+
+static int failures = 0;
+
+#define CHECK_EQUAL(expected, actual) CheckEqual((long long)(expected), (long long)(actual), #actual, __LINE__)
+#define CHECK_CLOSE(expected, actual, tolerance) CheckClose((double)(expected), (double)(actual), (tolerance), #actual, __LINE__)
+#define CHECK_STRING(expected, actual) CheckString((expected), (actual), #actual, __LINE__)
+
+static void CheckEqual(long long expected, long long actual, const char *expression, int line) {
+	if (expected != actual) {
+		printf("Line %d: %s is %lld, expected %lld\n", line, expression, actual, expected);
+		failures++;
+	}
+}
+
+static void CheckClose(double expected, double actual, double tolerance, const char *expression, int line) {
+	if (!(fabs(expected - actual) <= tolerance)) {
+		printf("Line %d: %s is %.6f, expected %.6f\n", line, expression, actual, expected);
+		failures++;
+	}
+}
+
+static void CheckString(const char *expected, const std::string &actual, const char *expression, int line) {
+	if (strcmp(expected, actual.c_str()) != 0) {
+		printf("Line %d: %s is %s, expected %s\n", line, expression, actual.c_str(), expected);
+		failures++;
+	}
+}
+
+static void TestTrueHeading(void) {
+	double trueHeading = -1.0;
+	CHECK_EQUAL(true, Heading_Estimator::TrueHeading(100.0, 2.5, true, trueHeading));
+	CHECK_CLOSE(102.5, trueHeading, 1e-9);
+	// Westerly variation
+	CHECK_EQUAL(true, Heading_Estimator::TrueHeading(100.0, -4.0, true, trueHeading));
+	CHECK_CLOSE(96.0, trueHeading, 1e-9);
+	// Through north, both ways
+	CHECK_EQUAL(true, Heading_Estimator::TrueHeading(355.0, 10.0, true, trueHeading));
+	CHECK_CLOSE(5.0, trueHeading, 1e-9);
+	CHECK_EQUAL(true, Heading_Estimator::TrueHeading(3.0, -10.0, true, trueHeading));
+	CHECK_CLOSE(353.0, trueHeading, 1e-9);
+	// Without a variation there is no true heading, and it is left untouched
+	trueHeading = -1.0;
+	CHECK_EQUAL(false, Heading_Estimator::TrueHeading(100.0, 0.0, false, trueHeading));
+	CHECK_CLOSE(-1.0, trueHeading, 0.0);
+}
+
+static void TestGyrometerRate(void) {
+	// Counter clockwise seen from above is a turn to port
+	CHECK_CLOSE(-180.0, Heading_Estimator::GyrometerRate(3.0), 1e-9);
+	CHECK_CLOSE(60.0, Heading_Estimator::GyrometerRate(-1.0), 1e-9);
+	CHECK_CLOSE(0.0, Heading_Estimator::GyrometerRate(0.0), 1e-9);
+}
+
+// A steady turn of three degrees per second, sampled at 20 Hz, through north
+static void TestHeadingRate(void) {
+	Heading_Estimator estimator;
+	double rateOfTurn = 12345.0;
+	long long interval = TEST_TICKS_PER_SECOND / 20;
+	double heading = 340.0;
+	long long timeStamp = TEST_START_TIME;
+	// Nothing to compare the first heading with
+	CHECK_EQUAL(false, estimator.Update(heading, timeStamp, rateOfTurn));
+	CHECK_CLOSE(12345.0, rateOfTurn, 0.0);
+	// Time has not advanced
+	CHECK_EQUAL(false, estimator.Update(heading, timeStamp, rateOfTurn));
+
+	double largest = 0.0;
+	double smallest = 1e9;
+	for (unsigned int i = 1; i <= 200; i++) {
+		heading = fmod(heading + 0.15, 360.0);
+		timeStamp += interval;
+		CHECK_EQUAL(true, estimator.Update(heading, timeStamp, rateOfTurn));
+		// Settled after seven time constants
+		if (i > 140) {
+			largest = fmax(largest, rateOfTurn);
+			smallest = fmin(smallest, rateOfTurn);
+		}
+	}
+	// Passing through north is not a turn of 360 degrees the other way
+	CHECK_CLOSE(180.0, smallest, 1.0);
+	CHECK_CLOSE(180.0, largest, 1.0);
+
+	// Turning to port through north
+	estimator.Reset();
+	heading = 20.0;
+	estimator.Update(heading, timeStamp, rateOfTurn);
+	for (unsigned int i = 1; i <= 200; i++) {
+		heading = fmod(heading - 0.15 + 360.0, 360.0);
+		timeStamp += interval;
+		estimator.Update(heading, timeStamp, rateOfTurn);
+	}
+	CHECK_CLOSE(-180.0, rateOfTurn, 1.0);
+}
+
+// A sudden change in the rate of turn is followed with the filter's time constant
+static void TestRateFilter(void) {
+	Heading_Estimator estimator;
+	double rateOfTurn = 0.0;
+	long long interval = TEST_TICKS_PER_SECOND / 100;
+	double heading = 90.0;
+	long long timeStamp = TEST_START_TIME;
+	estimator.Update(heading, timeStamp, rateOfTurn);
+	for (unsigned int i = 1; i <= (unsigned int)(ORIENTATION_RATE_TIME_CONSTANT * 100.0); i++) {
+		heading += 0.1;
+		timeStamp += interval;
+		estimator.Update(heading, timeStamp, rateOfTurn);
+	}
+	// Ten degrees per second, about 63% of the way there after one time constant
+	CHECK_CLOSE(600.0 * (1.0 - exp(-1.0)), rateOfTurn, 10.0);
+
+	// A single noisy heading barely moves the rate
+	double before = rateOfTurn;
+	heading += 5.0;
+	timeStamp += interval;
+	estimator.Update(heading, timeStamp, rateOfTurn);
+	CHECK_CLOSE(before, rateOfTurn, 0.02 * 60.0 * 5.0 / 0.01);
+	CHECK_EQUAL(true, rateOfTurn > before);
+}
+
+static void TestSentences(void) {
+	CHECK_STRING("$IIHDG,123.4,,,2.5,E", Heading_Estimator::FormatHDG(123.44, 2.5, true));
+	CHECK_STRING("$IIHDG,5.0,,,3.2,W", Heading_Estimator::FormatHDG(5.0, -3.2, true));
+	CHECK_STRING("$IIHDG,359.9,,,,", Heading_Estimator::FormatHDG(359.94, -3.2, false));
+	CHECK_STRING("$IIHDT,0.5,T", Heading_Estimator::FormatHDT(0.5));
+	CHECK_STRING("$IIROT,-180.0,A", Heading_Estimator::FormatROT(-180.0));
+	CHECK_STRING("$IIROT,12.3,A", Heading_Estimator::FormatROT(12.345));
+}
+
+int main(void) {
+	TestTrueHeading();
+	TestGyrometerRate();
+	TestHeadingRate();
+	TestRateFilter();
+	TestSentences();
+
+	if (failures > 0) {
+		printf("%d checks failed\n", failures);
+		return 1;
+	}
+	printf("All checks passed\n");
+	return 0;
+}
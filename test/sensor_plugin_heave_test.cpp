@@ -0,0 +1,118 @@
+// Copyright(C) 2024 by Steven Adler
+//
+// This file is part of Windows Sensor Plugin for OpenCPN.
+//
+// Windows Sensor Plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Windows Sensor Plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Windows Sensor Plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// Project: Windows Sensor Plugin
+// Description: Standalone tests for the heave estimator, using simulated vertical acceleration
+// Owner: twocanplugin@hotmail.com
+// Date: 01/04/2024
+// Version History:
+// 1.0 Initial Release
+
+#include "sensor_plugin_heave.h"
+
+#include <math.h>
+#include <stdio.h>
+
+#define TEST_PI 3.14159265358979323846
+// Sample rate of the motion sensors, Hz
+#define TEST_RATE 200.0
+
+static int failures = 0;
+
+#define CHECK_EQUAL(expected, actual) CheckEqual((long long)(expected), (long long)(actual), #actual, __LINE__)
+#define CHECK_CLOSE(expected, actual, tolerance) CheckClose((double)(expected), (double)(actual), (tolerance), #actual, __LINE__)
+
+static void CheckEqual(long long expected, long long actual, const char *expression, int line) {
+	if (expected != actual) {
+		printf("Line %d: %s is %lld, expected %lld\n", line, expression, actual, expected);
+		failures++;
+	}
+}
+
+static void CheckClose(double expected, double actual, double tolerance, const char *expression, int line) {
+	if (!(fabs(expected - actual) <= tolerance)) {
+		printf("Line %d: %s is %.6f, expected %.6f\n", line, expression, actual, expected);
+		failures++;
+	}
+}
+
+// Vertical acceleration of a sinusoidal swell, with a sensor bias
+static double SwellAcceleration(double amplitude, double period, double bias, double t) {
+	double frequency = 2.0 * TEST_PI / period;
+	return (-amplitude * frequency * frequency * sin(frequency * t)) + bias;
+}
+
+static void TestSettling(void) {
+	Heave_Estimator estimator;
+	double elapsed = 1.0 / TEST_RATE;
+	for (unsigned int i = 0; i < (HEAVE_SETTLING_TIME - 1.0) * TEST_RATE; i++) {
+		estimator.Process(SwellAcceleration(1.0, 8.0, 0.0, i * elapsed), elapsed);
+	}
+	CHECK_EQUAL(false, estimator.IsSettled());
+	CHECK_CLOSE(0.0, estimator.GetSignificantHeave(), 0.0);
+	for (unsigned int i = 0; i < 2 * TEST_RATE; i++) {
+		estimator.Process(0.0, elapsed);
+	}
+	CHECK_EQUAL(true, estimator.IsSettled());
+
+	// Samples without a time step are ignored
+	estimator.Reset();
+	estimator.Process(1.0, 0.0);
+	CHECK_CLOSE(0.0, estimator.GetHeave(), 0.0);
+	CHECK_EQUAL(false, estimator.IsSettled());
+}
+
+// A one metre swell of eight seconds, the band pass filters cost a little amplitude
+static void TestSwell(void) {
+	Heave_Estimator estimator;
+	double elapsed = 1.0 / TEST_RATE;
+	double largest = 0.0;
+	for (unsigned int i = 1; i <= 200 * TEST_RATE; i++) {
+		double t = i * elapsed;
+		estimator.Process(SwellAcceleration(1.0, 8.0, 0.05, t), elapsed);
+		if (t > 150.0) {
+			largest = fmax(largest, fabs(estimator.GetHeave()));
+		}
+	}
+	CHECK_CLOSE(1.0, largest, 0.1);
+	// Four times the standard deviation of a sine wave of unit amplitude
+	CHECK_CLOSE(4.0 / sqrt(2.0), estimator.GetSignificantHeave(), 0.25);
+}
+
+// A constant bias would integrate to an ever increasing displacement without the high pass filters
+static void TestBias(void) {
+	Heave_Estimator estimator;
+	double elapsed = 1.0 / TEST_RATE;
+	for (unsigned int i = 0; i < 600 * TEST_RATE; i++) {
+		estimator.Process(0.05, elapsed);
+	}
+	CHECK_CLOSE(0.0, estimator.GetHeave(), 0.01);
+	CHECK_CLOSE(0.0, estimator.GetSignificantHeave(), 0.01);
+}
+
+int main(void) {
+	TestSettling();
+	TestSwell();
+	TestBias();
+
+	if (failures > 0) {
+		printf("%d checks failed\n", failures);
+		return 1;
+	}
+	printf("All checks passed\n");
+	return 0;
+}
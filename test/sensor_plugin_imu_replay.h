@@ -0,0 +1,145 @@
+// Copyright(C) 2024 by Steven Adler
+//
+// This file is part of Windows Sensor Plugin for OpenCPN.
+//
+// Windows Sensor Plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Windows Sensor Plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Windows Sensor Plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// Project: Windows Sensor Plugin
+// Description: IMU datasets replayed by the attitude and heave tests and benchmark
+// Owner: twocanplugin@hotmail.com
+// Date: 01/04/2024
+// Version History:
+// 1.0 Initial Release
+
+#ifndef WINDOWS_SENSOR_PLUGIN_IMU_REPLAY_H
+#define WINDOWS_SENSOR_PLUGIN_IMU_REPLAY_H
+
+#include "sensor_plugin_ahrs.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <vector>
+
+#define IMU_PI 3.14159265358979323846
+#define IMU_GRAVITY 9.80665
+// Magnetic field strength and inclination, microtesla and degrees, typical of mid latitudes
+#define IMU_FIELD_STRENGTH 50.0
+#define IMU_FIELD_INCLINATION 60.0
+
+// One sample, as the motion sensors would report it, with the true attitude in degrees
+typedef struct _imu_sample {
+	double elapsed;
+	Vector3 gyroscope;
+	Vector3 accelerometer;
+	Vector3 magnetometer;
+	double roll;
+	double pitch;
+	double yaw;
+} ImuSample;
+
+// Inverse of Madgwick_Filter::GetEulerAngles
+static inline Quaternion ImuFromEulerAngles(double roll, double pitch, double yaw) {
+	double r = roll * IMU_PI / 360.0;
+	double p = -pitch * IMU_PI / 360.0;
+	double y = -yaw * IMU_PI / 360.0;
+	Quaternion q;
+	q.w = cos(r) * cos(p) * cos(y) + sin(r) * sin(p) * sin(y);
+	q.x = sin(r) * cos(p) * cos(y) - cos(r) * sin(p) * sin(y);
+	q.y = cos(r) * sin(p) * cos(y) + sin(r) * cos(p) * sin(y);
+	q.z = cos(r) * cos(p) * sin(y) - sin(r) * sin(p) * cos(y);
+	return q;
+}
+
+static inline Quaternion ImuConjugate(const Quaternion &q) {
+	Quaternion result = { q.w, -q.x, -q.y, -q.z };
+	return result;
+}
+
+static inline Quaternion ImuMultiply(const Quaternion &a, const Quaternion &b) {
+	Quaternion result;
+	result.w = a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z;
+	result.x = a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y;
+	result.y = a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x;
+	result.z = a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w;
+	return result;
+}
+
+// Readings of a stationary sensor at the given attitude, the body rates are zero
+static inline ImuSample ImuStationary(double roll, double pitch, double yaw, double elapsed) {
+	Quaternion bodyFromEarth = ImuConjugate(ImuFromEulerAngles(roll, pitch, yaw));
+	Vector3 up = { 0.0, 0.0, IMU_GRAVITY };
+	double inclination = IMU_FIELD_INCLINATION * IMU_PI / 180.0;
+	Vector3 field = { IMU_FIELD_STRENGTH * cos(inclination), 0.0, -IMU_FIELD_STRENGTH * sin(inclination) };
+	ImuSample sample;
+	sample.elapsed = elapsed;
+	sample.gyroscope.x = 0.0;
+	sample.gyroscope.y = 0.0;
+	sample.gyroscope.z = 0.0;
+	sample.accelerometer = Madgwick_Filter::Rotate(bodyFromEarth, up);
+	sample.magnetometer = Madgwick_Filter::Rotate(bodyFromEarth, field);
+	sample.roll = roll;
+	sample.pitch = pitch;
+	sample.yaw = yaw;
+	return sample;
+}
+
+// A vessel rolling, pitching and yawing in a seaway. Only the rotation is simulated, the accelerometer
+// measures gravity alone, and the body rates are derived from consecutive attitudes.
+static inline void ImuRollingSea(double duration, double rate, std::vector<ImuSample> &samples) {
+	double elapsed = 1.0 / rate;
+	unsigned int count = (unsigned int)(duration * rate);
+	samples.clear();
+	samples.reserve(count);
+	ImuSample previous = ImuStationary(0.0, 0.0, 60.0, elapsed);
+	for (unsigned int i = 1; i <= count; i++) {
+		double t = i * elapsed;
+		double roll = 15.0 * sin(2.0 * IMU_PI * t / 8.0);
+		double pitch = 5.0 * sin(2.0 * IMU_PI * t / 6.0);
+		double yaw = 60.0 + (10.0 * sin(2.0 * IMU_PI * t / 20.0));
+		ImuSample sample = ImuStationary(roll, pitch, yaw, elapsed);
+
+		// Body rates are twice the vector part of the rotation between samples, divided by the interval
+		Quaternion delta = ImuMultiply(ImuConjugate(ImuFromEulerAngles(previous.roll, previous.pitch, previous.yaw)),
+			ImuFromEulerAngles(roll, pitch, yaw));
+		sample.gyroscope.x = 2.0 * delta.x / elapsed;
+		sample.gyroscope.y = 2.0 * delta.y / elapsed;
+		sample.gyroscope.z = 2.0 * delta.z / elapsed;
+		samples.push_back(sample);
+		previous = sample;
+	}
+}
+
+// Recorded dataset, one sample per line of comma separated elapsed seconds, gyroscope in radians per second,
+// accelerometer and magnetometer, each x, y and z. The true attitude is unknown and left as zero.
+static inline bool ImuLoadDataset(const char *fileName, std::vector<ImuSample> &samples) {
+	FILE *file = fopen(fileName, "r");
+	if (file == NULL) {
+		return false;
+	}
+	samples.clear();
+	char line[512];
+	while (fgets(line, sizeof(line), file) != NULL) {
+		ImuSample sample = {};
+		if (sscanf(line, "%lf,%lf,%lf,%lf,%lf,%lf,%lf,%lf,%lf,%lf", &sample.elapsed,
+			&sample.gyroscope.x, &sample.gyroscope.y, &sample.gyroscope.z,
+			&sample.accelerometer.x, &sample.accelerometer.y, &sample.accelerometer.z,
+			&sample.magnetometer.x, &sample.magnetometer.y, &sample.magnetometer.z) == 10) {
+			samples.push_back(sample);
+		}
+	}
+	fclose(file);
+	return !samples.empty();
+}
+
+#endif
@@ -0,0 +1,245 @@
+// Copyright(C) 2024 by Steven Adler
+//
+// This file is part of Windows Sensor Plugin for OpenCPN.
+//
+// Windows Sensor Plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Windows Sensor Plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Windows Sensor Plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// Project: Windows Sensor Plugin
+// Description: Standalone tests for the NMEA 2000 PGN encoders and fast packet segmenter
+// Owner: twocanplugin@hotmail.com
+// Date: 01/04/2024
+// Version History:
+// 1.0 Initial Release
+
+#include "sensor_plugin_n2k_encoder.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static int failures = 0;
+
+#define CHECK_EQUAL(expected, actual) CheckEqual((long long)(expected), (long long)(actual), #actual, __LINE__)
+
+static void CheckEqual(long long expected, long long actual, const char *expression, int line) {
+	if (expected != actual) {
+		printf("Line %d: %s is %lld, expected %lld\n", line, expression, actual, expected);
+		failures++;
+	}
+}
+
+static unsigned long long ReadLittleEndian(const unsigned char *p, unsigned int length) {
+	unsigned long long value = 0;
+	for (unsigned int i = 0; i < length; i++) {
+		value |= (unsigned long long)p[i] << (i * 8);
+	}
+	return value;
+}
+
+// Reassemble a fast packet as a receiver would, returns the length or -1 if the frames are malformed
+static int Reassemble(const CanFrame *frames, unsigned int count, unsigned char sequence, unsigned char *payload) {
+	if ((count == 0) || (frames[0].data[0] != ((sequence << 5) | 0))) {
+		return -1;
+	}
+	int length = frames[0].data[1];
+	int offset = 0;
+	for (unsigned int i = 0; i < count; i++) {
+		if ((frames[i].id != frames[0].id) || (frames[i].length != 8) || (frames[i].data[0] != ((sequence << 5) | i))) {
+			return -1;
+		}
+		unsigned int start = i == 0 ? 2 : 1;
+		for (unsigned int j = start; (j < 8) && (offset < length); j++) {
+			payload[offset++] = frames[i].data[j];
+		}
+	}
+	return offset == length ? length : -1;
+}
+
+static PositionFix TestFix(void) {
+	PositionFix fix;
+	memset(&fix, 0, sizeof(fix));
+	fix.latitude = -33.8583333;
+	fix.longitude = 151.2050000;
+	fix.altitude = 12.5;
+	fix.speedOverGround = 10.0;
+	fix.courseOverGround = 90.0;
+	fix.hDOP = 0.9;
+	fix.pDOP = 1.6;
+	fix.geoidalSeparation = 22.1;
+	fix.satellitesInUse = 9;
+	fix.fixType = 1;
+	// 2024-01-01 12:00:00.250 UTC
+	fix.timeStamp = 1704110400250LL;
+	fix.isValid = true;
+	return fix;
+}
+
+static void TestSingleFrame(void) {
+	CanFrame frames[N2K_FAST_PACKET_MAXIMUM_FRAMES];
+	unsigned char payload[8] = { 1, 2, 3, 4, 5 };
+
+	CHECK_EQUAL(1, N2K_Encoder::Segment(N2K_PGN_POSITION_RAPID, 2, 15, 0, false, payload, 5, frames, N2K_FAST_PACKET_MAXIMUM_FRAMES));
+	// Priority, PGN and source address
+	CHECK_EQUAL(0x09F8010F, frames[0].id);
+	CHECK_EQUAL(8, frames[0].length);
+	CHECK_EQUAL(5, frames[0].data[4]);
+	// Unused bytes are padded
+	CHECK_EQUAL(0xFF, frames[0].data[5]);
+	CHECK_EQUAL(0xFF, frames[0].data[7]);
+
+	// Too large for a single frame, or nowhere to put it
+	unsigned char large[9] = { 0 };
+	CHECK_EQUAL(0, N2K_Encoder::Segment(N2K_PGN_POSITION_RAPID, 2, 15, 0, false, large, 9, frames, N2K_FAST_PACKET_MAXIMUM_FRAMES));
+	CHECK_EQUAL(0, N2K_Encoder::Segment(N2K_PGN_POSITION_RAPID, 2, 15, 0, false, payload, 5, frames, 0));
+}
+
+static void TestFastPacket(void) {
+	CanFrame frames[N2K_FAST_PACKET_MAXIMUM_FRAMES];
+	unsigned char payload[N2K_FAST_PACKET_MAXIMUM_LENGTH + 1];
+	unsigned char reassembled[N2K_FAST_PACKET_MAXIMUM_LENGTH];
+	for (unsigned int i = 0; i < sizeof(payload); i++) {
+		payload[i] = (unsigned char)i;
+	}
+
+	// 6 bytes in the first frame, then 7 in each of the rest
+	unsigned int count = N2K_Encoder::Segment(N2K_PGN_GNSS_POSITION, 3, 15, 5, true, payload, 43, frames, N2K_FAST_PACKET_MAXIMUM_FRAMES);
+	CHECK_EQUAL(7, count);
+	CHECK_EQUAL(0x0DF8050F, frames[0].id);
+	CHECK_EQUAL((5 << 5) | 0, frames[0].data[0]);
+	CHECK_EQUAL(43, frames[0].data[1]);
+	CHECK_EQUAL(0, frames[0].data[2]);
+	CHECK_EQUAL((5 << 5) | 1, frames[1].data[0]);
+	CHECK_EQUAL(6, frames[1].data[1]);
+	// The last frame has 2 bytes of payload and is padded
+	CHECK_EQUAL(42, frames[6].data[2]);
+	CHECK_EQUAL(0xFF, frames[6].data[3]);
+	CHECK_EQUAL(43, Reassemble(frames, count, 5, reassembled));
+	CHECK_EQUAL(0, memcmp(payload, reassembled, 43));
+
+	// Exactly filling the first frame
+	count = N2K_Encoder::Segment(N2K_PGN_GNSS_POSITION, 3, 15, 0, true, payload, 6, frames, N2K_FAST_PACKET_MAXIMUM_FRAMES);
+	CHECK_EQUAL(1, count);
+	CHECK_EQUAL(6, Reassemble(frames, count, 0, reassembled));
+
+	// The largest fast packet uses every frame
+	count = N2K_Encoder::Segment(N2K_PGN_SATELLITES_IN_VIEW, 6, 15, 7, true, payload, N2K_FAST_PACKET_MAXIMUM_LENGTH, frames, N2K_FAST_PACKET_MAXIMUM_FRAMES);
+	CHECK_EQUAL(N2K_FAST_PACKET_MAXIMUM_FRAMES, count);
+	CHECK_EQUAL(N2K_FAST_PACKET_MAXIMUM_LENGTH, Reassemble(frames, count, 7, reassembled));
+	CHECK_EQUAL(0, memcmp(payload, reassembled, N2K_FAST_PACKET_MAXIMUM_LENGTH));
+
+	// Too long, or too few frames supplied
+	CHECK_EQUAL(0, N2K_Encoder::Segment(N2K_PGN_SATELLITES_IN_VIEW, 6, 15, 0, true, payload, N2K_FAST_PACKET_MAXIMUM_LENGTH + 1, frames, N2K_FAST_PACKET_MAXIMUM_FRAMES));
+	CHECK_EQUAL(0, N2K_Encoder::Segment(N2K_PGN_GNSS_POSITION, 3, 15, 0, true, payload, 43, frames, 6));
+
+	// An empty payload still has a first frame
+	CHECK_EQUAL(1, N2K_Encoder::Segment(N2K_PGN_SATELLITES_IN_VIEW, 6, 15, 0, true, payload, 0, frames, N2K_FAST_PACKET_MAXIMUM_FRAMES));
+	CHECK_EQUAL(0, frames[0].data[1]);
+}
+
+static void TestPositionRapid(void) {
+	unsigned char payload[N2K_FAST_PACKET_MAXIMUM_LENGTH];
+	PositionFix fix = TestFix();
+	CHECK_EQUAL(8, N2K_Encoder::EncodePositionRapid(fix, payload));
+	// 1e-7 degrees, southern latitudes are negative
+	CHECK_EQUAL(-338583333, (int)ReadLittleEndian(&payload[0], 4));
+	CHECK_EQUAL(1512050000, (int)ReadLittleEndian(&payload[4], 4));
+}
+
+static void TestCogSogRapid(void) {
+	unsigned char payload[N2K_FAST_PACKET_MAXIMUM_LENGTH];
+	PositionFix fix = TestFix();
+	CHECK_EQUAL(8, N2K_Encoder::EncodeCogSogRapid(fix, 42, payload));
+	CHECK_EQUAL(42, payload[0]);
+	CHECK_EQUAL(0xFC, payload[1]);
+	// Radians with a resolution of 1e-4
+	CHECK_EQUAL(15708, ReadLittleEndian(&payload[2], 2));
+	// Metres per second with a resolution of 0.01
+	CHECK_EQUAL(514, ReadLittleEndian(&payload[4], 2));
+	CHECK_EQUAL(0xFFFF, ReadLittleEndian(&payload[6], 2));
+
+	// Negative angles are normalised
+	fix.courseOverGround = -90.0;
+	N2K_Encoder::EncodeCogSogRapid(fix, 42, payload);
+	CHECK_EQUAL(47124, ReadLittleEndian(&payload[2], 2));
+}
+
+static void TestGnssPosition(void) {
+	unsigned char payload[N2K_FAST_PACKET_MAXIMUM_LENGTH];
+	PositionFix fix = TestFix();
+	CHECK_EQUAL(43, N2K_Encoder::EncodeGnssPosition(fix, 42, payload));
+	CHECK_EQUAL(42, payload[0]);
+	// Days since 1970 and seconds since midnight with a resolution of 1e-4
+	CHECK_EQUAL(19723, ReadLittleEndian(&payload[1], 2));
+	CHECK_EQUAL(432002500, ReadLittleEndian(&payload[3], 4));
+	// 1e-16 degrees
+	CHECK_EQUAL(-338583333000000000LL, (long long)ReadLittleEndian(&payload[7], 8));
+	CHECK_EQUAL(1512050000000000000LL, (long long)ReadLittleEndian(&payload[15], 8));
+	// 1e-6 metres
+	CHECK_EQUAL(12500000, (long long)ReadLittleEndian(&payload[23], 8));
+	// GNSS fix
+	CHECK_EQUAL(0x10, payload[31]);
+	CHECK_EQUAL(9, payload[33]);
+	CHECK_EQUAL(90, ReadLittleEndian(&payload[34], 2));
+	CHECK_EQUAL(160, ReadLittleEndian(&payload[36], 2));
+	CHECK_EQUAL(2210, ReadLittleEndian(&payload[38], 4));
+	CHECK_EQUAL(0, payload[42]);
+}
+
+static void TestSatellitesInView(void) {
+	unsigned char payload[N2K_FAST_PACKET_MAXIMUM_LENGTH];
+	std::vector<SatelliteInformation> satellites;
+	for (unsigned int i = 0; i < 20; i++) {
+		SatelliteInformation satellite;
+		satellite.id = i + 1;
+		satellite.elevation = 30.0;
+		satellite.azimuth = 180.0;
+		satellite.snr = (i % 2) == 0 ? 42.0 : 0.0;
+		satellites.push_back(satellite);
+	}
+
+	// Only as many satellites as fit in the largest fast packet
+	unsigned int length = N2K_Encoder::EncodeSatellitesInView(satellites, 42, payload);
+	CHECK_EQUAL(3 + (12 * N2K_MAXIMUM_SATELLITES), length);
+	CHECK_EQUAL(true, length <= N2K_FAST_PACKET_MAXIMUM_LENGTH);
+	CHECK_EQUAL(N2K_MAXIMUM_SATELLITES, payload[2]);
+
+	const unsigned char *first = &payload[3];
+	CHECK_EQUAL(1, first[0]);
+	CHECK_EQUAL(5236, ReadLittleEndian(&first[1], 2));
+	CHECK_EQUAL(31416, ReadLittleEndian(&first[3], 2));
+	CHECK_EQUAL(4200, ReadLittleEndian(&first[5], 2));
+	CHECK_EQUAL(0x7FFFFFFF, ReadLittleEndian(&first[7], 4));
+	// Used if there is a signal, otherwise not tracked
+	CHECK_EQUAL(0xF2, first[11]);
+	CHECK_EQUAL(0xF0, first[12 + 11]);
+
+	satellites.clear();
+	CHECK_EQUAL(3, N2K_Encoder::EncodeSatellitesInView(satellites, 42, payload));
+	CHECK_EQUAL(0, payload[2]);
+}
+
+int main(void) {
+	TestSingleFrame();
+	TestFastPacket();
+	TestPositionRapid();
+	TestCogSogRapid();
+	TestGnssPosition();
+	TestSatellitesInView();
+
+	if (failures > 0) {
+		printf("%d checks failed\n", failures);
+		return 1;
+	}
+	printf("All checks passed\n");
+	return 0;
+}
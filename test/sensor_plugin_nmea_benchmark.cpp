@@ -0,0 +1,90 @@
+// Copyright(C) 2024 by Steven Adler
+//
+// This file is part of Windows Sensor Plugin for OpenCPN.
+//
+// Windows Sensor Plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Windows Sensor Plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Windows Sensor Plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// Project: Windows Sensor Plugin
+// Description: Sentences per second decoded by the NMEA 0183 parser
+// Owner: twocanplugin@hotmail.com
+// Date: 01/04/2024
+// Version History:
+// 1.0 Initial Release
+
+// Usage: sensor_plugin_nmea_benchmark [iterations]
+// Each iteration parses one epoch of a typical multi-constellation receiver's output
+
+#include "sensor_plugin_nmea.h"
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *epoch[] = {
+	"$GPRMC,123519.00,A,4807.038,N,01131.000,E,022.4,084.4,230324,003.1,W,A*22\r\n",
+	"$GPGGA,123519.00,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*69\r\n",
+	"$GPGLL,4807.038,N,01131.000,E,123519.00,A,A*66\r\n",
+	"$GPGSA,A,3,04,05,,09,12,,,24,,,,,2.5,1.3,2.1*39\r\n",
+	"$GPGSV,3,1,11,03,03,111,00,04,15,270,00,06,01,010,00,13,06,292,00*74\r\n",
+	"$GPGSV,3,2,11,14,25,170,00,16,57,208,39,18,67,296,40,19,40,246,00*74\r\n",
+	"$GPGSV,3,3,11,22,42,067,42,24,14,311,43,27,05,244,00*4D\r\n",
+	"$GLGSV,1,1,03,65,25,170,35,72,40,075,43,73,10,120,*50\r\n",
+	"$GPVTG,084.4,T,087.5,M,022.4,N,041.5,K,A*25\r\n",
+	"$HEHDT,274.07,T*19\r\n",
+	"$GPZDA,123519.00,23,03,2024,00,00*6D\r\n",
+	"$PSRFTXT,Version 2.3*36\r\n"
+};
+
+#define EPOCH_SENTENCES (sizeof(epoch) / sizeof(epoch[0]))
+
+int main(int argc, char *argv[]) {
+	long iterations = 1000000;
+	if (argc > 1) {
+		iterations = atol(argv[1]);
+	}
+
+	size_t lengths[EPOCH_SENTENCES];
+	for (size_t i = 0; i < EPOCH_SENTENCES; i++) {
+		lengths[i] = strlen(epoch[i]);
+	}
+
+	NmeaSentence sentence;
+	unsigned long long decoded = 0;
+	unsigned long long invalid = 0;
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (long n = 0; n < iterations; n++) {
+		for (size_t i = 0; i < EPOCH_SENTENCES; i++) {
+			if (NMEA_Parser::Parse(epoch[i], lengths[i], sentence)) {
+				decoded++;
+			}
+			else if (sentence.type == NMEA_INVALID) {
+				invalid++;
+			}
+		}
+	}
+	std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+	double seconds = std::chrono::duration<double>(end - start).count();
+	unsigned long long total = (unsigned long long)iterations * EPOCH_SENTENCES;
+	printf("%llu sentences in %.3f seconds, %.0f sentences per second\n", total, seconds, seconds > 0.0 ? total / seconds : 0.0);
+
+	// Every sentence except the proprietary one must decode, otherwise the figure is meaningless
+	if ((invalid != 0) || (decoded != (unsigned long long)iterations * (EPOCH_SENTENCES - 1))) {
+		printf("%llu sentences decoded, %llu invalid\n", decoded, invalid);
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,492 @@
+// Copyright(C) 2024 by Steven Adler
+//
+// This file is part of Windows Sensor Plugin for OpenCPN.
+//
+// Windows Sensor Plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Windows Sensor Plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Windows Sensor Plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// Project: Windows Sensor Plugin
+// Description: Standalone tests for the NMEA 0183 parser, GSV assembler and echo filter
+// Owner: twocanplugin@hotmail.com
+// Date: 01/04/2024
+// Version History:
+// 1.0 Initial Release
+
+#include "sensor_plugin_nmea.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+static int failures = 0;
+
+#define CHECK_EQUAL(expected, actual) CheckEqual((long long)(expected), (long long)(actual), #actual, __LINE__)
+#define CHECK_CLOSE(expected, actual) CheckClose((double)(expected), (double)(actual), #actual, __LINE__)
+
+static void CheckEqual(long long expected, long long actual, const char *expression, int line) {
+	if (expected != actual) {
+		printf("Line %d: %s is %lld, expected %lld\n", line, expression, actual, expected);
+		failures++;
+	}
+}
+
+static void CheckClose(double expected, double actual, const char *expression, int line) {
+	if (fabs(expected - actual) > 1e-6) {
+		printf("Line %d: %s is %.9f, expected %.9f\n", line, expression, actual, expected);
+		failures++;
+	}
+}
+
+// Frame the body of a sentence with its checksum and line terminator
+static const char *Frame(const char *body, char *buffer, size_t size) {
+	unsigned char checksum = 0;
+	for (const char *c = body + 1; *c != '\0'; c++) {
+		checksum ^= (unsigned char)*c;
+	}
+	snprintf(buffer, size, "%s*%02X\r\n", body, checksum);
+	return buffer;
+}
+
+static bool Parse(const char *body, NmeaSentence &result) {
+	char buffer[NMEA_MAXIMUM_LENGTH * 2];
+	Frame(body, buffer, sizeof(buffer));
+	return NMEA_Parser::Parse(buffer, strlen(buffer), result);
+}
+
+static void TestChecksum(void) {
+	NmeaField fields[NMEA_MAXIMUM_FIELDS];
+	unsigned int fieldCount;
+
+	const char *valid = "$GPHDT,123.4,T*31\r\n";
+	CHECK_EQUAL(true, NMEA_Parser::Split(valid, strlen(valid), fields, NMEA_MAXIMUM_FIELDS, fieldCount));
+
+	// Either case of hex digit
+	const char *lower = "$HEHDT,274.1,T*2f";
+	CHECK_EQUAL(true, NMEA_Parser::Split(lower, strlen(lower), fields, NMEA_MAXIMUM_FIELDS, fieldCount));
+
+	const char *wrong = "$GPHDT,123.4,T*32\r\n";
+	CHECK_EQUAL(false, NMEA_Parser::Split(wrong, strlen(wrong), fields, NMEA_MAXIMUM_FIELDS, fieldCount));
+
+	const char *notHex = "$GPHDT,123.4,T*3G";
+	CHECK_EQUAL(false, NMEA_Parser::Split(notHex, strlen(notHex), fields, NMEA_MAXIMUM_FIELDS, fieldCount));
+
+	const char *truncated = "$GPHDT,123.4,T*3";
+	CHECK_EQUAL(false, NMEA_Parser::Split(truncated, strlen(truncated), fields, NMEA_MAXIMUM_FIELDS, fieldCount));
+
+	// The checksum is optional
+	const char *absent = "$GPHDT,123.4,T\r\n";
+	CHECK_EQUAL(true, NMEA_Parser::Split(absent, strlen(absent), fields, NMEA_MAXIMUM_FIELDS, fieldCount));
+
+	// Framing
+	const char *noStart = "GPHDT,123.4,T*31";
+	CHECK_EQUAL(false, NMEA_Parser::Split(noStart, strlen(noStart), fields, NMEA_MAXIMUM_FIELDS, fieldCount));
+	const char *tooShort = "$GP";
+	CHECK_EQUAL(false, NMEA_Parser::Split(tooShort, strlen(tooShort), fields, NMEA_MAXIMUM_FIELDS, fieldCount));
+	char tooLong[NMEA_MAXIMUM_LENGTH + 8];
+	memset(tooLong, 'A', sizeof(tooLong));
+	tooLong[0] = '$';
+	CHECK_EQUAL(false, NMEA_Parser::Split(tooLong, sizeof(tooLong), fields, NMEA_MAXIMUM_FIELDS, fieldCount));
+
+	// AIS encapsulation starts with an exclamation mark
+	const char *ais = "!AIVDM,1,1,,A,13aEOK?P00PD2wVMdLDRhgvL289?,0*26";
+	CHECK_EQUAL(true, NMEA_Parser::Split(ais, strlen(ais), fields, NMEA_MAXIMUM_FIELDS, fieldCount));
+}
+
+static void TestSplit(void) {
+	NmeaField fields[NMEA_MAXIMUM_FIELDS];
+	unsigned int fieldCount;
+
+	const char *sentence = "$GPHDT,123.4,T*31\r\n";
+	CHECK_EQUAL(true, NMEA_Parser::Split(sentence, strlen(sentence), fields, NMEA_MAXIMUM_FIELDS, fieldCount));
+	CHECK_EQUAL(3, fieldCount);
+	CHECK_EQUAL(5, fields[0].length);
+	CHECK_EQUAL(0, memcmp(fields[0].data, "GPHDT", 5));
+	CHECK_EQUAL(5, fields[1].length);
+	CHECK_EQUAL(0, memcmp(fields[1].data, "123.4", 5));
+	// The checksum is not part of the last field
+	CHECK_EQUAL(1, fields[2].length);
+	CHECK_EQUAL('T', fields[2].data[0]);
+
+	// Empty fields, including a trailing one
+	const char *empty = "$GPVTG,,T,,M,,N,,K,";
+	CHECK_EQUAL(true, NMEA_Parser::Split(empty, strlen(empty), fields, NMEA_MAXIMUM_FIELDS, fieldCount));
+	CHECK_EQUAL(10, fieldCount);
+	CHECK_EQUAL(0, fields[1].length);
+	CHECK_EQUAL(0, fields[9].length);
+
+	// Anything after a null is ignored
+	const char nulled[] = "$GPHDT,123.4,T*31\0garbage";
+	CHECK_EQUAL(true, NMEA_Parser::Split(nulled, sizeof(nulled) - 1, fields, NMEA_MAXIMUM_FIELDS, fieldCount));
+	CHECK_EQUAL(3, fieldCount);
+
+	// More fields than the caller has room for
+	CHECK_EQUAL(false, NMEA_Parser::Split(sentence, strlen(sentence), fields, 2, fieldCount));
+}
+
+static void TestFieldDecoders(void) {
+	double d = 0.0;
+	NmeaField number = { "-12.50", 6 };
+	CHECK_EQUAL(true, NMEA_Parser::ToDouble(number, d));
+	CHECK_CLOSE(-12.5, d);
+	NmeaField integer = { "+7", 2 };
+	CHECK_EQUAL(true, NMEA_Parser::ToDouble(integer, d));
+	CHECK_CLOSE(7.0, d);
+	NmeaField fraction = { ".25", 3 };
+	CHECK_EQUAL(true, NMEA_Parser::ToDouble(fraction, d));
+	CHECK_CLOSE(0.25, d);
+	NmeaField exponent = { "1e3", 3 };
+	CHECK_EQUAL(false, NMEA_Parser::ToDouble(exponent, d));
+	NmeaField sign = { "-", 1 };
+	CHECK_EQUAL(false, NMEA_Parser::ToDouble(sign, d));
+	NmeaField empty = { "", 0 };
+	CHECK_EQUAL(false, NMEA_Parser::ToDouble(empty, d));
+
+	unsigned int u = 0;
+	NmeaField count = { "0123", 4 };
+	CHECK_EQUAL(true, NMEA_Parser::ToUnsigned(count, u));
+	CHECK_EQUAL(123, u);
+	CHECK_EQUAL(false, NMEA_Parser::ToUnsigned(number, u));
+	CHECK_EQUAL(false, NMEA_Parser::ToUnsigned(empty, u));
+
+	char c = '\0';
+	NmeaField letter = { "A", 1 };
+	CHECK_EQUAL(true, NMEA_Parser::ToChar(letter, c));
+	CHECK_EQUAL('A', c);
+	CHECK_EQUAL(false, NMEA_Parser::ToChar(count, c));
+
+	NmeaTime time;
+	NmeaField hhmmss = { "235959.50", 9 };
+	CHECK_EQUAL(true, NMEA_Parser::ToTime(hhmmss, time));
+	CHECK_EQUAL(true, time.isValid);
+	CHECK_EQUAL(23, time.hours);
+	CHECK_EQUAL(59, time.minutes);
+	CHECK_CLOSE(59.5, time.seconds);
+	NmeaField badHour = { "245959", 6 };
+	CHECK_EQUAL(false, NMEA_Parser::ToTime(badHour, time));
+	CHECK_EQUAL(false, time.isValid);
+
+	NmeaDate date;
+	NmeaField ddmmyy = { "290224", 6 };
+	CHECK_EQUAL(true, NMEA_Parser::ToDate(ddmmyy, date));
+	CHECK_EQUAL(29, date.day);
+	CHECK_EQUAL(2, date.month);
+	CHECK_EQUAL(2024, date.year);
+	NmeaField badMonth = { "011324", 6 };
+	CHECK_EQUAL(false, NMEA_Parser::ToDate(badMonth, date));
+
+	double coordinate = 0.0;
+	NmeaField latitude = { "3351.5000", 9 };
+	NmeaField south = { "S", 1 };
+	CHECK_EQUAL(true, NMEA_Parser::ToCoordinate(latitude, south, coordinate));
+	CHECK_CLOSE(-33.858333333, coordinate);
+	NmeaField longitude = { "15112.3000", 10 };
+	NmeaField east = { "E", 1 };
+	CHECK_EQUAL(true, NMEA_Parser::ToCoordinate(longitude, east, coordinate));
+	CHECK_CLOSE(151.205, coordinate);
+	NmeaField badMinutes = { "3360.0000", 9 };
+	CHECK_EQUAL(false, NMEA_Parser::ToCoordinate(badMinutes, south, coordinate));
+	NmeaField badHemisphere = { "X", 1 };
+	CHECK_EQUAL(false, NMEA_Parser::ToCoordinate(latitude, badHemisphere, coordinate));
+}
+
+static void TestRMC(void) {
+	NmeaSentence sentence;
+	CHECK_EQUAL(true, Parse("$GPRMC,123519.00,A,4807.038,N,01131.000,E,022.4,084.4,230324,003.1,W,D", sentence));
+	CHECK_EQUAL(NMEA_RMC, sentence.type);
+	CHECK_EQUAL(0, strcmp(sentence.talker, "GP"));
+	CHECK_EQUAL(12, sentence.rmc.time.hours);
+	CHECK_EQUAL(35, sentence.rmc.time.minutes);
+	CHECK_CLOSE(19.0, sentence.rmc.time.seconds);
+	CHECK_EQUAL(true, sentence.rmc.isActive);
+	CHECK_EQUAL(true, sentence.rmc.position.isValid);
+	CHECK_CLOSE(48.1173, sentence.rmc.position.latitude);
+	CHECK_CLOSE(11.516666667, sentence.rmc.position.longitude);
+	CHECK_CLOSE(22.4, sentence.rmc.speedOverGround);
+	CHECK_EQUAL(true, sentence.rmc.isCourseValid);
+	CHECK_CLOSE(84.4, sentence.rmc.courseOverGround);
+	CHECK_EQUAL(true, sentence.rmc.date.isValid);
+	CHECK_EQUAL(2024, sentence.rmc.date.year);
+	// West is negative
+	CHECK_EQUAL(true, sentence.rmc.isVariationValid);
+	CHECK_CLOSE(-3.1, sentence.rmc.magneticVariation);
+	CHECK_EQUAL('D', sentence.rmc.mode);
+
+	// Void, no position, and without the NMEA 0183 2.3 mode indicator
+	CHECK_EQUAL(true, Parse("$GNRMC,,V,,,,,,,,,", sentence));
+	CHECK_EQUAL(0, strcmp(sentence.talker, "GN"));
+	CHECK_EQUAL(false, sentence.rmc.isActive);
+	CHECK_EQUAL(false, sentence.rmc.position.isValid);
+	CHECK_EQUAL(false, sentence.rmc.isCourseValid);
+	CHECK_EQUAL(false, sentence.rmc.isVariationValid);
+	CHECK_CLOSE(0.0, sentence.rmc.speedOverGround);
+	CHECK_EQUAL('A', sentence.rmc.mode);
+
+	// Too few fields
+	CHECK_EQUAL(false, Parse("$GPRMC,123519,A,4807.038,N", sentence));
+	CHECK_EQUAL(NMEA_RMC, sentence.type);
+}
+
+static void TestGGA(void) {
+	NmeaSentence sentence;
+	CHECK_EQUAL(true, Parse("$GPGGA,123519,4807.038,N,01131.000,W,2,08,0.9,545.4,M,46.9,M,3.5,0120", sentence));
+	CHECK_EQUAL(NMEA_GGA, sentence.type);
+	CHECK_EQUAL(true, sentence.gga.time.isValid);
+	CHECK_EQUAL(true, sentence.gga.position.isValid);
+	CHECK_CLOSE(-11.516666667, sentence.gga.position.longitude);
+	CHECK_EQUAL(2, sentence.gga.quality);
+	CHECK_EQUAL(8, sentence.gga.satellitesInUse);
+	CHECK_CLOSE(0.9, sentence.gga.hDOP);
+	CHECK_EQUAL(true, sentence.gga.isAltitudeValid);
+	CHECK_CLOSE(545.4, sentence.gga.altitude);
+	CHECK_CLOSE(46.9, sentence.gga.geoidalSeparation);
+	CHECK_CLOSE(3.5, sentence.gga.dgpsAge);
+	CHECK_EQUAL(120, sentence.gga.dgpsReferenceId);
+
+	CHECK_EQUAL(true, Parse("$GPGGA,,,,,,0,,,,,,,,", sentence));
+	CHECK_EQUAL(false, sentence.gga.position.isValid);
+	CHECK_EQUAL(false, sentence.gga.isAltitudeValid);
+	CHECK_EQUAL(0, sentence.gga.quality);
+	CHECK_CLOSE(0.0, sentence.gga.hDOP);
+}
+
+static void TestGLL(void) {
+	NmeaSentence sentence;
+	CHECK_EQUAL(true, Parse("$GPGLL,4916.45,N,12311.12,W,225444,A,A", sentence));
+	CHECK_EQUAL(NMEA_GLL, sentence.type);
+	CHECK_EQUAL(true, sentence.gll.position.isValid);
+	CHECK_CLOSE(49.274166667, sentence.gll.position.latitude);
+	CHECK_CLOSE(-123.185333333, sentence.gll.position.longitude);
+	CHECK_EQUAL(22, sentence.gll.time.hours);
+	CHECK_EQUAL(true, sentence.gll.isActive);
+
+	CHECK_EQUAL(true, Parse("$GPGLL,4916.45,N,12311.12,W,225444,V,N", sentence));
+	CHECK_EQUAL(false, sentence.gll.isActive);
+	CHECK_EQUAL('N', sentence.gll.mode);
+}
+
+static void TestGSA(void) {
+	NmeaSentence sentence;
+	CHECK_EQUAL(true, Parse("$GPGSA,A,3,04,05,,09,12,,,24,,,,,2.5,1.3,2.1", sentence));
+	CHECK_EQUAL(NMEA_GSA, sentence.type);
+	CHECK_EQUAL('A', sentence.gsa.selectionMode);
+	CHECK_EQUAL(3, sentence.gsa.fixMode);
+	// Empty slots are skipped
+	CHECK_EQUAL(5, sentence.gsa.satelliteCount);
+	CHECK_EQUAL(4, sentence.gsa.satellites[0]);
+	CHECK_EQUAL(9, sentence.gsa.satellites[2]);
+	CHECK_EQUAL(24, sentence.gsa.satellites[4]);
+	CHECK_CLOSE(2.5, sentence.gsa.pDOP);
+	CHECK_CLOSE(1.3, sentence.gsa.hDOP);
+	CHECK_CLOSE(2.1, sentence.gsa.vDOP);
+}
+
+static void TestGSV(void) {
+	NmeaSentence sentence;
+	CHECK_EQUAL(true, Parse("$GPGSV,3,1,11,03,03,111,00,04,15,270,00,06,01,010,00,13,06,292,00", sentence));
+	CHECK_EQUAL(NMEA_GSV, sentence.type);
+	CHECK_EQUAL(3, sentence.gsv.totalSentences);
+	CHECK_EQUAL(1, sentence.gsv.sentenceNumber);
+	CHECK_EQUAL(11, sentence.gsv.satellitesInView);
+	CHECK_EQUAL(4, sentence.gsv.satelliteCount);
+	CHECK_EQUAL(13, sentence.gsv.satellites[3].id);
+	CHECK_CLOSE(6.0, sentence.gsv.satellites[3].elevation);
+	CHECK_CLOSE(292.0, sentence.gsv.satellites[3].azimuth);
+
+	// The last sentence of a sequence is short, and a satellite not being tracked has no SNR
+	CHECK_EQUAL(true, Parse("$GLGSV,3,3,11,72,40,075,43,73,10,120,", sentence));
+	CHECK_EQUAL(0, strcmp(sentence.talker, "GL"));
+	CHECK_EQUAL(2, sentence.gsv.satelliteCount);
+	CHECK_EQUAL(72, sentence.gsv.satellites[0].id);
+	CHECK_CLOSE(43.0, sentence.gsv.satellites[0].snr);
+	CHECK_CLOSE(0.0, sentence.gsv.satellites[1].snr);
+
+	// Satellites with no id are skipped
+	CHECK_EQUAL(true, Parse("$GPGSV,1,1,01,,,,,07,79,048,42", sentence));
+	CHECK_EQUAL(1, sentence.gsv.satelliteCount);
+	CHECK_EQUAL(7, sentence.gsv.satellites[0].id);
+
+	CHECK_EQUAL(false, Parse("$GPGSV,,1,11", sentence));
+}
+
+static void TestVTG(void) {
+	NmeaSentence sentence;
+	CHECK_EQUAL(true, Parse("$GPVTG,054.7,T,034.4,M,005.5,N,010.2,K,A", sentence));
+	CHECK_EQUAL(NMEA_VTG, sentence.type);
+	CHECK_EQUAL(true, sentence.vtg.isCourseTrueValid);
+	CHECK_CLOSE(54.7, sentence.vtg.courseTrue);
+	CHECK_EQUAL(true, sentence.vtg.isCourseMagneticValid);
+	CHECK_CLOSE(34.4, sentence.vtg.courseMagnetic);
+	CHECK_CLOSE(5.5, sentence.vtg.speedKnots);
+
+	// Only the speed in kilometres per hour
+	CHECK_EQUAL(true, Parse("$GPVTG,,T,,M,,N,18.52,K", sentence));
+	CHECK_EQUAL(false, sentence.vtg.isCourseTrueValid);
+	CHECK_EQUAL(true, sentence.vtg.isSpeedValid);
+	CHECK_CLOSE(10.0, sentence.vtg.speedKnots);
+	CHECK_EQUAL('A', sentence.vtg.mode);
+}
+
+static void TestHDT(void) {
+	NmeaSentence sentence;
+	CHECK_EQUAL(true, Parse("$HEHDT,274.07,T", sentence));
+	CHECK_EQUAL(NMEA_HDT, sentence.type);
+	CHECK_EQUAL(0, strcmp(sentence.talker, "HE"));
+	CHECK_EQUAL(true, sentence.hdt.isValid);
+	CHECK_CLOSE(274.07, sentence.hdt.heading);
+
+	CHECK_EQUAL(true, Parse("$HEHDT,,T", sentence));
+	CHECK_EQUAL(false, sentence.hdt.isValid);
+}
+
+static void TestZDA(void) {
+	NmeaSentence sentence;
+	CHECK_EQUAL(true, Parse("$GPZDA,201530.00,04,07,2024,00,00", sentence));
+	CHECK_EQUAL(NMEA_ZDA, sentence.type);
+	CHECK_EQUAL(true, sentence.zda.time.isValid);
+	CHECK_EQUAL(20, sentence.zda.time.hours);
+	CHECK_EQUAL(15, sentence.zda.time.minutes);
+	CHECK_EQUAL(true, sentence.zda.date.isValid);
+	CHECK_EQUAL(4, sentence.zda.date.day);
+	CHECK_EQUAL(7, sentence.zda.date.month);
+	CHECK_EQUAL(2024, sentence.zda.date.year);
+
+	CHECK_EQUAL(true, Parse("$GPZDA,201530.00,00,07,2024,00,00", sentence));
+	CHECK_EQUAL(false, sentence.zda.date.isValid);
+}
+
+static void TestProprietaryUnknownInvalid(void) {
+	NmeaSentence sentence;
+
+	// Proprietary sentences are well formed, but not decoded
+	CHECK_EQUAL(false, Parse("$PSRFTXT,Version 2.3", sentence));
+	CHECK_EQUAL(NMEA_UNKNOWN, sentence.type);
+	CHECK_EQUAL(0, strcmp(sentence.talker, "P"));
+
+	CHECK_EQUAL(false, Parse("$GPXTE,A,A,0.67,L,N", sentence));
+	CHECK_EQUAL(NMEA_UNKNOWN, sentence.type);
+	CHECK_EQUAL(0, strcmp(sentence.talker, "GP"));
+
+	// Bad checksum
+	const char *corrupt = "$HEHDT,274.07,T*00";
+	CHECK_EQUAL(false, NMEA_Parser::Parse(corrupt, strlen(corrupt), sentence));
+	CHECK_EQUAL(NMEA_INVALID, sentence.type);
+
+	// Address of the wrong length
+	CHECK_EQUAL(false, Parse("$GPRMCX,123519", sentence));
+	CHECK_EQUAL(NMEA_INVALID, sentence.type);
+
+	CHECK_EQUAL(false, NMEA_Parser::Parse("", 0, sentence));
+	CHECK_EQUAL(NMEA_INVALID, sentence.type);
+}
+
+static void AddSatellites(GSV_Assembler &assembler, const char *talker, unsigned int total, unsigned int number,
+	unsigned int firstId, unsigned int count, long long now) {
+	NmeaGSV gsv;
+	gsv.totalSentences = total;
+	gsv.sentenceNumber = number;
+	gsv.satellitesInView = 0;
+	gsv.satelliteCount = count;
+	for (unsigned int i = 0; i < count; i++) {
+		gsv.satellites[i].id = firstId + i;
+		gsv.satellites[i].elevation = 45.0;
+		gsv.satellites[i].azimuth = 90.0;
+		gsv.satellites[i].snr = 40.0;
+	}
+	assembler.Add(talker, gsv, now);
+}
+
+static void TestGSVAssembler(void) {
+	GSV_Assembler assembler;
+	std::vector<SatelliteInformation> satellites;
+
+	// A sequence is not used until it is complete
+	AddSatellites(assembler, "GP", 2, 1, 1, 4, 1000);
+	assembler.Merge(1000, satellites);
+	CHECK_EQUAL(0, satellites.size());
+	AddSatellites(assembler, "GP", 2, 2, 5, 2, 1000);
+	assembler.Merge(1000, satellites);
+	CHECK_EQUAL(6, satellites.size());
+
+	// Each constellation is kept alongside the others
+	AddSatellites(assembler, "GL", 1, 1, 65, 3, 1100);
+	AddSatellites(assembler, "GA", 1, 1, 301, 2, 1200);
+	assembler.Merge(1200, satellites);
+	CHECK_EQUAL(11, satellites.size());
+	CHECK_EQUAL(1, satellites[0].id);
+	CHECK_EQUAL(65, satellites[6].id);
+	CHECK_EQUAL(301, satellites[9].id);
+
+	// A new sequence replaces its talker's satellites, while a partial sequence leaves them intact
+	AddSatellites(assembler, "GP", 1, 1, 10, 1, 2000);
+	AddSatellites(assembler, "GL", 2, 1, 80, 4, 2000);
+	assembler.Merge(2000, satellites);
+	CHECK_EQUAL(6, satellites.size());
+	CHECK_EQUAL(10, satellites[0].id);
+	CHECK_EQUAL(65, satellites[1].id);
+
+	// A talker that stops sending is dropped
+	AddSatellites(assembler, "GP", 1, 1, 10, 1, 1000 + NMEA_SATELLITE_TIMEOUT);
+	assembler.Merge(1200 + NMEA_SATELLITE_TIMEOUT, satellites);
+	CHECK_EQUAL(1, satellites.size());
+
+	assembler.Clear();
+	assembler.Merge(1200 + NMEA_SATELLITE_TIMEOUT, satellites);
+	CHECK_EQUAL(0, satellites.size());
+}
+
+static void TestEchoFilter(void) {
+	const char *sent = "$IIHDT,274.1,T*22\r\n";
+	const char *received = "$IIHDT,274.1,T*22";
+	const char *other = "$HEHDT,274.1,T*2F";
+
+	CHECK_EQUAL(false, NMEA_Echo_Filter::IsEcho(received, strlen(received)));
+	NMEA_Echo_Filter::Add(sent, strlen(sent));
+	// OpenCPN may strip the line terminator
+	CHECK_EQUAL(true, NMEA_Echo_Filter::IsEcho(received, strlen(received)));
+	CHECK_EQUAL(true, NMEA_Echo_Filter::IsEcho(sent, strlen(sent)));
+	CHECK_EQUAL(false, NMEA_Echo_Filter::IsEcho(other, strlen(other)));
+
+	// The oldest sentence is forgotten once the ring wraps
+	char buffer[NMEA_MAXIMUM_LENGTH];
+	for (unsigned int i = 0; i < NMEA_ECHO_SLOTS; i++) {
+		int length = snprintf(buffer, sizeof(buffer), "$IIXDR,A,%u,D,ROLL", i);
+		NMEA_Echo_Filter::Add(buffer, length);
+	}
+	CHECK_EQUAL(false, NMEA_Echo_Filter::IsEcho(received, strlen(received)));
+	int length = snprintf(buffer, sizeof(buffer), "$IIXDR,A,%u,D,ROLL", NMEA_ECHO_SLOTS - 1);
+	CHECK_EQUAL(true, NMEA_Echo_Filter::IsEcho(buffer, length));
+}
+
+int main(void) {
+	TestChecksum();
+	TestSplit();
+	TestFieldDecoders();
+	TestRMC();
+	TestGGA();
+	TestGLL();
+	TestGSA();
+	TestGSV();
+	TestVTG();
+	TestHDT();
+	TestZDA();
+	TestProprietaryUnknownInvalid();
+	TestGSVAssembler();
+	TestEchoFilter();
+
+	if (failures > 0) {
+		printf("%d checks failed\n", failures);
+		return 1;
+	}
+	printf("All checks passed\n");
+	return 0;
+}
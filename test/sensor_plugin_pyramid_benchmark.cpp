@@ -0,0 +1,153 @@
+// Copyright(C) 2024 by Steven Adler
+//
+// This file is part of Windows Sensor Plugin for OpenCPN.
+//
+// Windows Sensor Plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Windows Sensor Plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Windows Sensor Plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// Project: Windows Sensor Plugin
+// Description: Per frame cost of preparing a 24 hour trail for the track overlay
+// Owner: twocanplugin@hotmail.com
+// Date: 01/04/2024
+// Version History:
+// 1.0 Initial Release
+
+// Usage: sensor_plugin_pyramid_benchmark [frames]
+// Fills the pyramid with a simulated day's sail at one fix per second, then for each frame does what the overlay does
+// before it draws: select the level, cull the chunks and project the points to pixels, dropping those that share a pixel.
+// The projection is a simple Mercator standing in for the chart canvas, so nothing here needs OpenCPN or wxWidgets.
+
+#include "sensor_plugin_pyramid.h"
+#include "sensor_plugin_track_passage.h"
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define BENCHMARK_WIDTH 1920
+#define BENCHMARK_HEIGHT 1080
+#define BENCHMARK_EARTH_RADIUS 6378137.0
+
+typedef struct _benchmark_pixel {
+	int x;
+	int y;
+} BenchmarkPixel;
+
+typedef struct _benchmark_viewport {
+	double latitude;
+	double longitude;
+	double pixelsPerMetre;
+	double latitudeMinimum;
+	double latitudeMaximum;
+	double longitudeMinimum;
+	double longitudeMaximum;
+} BenchmarkViewport;
+
+static double MercatorY(double latitude) {
+	return BENCHMARK_EARTH_RADIUS * log(tan((PASSAGE_PI / 4.0) + (latitude * PASSAGE_PI / 360.0)));
+}
+
+static double InverseMercatorY(double y) {
+	return ((2.0 * atan(exp(y / BENCHMARK_EARTH_RADIUS))) - (PASSAGE_PI / 2.0)) * 180.0 / PASSAGE_PI;
+}
+
+static BenchmarkViewport MakeViewport(double latitude, double longitude, double pixelsPerMetre) {
+	BenchmarkViewport vp;
+	vp.latitude = latitude;
+	vp.longitude = longitude;
+	vp.pixelsPerMetre = pixelsPerMetre;
+	double halfWidth = (BENCHMARK_WIDTH / 2.0) / pixelsPerMetre;
+	double halfHeight = (BENCHMARK_HEIGHT / 2.0) / pixelsPerMetre;
+	double centre = MercatorY(latitude);
+	vp.latitudeMinimum = InverseMercatorY(centre - halfHeight);
+	vp.latitudeMaximum = InverseMercatorY(centre + halfHeight);
+	vp.longitudeMinimum = longitude - (halfWidth / BENCHMARK_EARTH_RADIUS * 180.0 / PASSAGE_PI);
+	vp.longitudeMaximum = longitude + (halfWidth / BENCHMARK_EARTH_RADIUS * 180.0 / PASSAGE_PI);
+	return vp;
+}
+
+static void AddPixel(const BenchmarkViewport &vp, double centre, const TrackPoint &point, std::vector<BenchmarkPixel> &pixels) {
+	BenchmarkPixel pixel;
+	pixel.x = (int)((BENCHMARK_WIDTH / 2.0) + ((point.longitude - vp.longitude) * PASSAGE_PI / 180.0 * BENCHMARK_EARTH_RADIUS * vp.pixelsPerMetre));
+	pixel.y = (int)((BENCHMARK_HEIGHT / 2.0) - ((MercatorY(point.latitude) - centre) * vp.pixelsPerMetre));
+	if ((pixels.empty()) || (pixels.back().x != pixel.x) || (pixels.back().y != pixel.y)) {
+		pixels.push_back(pixel);
+	}
+}
+
+// Mirrors Track_Overlay::Draw, returns the number of vertices that would be drawn
+static size_t PrepareFrame(Track_Pyramid &pyramid, const BenchmarkViewport &vp, std::vector<BenchmarkPixel> &pixels, size_t &chunksDrawn) {
+	double centre = MercatorY(vp.latitude);
+	size_t vertices = 0;
+	const std::deque<TrackChunk> &chunks = pyramid.GetChunks(pyramid.SelectLevel(vp.pixelsPerMetre));
+	for (std::deque<TrackChunk>::const_iterator it = chunks.begin(); it != chunks.end(); ++it) {
+		if (!Track_Pyramid::IsVisible(*it, vp.latitudeMinimum, vp.latitudeMaximum, vp.longitudeMinimum, vp.longitudeMaximum)) {
+			continue;
+		}
+		pixels.clear();
+		for (std::vector<TrackPoint>::const_iterator point = it->points.begin(); point != it->points.end(); ++point) {
+			AddPixel(vp, centre, *point, pixels);
+		}
+		vertices += pixels.size();
+		chunksDrawn++;
+	}
+	return vertices;
+}
+
+int main(int argc, char *argv[]) {
+	int frames = 1000;
+	if (argc > 1) {
+		frames = atoi(argv[1]);
+	}
+	if (frames < 1) {
+		printf("Usage: %s [frames]\n", argv[0]);
+		return 1;
+	}
+
+	std::vector<TrackPoint> points;
+	PassageDay(points);
+	Track_Pyramid pyramid;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (std::vector<TrackPoint>::const_iterator it = points.begin(); it != points.end(); ++it) {
+		pyramid.Add(*it);
+	}
+	std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+	printf("Filled %zu points in %.0f ns per point\n", points.size(),
+		std::chrono::duration<double, std::nano>(end - start).count() / points.size());
+
+	std::vector<BenchmarkPixel> pixels;
+	pixels.reserve(TRACK_OVERLAY_CHUNK_SIZE);
+
+	// From a harbour to an ocean, centred on the latest fix as when following the vessel
+	static const double scales[] = { 2.0, 0.2, 0.02, 0.002, 0.0002 };
+	for (size_t i = 0; i < sizeof(scales) / sizeof(scales[0]); i++) {
+		BenchmarkViewport vp = MakeViewport(points.back().latitude, points.back().longitude, scales[i]);
+		size_t vertices = 0;
+		size_t chunksDrawn = 0;
+		start = std::chrono::steady_clock::now();
+		for (int frame = 0; frame < frames; frame++) {
+			chunksDrawn = 0;
+			vertices = PrepareFrame(pyramid, vp, pixels, chunksDrawn);
+		}
+		end = std::chrono::steady_clock::now();
+
+		double microseconds = std::chrono::duration<double, std::micro>(end - start).count() / frames;
+		unsigned int level = pyramid.SelectLevel(scales[i]);
+		printf("Scale %8.4f ppm: level %u, %zu of %zu chunks drawn, %zu vertices, %.1f us per frame\n",
+			scales[i], level, chunksDrawn, pyramid.GetChunks(level).size(), vertices, microseconds);
+		if (vertices < 2) {
+			return 1;
+		}
+	}
+	return 0;
+}
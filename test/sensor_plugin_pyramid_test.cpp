@@ -0,0 +1,207 @@
+// Copyright(C) 2024 by Steven Adler
+//
+// This file is part of Windows Sensor Plugin for OpenCPN.
+//
+// Windows Sensor Plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Windows Sensor Plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Windows Sensor Plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// Project: Windows Sensor Plugin
+// Description: Standalone tests for the level of detail pyramid behind the track overlay
+// Owner: twocanplugin@hotmail.com
+// Date: 01/04/2024
+// Version History:
+// 1.0 Initial Release
+
+#include "sensor_plugin_pyramid.h"
+#include "sensor_plugin_track_passage.h"
+
+#include <stdio.h>
+
+static int failures = 0;
+
+#define CHECK_EQUAL(expected, actual) CheckEqual((long long)(expected), (long long)(actual), #actual, __LINE__)
+#define CHECK_TRUE(condition) CheckTrue((condition), #condition, __LINE__)
+
+static void CheckEqual(long long expected, long long actual, const char *expression, int line) {
+	if (expected != actual) {
+		printf("Line %d: %s is %lld, expected %lld\n", line, expression, actual, expected);
+		failures++;
+	}
+}
+
+static void CheckTrue(bool condition, const char *expression, int line) {
+	if (!condition) {
+		printf("Line %d: %s is false\n", line, expression);
+		failures++;
+	}
+}
+
+static size_t CountPoints(const std::deque<TrackChunk> &chunks) {
+	size_t count = 0;
+	for (std::deque<TrackChunk>::const_iterator it = chunks.begin(); it != chunks.end(); ++it) {
+		count += it->points.size();
+	}
+	return count;
+}
+
+static TrackChunk MakeChunk(double latitudeMinimum, double latitudeMaximum, double longitudeMinimum, double longitudeMaximum) {
+	TrackChunk chunk;
+	chunk.latitudeMinimum = latitudeMinimum;
+	chunk.latitudeMaximum = latitudeMaximum;
+	chunk.longitudeMinimum = longitudeMinimum;
+	chunk.longitudeMaximum = longitudeMaximum;
+	return chunk;
+}
+
+// Tolerances are 1, 4, 16, 64, 256 and 1024 metres
+static void TestSelectLevel(void) {
+	Track_Pyramid pyramid;
+	// Zoomed in, a metre is more than a pixel
+	CHECK_EQUAL(0, pyramid.SelectLevel(10.0));
+	CHECK_EQUAL(0, pyramid.SelectLevel(1.0));
+	CHECK_EQUAL(0, pyramid.SelectLevel(0.3));
+	CHECK_EQUAL(1, pyramid.SelectLevel(0.25));
+	CHECK_EQUAL(2, pyramid.SelectLevel(1.0 / 16.0));
+	CHECK_EQUAL(3, pyramid.SelectLevel(0.01));
+	CHECK_EQUAL(4, pyramid.SelectLevel(1.0 / 256.0));
+	CHECK_EQUAL(TRACK_OVERLAY_LEVELS - 1, pyramid.SelectLevel(1.0 / 1024.0));
+	// Zoomed out to an ocean, the coarsest level
+	CHECK_EQUAL(TRACK_OVERLAY_LEVELS - 1, pyramid.SelectLevel(0.00001));
+	// Out of range levels are clamped to the coarsest
+	CHECK_TRUE(&pyramid.GetChunks(TRACK_OVERLAY_LEVELS + 3) == &pyramid.GetChunks(TRACK_OVERLAY_LEVELS - 1));
+}
+
+// Every level is split into chunks of bounded size, each with a tight bounding box, and each starting
+// where the previous chunk ended so the drawn trail has no gaps
+static void TestChunks(void) {
+	std::vector<TrackPoint> points;
+	PassageDay(points);
+	Track_Pyramid pyramid;
+	for (std::vector<TrackPoint>::const_iterator it = points.begin(); it != points.end(); ++it) {
+		pyramid.Add(*it);
+	}
+
+	size_t previousCount = points.size() + 1;
+	for (unsigned int level = 0; level < TRACK_OVERLAY_LEVELS; level++) {
+		const std::deque<TrackChunk> &chunks = pyramid.GetChunks(level);
+		CHECK_TRUE(!chunks.empty());
+		// Each level needs no more points than the last, the coarsest levels all keep the point that closes each window
+		size_t count = CountPoints(chunks);
+		CHECK_TRUE(count <= previousCount);
+		previousCount = count;
+
+		for (size_t i = 0; i < chunks.size(); i++) {
+			const TrackChunk &chunk = chunks[i];
+			CHECK_TRUE(chunk.points.size() <= TRACK_OVERLAY_CHUNK_SIZE);
+			if (i > 0) {
+				CHECK_EQUAL(chunks[i - 1].points.back().timeStamp, chunk.points.front().timeStamp);
+				CHECK_TRUE(chunks[i - 1].points.back().latitude == chunk.points.front().latitude);
+				CHECK_TRUE(chunks[i - 1].points.back().longitude == chunk.points.front().longitude);
+			}
+			double latitudeMinimum = chunk.points.front().latitude;
+			double latitudeMaximum = latitudeMinimum;
+			double longitudeMinimum = chunk.points.front().longitude;
+			double longitudeMaximum = longitudeMinimum;
+			for (std::vector<TrackPoint>::const_iterator it = chunk.points.begin(); it != chunk.points.end(); ++it) {
+				latitudeMinimum = fmin(latitudeMinimum, it->latitude);
+				latitudeMaximum = fmax(latitudeMaximum, it->latitude);
+				longitudeMinimum = fmin(longitudeMinimum, it->longitude);
+				longitudeMaximum = fmax(longitudeMaximum, it->longitude);
+			}
+			CHECK_TRUE(chunk.latitudeMinimum == latitudeMinimum);
+			CHECK_TRUE(chunk.latitudeMaximum == latitudeMaximum);
+			CHECK_TRUE(chunk.longitudeMinimum == longitudeMinimum);
+			CHECK_TRUE(chunk.longitudeMaximum == longitudeMaximum);
+		}
+	}
+	CHECK_TRUE(CountPoints(pyramid.GetChunks(TRACK_OVERLAY_LEVELS - 1)) * 4 < CountPoints(pyramid.GetChunks(0)));
+	// The most detailed level needs several chunks for a day's sail
+	CHECK_TRUE(pyramid.GetChunks(0).size() > 10);
+	// The first fix is always retained
+	CHECK_EQUAL(points.front().timeStamp, pyramid.GetChunks(0).front().points.front().timeStamp);
+
+	pyramid.Clear();
+	for (unsigned int level = 0; level < TRACK_OVERLAY_LEVELS; level++) {
+		CHECK_TRUE(pyramid.GetChunks(level).empty());
+	}
+	// A new trail after clearing starts with its first fix
+	pyramid.Add(points[1000]);
+	CHECK_EQUAL(1, pyramid.GetChunks(0).size());
+	CHECK_EQUAL(points[1000].timeStamp, pyramid.GetChunks(0).front().points.front().timeStamp);
+}
+
+// Chunks wholly older than the length of the trail are discarded, the trail still reaches back the full 24 hours
+static void TestExpiry(void) {
+	std::vector<TrackPoint> points;
+	PassageDay(points);
+	Track_Pyramid pyramid;
+	for (std::vector<TrackPoint>::const_iterator it = points.begin(); it != points.end(); ++it) {
+		pyramid.Add(*it);
+	}
+	// Sail on for another six hours
+	TrackPoint point = points.back();
+	for (unsigned int second = 0; second < 6 * 3600; second++) {
+		point = PassageNext(point, ((second / 600) % 2) == 0 ? 35.0 : 325.0, 5.0, 1000);
+		pyramid.Add(point);
+	}
+
+	long long cutoff = point.timeStamp - TRACK_OVERLAY_DURATION;
+	for (unsigned int level = 0; level < TRACK_OVERLAY_LEVELS; level++) {
+		const std::deque<TrackChunk> &chunks = pyramid.GetChunks(level);
+		CHECK_TRUE(chunks.front().points.back().timeStamp >= cutoff);
+		CHECK_TRUE(chunks.front().points.front().timeStamp > points.front().timeStamp);
+	}
+	// The finest level is dense enough to start within a chunk's length of the cutoff
+	CHECK_TRUE(pyramid.GetChunks(0).front().points.front().timeStamp <= cutoff);
+	CHECK_TRUE(pyramid.GetChunks(0).front().points.front().timeStamp > cutoff - (TRACK_OVERLAY_CHUNK_SIZE * TRACK_WINDOW_SIZE * 1000LL));
+}
+
+static void TestVisible(void) {
+	TrackChunk chunk = MakeChunk(50.0, 50.1, -1.5, -1.4);
+	CHECK_TRUE(Track_Pyramid::IsVisible(chunk, 49.0, 51.0, -2.0, -1.0));
+	// Partially overlapping
+	CHECK_TRUE(Track_Pyramid::IsVisible(chunk, 50.05, 51.0, -1.45, -1.0));
+	// Containing the viewport
+	CHECK_TRUE(Track_Pyramid::IsVisible(chunk, 50.01, 50.02, -1.46, -1.44));
+	// North, south, east and west of the viewport
+	CHECK_TRUE(!Track_Pyramid::IsVisible(chunk, 48.0, 49.9, -2.0, -1.0));
+	CHECK_TRUE(!Track_Pyramid::IsVisible(chunk, 50.2, 51.0, -2.0, -1.0));
+	CHECK_TRUE(!Track_Pyramid::IsVisible(chunk, 49.0, 51.0, -3.0, -1.6));
+	CHECK_TRUE(!Track_Pyramid::IsVisible(chunk, 49.0, 51.0, -1.3, 0.0));
+
+	// A viewport spanning the antimeridian, given either as longitudes beyond 180 or as a minimum greater than the maximum
+	TrackChunk east = MakeChunk(-17.1, -17.0, 179.9, 179.95);
+	TrackChunk west = MakeChunk(-17.1, -17.0, -179.95, -179.9);
+	CHECK_TRUE(Track_Pyramid::IsVisible(east, -18.0, -16.0, 179.0, 181.0));
+	CHECK_TRUE(Track_Pyramid::IsVisible(west, -18.0, -16.0, 179.0, 181.0));
+	CHECK_TRUE(Track_Pyramid::IsVisible(east, -18.0, -16.0, -181.0, -179.0));
+	CHECK_TRUE(Track_Pyramid::IsVisible(west, -18.0, -16.0, 179.0, -179.0));
+	// Latitude still culls when the antimeridian is spanned
+	CHECK_TRUE(!Track_Pyramid::IsVisible(east, 10.0, 12.0, 179.0, 181.0));
+	// A viewport that stops short of the antimeridian culls the chunk on the far side
+	CHECK_TRUE(!Track_Pyramid::IsVisible(west, -18.0, -16.0, 179.0, 180.0));
+}
+
+int main(void) {
+	TestSelectLevel();
+	TestChunks();
+	TestExpiry();
+	TestVisible();
+
+	if (failures > 0) {
+		printf("%d checks failed\n", failures);
+		return 1;
+	}
+	printf("All checks passed\n");
+	return 0;
+}
@@ -0,0 +1,68 @@
+// Copyright(C) 2024 by Steven Adler
+//
+// This file is part of Windows Sensor Plugin for OpenCPN.
+//
+// Windows Sensor Plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Windows Sensor Plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Windows Sensor Plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// Project: Windows Sensor Plugin
+// Description: Compression ratio and per point cost of the streaming track simplifier
+// Owner: twocanplugin@hotmail.com
+// Date: 01/04/2024
+// Version History:
+// 1.0 Initial Release
+
+// Usage: sensor_plugin_simplifier_benchmark [days]
+// Simplifies a simulated day's sail at one fix per second, at the tolerances used for logging, export and the overlay
+
+#include "sensor_plugin_simplifier.h"
+#include "sensor_plugin_track_passage.h"
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+
+int main(int argc, char *argv[]) {
+	int days = 1;
+	if (argc > 1) {
+		days = atoi(argv[1]);
+	}
+	if (days < 1) {
+		printf("Usage: %s [days]\n", argv[0]);
+		return 1;
+	}
+
+	std::vector<TrackPoint> points;
+	PassageDay(points);
+	std::vector<TrackPoint> output;
+	output.reserve(points.size());
+
+	static const double tolerances[] = { 1.0, 5.0, 20.0, 100.0 };
+	for (size_t i = 0; i < sizeof(tolerances) / sizeof(tolerances[0]); i++) {
+		Track_Simplifier simplifier(tolerances[i], 1.0);
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		for (int day = 0; day < days; day++) {
+			PassageSimplify(simplifier, points, output);
+		}
+		std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+		double nanoseconds = std::chrono::duration<double, std::nano>(end - start).count();
+		double perPoint = nanoseconds / ((double)points.size() * days);
+		printf("Tolerance %6.1f m: %zu points in, %zu out, compression %.1f:1, %.0f ns per point\n",
+			tolerances[i], points.size(), output.size(), (double)points.size() / output.size(), perPoint);
+		if ((output.size() < 2) || (output.size() > points.size())) {
+			return 1;
+		}
+	}
+	return 0;
+}
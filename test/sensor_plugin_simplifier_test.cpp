@@ -0,0 +1,212 @@
+// Copyright(C) 2024 by Steven Adler
+//
+// This file is part of Windows Sensor Plugin for OpenCPN.
+//
+// Windows Sensor Plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Windows Sensor Plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Windows Sensor Plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// Project: Windows Sensor Plugin
+// Description: Standalone tests for the streaming track simplifier
+// Owner: twocanplugin@hotmail.com
+// Date: 01/04/2024
+// Version History:
+// 1.0 Initial Release
+
+#include "sensor_plugin_simplifier.h"
+#include "sensor_plugin_track_passage.h"
+
+#include <math.h>
+#include <stdio.h>
+
+static int failures = 0;
+
+#define CHECK_EQUAL(expected, actual) CheckEqual((long long)(expected), (long long)(actual), #actual, __LINE__)
+#define CHECK_TRUE(condition) CheckTrue((condition), #condition, __LINE__)
+
+static void CheckEqual(long long expected, long long actual, const char *expression, int line) {
+	if (expected != actual) {
+		printf("Line %d: %s is %lld, expected %lld\n", line, expression, actual, expected);
+		failures++;
+	}
+}
+
+static void CheckTrue(bool condition, const char *expression, int line) {
+	if (!condition) {
+		printf("Line %d: %s is false\n", line, expression);
+		failures++;
+	}
+}
+
+// Largest distance, in metres, between each input point and where the simplified track was at the same instant
+static double WorstError(const std::vector<TrackPoint> &input, const std::vector<TrackPoint> &output) {
+	double worst = 0.0;
+	size_t segment = 0;
+	for (std::vector<TrackPoint>::const_iterator it = input.begin(); it != input.end(); ++it) {
+		while ((segment + 2 < output.size()) && (output[segment + 1].timeStamp < it->timeStamp)) {
+			segment++;
+		}
+		const TrackPoint &start = output[segment];
+		const TrackPoint &end = output[segment + 1 < output.size() ? segment + 1 : segment];
+		double fraction = end.timeStamp > start.timeStamp ? (double)(it->timeStamp - start.timeStamp) / (double)(end.timeStamp - start.timeStamp) : 0.0;
+		double deltaLongitude = end.longitude - start.longitude;
+		if (deltaLongitude > 180.0) {
+			deltaLongitude -= 360.0;
+		}
+		else if (deltaLongitude < -180.0) {
+			deltaLongitude += 360.0;
+		}
+		double longitude = start.longitude + (fraction * deltaLongitude) - it->longitude;
+		if (longitude > 180.0) {
+			longitude -= 360.0;
+		}
+		else if (longitude < -180.0) {
+			longitude += 360.0;
+		}
+		double x = longitude * PASSAGE_METRES_PER_DEGREE * cos(start.latitude * PASSAGE_PI / 180.0);
+		double y = (start.latitude + (fraction * (end.latitude - start.latitude)) - it->latitude) * PASSAGE_METRES_PER_DEGREE;
+		worst = fmax(worst, sqrt((x * x) + (y * y)));
+	}
+	return worst;
+}
+
+static void Leg(std::vector<TrackPoint> &points, double course, double speed, unsigned int seconds) {
+	for (unsigned int i = 0; i < seconds; i++) {
+		points.push_back(PassageNext(points.back(), course, speed, 1000));
+	}
+}
+
+// A straight leg at constant speed needs only the points that close each full window
+static void TestStraightLeg(void) {
+	std::vector<TrackPoint> points(1, PassageStart(50.0, -1.5));
+	points[0].speedOverGround = 6.0;
+	Leg(points, 45.0, 6.0, 1000);
+
+	Track_Simplifier simplifier(5.0, 1.0);
+	std::vector<TrackPoint> output;
+	PassageSimplify(simplifier, points, output);
+	CHECK_EQUAL(1001, simplifier.pointsIn);
+	CHECK_EQUAL(output.size(), simplifier.pointsOut);
+	CHECK_EQUAL(2 + (1000 / TRACK_WINDOW_SIZE), output.size());
+	// The ends of the stream are always retained
+	CHECK_EQUAL(points.front().timeStamp, output.front().timeStamp);
+	CHECK_EQUAL(points.back().timeStamp, output.back().timeStamp);
+	CHECK_TRUE(WorstError(points, output) < 0.01);
+}
+
+// A turn is retained to within the tolerance
+static void TestTurn(void) {
+	std::vector<TrackPoint> points(1, PassageStart(50.0, -1.5));
+	points[0].speedOverGround = 6.0;
+	Leg(points, 0.0, 6.0, 40);
+	Leg(points, 90.0, 6.0, 40);
+
+	Track_Simplifier simplifier(5.0, 1.0);
+	std::vector<TrackPoint> output;
+	PassageSimplify(simplifier, points, output);
+	CHECK_TRUE(output.size() >= 3);
+	CHECK_TRUE(WorstError(points, output) <= 5.0);
+
+	// A coarser tolerance needs no more points
+	Track_Simplifier coarse(50.0, 1.0);
+	std::vector<TrackPoint> coarseOutput;
+	PassageSimplify(coarse, points, coarseOutput);
+	CHECK_TRUE(coarseOutput.size() <= output.size());
+	CHECK_TRUE(WorstError(points, coarseOutput) <= 50.0);
+}
+
+// Slowing down on a straight course moves no point off the line, but changes where the vessel was and when
+static void TestSpeedChange(void) {
+	std::vector<TrackPoint> points(1, PassageStart(50.0, -1.5));
+	points[0].speedOverGround = 8.0;
+	Leg(points, 90.0, 8.0, 30);
+	Leg(points, 90.0, 2.0, 30);
+
+	Track_Simplifier simplifier(5.0, 1.0);
+	std::vector<TrackPoint> output;
+	PassageSimplify(simplifier, points, output);
+	CHECK_TRUE(output.size() >= 3);
+	CHECK_TRUE(WorstError(points, output) <= 5.0);
+	bool hasSpeedChange = false;
+	for (size_t i = 1; i + 1 < output.size(); i++) {
+		if ((output[i].speedOverGround == 8.0) && (output[i + 1].speedOverGround == 2.0)) {
+			hasSpeedChange = true;
+		}
+	}
+	CHECK_TRUE(hasSpeedChange);
+}
+
+// Crossing the antimeridian is not mistaken for a jump of 360 degrees
+static void TestAntimeridian(void) {
+	std::vector<TrackPoint> points(1, PassageStart(-17.0, 179.999));
+	points[0].speedOverGround = 6.0;
+	Leg(points, 90.0, 6.0, 60);
+	CHECK_TRUE(points.back().longitude < 0.0);
+
+	Track_Simplifier simplifier(5.0, 1.0);
+	std::vector<TrackPoint> output;
+	PassageSimplify(simplifier, points, output);
+	CHECK_EQUAL(2, output.size());
+	CHECK_TRUE(WorstError(points, output) < 0.01);
+
+	// and heading west
+	points.assign(1, PassageStart(-17.0, -179.999));
+	points[0].speedOverGround = 6.0;
+	Leg(points, 270.0, 6.0, 60);
+	CHECK_TRUE(points.back().longitude > 0.0);
+	PassageSimplify(simplifier, points, output);
+	CHECK_EQUAL(2, output.size());
+	CHECK_TRUE(WorstError(points, output) < 0.01);
+}
+
+// A whole day, with noise, stays within the tolerance
+static void TestPassage(void) {
+	std::vector<TrackPoint> points;
+	PassageDay(points);
+
+	Track_Simplifier simplifier(10.0, 1.0);
+	std::vector<TrackPoint> output;
+	PassageSimplify(simplifier, points, output);
+	CHECK_TRUE(WorstError(points, output) <= 10.0);
+	CHECK_TRUE(output.size() * 10 < points.size());
+}
+
+static void TestReset(void) {
+	Track_Simplifier simplifier;
+	TrackPoint committed;
+	CHECK_EQUAL(false, simplifier.Flush(committed));
+	TrackPoint point = PassageStart(50.0, -1.5);
+	CHECK_EQUAL(true, simplifier.Add(point, committed));
+	CHECK_EQUAL(false, simplifier.Add(PassageNext(point, 0.0, 0.0, 1000), committed));
+	simplifier.Reset();
+	CHECK_EQUAL(0, simplifier.pointsIn);
+	CHECK_EQUAL(0, simplifier.pointsOut);
+	CHECK_EQUAL(false, simplifier.Flush(committed));
+	// The first point of a new stream is retained
+	CHECK_EQUAL(true, simplifier.Add(point, committed));
+}
+
+int main(void) {
+	TestStraightLeg();
+	TestTurn();
+	TestSpeedChange();
+	TestAntimeridian();
+	TestPassage();
+	TestReset();
+
+	if (failures > 0) {
+		printf("%d checks failed\n", failures);
+		return 1;
+	}
+	printf("All checks passed\n");
+	return 0;
+}
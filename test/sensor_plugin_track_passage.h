@@ -0,0 +1,115 @@
+// Copyright(C) 2024 by Steven Adler
+//
+// This file is part of Windows Sensor Plugin for OpenCPN.
+//
+// Windows Sensor Plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Windows Sensor Plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Windows Sensor Plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// Project: Windows Sensor Plugin
+// Description: Simulated passages used by the track simplifier tests and benchmark
+// Owner: twocanplugin@hotmail.com
+// Date: 01/04/2024
+// Version History:
+// 1.0 Initial Release
+
+#ifndef WINDOWS_SENSOR_PLUGIN_TRACK_PASSAGE_H
+#define WINDOWS_SENSOR_PLUGIN_TRACK_PASSAGE_H
+
+#include "sensor_plugin_simplifier.h"
+
+#include <math.h>
+#include <vector>
+
+#define PASSAGE_PI 3.14159265358979323846
+#define PASSAGE_METRES_PER_DEGREE 111195.08
+#define PASSAGE_KNOTS_TO_MS 0.514444
+
+// Dead reckon from the previous point for the given number of milliseconds at the given course and speed
+static inline TrackPoint PassageNext(const TrackPoint &previous, double course, double speed, long long interval) {
+	double distance = speed * PASSAGE_KNOTS_TO_MS * (interval / 1000.0);
+	double radians = course * PASSAGE_PI / 180.0;
+	TrackPoint point;
+	point.latitude = previous.latitude + ((distance * cos(radians)) / PASSAGE_METRES_PER_DEGREE);
+	point.longitude = previous.longitude + ((distance * sin(radians)) / (PASSAGE_METRES_PER_DEGREE * cos(previous.latitude * PASSAGE_PI / 180.0)));
+	if (point.longitude > 180.0) {
+		point.longitude -= 360.0;
+	}
+	else if (point.longitude < -180.0) {
+		point.longitude += 360.0;
+	}
+	point.speedOverGround = speed;
+	point.courseOverGround = course;
+	point.timeStamp = previous.timeStamp + interval;
+	return point;
+}
+
+static inline TrackPoint PassageStart(double latitude, double longitude) {
+	TrackPoint point;
+	point.latitude = latitude;
+	point.longitude = longitude;
+	point.speedOverGround = 0.0;
+	point.courseOverGround = 0.0;
+	// 2024-01-01 00:00:00 UTC
+	point.timeStamp = 1704067200000LL;
+	return point;
+}
+
+// A day's sail at one fix per second. Long reaches, a beat to windward with tacks every ten minutes,
+// gusts that change the speed, and a few metres of position noise from a simple deterministic generator.
+static inline void PassageDay(std::vector<TrackPoint> &points) {
+	points.clear();
+	points.reserve(86400);
+	TrackPoint point = PassageStart(50.0, -1.5);
+	point.speedOverGround = 6.0;
+	unsigned int seed = 12345;
+	TrackPoint truth = point;
+	for (unsigned int second = 0; second < 86400; second++) {
+		double course;
+		double speed;
+		unsigned int hour = second / 3600;
+		if ((hour % 6) < 3) {
+			// Reaching, with a gust every five minutes
+			course = 120.0;
+			speed = ((second / 300) % 2) == 0 ? 6.5 : 7.5;
+		}
+		else {
+			// Beating, tacking every ten minutes
+			course = ((second / 600) % 2) == 0 ? 35.0 : 325.0;
+			speed = 5.0;
+		}
+		truth = PassageNext(truth, course, speed, 1000);
+		point = truth;
+		seed = (seed * 1103515245) + 12345;
+		point.latitude += ((((seed >> 16) & 0xFF) / 255.0) - 0.5) * 4.0 / PASSAGE_METRES_PER_DEGREE;
+		seed = (seed * 1103515245) + 12345;
+		point.longitude += ((((seed >> 16) & 0xFF) / 255.0) - 0.5) * 4.0 / (PASSAGE_METRES_PER_DEGREE * cos(point.latitude * PASSAGE_PI / 180.0));
+		points.push_back(point);
+	}
+}
+
+// Simplify a whole stream, including the final flush
+static inline void PassageSimplify(Track_Simplifier &simplifier, const std::vector<TrackPoint> &points, std::vector<TrackPoint> &output) {
+	output.clear();
+	simplifier.Reset();
+	TrackPoint committed;
+	for (std::vector<TrackPoint>::const_iterator it = points.begin(); it != points.end(); ++it) {
+		if (simplifier.Add(*it, committed)) {
+			output.push_back(committed);
+		}
+	}
+	if (simplifier.Flush(committed)) {
+		output.push_back(committed);
+	}
+}
+
+#endif